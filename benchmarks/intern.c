@@ -0,0 +1,74 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#   define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef _WIN32
+#   include <windows.h>
+#endif
+
+#include "instance.h"
+#include "debug.h"
+
+// Measures pmap calls which mostly create and release strings, all of
+// which are interned in the table shared by the threads of the map
+
+// Same as the range mapped by the script
+#define _MG_BENCH_ITEMS 4000
+
+static const char *_mgBenchScript =
+	"func names(i)\n"
+	"\tkeys = {}\n"
+	"\tfor j in range(100)\n"
+	"\t\tkey = \"item_\" + string(j % 40)\n"
+	"\t\tkeys[key] = string(i) + \"_\" + key\n"
+	"\treturn len(keys)\n"
+	"\n"
+	"counts = pmap(names, range(4000))\n"
+	"assert len(counts) == 4000\n";
+
+static double _mgBenchTime(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER time, frequency;
+
+	QueryPerformanceCounter(&time);
+	QueryPerformanceFrequency(&frequency);
+
+	return (double) time.QuadPart / (double) frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+	static const unsigned int threadCounts[] = { 1, 2, 4, 8 };
+
+	printf("%8s %14s %14s\n", "threads", "total (ms)", "item (us)");
+
+	for (size_t i = 0; i < sizeof(threadCounts) / sizeof(*threadCounts); ++i)
+	{
+		MGInstance instance;
+		mgCreateInstance(&instance);
+
+		instance.threadCount = threadCounts[i];
+
+		const double start = _mgBenchTime();
+		mgRunString(&instance, _mgBenchScript, "<bench>");
+		const double elapsed = _mgBenchTime() - start;
+
+		mgDestroyInstance(&instance);
+
+		printf("%8u %14.1f %14.1f\n", threadCounts[i],
+		       elapsed * 1e3, elapsed * 1e6 / _MG_BENCH_ITEMS);
+	}
+
+	return EXIT_SUCCESS;
+}
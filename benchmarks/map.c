@@ -0,0 +1,87 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "value.h"
+#include "types/primitive.h"
+#include "types/composite.h"
+#include "utilities.h"
+#include "debug.h"
+
+// Measures the cost of a lookup in a map with a growing
+// number of entries, e.g. the globals of a module
+
+#define _MG_BENCH_LOOKUPS 4000000
+
+static const MGValue* _mgLinearMapGet(const MGValueMap *map, const char *key)
+{
+	for (size_t i = 0; i < _mgMapSize(*map); ++i)
+		if (!strcmp(_mgListGet(map->pairs, i).key, key))
+			return _mgListGet(map->pairs, i).value;
+	return NULL;
+}
+
+static double _mgBenchSeconds(clock_t start)
+{
+	return (double) (clock() - start) / (double) CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+	static const size_t sizes[] = { 1, 4, 8, 16, 64, 256, 1024, 4096 };
+
+	printf("%8s %14s %14s %14s\n", "globals", "hit (ns)", "miss (ns)", "linear (ns)");
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i)
+	{
+		const size_t size = sizes[i];
+
+		MGValue *map = mgCreateValueMap(size);
+
+		char **names = (char**) malloc(size * sizeof(char*));
+		for (size_t j = 0; j < size; ++j)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "global_%zu", j);
+			names[j] = mgStringDuplicate(name);
+			mgMapSet(map, name, mgCreateValueInteger((int) j));
+		}
+
+		volatile size_t found = 0;
+		clock_t start;
+
+		start = clock();
+		for (size_t j = 0; j < _MG_BENCH_LOOKUPS; ++j)
+			found += mgMapGet(map, names[j % size]) != NULL;
+		const double hit = _mgBenchSeconds(start);
+
+		start = clock();
+		for (size_t j = 0; j < _MG_BENCH_LOOKUPS; ++j)
+			found += mgMapGet(map, "missing") != NULL;
+		const double miss = _mgBenchSeconds(start);
+
+		// Linear scans get slow quickly, so do fewer of them
+		const size_t linearLookups = _MG_BENCH_LOOKUPS / (size < 64 ? 1 : size / 64);
+		start = clock();
+		for (size_t j = 0; j < linearLookups; ++j)
+			found += _mgLinearMapGet(&map->data.m, names[j % size]) != NULL;
+		const double linear = _mgBenchSeconds(start);
+
+		MG_ASSERT(found == _MG_BENCH_LOOKUPS + linearLookups);
+
+		printf("%8zu %14.1f %14.1f %14.1f\n", size,
+		       hit * 1e9 / _MG_BENCH_LOOKUPS,
+		       miss * 1e9 / _MG_BENCH_LOOKUPS,
+		       linear * 1e9 / (double) linearLookups);
+
+		for (size_t j = 0; j < size; ++j)
+			free(names[j]);
+		free(names);
+
+		mgDestroyValue(map);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -17,7 +17,7 @@ _cflags.append("-DMG_ANSI_COLORS")
 debug_cflags = _cflags + ["-DDEBUG", "-g", "-O0", "-Wno-unused-function", "-Wno-unused-variable", "-Wno-unused-but-set-variable"]
 release_cflags = _cflags + ["-O3"]
 cflags = release_cflags
-ldflags = ["-lm"]
+ldflags = ["-lm"] if os.name == "nt" else ["-lm", "-lpthread"]
 
 
 modelgen_dir = os.path.abspath(os.path.dirname(__file__))
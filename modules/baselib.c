@@ -8,7 +8,13 @@
 #include "types/primitive.h"
 #include "types/composite.h"
 #include "types/module.h"
+#include "types/vector.h"
+#include "types/matrix.h"
+#include "types/buffer.h"
 #include "callable.h"
+#include "range.h"
+#include "iterator.h"
+#include "parallel.h"
 #include "eval.h"
 #include "interpret.h"
 #include "inspect.h"
@@ -26,7 +32,7 @@ static MGValue* mg_print(MGInstance *instance, size_t argc, const MGValue* const
 
 		const MGValue *value = argv[i];
 
-		if (value->type != MG_TYPE_STRING)
+		if (mgValueType(value) != MG_TYPE_STRING)
 			mgInspectValueEx(argv[i], MG_FALSE);
 		else if (value->data.str.s)
 			fputs(value->data.str.s, stdout);
@@ -38,100 +44,13 @@ static MGValue* mg_print(MGInstance *instance, size_t argc, const MGValue* const
 }
 
 
-MGValue* _mg_rangei(int start, int stop, int step)
-{
-	int difference = stop - start;
-
-	if (difference == 0)
-		return mgCreateValueList(0);
-
-	if (step == 0)
-		step = (difference > 0) - (difference < 0);
-
-	if ((difference ^ step) < 0)
-		return mgCreateValueList(0);
-
-	int length = difference / step + ((difference % step) != 0);
-
-	MGValue *range = mgCreateValueList((size_t) length);
-	for (int i = 0; i < length; ++i)
-		mgListAdd(range, mgCreateValueInteger(start + step * i));
-
-	return range;
-}
-
-
-static MGValue* _mg_rangef(float start, float stop, float step)
-{
-	float difference = stop - start;
-
-	if (MG_FEQUAL(difference, 0.0f))
-		return mgCreateValueList(0);
-
-	if (MG_FEQUAL(step, 0.0f))
-		step = (float) ((difference > 0) - (difference < 0));
-
-	int length = (int) ceilf((stop - start) / step);
-
-	if (length < 0)
-		return mgCreateValueList(0);
-
-	MGValue *range = mgCreateValueList((size_t) length);
-	for (int i = 0; i < length; ++i)
-		mgListAdd(range, mgCreateValueFloat(start + step * i));
-
-	return range;
-}
-
-
 // Returns a tuple containing values within the half-closed interval [start, stop)
-static MGValue* mg_range(MGInstance *instance, size_t argc, const MGValue* const* argv)
+MGValue* mg_range(MGInstance *instance, size_t argc, const MGValue* const* argv)
 {
-	mgCheckArgumentCount(instance, argc, 1, 3);
-	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
-
-	if (argc < 1)
-		mgFatalError("Error: range expected at least 1 argument, received %zu", argc);
-	else if (argc > 3)
-		mgFatalError("Error: range expected at most 3 arguments, received %zu", argc);
-
-	MGbool isInt = MG_TRUE;
-
-	for (size_t i = 0; i < argc; ++i)
-		if (argv[i]->type == MG_TYPE_FLOAT)
-			isInt = MG_FALSE;
-
-	union {
-		int i[3];
-		float f[3];
-	} range;
+	MGRange range;
+	mgCreateRangeFromArguments(&range, instance, argc, argv);
 
-	memset(&range, 0, sizeof(range));
-
-	if (isInt)
-	{
-		if (argc > 1)
-			for (size_t i = 0; i < argc; ++i)
-				range.i[i] = argv[i]->data.i;
-		else
-			range.i[1] = argv[0]->data.i;
-	}
-	else
-	{
-		if (argc > 1)
-			for (size_t i = 0; i < argc; ++i)
-				range.f[i] = (argv[i]->type == MG_TYPE_INTEGER) ? (float) argv[i]->data.i : argv[i]->data.f;
-		else
-			range.f[1] = (argv[0]->type == MG_TYPE_INTEGER) ? (float) argv[0]->data.i : argv[0]->data.f;
-	}
-
-	if (argc > 2)
-		if ((isInt && (range.i[2] == 0)) || (!isInt && MG_FEQUAL(range.f[2], 0.0f)))
-			mgFatalError("Error: step cannot be 0");
-
-	return isInt ?
-	       _mg_rangei(range.i[0], range.i[1], range.i[2]) :
-	       _mg_rangef(range.f[0], range.f[1], range.f[2]);
+	return mgRangeToList(&range);
 }
 
 
@@ -140,7 +59,7 @@ static MGValue* mg_enumerate(MGInstance *instance, size_t argc, const MGValue* c
 	mgCheckArgumentCount(instance, argc, 1, 2);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_TUPLE, MG_TYPE_LIST, 1, MG_TYPE_INTEGER);
 
-	int start = (argc > 1) ? argv[1]->data.i : 0;
+	int start = (argc > 1) ? mgIntegerGet(argv[1]) : 0;
 
 	size_t length = mgListLength(argv[0]);
 
@@ -157,7 +76,7 @@ static MGValue* mg_consecutive(MGInstance *instance, size_t argc, const MGValue*
 	mgCheckArgumentCount(instance, argc, 1, 2);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_TUPLE, MG_TYPE_LIST, 1, MG_TYPE_INTEGER);
 
-	intmax_t n = (argc > 1) ? (intmax_t) argv[1]->data.i : 2;
+	intmax_t n = (argc > 1) ? (intmax_t) mgIntegerGet(argv[1]) : 2;
 
 	const MGValue *list = argv[0];
 	const intmax_t length = (intmax_t) mgListLength(list) - n + 1;
@@ -251,6 +170,65 @@ static MGValue* mg_map(MGInstance *instance, size_t argc, const MGValue* const*
 }
 
 
+// Same as map, except the calls are spread across threads, see parallel.h
+static MGValue* mg_pmap(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 9);
+	mgCheckArgumentTypes(instance, argc, argv,
+	                     3, MG_TYPE_CFUNCTION, MG_TYPE_BOUND_CFUNCTION, MG_TYPE_FUNCTION,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST);
+
+	return mgParallelMap(instance, argv[0], argc - 1, argv + 1);
+}
+
+
+static MGValue* mg_spawn(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, SIZE_MAX);
+	mgCheckArgumentTypes(instance, 1, argv, 4, MG_TYPE_CFUNCTION, MG_TYPE_BOUND_CFUNCTION, MG_TYPE_FUNCTION, MG_TYPE_PROCEDURE);
+
+	return mgSpawnTask(instance, argv[0], argc - 1, argv + 1);
+}
+
+
+// Waits for all pending tasks, a single future returns its
+// result, while several or a list of futures return a list
+static MGValue* mg_wait(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	if (argc == 0)
+	{
+		mgWaitTasks(instance);
+		return MG_NULL_VALUE;
+	}
+	else if ((argc == 1) && (mgValueType(argv[0]) == MG_TYPE_FUTURE))
+		return mgWaitFuture(instance, argv[0]);
+
+	if ((argc == 1) && ((mgValueType(argv[0]) == MG_TYPE_TUPLE) || (mgValueType(argv[0]) == MG_TYPE_LIST)))
+	{
+		argc = mgListLength(argv[0]);
+		argv = (const MGValue* const*) _mgListItems(argv[0]->data.a);
+	}
+
+	for (size_t i = 0; i < argc; ++i)
+		if (mgValueType(argv[i]) != MG_TYPE_FUTURE)
+			mgFatalError("Error: %s expected argument %zu as \"%s\", received \"%s\"", mgGetCalleeName(instance), i + 1, mgGetTypeName(MG_TYPE_FUTURE), mgGetTypeName(mgValueType(argv[i])));
+
+	MGValue *results = mgCreateValueList(argc);
+
+	for (size_t i = 0; i < argc; ++i)
+		mgListAdd(results, mgWaitFuture(instance, argv[i]));
+
+	return results;
+}
+
+
 static MGValue* mg_filter(MGInstance *instance, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 2, 2);
@@ -269,9 +247,9 @@ static MGValue* mg_filter(MGInstance *instance, size_t argc, const MGValue* cons
 
 		MGValue *filtered = mgCall(instance, callable, 1, argv2);
 		MG_ASSERT(filtered);
-		MG_ASSERT(filtered->type == MG_TYPE_INTEGER);
+		MG_ASSERT(mgValueType(filtered) == MG_TYPE_INTEGER);
 
-		if (filtered->data.i)
+		if (mgIntegerGet(filtered))
 			mgListAdd(result, mgReferenceValue(item));
 
 		mgDestroyValue(filtered);
@@ -281,6 +259,271 @@ static MGValue* mg_filter(MGInstance *instance, size_t argc, const MGValue* cons
 }
 
 
+// Lazy counterparts of the functions above, which for loops call
+// to step through their results instead of creating lists, where
+// lists may also be iterators created for nested calls
+
+
+static MGValue* mg_range_iterator(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	MGRange range;
+	mgCreateRangeFromArguments(&range, instance, argc, argv);
+
+	return mgCreateRangeIterator(&range);
+}
+
+
+static MGValue* _mg_enumerate_next(MGValue *iterator)
+{
+	MGValue *item = mgIteratorNext(_mgListGet(iterator->data.iter->values, 0));
+
+	if (!item)
+		return NULL;
+
+	return mgCreateValueTupleEx(2, mgCreateValueInteger((int) (iterator->data.iter->count + iterator->data.iter->index++)), item);
+}
+
+
+static MGValue* mg_enumerate_iterator(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_TUPLE, MG_TYPE_LIST, 1, MG_TYPE_INTEGER);
+
+	MGValue *iterator = mgCreateValueIterator(instance, _mg_enumerate_next, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgCreateIterator(argv[0]));
+
+	iterator->data.iter->count = (argc > 1) ? mgIntegerGet(argv[1]) : 0;
+
+	return iterator;
+}
+
+
+static MGValue* _mg_consecutive_next(MGValue *iterator)
+{
+	MGValue *items = _mgListGet(iterator->data.iter->values, 0);
+	MGValue *window = iterator->data.iter->window;
+
+	const intmax_t n = iterator->data.iter->count;
+
+	if (n < 1)
+		return NULL;
+
+	// Like consecutive(), at least two tuples are required
+	if (iterator->data.iter->index++ == 0)
+	{
+		for (intmax_t i = 0; i <= n; ++i)
+		{
+			MGValue *item = mgIteratorNext(items);
+
+			if (!item)
+			{
+				mgListClear(window);
+				return NULL;
+			}
+
+			mgListAdd(window, item);
+		}
+	}
+
+	if ((intmax_t) mgListLength(window) < n)
+		return NULL;
+
+	MGValue *tuple = mgCreateValueTuple((size_t) n);
+
+	for (intmax_t i = 0; i < n; ++i)
+		mgListAdd(tuple, mgReferenceValue(_mgListGet(window->data.a, i)));
+
+	mgListRemove(window, 0);
+
+	if ((intmax_t) mgListLength(window) < n)
+	{
+		MGValue *item = mgIteratorNext(items);
+
+		if (item)
+			mgListAdd(window, item);
+	}
+
+	return tuple;
+}
+
+
+static MGValue* mg_consecutive_iterator(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_TUPLE, MG_TYPE_LIST, 1, MG_TYPE_INTEGER);
+
+	MGValue *iterator = mgCreateValueIterator(instance, _mg_consecutive_next, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgCreateIterator(argv[0]));
+
+	iterator->data.iter->count = (argc > 1) ? (intmax_t) mgIntegerGet(argv[1]) : 2;
+	iterator->data.iter->window = mgCreateValueList((iterator->data.iter->count > 0) ? (size_t) iterator->data.iter->count + 1 : 0);
+
+	return iterator;
+}
+
+
+// Gets the next item of every iterator, or returns MG_FALSE once any is exhausted
+static MGbool _mg_iterators_next(MGValue *iterator, MGValue **items)
+{
+	const size_t count = _mgListLength(iterator->data.iter->values);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		items[i] = mgIteratorNext(_mgListGet(iterator->data.iter->values, i));
+
+		if (!items[i])
+		{
+			for (size_t j = 0; j < i; ++j)
+				mgDestroyValue(items[j]);
+
+			return MG_FALSE;
+		}
+	}
+
+	return MG_TRUE;
+}
+
+
+static MGValue* _mg_zip_next(MGValue *iterator)
+{
+	const size_t count = _mgListLength(iterator->data.iter->values);
+	MGValue *items[8] = { NULL };
+
+	if (!_mg_iterators_next(iterator, items))
+		return NULL;
+
+	MGValue *tuple = mgCreateValueTuple(count);
+
+	for (size_t i = 0; i < count; ++i)
+		mgListAdd(tuple, items[i]);
+
+	return tuple;
+}
+
+
+static MGValue* mg_zip_iterator(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 8);
+	mgCheckArgumentTypes(instance, argc, argv,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST);
+
+	MGValue *iterator = mgCreateValueIterator(instance, _mg_zip_next, argc);
+
+	for (size_t i = 0; i < argc; ++i)
+		_mgListAdd(MGValue*, iterator->data.iter->values, mgCreateIterator(argv[i]));
+
+	return iterator;
+}
+
+
+static MGValue* _mg_map_next(MGValue *iterator)
+{
+	const size_t count = _mgListLength(iterator->data.iter->values);
+	MGValue *items[8] = { NULL };
+
+	if (!_mg_iterators_next(iterator, items))
+		return NULL;
+
+	MGValue *mapped = mgCall(iterator->data.iter->instance, iterator->data.iter->callable, count, (const MGValue* const*) items);
+
+	for (size_t i = 0; i < count; ++i)
+		mgDestroyValue(items[i]);
+
+	return mapped;
+}
+
+
+static MGValue* mg_map_iterator(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 9);
+	mgCheckArgumentTypes(instance, argc, argv,
+	                     3, MG_TYPE_CFUNCTION, MG_TYPE_BOUND_CFUNCTION, MG_TYPE_FUNCTION,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST,
+	                     2, MG_TYPE_TUPLE, MG_TYPE_LIST);
+
+	MGValue *iterator = mgCreateValueIterator(instance, _mg_map_next, argc - 1);
+	iterator->data.iter->callable = mgReferenceValue(argv[0]);
+
+	for (size_t i = 1; i < argc; ++i)
+		_mgListAdd(MGValue*, iterator->data.iter->values, mgCreateIterator(argv[i]));
+
+	return iterator;
+}
+
+
+static MGValue* _mg_filter_next(MGValue *iterator)
+{
+	for (MGValue *item; (item = mgIteratorNext(_mgListGet(iterator->data.iter->values, 0)));)
+	{
+		const MGValue* const argv[1] = { item };
+
+		MGValue *filtered = mgCall(iterator->data.iter->instance, iterator->data.iter->callable, 1, argv);
+		MG_ASSERT(filtered);
+		MG_ASSERT(mgValueType(filtered) == MG_TYPE_INTEGER);
+
+		const MGbool keep = (MGbool) (mgIntegerGet(filtered) != 0);
+		mgDestroyValue(filtered);
+
+		if (keep)
+			return item;
+
+		mgDestroyValue(item);
+	}
+
+	return NULL;
+}
+
+
+static MGValue* mg_filter_iterator(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 3, MG_TYPE_CFUNCTION, MG_TYPE_BOUND_CFUNCTION, MG_TYPE_FUNCTION, 2, MG_TYPE_TUPLE, MG_TYPE_LIST);
+
+	MGValue *iterator = mgCreateValueIterator(instance, _mg_filter_next, 1);
+	iterator->data.iter->callable = mgReferenceValue(argv[0]);
+
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgCreateIterator(argv[1]));
+
+	return iterator;
+}
+
+
+static const struct {
+	MGCFunction func;
+	MGIteratorCFunction iterate;
+} _mg_iterator_functions[] = {
+	{ mg_range, mg_range_iterator },
+	{ mg_enumerate, mg_enumerate_iterator },
+	{ mg_consecutive, mg_consecutive_iterator },
+	{ mg_zip, mg_zip_iterator },
+	{ mg_map, mg_map_iterator },
+	{ mg_filter, mg_filter_iterator }
+};
+
+
+MGIteratorCFunction _mg_iterator_function(MGCFunction func)
+{
+	for (size_t i = 0; i < sizeof(_mg_iterator_functions) / sizeof(*_mg_iterator_functions); ++i)
+		if (_mg_iterator_functions[i].func == func)
+			return _mg_iterator_functions[i].iterate;
+
+	return NULL;
+}
+
+
 static MGValue* mg_reduce(MGInstance *instance, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 2, 2);
@@ -292,7 +535,7 @@ static MGValue* mg_reduce(MGInstance *instance, size_t argc, const MGValue* cons
 
 	if (length < 1)
 		mgFatalError("Error: reduce expected argument %zu as a non-empty \"%s\"",
-		        2, mgGetTypeName(list->type));
+		        2, mgGetTypeName(mgValueType(list)));
 
 	MGValue *result = mgReferenceValue(_mgListGet(list->data.a, 0));
 
@@ -349,7 +592,7 @@ static MGValue* mg_type(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 0);
 
-	return mgCreateValueStringEx(mgGetTypeName(argv[0]->type), MG_STRING_USAGE_STATIC);
+	return mgCreateValueInternedString(instance->typeNames[mgValueType(argv[0])]);
 }
 
 
@@ -357,7 +600,7 @@ MGValue* mg_len(MGInstance *instance, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 1, 1);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_TUPLE:
 	case MG_TYPE_LIST:
@@ -366,8 +609,16 @@ MGValue* mg_len(MGInstance *instance, size_t argc, const MGValue* const* argv)
 		return mgCreateValueInteger((int) mgMapSize(argv[0]));
 	case MG_TYPE_STRING:
 		return mgCreateValueInteger((int) mgStringLength(argv[0]));
+	case MG_TYPE_VEC2:
+	case MG_TYPE_VEC3:
+	case MG_TYPE_VEC4:
+		return mgCreateValueInteger((int) mgVectorLength(argv[0]));
+	case MG_TYPE_MAT4:
+		return mgCreateValueInteger(4);
+	case MG_TYPE_BUFFER:
+		return mgCreateValueInteger((int) mgBufferLength(argv[0]));
 	default:
-		mgFatalError("Error: \"%s\" has no length", mgGetTypeName(argv[0]->type));
+		mgFatalError("Error: \"%s\" has no length", mgGetTypeName(mgValueType(argv[0])));
 		return MG_NULL_VALUE;
 	}
 }
@@ -390,14 +641,14 @@ static MGValue* mg_int(MGInstance *instance, size_t argc, const MGValue* const*
 	else
 		mgCheckArgumentTypes(instance, argc, argv, 3, MG_TYPE_INTEGER, MG_TYPE_FLOAT, MG_TYPE_STRING);
 
-	int base = (argc == 2) ? argv[1]->data.i : 10;
+	int base = (argc == 2) ? mgIntegerGet(argv[1]) : 10;
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger(argv[0]->data.i);
+		return mgCreateValueInteger(mgIntegerGet(argv[0]));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueInteger((int) argv[0]->data.f);
+		return mgCreateValueInteger((int) mgFloatGet(argv[0]));
 	case MG_TYPE_STRING:
 		return mgCreateValueInteger(strtol(argv[0]->data.str.s, NULL, base));
 	default:
@@ -411,12 +662,12 @@ static MGValue* mg_float(MGInstance *instance, size_t argc, const MGValue* const
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 3, MG_TYPE_INTEGER, MG_TYPE_FLOAT, MG_TYPE_STRING);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat((float) argv[0]->data.i);
+		return mgCreateValueFloat((float) mgIntegerGet(argv[0]));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(argv[0]->data.f);
+		return mgCreateValueFloat(mgFloatGet(argv[0]));
 	case MG_TYPE_STRING:
 		return mgCreateValueFloat(strtof(argv[0]->data.str.s, NULL));
 	default:
@@ -439,6 +690,333 @@ static MGValue* mg_string(MGInstance *instance, size_t argc, const MGValue* cons
 }
 
 
+// vec2(x, y), vec3(x, y, z) and vec4(x, y, z, w), or given a single
+// number used for every component, or a tuple or list of numbers
+static MGValue* _mg_vector(MGInstance *instance, size_t length, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, length);
+
+	float components[4];
+
+	if (argc == 1)
+	{
+		mgCheckArgumentTypes(instance, argc, argv, 5, MG_TYPE_INTEGER, MG_TYPE_FLOAT, MG_TYPE_TUPLE, MG_TYPE_LIST, (MGType) (MG_TYPE_VEC2 + (length - 2)));
+
+		if (!mgVectorLoad(argv[0], length, components))
+			mgFatalError("Error: %s expected a %s of %zu numbers", mgGetCalleeName(instance), mgGetTypeName(mgValueType(argv[0])), length);
+	}
+	else
+	{
+		mgCheckArgumentCount(instance, argc, length, length);
+
+		for (size_t i = 0; i < length; ++i)
+		{
+			if (!mgIsNumericValue(argv[i]))
+				mgFatalError("Error: %s expected argument %zu as \"%s\" or \"%s\", received \"%s\"", mgGetCalleeName(instance), i + 1,
+				             mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT), mgGetTypeName(mgValueType(argv[i])));
+
+			components[i] = _mgNumericGet(argv[i]);
+		}
+	}
+
+	return mgCreateValueVector(length, components);
+}
+
+
+static MGValue* mg_vec2(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	return _mg_vector(instance, 2, argc, argv);
+}
+
+
+static MGValue* mg_vec3(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	return _mg_vector(instance, 3, argc, argv);
+}
+
+
+static MGValue* mg_vec4(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	return _mg_vector(instance, 4, argc, argv);
+}
+
+
+// buffer(elements, format = "float", components = 0), where elements
+// is a tuple, list or buffer, or the number of elements being zero
+static MGValue* mg_buffer(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 3);
+	mgCheckArgumentTypes(instance, argc, argv, 4, MG_TYPE_INTEGER, MG_TYPE_TUPLE, MG_TYPE_LIST, MG_TYPE_BUFFER, 1, MG_TYPE_STRING, 1, MG_TYPE_INTEGER);
+
+	MGBufferFormat format = MG_BUFFER_FORMAT_FLOAT;
+
+	if ((argc > 1) && !mgLookupBufferFormat(argv[1]->data.str.s, &format))
+		mgFatalError("Error: %s expected format \"%s\" or \"%s\", received \"%s\"", mgGetCalleeName(instance),
+		             mgGetBufferFormatName(MG_BUFFER_FORMAT_FLOAT), mgGetBufferFormatName(MG_BUFFER_FORMAT_INT), argv[1]->data.str.s);
+
+	const int components = (argc > 2) ? mgIntegerGet(argv[2]) : 0;
+
+	if (components < 0)
+		mgFatalError("Error: %s expected a positive number of components, received %d", mgGetCalleeName(instance), components);
+
+	if (mgValueType(argv[0]) == MG_TYPE_INTEGER)
+	{
+		if (mgIntegerGet(argv[0]) < 0)
+			mgFatalError("Error: %s expected a positive number of elements, received %d", mgGetCalleeName(instance), mgIntegerGet(argv[0]));
+
+		return mgCreateValueBuffer(format, components ? (size_t) components : 1, (size_t) mgIntegerGet(argv[0]));
+	}
+
+	MGValue *buffer = mgCreateValueBufferFrom(argv[0], format, (size_t) components);
+
+	if (buffer == NULL)
+		mgFatalError("Error: %s expected elements of %s numbers", mgGetCalleeName(instance), components ? "as many" : "the same number of");
+
+	return buffer;
+}
+
+
+typedef struct MGEmitTransform {
+	MGbool offset, transform;
+	float center[3];
+	float matrix[16], rotation[16];
+} MGEmitTransform;
+
+
+// Offsets and transforms the position and normal in the same order
+// as geom.vertex, such that both yield exactly the same vertices
+static inline void _mg_emit_vertex(MGVertex vertex, const float *position, const float *normal, const MGEmitTransform *transform)
+{
+	float p[4] = { position[0], position[1], position[2], 1.0f };
+	float n[4] = { normal[0], normal[1], normal[2], 1.0f };
+
+	if (transform->offset)
+		for (int i = 0; i < 3; ++i)
+			p[i] += transform->center[i];
+
+	if (transform->transform)
+	{
+		mgMatrixTransform(p, transform->matrix, p);
+		mgMatrixTransform(n, transform->rotation, n);
+	}
+
+	memcpy(vertex, p, 3 * sizeof(float));
+	memcpy(vertex + 3, n, 3 * sizeof(float));
+}
+
+
+// Emits the triangle with the normal geom.get_triangle_normal yields
+static inline void _mg_emit_triangle(MGVertex *vertices, float (*p)[3], MGbool clockwise, const MGEmitTransform *transform)
+{
+	if (clockwise)
+	{
+		float t[3];
+
+		memcpy(t, p[1], sizeof(t));
+		memcpy(p[1], p[2], sizeof(t));
+		memcpy(p[2], t, sizeof(t));
+	}
+
+	const float a[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+	const float b[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+
+	const float normal[3] = {
+		(a[1] * b[2]) - (a[2] * b[1]),
+		(a[2] * b[0]) - (a[0] * b[2]),
+		(a[0] * b[1]) - (a[1] * b[0])
+	};
+
+	for (int i = 0; i < 3; ++i)
+		_mg_emit_vertex(vertices[i], p[i], normal, transform);
+}
+
+
+static inline void _mg_emit_buffer_load(const MGValue *buffer, size_t index, size_t count, float *components)
+{
+	const size_t offset = index * mgBufferComponents(buffer);
+
+	if (mgBufferFormat(buffer) == MG_BUFFER_FORMAT_FLOAT)
+		memcpy(components, mgBufferFloats(buffer) + offset, count * sizeof(float));
+	else
+		for (size_t i = 0; i < count; ++i)
+			components[i] = (float) mgBufferInts(buffer)[offset + i];
+}
+
+
+// emit_many(vertices, matrix = null, center = null, clockwise = false),
+// where vertices is a buffer of whole vertices, or a buffer of positions,
+// tuple or list of triangles, each emitted like geom.triangle would.
+// Positions are offset by center then transformed by matrix, while
+// normals are transformed by mat.get_rotation(matrix)
+static MGValue* mg_emit_many(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 4);
+	mgCheckArgumentTypes(instance, argc, argv, 3, MG_TYPE_TUPLE, MG_TYPE_LIST, MG_TYPE_BUFFER, 0, 0, 1, MG_TYPE_INTEGER);
+
+	const unsigned int vertexSize = mgInstanceGetVertexSize(instance);
+	const MGValue *elements = argv[0];
+
+	MGEmitTransform transform;
+	transform.offset = (argc > 2) && (mgValueType(argv[2]) != MG_TYPE_NULL);
+	transform.transform = (argc > 1) && (mgValueType(argv[1]) != MG_TYPE_NULL);
+
+	const MGbool clockwise = (argc > 3) && mgIntegerGet(argv[3]);
+
+	if ((vertexSize != 6) || (instance->vertexSize.position != 3) || (instance->vertexSize.normal != 3))
+		mgFatalError("Error: %s expected vertices of a position and normal", mgGetCalleeName(instance));
+
+	if (transform.transform)
+	{
+		if (!mgMatrixLoad(argv[1], transform.matrix))
+			mgFatalError("Error: %s expected argument 2 as \"%s\", received \"%s\"",
+			             mgGetCalleeName(instance), mgGetTypeName(MG_TYPE_MAT4), mgGetTypeName(mgValueType(argv[1])));
+
+		mgMatrixRotation(transform.rotation, transform.matrix);
+	}
+
+	if (transform.offset && !mgVectorLoad(argv[2], 3, transform.center))
+		mgFatalError("Error: %s expected argument 3 as \"%s\", received \"%s\"",
+		             mgGetCalleeName(instance), mgGetTypeName(MG_TYPE_VEC3), mgGetTypeName(mgValueType(argv[2])));
+
+	const MGbool whole = mgIsBufferValue(elements) && (mgBufferComponents(elements) == vertexSize);
+
+	size_t vertexCount;
+
+	if (whole)
+		vertexCount = mgBufferLength(elements);
+	else if (mgIsBufferValue(elements))
+	{
+		if ((mgBufferComponents(elements) != 3) || (mgBufferLength(elements) % 3))
+			mgFatalError("Error: %s expected a buffer of %u components, or of positions forming triangles",
+			             mgGetCalleeName(instance), vertexSize);
+
+		vertexCount = mgBufferLength(elements);
+	}
+	else
+		vertexCount = mgListLength(elements) * 3;
+
+	// Reserved once, as every element is known to emit a fixed number of vertices
+	while (_mgListCapacity(instance->vertices) < (_mgListLength(instance->vertices) + vertexCount))
+		_mgListGrow(MGVertex, instance->vertices);
+
+	MGVertex *vertices = _mgListItems(instance->vertices) + _mgListLength(instance->vertices);
+
+	if (whole)
+	{
+		if (!transform.offset && !transform.transform && (mgBufferFormat(elements) == MG_BUFFER_FORMAT_FLOAT))
+			memcpy(vertices, mgBufferFloats(elements), vertexCount * sizeof(MGVertex));
+		else
+		{
+			for (size_t i = 0; i < vertexCount; ++i)
+			{
+				float v[6];
+				_mg_emit_buffer_load(elements, i, 6, v);
+				_mg_emit_vertex(vertices[i], v, v + 3, &transform);
+			}
+		}
+	}
+	else if (mgIsBufferValue(elements))
+	{
+		for (size_t i = 0; i < vertexCount; i += 3)
+		{
+			float p[3][3];
+
+			for (size_t j = 0; j < 3; ++j)
+				_mg_emit_buffer_load(elements, i + j, 3, p[j]);
+
+			_mg_emit_triangle(vertices + i, p, clockwise, &transform);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < vertexCount; i += 3)
+		{
+			const MGValue *triangle = mgListGet(elements, i / 3);
+			float p[3][3];
+
+			if (((mgValueType(triangle) != MG_TYPE_TUPLE) && (mgValueType(triangle) != MG_TYPE_LIST)) || (mgListLength(triangle) != 3))
+				mgFatalError("Error: %s expected triangles of 3 positions", mgGetCalleeName(instance));
+
+			for (size_t j = 0; j < 3; ++j)
+				if (!mgVectorLoad(mgListGet(triangle, j), 3, p[j]))
+					mgFatalError("Error: %s expected positions of 3 numbers", mgGetCalleeName(instance));
+
+			_mg_emit_triangle(vertices + i, p, clockwise, &transform);
+		}
+	}
+
+	_mgListLength(instance->vertices) += vertexCount;
+
+	return MG_NULL_VALUE;
+}
+
+
+// The current transform and its stack, used by geom, see MGInstance.
+// Transforms are returned as they were set, such that geom works with
+// the native mat module as well as the reference modules/mat.mg
+static MGValue* mg_transform(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 0);
+
+	return mgReferenceValue(mgInstanceGetTransform(instance));
+}
+
+
+static MGValue* mg_set_transform(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16];
+
+	if (!mgMatrixLoad(argv[0], m))
+		mgFatalError("Error: %s expected argument 1 as \"%s\", received \"%s\"",
+		             mgGetCalleeName(instance), mgGetTypeName(MG_TYPE_MAT4), mgGetTypeName(mgValueType(argv[0])));
+
+	mgDestroyValue(mgInstanceGetTransform(instance));
+	mgInstanceGetTransform(instance) = mgReferenceValue(argv[0]);
+
+	return MG_NULL_VALUE;
+}
+
+
+static MGValue* mg_push_transform(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 0);
+
+	MGValue *transform = mgReferenceValue(mgInstanceGetTransform(instance));
+	_mgListAdd(MGValue*, instance->transforms, transform);
+
+	return MG_NULL_VALUE;
+}
+
+
+static MGValue* mg_pop_transform(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 0);
+
+	if (_mgListLength(instance->transforms) < 2)
+		mgFatalError("Error: %s called without a transform pushed", mgGetCalleeName(instance));
+
+	mgDestroyValue(_mgListPop(instance->transforms));
+
+	return MG_NULL_VALUE;
+}
+
+
+// The transforms of the stack, oldest first, as a list of their own
+static MGValue* mg_transforms(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 0);
+
+	MGValue *transforms = mgCreateValueList(_mgListLength(instance->transforms));
+
+	for (size_t i = 0; i < _mgListLength(instance->transforms); ++i)
+		mgListAdd(transforms, mgReferenceValue(_mgListGet(instance->transforms, i)));
+
+	return transforms;
+}
+
+
 static MGValue* mg_shallow_copy(MGInstance *instance, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 1, 1);
@@ -472,7 +1050,7 @@ static MGValue* mg_globals(MGInstance *instance, size_t argc, const MGValue* con
 	MG_ASSERT(instance);
 	MG_ASSERT(instance->callStackTop);
 	MG_ASSERT(instance->callStackTop->module);
-	MG_ASSERT(instance->callStackTop->module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(instance->callStackTop->module) == MG_TYPE_MODULE);
 	MG_ASSERT(instance->callStackTop->module->data.module.globals);
 
 	mgCheckArgumentCount(instance, argc, 0, 0);
@@ -486,11 +1064,10 @@ static MGValue* mg_locals(MGInstance *instance, size_t argc, const MGValue* cons
 	MG_ASSERT(instance);
 	MG_ASSERT(instance->callStackTop);
 	MG_ASSERT(instance->callStackTop->last);
-	MG_ASSERT(instance->callStackTop->last->locals);
 
 	mgCheckArgumentCount(instance, argc, 0, 0);
 
-	return mgReferenceValue(instance->callStackTop->last->locals);
+	return mgStackFrameGetLocals(instance->callStackTop->last);
 }
 
 
@@ -521,7 +1098,7 @@ MGValue* mgCreateBaseLib(void)
 	MGValue *module = mgCreateValueModule();
 
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 
 	mgModuleSetInteger(module, "false", 0);
 	mgModuleSetInteger(module, "true", 1);
@@ -537,6 +1114,9 @@ MGValue* mgCreateBaseLib(void)
 	mgModuleSetCFunction(module, "zip", mg_zip);
 
 	mgModuleSetCFunction(module, "map", mg_map);
+	mgModuleSetCFunction(module, "pmap", mg_pmap);
+	mgModuleSetCFunction(module, "spawn", mg_spawn);
+	mgModuleSetCFunction(module, "wait", mg_wait);
 	mgModuleSetCFunction(module, "filter", mg_filter);
 	mgModuleSetCFunction(module, "reduce", mg_reduce);
 
@@ -551,6 +1131,19 @@ MGValue* mgCreateBaseLib(void)
 	mgModuleSetCFunction(module, "float", mg_float);
 	mgModuleSetCFunction(module, "string", mg_string);
 
+	mgModuleSetCFunction(module, "vec2", mg_vec2);
+	mgModuleSetCFunction(module, "vec3", mg_vec3);
+	mgModuleSetCFunction(module, "vec4", mg_vec4);
+	mgModuleSetCFunction(module, "buffer", mg_buffer);
+
+	mgModuleSetCFunction(module, "emit_many", mg_emit_many);
+
+	mgModuleSetCFunction(module, "transform", mg_transform);
+	mgModuleSetCFunction(module, "set_transform", mg_set_transform);
+	mgModuleSetCFunction(module, "push_transform", mg_push_transform);
+	mgModuleSetCFunction(module, "pop_transform", mg_pop_transform);
+	mgModuleSetCFunction(module, "transforms", mg_transforms);
+
 	mgModuleSetCFunction(module, "copy", mg_shallow_copy);
 	mgModuleSetCFunction(module, "deep_copy", mg_deep_copy);
 
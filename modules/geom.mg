@@ -6,20 +6,28 @@ import mat
 import modifiers
 
 
-matrix_stack = [mat.mat4(1)]
+# Each pmap item and task has a transform stack of its own, holding
+# the matrices set using either mat module, or null until one is set
+
+_identity = mat.mat4(1)
 
 func get_matrix()
-	return matrix_stack[-1]
+	return transform() ?? _identity
+
+# The matrices of the transform stack, oldest first, in place of the
+# matrix_stack list geom used to keep. Changing the list returned does
+# not change the stack, use set_matrix, push and pop instead
+func get_matrix_stack()
+	return map(m -> m ?? _identity, transforms())
 
 func set_matrix(matrix)
-	matrix_stack[-1] = matrix
+	set_transform(matrix)
 
 func push()
-	matrix_stack.add(get_matrix())
+	push_transform()
 
 func pop()
-	assert len(matrix_stack) > 1
-	delete matrix_stack[-1]
+	pop_transform()
 
 func scale(x, y, z)
 	set_matrix(mat.mul(get_matrix(), mat.scaling((x, y, z))))
@@ -37,7 +45,7 @@ proc vertex(position, normal)
 	position = mat.mul(m, position)
 	normal = mat.mul(mat.get_rotation(m), normal)
 
-	for modifier in modifiers._modifiers
+	for modifier in modifiers.active()
 		position, normal = modifier(position, normal)
 
 	emit position[0], position[1], position[2], normal[0], normal[1], normal[2]
@@ -624,16 +632,23 @@ func make_lathe(polygon, segments = 24, angle = math.tau, angle_start = 0, cente
 	return translate_triangles(_triangles, center)
 
 
+# Without modifiers, emit_many yields the same vertices as vertex
 proc triangle(p1, p2, p3, center = (0, 0, 0), clockwise = false)
-	if clockwise
-		p1, p2, p3 = flip_triangle(p1, p2, p3)
-	normal = get_triangle_normal(p1, p2, p3)
-	for position in p1, p2, p3
-		vertex(vec.add(position, center), normal)
+	if len(modifiers.active()) == 0
+		emit_many(((p1, p2, p3),), get_matrix(), center, clockwise)
+	else
+		if clockwise
+			p1, p2, p3 = flip_triangle(p1, p2, p3)
+		normal = get_triangle_normal(p1, p2, p3)
+		for position in p1, p2, p3
+			vertex(vec.add(position, center), normal)
 
 proc triangles(triangles, center = (0, 0, 0), clockwise = false)
-	for p1, p2, p3 in triangles
-		triangle(p1, p2, p3, center, clockwise)
+	if len(modifiers.active()) == 0
+		emit_many(triangles, get_matrix(), center, clockwise)
+	else
+		for p1, p2, p3 in triangles
+			triangle(p1, p2, p3, center, clockwise)
 
 
 proc quad(p1, p2, p3, p4, clockwise = false)
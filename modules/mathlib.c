@@ -25,12 +25,12 @@ static MGValue* mg_abs(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger((argv[0]->data.i < 0) ? -argv[0]->data.i : argv[0]->data.i);
+		return mgCreateValueInteger((mgIntegerGet(argv[0]) < 0) ? -mgIntegerGet(argv[0]) : mgIntegerGet(argv[0]));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(fabsf(argv[0]->data.f));
+		return mgCreateValueFloat(fabsf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -42,12 +42,12 @@ static MGValue* mg_deg(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(argv[0]->data.i * _MG_RAD2DEG);
+		return mgCreateValueFloat(mgIntegerGet(argv[0]) * _MG_RAD2DEG);
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(argv[0]->data.f * _MG_RAD2DEG);
+		return mgCreateValueFloat(mgFloatGet(argv[0]) * _MG_RAD2DEG);
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -59,12 +59,12 @@ static MGValue* mg_rad(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(argv[0]->data.i * _MG_DEG2RAD);
+		return mgCreateValueFloat(mgIntegerGet(argv[0]) * _MG_DEG2RAD);
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(argv[0]->data.f * _MG_DEG2RAD);
+		return mgCreateValueFloat(mgFloatGet(argv[0]) * _MG_DEG2RAD);
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -77,9 +77,9 @@ static MGValue* mg_approximately(MGInstance *instance, size_t argc, const MGValu
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
 	return mgCreateValueBoolean(MG_APPROXIMATELY(
-			(argv[0]->type == MG_TYPE_INTEGER) ? argv[0]->data.i : argv[0]->data.f,
-			(argv[1]->type == MG_TYPE_INTEGER) ? argv[1]->data.i : argv[1]->data.f,
-			(argc > 2) ? ((argv[2]->type == MG_TYPE_INTEGER) ? argv[2]->data.i : argv[2]->data.f) : MG_EPSILON));
+			(mgValueType(argv[0]) == MG_TYPE_INTEGER) ? mgIntegerGet(argv[0]) : mgFloatGet(argv[0]),
+			(mgValueType(argv[1]) == MG_TYPE_INTEGER) ? mgIntegerGet(argv[1]) : mgFloatGet(argv[1]),
+			(argc > 2) ? ((mgValueType(argv[2]) == MG_TYPE_INTEGER) ? mgIntegerGet(argv[2]) : mgFloatGet(argv[2])) : MG_EPSILON));
 }
 
 
@@ -88,12 +88,12 @@ static MGValue* mg_sign(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger((0 < argv[0]->data.i) - (argv[0]->data.i < 0));
+		return mgCreateValueInteger((0 < mgIntegerGet(argv[0])) - (mgIntegerGet(argv[0]) < 0));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueInteger((0.0f < argv[0]->data.f) - (argv[0]->data.f < 0.0f));
+		return mgCreateValueInteger((0.0f < mgFloatGet(argv[0])) - (mgFloatGet(argv[0]) < 0.0f));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -105,12 +105,12 @@ static MGValue* mg_even(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueBoolean((argv[0]->data.i & 1) == 0);
+		return mgCreateValueBoolean((mgIntegerGet(argv[0]) & 1) == 0);
 	case MG_TYPE_FLOAT:
-		return mgCreateValueBoolean(MG_FEQUAL(fmodf(argv[0]->data.f, 2.0f), 0.0f));
+		return mgCreateValueBoolean(MG_FEQUAL(fmodf(mgFloatGet(argv[0]), 2.0f), 0.0f));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -122,12 +122,12 @@ static MGValue* mg_odd(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueBoolean((argv[0]->data.i & 1) == 1);
+		return mgCreateValueBoolean((mgIntegerGet(argv[0]) & 1) == 1);
 	case MG_TYPE_FLOAT:
-		return mgCreateValueBoolean(MG_FEQUAL(fmodf(argv[0]->data.f, 2.0f), 1.0f));
+		return mgCreateValueBoolean(MG_FEQUAL(fmodf(mgFloatGet(argv[0]), 2.0f), 1.0f));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -140,25 +140,25 @@ static MGValue* mg_multiple(MGInstance *instance, size_t argc, const MGValue* co
 	mgCheckArgumentCount(instance, argc, 2, 2);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		switch (argv[1]->type)
+		switch (mgValueType(argv[1]))
 		{
 		case MG_TYPE_INTEGER:
-			return mgCreateValueBoolean((argv[1]->data.i % argv[0]->data.i) == 0);
+			return mgCreateValueBoolean((mgIntegerGet(argv[1]) % mgIntegerGet(argv[0])) == 0);
 		case MG_TYPE_FLOAT:
-			return mgCreateValueBoolean(MG_FEQUAL(fmodf(argv[1]->data.f, (float) argv[0]->data.i), 0.0f));
+			return mgCreateValueBoolean(MG_FEQUAL(fmodf(mgFloatGet(argv[1]), (float) mgIntegerGet(argv[0])), 0.0f));
 		default:
 			return MG_NULL_VALUE;
 		}
 	case MG_TYPE_FLOAT:
-		switch (argv[1]->type)
+		switch (mgValueType(argv[1]))
 		{
 		case MG_TYPE_INTEGER:
-			return mgCreateValueBoolean(MG_FEQUAL(fmodf((float) argv[1]->data.i, argv[0]->data.f), 0.0f));
+			return mgCreateValueBoolean(MG_FEQUAL(fmodf((float) mgIntegerGet(argv[1]), mgFloatGet(argv[0])), 0.0f));
 		case MG_TYPE_FLOAT:
-			return mgCreateValueBoolean(MG_FEQUAL(fmodf(argv[1]->data.f, argv[0]->data.f), 0.0f));
+			return mgCreateValueBoolean(MG_FEQUAL(fmodf(mgFloatGet(argv[1]), mgFloatGet(argv[0])), 0.0f));
 		default:
 			return MG_NULL_VALUE;
 		}
@@ -173,12 +173,12 @@ static MGValue* mg_ceil(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger(argv[0]->data.i);
+		return mgCreateValueInteger(mgIntegerGet(argv[0]));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(ceilf(argv[0]->data.f));
+		return mgCreateValueFloat(ceilf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -190,12 +190,12 @@ static MGValue* mg_floor(MGInstance *instance, size_t argc, const MGValue* const
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger(argv[0]->data.i);
+		return mgCreateValueInteger(mgIntegerGet(argv[0]));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(floorf(argv[0]->data.f));
+		return mgCreateValueFloat(floorf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -207,12 +207,12 @@ static MGValue* mg_round(MGInstance *instance, size_t argc, const MGValue* const
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger(argv[0]->data.i);
+		return mgCreateValueInteger(mgIntegerGet(argv[0]));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(roundf(argv[0]->data.f));
+		return mgCreateValueFloat(roundf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -245,12 +245,12 @@ static MGValue* mg_pow(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 2, 2);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	if ((argv[0]->type == MG_TYPE_INTEGER) && (argv[1]->type == MG_TYPE_INTEGER) && (argv[1]->data.i >= 0))
-		return mgCreateValueInteger(_mg_powi(argv[0]->data.i, (unsigned int) argv[1]->data.i));
+	if ((mgValueType(argv[0]) == MG_TYPE_INTEGER) && (mgValueType(argv[1]) == MG_TYPE_INTEGER) && (mgIntegerGet(argv[1]) >= 0))
+		return mgCreateValueInteger(_mg_powi(mgIntegerGet(argv[0]), (unsigned int) mgIntegerGet(argv[1])));
 	else
 		return mgCreateValueFloat(powf(
-				(argv[0]->type == MG_TYPE_INTEGER) ? (float) argv[0]->data.i : argv[0]->data.f,
-				(argv[1]->type == MG_TYPE_INTEGER) ? (float) argv[1]->data.i : argv[1]->data.f));
+				(mgValueType(argv[0]) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(argv[0]) : mgFloatGet(argv[0]),
+				(mgValueType(argv[1]) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(argv[1]) : mgFloatGet(argv[1])));
 }
 
 
@@ -259,12 +259,12 @@ static MGValue* mg_sqrt(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(sqrtf((float) argv[0]->data.i));
+		return mgCreateValueFloat(sqrtf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(sqrtf(argv[0]->data.f));
+		return mgCreateValueFloat(sqrtf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -276,12 +276,12 @@ static MGValue* mg_cos(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(cosf((float) argv[0]->data.i));
+		return mgCreateValueFloat(cosf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(cosf(argv[0]->data.f));
+		return mgCreateValueFloat(cosf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -293,12 +293,12 @@ static MGValue* mg_sin(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(sinf((float) argv[0]->data.i));
+		return mgCreateValueFloat(sinf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(sinf(argv[0]->data.f));
+		return mgCreateValueFloat(sinf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -310,12 +310,12 @@ static MGValue* mg_tan(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(tanf((float) argv[0]->data.i));
+		return mgCreateValueFloat(tanf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(tanf(argv[0]->data.f));
+		return mgCreateValueFloat(tanf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -327,12 +327,12 @@ static MGValue* mg_acos(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(acosf((float) argv[0]->data.i));
+		return mgCreateValueFloat(acosf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(acosf(argv[0]->data.f));
+		return mgCreateValueFloat(acosf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -344,12 +344,12 @@ static MGValue* mg_asin(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(asinf((float) argv[0]->data.i));
+		return mgCreateValueFloat(asinf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(asinf(argv[0]->data.f));
+		return mgCreateValueFloat(asinf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -361,12 +361,12 @@ static MGValue* mg_atan(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(atanf((float) argv[0]->data.i));
+		return mgCreateValueFloat(atanf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(atanf(argv[0]->data.f));
+		return mgCreateValueFloat(atanf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -379,8 +379,8 @@ static MGValue* mg_atan2(MGInstance *instance, size_t argc, const MGValue* const
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
 	return mgCreateValueFloat(atan2f(
-			(argv[0]->type == MG_TYPE_INTEGER) ? (float) argv[0]->data.i : argv[0]->data.f,
-			(argv[1]->type == MG_TYPE_INTEGER) ? (float) argv[1]->data.i : argv[1]->data.f));
+			(mgValueType(argv[0]) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(argv[0]) : mgFloatGet(argv[0]),
+			(mgValueType(argv[1]) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(argv[1]) : mgFloatGet(argv[1])));
 }
 
 
@@ -389,12 +389,12 @@ static MGValue* mg_exp(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(expf((float) argv[0]->data.i));
+		return mgCreateValueFloat(expf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(expf(argv[0]->data.f));
+		return mgCreateValueFloat(expf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -406,12 +406,12 @@ static MGValue* mg_log(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(logf((float) argv[0]->data.i));
+		return mgCreateValueFloat(logf((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(logf(argv[0]->data.f));
+		return mgCreateValueFloat(logf(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -423,12 +423,12 @@ static MGValue* mg_log2(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueFloat(log2f((float) argv[0]->data.i));
+		return mgCreateValueFloat(log2f((float) mgIntegerGet(argv[0])));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(log2f(argv[0]->data.f));
+		return mgCreateValueFloat(log2f(mgFloatGet(argv[0])));
 	default:
 		return MG_NULL_VALUE;
 	}
@@ -448,47 +448,47 @@ MGValue* _mg_max(size_t argc, const MGValue* const* argv)
 
 	memset(&result, 0, sizeof(result));
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
 		isInt = MG_TRUE;
-		result.i = argv[0]->data.i;
+		result.i = mgIntegerGet(argv[0]);
 		break;
 	case MG_TYPE_FLOAT:
 		isInt = MG_FALSE;
-		result.f = argv[0]->data.f;
+		result.f = mgFloatGet(argv[0]);
 		break;
 	default:
 		mgFatalError("Error: max expected argument as \"%s\" or \"%s\", received \"%s\"",
 		        mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
-		        mgGetTypeName(argv[0]->type));
+		        mgGetTypeName(mgValueType(argv[0])));
 		return MG_NULL_VALUE;
 	}
 
 	for (size_t i = 1; i < argc; ++i)
 	{
-		if (isInt && (argv[i]->type == MG_TYPE_FLOAT))
+		if (isInt && (mgValueType(argv[i]) == MG_TYPE_FLOAT))
 		{
 			isInt = MG_FALSE;
 			result.f = (float) result.i;
 		}
 
-		switch (argv[i]->type)
+		switch (mgValueType(argv[i]))
 		{
 		case MG_TYPE_INTEGER:
 			if (isInt)
-				result.i = (argv[i]->data.i > result.i) ? argv[i]->data.i : result.i;
+				result.i = (mgIntegerGet(argv[i]) > result.i) ? mgIntegerGet(argv[i]) : result.i;
 			else
-				result.f = ((float) argv[i]->data.i > result.f) ? (float) argv[i]->data.i : result.f;
+				result.f = ((float) mgIntegerGet(argv[i]) > result.f) ? (float) mgIntegerGet(argv[i]) : result.f;
 			break;
 		case MG_TYPE_FLOAT:
 			MG_ASSERT(!isInt);
-			result.f = (argv[i]->data.f > result.f) ? argv[i]->data.f : result.f;
+			result.f = (mgFloatGet(argv[i]) > result.f) ? mgFloatGet(argv[i]) : result.f;
 			break;
 		default:
 			mgFatalError("Error: max expected argument %zu as \"%s\" or \"%s\", received \"%s\"",
 			        i + 1, mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
-			        mgGetTypeName(argv[i]->type));
+			        mgGetTypeName(mgValueType(argv[i])));
 		}
 	}
 
@@ -509,47 +509,47 @@ MGValue* _mg_min(size_t argc, const MGValue* const* argv)
 
 	memset(&result, 0, sizeof(result));
 
-	switch (argv[0]->type)
+	switch (mgValueType(argv[0]))
 	{
 	case MG_TYPE_INTEGER:
 		isInt = MG_TRUE;
-		result.i = argv[0]->data.i;
+		result.i = mgIntegerGet(argv[0]);
 		break;
 	case MG_TYPE_FLOAT:
 		isInt = MG_FALSE;
-		result.f = argv[0]->data.f;
+		result.f = mgFloatGet(argv[0]);
 		break;
 	default:
 		mgFatalError("Error: min expected argument as \"%s\" or \"%s\", received \"%s\"",
 		        mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
-		        mgGetTypeName(argv[0]->type));
+		        mgGetTypeName(mgValueType(argv[0])));
 		return MG_NULL_VALUE;
 	}
 
 	for (size_t i = 1; i < argc; ++i)
 	{
-		if (isInt && (argv[i]->type == MG_TYPE_FLOAT))
+		if (isInt && (mgValueType(argv[i]) == MG_TYPE_FLOAT))
 		{
 			isInt = MG_FALSE;
 			result.f = (float) result.i;
 		}
 
-		switch (argv[i]->type)
+		switch (mgValueType(argv[i]))
 		{
 		case MG_TYPE_INTEGER:
 			if (isInt)
-				result.i = (argv[i]->data.i < result.i) ? argv[i]->data.i : result.i;
+				result.i = (mgIntegerGet(argv[i]) < result.i) ? mgIntegerGet(argv[i]) : result.i;
 			else
-				result.f = ((float) argv[i]->data.i < result.f) ? (float) argv[i]->data.i : result.f;
+				result.f = ((float) mgIntegerGet(argv[i]) < result.f) ? (float) mgIntegerGet(argv[i]) : result.f;
 			break;
 		case MG_TYPE_FLOAT:
 			MG_ASSERT(!isInt);
-			result.f = (argv[i]->data.f < result.f) ? argv[i]->data.f : result.f;
+			result.f = (mgFloatGet(argv[i]) < result.f) ? mgFloatGet(argv[i]) : result.f;
 			break;
 		default:
 			mgFatalError("Error: min expected argument %zu as \"%s\" or \"%s\", received \"%s\"",
 			        i + 1, mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
-			        mgGetTypeName(argv[i]->type));
+			        mgGetTypeName(mgValueType(argv[i])));
 		}
 	}
 
@@ -566,9 +566,9 @@ static MGValue* mg_max(MGInstance *instance, size_t argc, const MGValue* const*
 
 	if (argc == 1)
 	{
-		if ((argv[0]->type != MG_TYPE_TUPLE) && (argv[0]->type != MG_TYPE_LIST))
+		if ((mgValueType(argv[0]) != MG_TYPE_TUPLE) && (mgValueType(argv[0]) != MG_TYPE_LIST))
 			mgFatalError("Error: max expected argument %zu as \"%s\", received \"%s\"",
-			        1, mgGetTypeName(MG_TYPE_LIST), mgGetTypeName(argv[0]->type));
+			        1, mgGetTypeName(MG_TYPE_LIST), mgGetTypeName(mgValueType(argv[0])));
 
 		return _mg_max(mgListLength(argv[0]), (const MGValue* const*) mgListItems(argv[0]));
 	}
@@ -583,9 +583,9 @@ static MGValue* mg_min(MGInstance *instance, size_t argc, const MGValue* const*
 
 	if (argc == 1)
 	{
-		if ((argv[0]->type != MG_TYPE_TUPLE) && (argv[0]->type != MG_TYPE_LIST))
+		if ((mgValueType(argv[0]) != MG_TYPE_TUPLE) && (mgValueType(argv[0]) != MG_TYPE_LIST))
 			mgFatalError("Error: min expected argument %zu as \"%s\", received \"%s\"",
-			        1, mgGetTypeName(MG_TYPE_LIST), mgGetTypeName(argv[0]->type));
+			        1, mgGetTypeName(MG_TYPE_LIST), mgGetTypeName(mgValueType(argv[0])));
 
 		return _mg_min(mgListLength(argv[0]), (const MGValue* const*) mgListItems(argv[0]));
 	}
@@ -603,19 +603,19 @@ static MGValue* mg_clamp(MGInstance *instance, size_t argc, const MGValue* const
 	mgCheckArgumentCount(instance, argc, 3, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	if ((value->type == MG_TYPE_FLOAT) || (min->type == MG_TYPE_FLOAT) || (max->type == MG_TYPE_FLOAT))
+	if ((mgValueType(value) == MG_TYPE_FLOAT) || (mgValueType(min) == MG_TYPE_FLOAT) || (mgValueType(max) == MG_TYPE_FLOAT))
 	{
-		float result = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-		result = (min->type == MG_TYPE_INTEGER) ? ((result < min->data.i) ? (float) min->data.i : result) : ((result < min->data.f) ? min->data.f : result);
-		result = (max->type == MG_TYPE_INTEGER) ? ((result > max->data.i) ? (float) max->data.i : result) : ((result > max->data.f) ? max->data.f : result);
+		float result = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+		result = (mgValueType(min) == MG_TYPE_INTEGER) ? ((result < mgIntegerGet(min)) ? (float) mgIntegerGet(min) : result) : ((result < mgFloatGet(min)) ? mgFloatGet(min) : result);
+		result = (mgValueType(max) == MG_TYPE_INTEGER) ? ((result > mgIntegerGet(max)) ? (float) mgIntegerGet(max) : result) : ((result > mgFloatGet(max)) ? mgFloatGet(max) : result);
 
 		return mgCreateValueFloat(result);
 	}
 	else
 	{
-		int result = value->data.i;
-		result = (result < min->data.i) ? min->data.i : result;
-		result = (result > max->data.i) ? max->data.i : result;
+		int result = mgIntegerGet(value);
+		result = (result < mgIntegerGet(min)) ? mgIntegerGet(min) : result;
+		result = (result > mgIntegerGet(max)) ? mgIntegerGet(max) : result;
 
 		return mgCreateValueInteger(result);
 	}
@@ -644,28 +644,28 @@ static MGValue* mg_sum(MGInstance *instance, size_t argc, const MGValue* const*
 	{
 		MGValue *item = _mgListGet(list->data.a, i);
 
-		if (isInt && (item->type == MG_TYPE_FLOAT))
+		if (isInt && (mgValueType(item) == MG_TYPE_FLOAT))
 		{
 			isInt = MG_FALSE;
 			result.f = (float) result.i;
 		}
 
-		switch (item->type)
+		switch (mgValueType(item))
 		{
 		case MG_TYPE_INTEGER:
 			if (isInt)
-				result.i += item->data.i;
+				result.i += mgIntegerGet(item);
 			else
-				result.f += (float) item->data.i;
+				result.f += (float) mgIntegerGet(item);
 			break;
 		case MG_TYPE_FLOAT:
 			MG_ASSERT(!isInt);
-			result.f += item->data.f;
+			result.f += mgFloatGet(item);
 			break;
 		default:
 			mgFatalError("Error: sum expected argument %zu as \"%s\" or \"%s\", received \"%s\"",
 			        i + 1, mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
-			        mgGetTypeName(item->type));
+			        mgGetTypeName(mgValueType(item)));
 		}
 	}
 
@@ -673,11 +673,14 @@ static MGValue* mg_sum(MGInstance *instance, size_t argc, const MGValue* const*
 }
 
 
+// Each instance has its own generator (SplitMix64), which
+// unlike rand() is safe to use from multiple threads
 static MGValue* mg_random(MGInstance *instance, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 0, 0);
 
-	return mgCreateValueFloat((float) rand() / (float) RAND_MAX);
+	// The upper 24 bits fill the mantissa of a float in [0, 1)
+	return mgCreateValueFloat((float) (mgRandomNext(&instance->randomState) >> 40) / (float) (1 << 24));
 }
 
 
@@ -686,7 +689,7 @@ static MGValue* mg_seed(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 1, MG_TYPE_INTEGER);
 
-	srand((unsigned int) argv[0]->data.i);
+	instance->randomState = (uint64_t) (int64_t) mgIntegerGet(argv[0]);
 
 	return mgReferenceValue(argv[0]);
 }
@@ -701,9 +704,9 @@ static MGValue* mg_normalize(MGInstance *instance, size_t argc, const MGValue* c
 	mgCheckArgumentCount(instance, argc, 2, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-	float _min = min ? ((min->type == MG_TYPE_INTEGER) ? (float) min->data.i : min->data.f) : 0.0f;
-	float _max = (max->type == MG_TYPE_INTEGER) ? (float) max->data.i : max->data.f;
+	float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+	float _min = min ? ((mgValueType(min) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(min) : mgFloatGet(min)) : 0.0f;
+	float _max = (mgValueType(max) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(max) : mgFloatGet(max);
 
 	return mgCreateValueFloat((_value - _min) / (_max - _min));
 }
@@ -718,9 +721,9 @@ static MGValue* mg_lerp(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 3, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _a = (a->type == MG_TYPE_INTEGER) ? (float) a->data.i : a->data.f;
-	float _b = (b->type == MG_TYPE_INTEGER) ? (float) b->data.i : b->data.f;
-	float _t = (t->type == MG_TYPE_INTEGER) ? (float) t->data.i : t->data.f;
+	float _a = (mgValueType(a) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(a) : mgFloatGet(a);
+	float _b = (mgValueType(b) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(b) : mgFloatGet(b);
+	float _t = (mgValueType(t) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(t) : mgFloatGet(t);
 
 	return mgCreateValueFloat((1.0f - _t) * _a + _t * _b);
 }
@@ -737,11 +740,11 @@ static MGValue* mg_map(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 5, 5);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-	float _min1 = (min1->type == MG_TYPE_INTEGER) ? (float) min1->data.i : min1->data.f;
-	float _max1 = (max1->type == MG_TYPE_INTEGER) ? (float) max1->data.i : max1->data.f;
-	float _min2 = (min2->type == MG_TYPE_INTEGER) ? (float) min2->data.i : min2->data.f;
-	float _max2 = (max2->type == MG_TYPE_INTEGER) ? (float) max2->data.i : max2->data.f;
+	float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+	float _min1 = (mgValueType(min1) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(min1) : mgFloatGet(min1);
+	float _max1 = (mgValueType(max1) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(max1) : mgFloatGet(max1);
+	float _min2 = (mgValueType(min2) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(min2) : mgFloatGet(min2);
+	float _max2 = (mgValueType(max2) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(max2) : mgFloatGet(max2);
 
 	return mgCreateValueFloat(_min2 + (_max2 - _min2) * ((_value - _min1) / (_max1 - _min1)));
 }
@@ -756,19 +759,19 @@ static MGValue* mg_nearest(MGInstance *instance, size_t argc, const MGValue* con
 	mgCheckArgumentCount(instance, argc, 3, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	if ((value->type == MG_TYPE_FLOAT) || (a->type == MG_TYPE_FLOAT) || (b->type == MG_TYPE_FLOAT))
+	if ((mgValueType(value) == MG_TYPE_FLOAT) || (mgValueType(a) == MG_TYPE_FLOAT) || (mgValueType(b) == MG_TYPE_FLOAT))
 	{
-		float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-		float _a = (a->type == MG_TYPE_INTEGER) ? (float) a->data.i : a->data.f;
-		float _b = (b->type == MG_TYPE_INTEGER) ? (float) b->data.i : b->data.f;
+		float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+		float _a = (mgValueType(a) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(a) : mgFloatGet(a);
+		float _b = (mgValueType(b) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(b) : mgFloatGet(b);
 
 		return mgCreateValueFloat((fabsf(_a - _value) > fabsf(_b - _value)) ? _b : _a);
 	}
 	else
 	{
-		int _value = value->data.i;
-		int _a = a->data.i;
-		int _b = b->data.i;
+		int _value = mgIntegerGet(value);
+		int _a = mgIntegerGet(a);
+		int _b = mgIntegerGet(b);
 
 		return mgCreateValueInteger((abs(_a - _value) > abs(_b - _value)) ? _b : _a);
 	}
@@ -784,9 +787,9 @@ static MGValue* mg_snap(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 2, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-	float _n = (n->type == MG_TYPE_INTEGER) ? (float) n->data.i : n->data.f;
-	float _offset = offset ? ((offset->type == MG_TYPE_INTEGER) ? (float) offset->data.i : offset->data.f) : 0.0f;
+	float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+	float _n = (mgValueType(n) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(n) : mgFloatGet(n);
+	float _offset = offset ? ((mgValueType(offset) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(offset) : mgFloatGet(offset)) : 0.0f;
 
 	return mgCreateValueFloat(roundf((_value - _offset) / _n) * _n + _offset);
 }
@@ -801,9 +804,9 @@ static MGValue* mg_snap_ceil(MGInstance *instance, size_t argc, const MGValue* c
 	mgCheckArgumentCount(instance, argc, 2, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-	float _n = (n->type == MG_TYPE_INTEGER) ? (float) n->data.i : n->data.f;
-	float _offset = offset ? ((offset->type == MG_TYPE_INTEGER) ? (float) offset->data.i : offset->data.f) : 0.0f;
+	float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+	float _n = (mgValueType(n) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(n) : mgFloatGet(n);
+	float _offset = offset ? ((mgValueType(offset) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(offset) : mgFloatGet(offset)) : 0.0f;
 
 	return mgCreateValueFloat(ceilf((_value - _offset) / _n) * _n + _offset);
 }
@@ -818,9 +821,9 @@ static MGValue* mg_snap_floor(MGInstance *instance, size_t argc, const MGValue*
 	mgCheckArgumentCount(instance, argc, 2, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-	float _n = (n->type == MG_TYPE_INTEGER) ? (float) n->data.i : n->data.f;
-	float _offset = offset ? ((offset->type == MG_TYPE_INTEGER) ? (float) offset->data.i : offset->data.f) : 0.0f;
+	float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+	float _n = (mgValueType(n) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(n) : mgFloatGet(n);
+	float _offset = offset ? ((mgValueType(offset) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(offset) : mgFloatGet(offset)) : 0.0f;
 
 	return mgCreateValueFloat(floorf((_value - _offset) / _n) * _n + _offset);
 }
@@ -836,10 +839,10 @@ static MGValue* mg_snap_within(MGInstance *instance, size_t argc, const MGValue*
 	mgCheckArgumentCount(instance, argc, 3, 4);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-	float _n = (n->type == MG_TYPE_INTEGER) ? (float) n->data.i : n->data.f;
-	float _within = (within->type == MG_TYPE_INTEGER) ? (float) within->data.i : within->data.f;
-	float _offset = offset ? ((offset->type == MG_TYPE_INTEGER) ? (float) offset->data.i : offset->data.f) : 0.0f;
+	float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+	float _n = (mgValueType(n) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(n) : mgFloatGet(n);
+	float _within = (mgValueType(within) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(within) : mgFloatGet(within);
+	float _offset = offset ? ((mgValueType(offset) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(offset) : mgFloatGet(offset)) : 0.0f;
 	float snapped = roundf((_value - _offset) / _n) * _n + _offset;
 
 	return mgCreateValueFloat((fabsf(_value - snapped) > _within) ? _value : snapped);
@@ -856,11 +859,11 @@ static MGValue* mg_wrap(MGInstance *instance, size_t argc, const MGValue* const*
 	mgCheckArgumentCount(instance, argc, 2, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	if ((value->type == MG_TYPE_FLOAT) || (min && (min->type == MG_TYPE_FLOAT)) || (max->type == MG_TYPE_FLOAT))
+	if ((mgValueType(value) == MG_TYPE_FLOAT) || (min && (mgValueType(min) == MG_TYPE_FLOAT)) || (mgValueType(max) == MG_TYPE_FLOAT))
 	{
-		float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-		float _min = min ? ((min->type == MG_TYPE_INTEGER) ? (float) min->data.i : min->data.f) : 0.0f;
-		float _max = (max->type == MG_TYPE_INTEGER) ? (float) max->data.i : max->data.f;
+		float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+		float _min = min ? ((mgValueType(min) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(min) : mgFloatGet(min)) : 0.0f;
+		float _max = (mgValueType(max) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(max) : mgFloatGet(max);
 
 		float length = _max - _min;
 		float wrapped = fmodf(_value, length);
@@ -870,9 +873,9 @@ static MGValue* mg_wrap(MGInstance *instance, size_t argc, const MGValue* const*
 	}
 	else
 	{
-		int _value = value->data.i;
-		int _min = min ? min->data.i : 0;
-		int _max = max->data.i;
+		int _value = mgIntegerGet(value);
+		int _min = min ? mgIntegerGet(min) : 0;
+		int _max = mgIntegerGet(max);
 
 		int length = _max - _min;
 		int wrapped = _value % length;
@@ -893,11 +896,11 @@ static MGValue* mg_ping_pong(MGInstance *instance, size_t argc, const MGValue* c
 	mgCheckArgumentCount(instance, argc, 2, 3);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
 
-	if ((value->type == MG_TYPE_FLOAT) || (min && (min->type == MG_TYPE_FLOAT)) || (max->type == MG_TYPE_FLOAT))
+	if ((mgValueType(value) == MG_TYPE_FLOAT) || (min && (mgValueType(min) == MG_TYPE_FLOAT)) || (mgValueType(max) == MG_TYPE_FLOAT))
 	{
-		float _value = (value->type == MG_TYPE_INTEGER) ? (float) value->data.i : value->data.f;
-		float _min = min ? ((min->type == MG_TYPE_INTEGER) ? (float) min->data.i : min->data.f) : 0.0f;
-		float _max = (max->type == MG_TYPE_INTEGER) ? (float) max->data.i : max->data.f;
+		float _value = (mgValueType(value) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+		float _min = min ? ((mgValueType(min) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(min) : mgFloatGet(min)) : 0.0f;
+		float _max = (mgValueType(max) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(max) : mgFloatGet(max);
 
 		float length = _max - _min;
 		float pingPonged = fmodf(_value, (length * 2.0f));
@@ -908,9 +911,9 @@ static MGValue* mg_ping_pong(MGInstance *instance, size_t argc, const MGValue* c
 	}
 	else
 	{
-		int _value = value->data.i;
-		int _min = min ? min->data.i : 0;
-		int _max = max->data.i;
+		int _value = mgIntegerGet(value);
+		int _min = min ? mgIntegerGet(min) : 0;
+		int _max = mgIntegerGet(max);
 
 		int length = _max - _min;
 		int pingPonged = _value % (length * 2);
@@ -927,7 +930,7 @@ MGValue* mgCreateMathLib(void)
 	MGValue *module = mgCreateValueModule();
 
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 
 	mgModuleSetFloat(module, "epsilon", MG_EPSILON);
 	mgModuleSetFloat(module, "inf", INFINITY);
@@ -0,0 +1,496 @@
+
+#include <string.h>
+#include <math.h>
+
+#include "value.h"
+#include "types/primitive.h"
+#include "types/composite.h"
+#include "types/module.h"
+#include "types/vector.h"
+#include "types/matrix.h"
+#include "callable.h"
+#include "error.h"
+#include "utilities.h"
+
+
+// Native version of modules/mat.mg, which remains as the reference
+// implementation. Matrices are returned as mat4 values, while tuples of
+// four columns are accepted wherever a matrix is. Vectors are returned
+// as tuples of floats, unless computed from a vec3 or vec4, in which case
+// they are of the same type. The components are computed in the same
+// order as mat.mg does, such that floats yield exactly the same results.
+
+
+extern MGValue* _mg_vec_mul(MGInstance *instance, const MGValue *a, const MGValue *b);
+
+
+typedef enum MGMatKind {
+	MG_MAT_KIND_OTHER,
+	MG_MAT_KIND_VEC,
+	MG_MAT_KIND_MAT
+} MGMatKind;
+
+
+// Like vec_type, a tuple of tuples is a matrix and any other tuple is a vector
+static MGMatKind _mg_mat_kind(const MGValue *value)
+{
+	if (mgIsMatrixValue(value))
+		return MG_MAT_KIND_MAT;
+	else if (mgIsVectorValue(value))
+		return MG_MAT_KIND_VEC;
+	else if (mgValueType(value) != MG_TYPE_TUPLE)
+		return MG_MAT_KIND_OTHER;
+	else if (mgTupleLength(value) == 0)
+		return MG_MAT_KIND_VEC;
+
+	const MGValue *first = _mgListGet(value->data.a, 0);
+
+	return ((mgValueType(first) == MG_TYPE_TUPLE) || mgIsVectorValue(first)) ? MG_MAT_KIND_MAT : MG_MAT_KIND_VEC;
+}
+
+
+static void _mg_mat_load(MGInstance *instance, const MGValue* const* argv, size_t index, float *m)
+{
+	if (!mgMatrixLoad(argv[index], m))
+		mgFatalError("Error: %s expected argument %zu as \"%s\", received \"%s\"",
+		             mgGetCalleeName(instance), index + 1, mgGetTypeName(MG_TYPE_MAT4), mgGetTypeName(mgValueType(argv[index])));
+}
+
+
+// Like _cast(v, 3), numbers are used for every component
+static void _mg_mat_load_vec3(MGInstance *instance, const MGValue* const* argv, size_t index, float *v)
+{
+	if (!mgVectorLoad(argv[index], 3, v))
+		mgFatalError("Error: %s expected argument %zu as \"%s\", received \"%s\"",
+		             mgGetCalleeName(instance), index + 1, mgGetTypeName(MG_TYPE_VEC3), mgGetTypeName(mgValueType(argv[index])));
+}
+
+
+// Loads a vector of 3 or 4 numbers, with the former having w = 1
+static size_t _mg_mat_load_vec(MGInstance *instance, const MGValue *value, float *v)
+{
+	const size_t length = mgIsVectorValue(value) ? mgVectorLength(value) : mgTupleLength(value);
+
+	v[3] = 1.0f;
+
+	if (((length != 3) && (length != 4)) || !mgVectorLoad(value, length, v))
+		mgFatalError("Error: %s expected a vector of 3 or 4 numbers", mgGetCalleeName(instance));
+
+	return length;
+}
+
+
+static MGValue* _mg_mat_vec_result(const MGValue *like, size_t length, const float *v)
+{
+	if (mgIsVectorValue(like))
+		return mgCreateValueVector(length, v);
+
+	MGValue *tuple = mgCreateValueTuple(length);
+
+	for (size_t i = 0; i < length; ++i)
+		mgTupleAdd(tuple, mgCreateValueFloat(v[i]));
+
+	return tuple;
+}
+
+
+static void _mg_mat_rotation(float *m, float radians, const float *axis)
+{
+	const float s = sinf(radians), c = cosf(radians);
+	const float oc = 1.0f - c;
+
+	// Normalized like vec.normalize
+	const float length = sqrtf(0.0f + axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	const float scale = 1.0f / length;
+	const float x = axis[0] * scale, y = axis[1] * scale, z = axis[2] * scale;
+
+	mgMatrixIdentity(m, 1.0f);
+
+	m[0] = x * x * oc + c;
+	m[1] = x * y * oc - z * s;
+	m[2] = x * z * oc + y * s;
+
+	m[4] = y * x * oc + z * s;
+	m[5] = y * y * oc + c;
+	m[6] = y * z * oc - x * s;
+
+	m[8] = x * z * oc - y * s;
+	m[9] = y * z * oc + x * s;
+	m[10] = z * z * oc + c;
+}
+
+
+static int _mg_mat_index(MGInstance *instance, const MGValue* const* argv, size_t index)
+{
+	const int i = mgIntegerGet(argv[index]);
+
+	if ((i >= 4) || (i < -4))
+		mgFatalError("Error: %s expected argument %zu in range (-4 <= %d < 4)", mgGetCalleeName(instance), index + 1, i);
+
+	return (i < 0) ? (4 + i) : i;
+}
+
+
+static MGValue* mg_mat_vec_type(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	switch (_mg_mat_kind(argv[0]))
+	{
+	case MG_MAT_KIND_MAT:
+		return mgCreateValueString("mat");
+	case MG_MAT_KIND_VEC:
+		return mgCreateValueString("vec");
+	default:
+		return mgCreateValueString(mgGetTypeName(mgValueType(argv[0])));
+	}
+}
+
+
+static MGValue* mg_mat_mat4(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 1);
+	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
+
+	MGValue *m = mgCreateValueMatrix(NULL);
+
+	if (argc > 0)
+		mgMatrixIdentity(m->data.mat, _mgNumericGet(argv[0]));
+
+	return m;
+}
+
+
+static MGValue* mg_mat_column(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 0, 1, MG_TYPE_INTEGER);
+
+	float m[16];
+	_mg_mat_load(instance, argv, 0, m);
+
+	return _mg_mat_vec_result(argv[0], 4, m + _mg_mat_index(instance, argv, 1) * 4);
+}
+
+
+static MGValue* mg_mat_row(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 0, 1, MG_TYPE_INTEGER);
+
+	float m[16], row[4];
+	_mg_mat_load(instance, argv, 0, m);
+
+	const int j = _mg_mat_index(instance, argv, 1);
+
+	for (int i = 0; i < 4; ++i)
+		row[i] = m[i * 4 + j];
+
+	return _mg_mat_vec_result(argv[0], 4, row);
+}
+
+
+static MGValue* mg_mat_scaling(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float scaling[3];
+	_mg_mat_load_vec3(instance, argv, 0, scaling);
+
+	MGValue *m = mgCreateValueMatrix(NULL);
+
+	for (int i = 0; i < 3; ++i)
+		mgMatrixGet(m, i, i) = scaling[i];
+
+	return m;
+}
+
+
+static MGValue* mg_mat_translation(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float xyz[3];
+	_mg_mat_load_vec3(instance, argv, 0, xyz);
+
+	MGValue *m = mgCreateValueMatrix(NULL);
+
+	for (int i = 0; i < 3; ++i)
+		mgMatrixGet(m, 3, i) = xyz[i];
+
+	return m;
+}
+
+
+static MGValue* mg_mat_rotation(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 0);
+
+	float axis[3];
+	_mg_mat_load_vec3(instance, argv, 1, axis);
+
+	MGValue *m = mgCreateValue(MG_TYPE_MAT4);
+	_mg_mat_rotation(m->data.mat, _mgNumericGet(argv[0]), axis);
+
+	return m;
+}
+
+
+static MGValue* mg_mat_mul(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	const MGValue *a = argv[0], *b = argv[1];
+	const MGMatKind ka = _mg_mat_kind(a), kb = _mg_mat_kind(b);
+
+	if ((ka == MG_MAT_KIND_MAT) && (kb == MG_MAT_KIND_MAT))
+	{
+		float ma[16], mb[16];
+
+		_mg_mat_load(instance, argv, 0, ma);
+		_mg_mat_load(instance, argv, 1, mb);
+
+		MGValue *m = mgCreateValue(MG_TYPE_MAT4);
+		mgMatrixMultiply(m->data.mat, ma, mb);
+
+		return m;
+	}
+	else if ((ka == MG_MAT_KIND_VEC) && (kb == MG_MAT_KIND_MAT))
+	{
+		float v[4], m[16], r[4];
+
+		const size_t length = _mg_mat_load_vec(instance, a, v);
+		_mg_mat_load(instance, argv, 1, m);
+
+		// Each component is dot(a, b[i])
+		for (size_t i = 0; i < length; ++i)
+			r[i] = 0.0f + v[0] * m[i * 4] + v[1] * m[i * 4 + 1] + v[2] * m[i * 4 + 2] + v[3] * m[i * 4 + 3];
+
+		return _mg_mat_vec_result(a, length, r);
+	}
+	else if ((ka == MG_MAT_KIND_MAT) && (kb == MG_MAT_KIND_VEC))
+	{
+		float m[16], v[4], r[4];
+
+		_mg_mat_load(instance, argv, 0, m);
+		const size_t length = _mg_mat_load_vec(instance, b, v);
+
+		mgMatrixTransform(r, m, v);
+
+		return _mg_mat_vec_result(b, length, r);
+	}
+	else if ((ka == MG_MAT_KIND_VEC) && (kb == MG_MAT_KIND_VEC))
+		return _mg_vec_mul(instance, a, b);
+
+	mgFatalError("Error: %s expected matrices or vectors, received \"%s\" and \"%s\"",
+	             mgGetCalleeName(instance), mgGetTypeName(mgValueType(a)), mgGetTypeName(mgValueType(b)));
+
+	return MG_NULL_VALUE;
+}
+
+
+static MGValue* mg_mat_scale(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	float m[16], xyz[3], scaling[16];
+
+	_mg_mat_load(instance, argv, 0, m);
+	_mg_mat_load_vec3(instance, argv, 1, xyz);
+
+	mgMatrixIdentity(scaling, 1.0f);
+
+	for (int i = 0; i < 3; ++i)
+		scaling[i * 5] = xyz[i];
+
+	MGValue *result = mgCreateValue(MG_TYPE_MAT4);
+	mgMatrixMultiply(result->data.mat, m, scaling);
+
+	return result;
+}
+
+
+static MGValue* mg_mat_translate(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	float m[16], translation[16];
+
+	_mg_mat_load(instance, argv, 0, m);
+	mgMatrixIdentity(translation, 1.0f);
+	_mg_mat_load_vec3(instance, argv, 1, translation + 12);
+
+	MGValue *result = mgCreateValue(MG_TYPE_MAT4);
+	mgMatrixMultiply(result->data.mat, m, translation);
+
+	return result;
+}
+
+
+static MGValue* mg_mat_rotate(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 3, 3);
+	mgCheckArgumentTypes(instance, argc, argv, 0, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 0);
+
+	float m[16], axis[3], rotation[16];
+
+	_mg_mat_load(instance, argv, 0, m);
+	_mg_mat_load_vec3(instance, argv, 2, axis);
+	_mg_mat_rotation(rotation, _mgNumericGet(argv[1]), axis);
+
+	MGValue *result = mgCreateValue(MG_TYPE_MAT4);
+	mgMatrixMultiply(result->data.mat, m, rotation);
+
+	return result;
+}
+
+
+static MGValue* mg_mat_get_translation(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16];
+	_mg_mat_load(instance, argv, 0, m);
+
+	return _mg_mat_vec_result(argv[0], 3, m + 12);
+}
+
+
+static MGValue* mg_mat_get_scaling(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16], scaling[3];
+
+	_mg_mat_load(instance, argv, 0, m);
+	mgMatrixScaling(scaling, m);
+
+	return _mg_mat_vec_result(argv[0], 3, scaling);
+}
+
+
+static MGValue* mg_mat_get_rotation(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16];
+	_mg_mat_load(instance, argv, 0, m);
+
+	MGValue *rotation = mgCreateValue(MG_TYPE_MAT4);
+	mgMatrixRotation(rotation->data.mat, m);
+
+	return rotation;
+}
+
+
+static MGValue* mg_mat_transpose(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16];
+	_mg_mat_load(instance, argv, 0, m);
+
+	MGValue *result = mgCreateValue(MG_TYPE_MAT4);
+	mgMatrixTranspose(result->data.mat, m);
+
+	return result;
+}
+
+
+static MGValue* mg_mat_inverse(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16];
+	_mg_mat_load(instance, argv, 0, m);
+
+	MGValue *result = mgCreateValue(MG_TYPE_MAT4);
+
+	if (!mgMatrixInverse(result->data.mat, m))
+		mgFatalError("Error: %s expected an invertible matrix", mgGetCalleeName(instance));
+
+	return result;
+}
+
+
+static MGValue* mg_mat_normal_matrix(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	float m[16];
+	_mg_mat_load(instance, argv, 0, m);
+
+	MGValue *result = mgCreateValue(MG_TYPE_MAT4);
+
+	if (!mgMatrixNormal(result->data.mat, m))
+		mgFatalError("Error: %s expected an invertible matrix", mgGetCalleeName(instance));
+
+	return result;
+}
+
+
+static MGValue* _mg_mat_transform(MGInstance *instance, size_t argc, const MGValue* const* argv, float w)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	float m[16], v[4], r[4];
+
+	_mg_mat_load(instance, argv, 0, m);
+	_mg_mat_load_vec3(instance, argv, 1, v);
+	v[3] = w;
+
+	mgMatrixTransform(r, m, v);
+
+	return _mg_mat_vec_result(argv[1], 3, r);
+}
+
+
+static MGValue* mg_mat_transform_point(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	return _mg_mat_transform(instance, argc, argv, 1.0f);
+}
+
+
+static MGValue* mg_mat_transform_direction(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	return _mg_mat_transform(instance, argc, argv, 0.0f);
+}
+
+
+MGValue* mgCreateMatLib(void)
+{
+	MGValue *module = mgCreateValueModule();
+
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+
+	mgModuleSetCFunction(module, "vec_type", mg_mat_vec_type);
+
+	mgModuleSetCFunction(module, "mat4", mg_mat_mat4); // mat4(diagonal = 1)
+	mgModuleSetCFunction(module, "column", mg_mat_column);
+	mgModuleSetCFunction(module, "row", mg_mat_row);
+
+	mgModuleSetCFunction(module, "scaling", mg_mat_scaling);
+	mgModuleSetCFunction(module, "translation", mg_mat_translation);
+	mgModuleSetCFunction(module, "rotation", mg_mat_rotation);
+
+	mgModuleSetCFunction(module, "mul", mg_mat_mul);
+
+	mgModuleSetCFunction(module, "scale", mg_mat_scale);
+	mgModuleSetCFunction(module, "translate", mg_mat_translate);
+	mgModuleSetCFunction(module, "rotate", mg_mat_rotate);
+
+	mgModuleSetCFunction(module, "get_translation", mg_mat_get_translation);
+	mgModuleSetCFunction(module, "get_scaling", mg_mat_get_scaling);
+	mgModuleSetCFunction(module, "get_rotation", mg_mat_get_rotation);
+
+	mgModuleSetCFunction(module, "transpose", mg_mat_transpose);
+	mgModuleSetCFunction(module, "inverse", mg_mat_inverse);
+	mgModuleSetCFunction(module, "normal_matrix", mg_mat_normal_matrix);
+
+	mgModuleSetCFunction(module, "transform_point", mg_mat_transform_point);
+	mgModuleSetCFunction(module, "transform_direction", mg_mat_transform_direction);
+
+	return module;
+}
@@ -14,6 +14,10 @@ func pop_modifier()
 	assert len(_modifiers) > 0
 	delete _modifiers[-1]
 
+# The modifiers geom applies to each vertex, in the order they were pushed
+func active()
+	return _modifiers
+
 
 func _twist(angle, axis = (0, 1, 0))
 	axis = vec.normalize(axis)
@@ -0,0 +1,549 @@
+
+#include <string.h>
+#include <math.h>
+
+#include "value.h"
+#include "types/primitive.h"
+#include "types/composite.h"
+#include "types/module.h"
+#include "types/vector.h"
+#include "callable.h"
+#include "simd.h"
+#include "error.h"
+#include "utilities.h"
+
+
+// Native version of modules/vec.mg, which remains as the reference
+// implementation. Anything which isn't a tuple is treated as a vector
+// of one component, which is broadcast like any vector whose length is
+// a multiple of the other's. Components are computed exactly like the
+// operators and math functions used by vec.mg, while vectors of up to 4
+// numbers compute every component which isn't integer using SIMD.
+// vec2, vec3 and vec4 values are accepted wherever tuples are, and
+// the results computed from them are vectors as well.
+
+
+extern MGValue* _mg_max(size_t argc, const MGValue* const* argv);
+extern MGValue* _mg_min(size_t argc, const MGValue* const* argv);
+
+
+typedef enum MGVecOp {
+	MG_VEC_OP_ADD,
+	MG_VEC_OP_SUB,
+	MG_VEC_OP_MUL,
+	MG_VEC_OP_DIV,
+	MG_VEC_OP_MOD,
+	MG_VEC_OP_MAX,
+	MG_VEC_OP_MIN,
+	MG_VEC_OP_CALL
+} MGVecOp;
+
+static const MGBinOpType _MG_VEC_BIN_OPS[] = {
+	MG_BIN_OP_ADD,
+	MG_BIN_OP_SUB,
+	MG_BIN_OP_MUL,
+	MG_BIN_OP_DIV,
+	MG_BIN_OP_MOD
+};
+
+
+#define _mgVecLength(v) \
+	((mgValueType(v) == MG_TYPE_TUPLE) ? mgTupleLength(v) : (mgIsVectorValue(v) ? mgVectorLength(v) : 1))
+#define _mgVecGet(v, i) \
+	((mgValueType(v) == MG_TYPE_TUPLE) ? _mgListGet((v)->data.a, i) : (mgIsVectorValue(v) ? mgCreateValueFloat(mgVectorGet(v, i)) : (v)))
+
+
+// Turns the components into a vector if either operand was one
+static MGValue* _mg_vec_result(const MGValue *a, const MGValue *b, size_t length, MGValue **items)
+{
+	MGbool vector = (mgIsVectorValue(a) || mgIsVectorValue(b)) && (length >= 2) && (length <= 4);
+
+	for (size_t i = 0; vector && (i < length); ++i)
+		vector = mgIsNumericValue(items[i]);
+
+	MGValue *v;
+
+	if (vector)
+	{
+		float components[4];
+
+		for (size_t i = 0; i < length; ++i)
+			components[i] = _mgNumericGet(items[i]);
+
+		v = mgCreateValueVector(length, components);
+	}
+	else
+	{
+		v = mgCreateValueTuple(length);
+
+		for (size_t i = 0; i < length; ++i)
+			mgTupleAdd(v, mgReferenceValue(items[i]));
+	}
+
+	for (size_t i = 0; i < length; ++i)
+		mgDestroyValue(items[i]);
+
+	return v;
+}
+
+
+static MGValue* _mg_vec_component(MGInstance *instance, MGVecOp op, const MGValue *callable, const MGValue *a, const MGValue *b)
+{
+	const MGValue *argv[2] = { a, b };
+
+	switch (op)
+	{
+	case MG_VEC_OP_MAX:
+		return _mg_max(2, argv);
+	case MG_VEC_OP_MIN:
+		return _mg_min(2, argv);
+	case MG_VEC_OP_CALL:
+		return mgCall(instance, callable, 2, argv);
+	default:
+		return mgValueBinaryOp(a, b, _MG_VEC_BIN_OPS[op]);
+	}
+}
+
+
+// Computes the lanes of numbers which aren't both integers, as those
+// are the only ones where the result is the same as converting both
+// operands to floats, and leaves the rest to _mg_vec_component
+static MGbool _mg_vec_op_simd(MGVecOp op, const MGValue *a, const MGValue *b, size_t length, MGValue **result)
+{
+	if ((length > 4) || (op == MG_VEC_OP_MOD) || (op == MG_VEC_OP_CALL))
+		return MG_FALSE;
+
+	const size_t lengthA = _mgVecLength(a), lengthB = _mgVecLength(b);
+
+	float fa[4] = { 0.0f }, fb[4] = { 0.0f }, fr[4];
+	MGbool floats = MG_FALSE;
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		const MGValue *ai = _mgVecGet(a, i % lengthA);
+		const MGValue *bi = _mgVecGet(b, i % lengthB);
+
+		if (!mgIsNumericValue(ai) || !mgIsNumericValue(bi))
+			return MG_FALSE;
+
+		fa[i] = _mgNumericGet(ai);
+		fb[i] = _mgNumericGet(bi);
+
+		floats |= (_mgValueTag(ai) == _MG_VALUE_TAG_FLOAT) || (_mgValueTag(bi) == _MG_VALUE_TAG_FLOAT);
+	}
+
+	if (!floats)
+		return MG_FALSE;
+
+	const MGFloat4 va = mgFloat4Load(fa), vb = mgFloat4Load(fb);
+	MGFloat4 vr;
+
+	// math.max and math.min keep the first argument unless
+	// the second is greater or less, like SSE does with b
+	switch (op)
+	{
+	case MG_VEC_OP_ADD:
+		vr = mgFloat4Add(va, vb);
+		break;
+	case MG_VEC_OP_SUB:
+		vr = mgFloat4Sub(va, vb);
+		break;
+	case MG_VEC_OP_MUL:
+		vr = mgFloat4Mul(va, vb);
+		break;
+	case MG_VEC_OP_DIV:
+		vr = mgFloat4Div(va, vb);
+		break;
+	case MG_VEC_OP_MAX:
+		vr = mgFloat4Max(vb, va);
+		break;
+	case MG_VEC_OP_MIN:
+		vr = mgFloat4Min(vb, va);
+		break;
+	default:
+		return MG_FALSE;
+	}
+
+	mgFloat4Store(fr, vr);
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		const MGValue *ai = _mgVecGet(a, i % lengthA);
+		const MGValue *bi = _mgVecGet(b, i % lengthB);
+
+		if ((_mgValueTag(ai) == _MG_VALUE_TAG_INTEGER) && (_mgValueTag(bi) == _MG_VALUE_TAG_INTEGER))
+			result[i] = _mg_vec_component(NULL, op, NULL, ai, bi);
+		else
+			result[i] = mgCreateValueFloat(fr[i]);
+	}
+
+	return MG_TRUE;
+}
+
+
+static MGValue* _mg_vec_op(MGInstance *instance, MGVecOp op, const MGValue *callable, const MGValue *a, const MGValue *b)
+{
+	const size_t lengthA = _mgVecLength(a), lengthB = _mgVecLength(b);
+	const size_t length = (lengthA > lengthB) ? lengthA : lengthB;
+
+	if ((lengthA != lengthB) && (!lengthA || !lengthB || (length % lengthA) || (length % lengthB)))
+		mgFatalError("Error: vec%zu and vec%zu either is not a multiple of the other", lengthA, lengthB);
+
+	MGValue *items[4];
+
+	if (_mg_vec_op_simd(op, a, b, length, items))
+		return _mg_vec_result(a, b, length, items);
+	else if ((length <= 4) && (mgIsVectorValue(a) || mgIsVectorValue(b)))
+	{
+		for (size_t i = 0; i < length; ++i)
+			items[i] = _mg_vec_component(instance, op, callable, _mgVecGet(a, i % lengthA), _mgVecGet(b, i % lengthB));
+
+		return _mg_vec_result(a, b, length, items);
+	}
+
+	MGValue *v = mgCreateValueTuple(length);
+
+	for (size_t i = 0; i < length; ++i)
+		mgTupleAdd(v, _mg_vec_component(instance, op, callable, _mgVecGet(a, i % lengthA), _mgVecGet(b, i % lengthB)));
+
+	return v;
+}
+
+
+// Sums like math.sum, i.e. integers until the first float
+static MGValue* _mg_vec_sum(const MGValue *v)
+{
+	MGbool isInt = MG_TRUE;
+	int i = 0;
+	float f = 0.0f;
+
+	for (size_t j = 0; j < _mgVecLength(v); ++j)
+	{
+		const MGValue *item = _mgVecGet(v, j);
+
+		if (isInt && (mgValueType(item) == MG_TYPE_FLOAT))
+		{
+			isInt = MG_FALSE;
+			f = (float) i;
+		}
+
+		switch (mgValueType(item))
+		{
+		case MG_TYPE_INTEGER:
+			if (isInt)
+				i += mgIntegerGet(item);
+			else
+				f += (float) mgIntegerGet(item);
+			break;
+		case MG_TYPE_FLOAT:
+			f += mgFloatGet(item);
+			break;
+		default:
+			mgFatalError("Error: sum expected argument %zu as \"%s\" or \"%s\", received \"%s\"",
+			        j + 1, mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
+			        mgGetTypeName(mgValueType(item)));
+		}
+	}
+
+	return isInt ? mgCreateValueInteger(i) : mgCreateValueFloat(f);
+}
+
+
+static MGValue* _mg_vec_dot(MGInstance *instance, const MGValue *a, const MGValue *b)
+{
+	MGValue *products = _mg_vec_op(instance, MG_VEC_OP_MUL, NULL, a, b);
+	MGValue *dot = _mg_vec_sum(products);
+
+	mgDestroyValue(products);
+
+	return dot;
+}
+
+
+static MGValue* _mg_vec_length(MGInstance *instance, const MGValue *a)
+{
+	const MGValue *dot = _mg_vec_dot(instance, a, a);
+
+	return mgCreateValueFloat(sqrtf(_mgNumericGet(dot)));
+}
+
+
+// mat.mul of two vectors, for the native mat module
+MGValue* _mg_vec_mul(MGInstance *instance, const MGValue *a, const MGValue *b)
+{
+	return _mg_vec_op(instance, MG_VEC_OP_MUL, NULL, a, b);
+}
+
+
+#define _MG_VEC_OP_FUNCTION(name, op) \
+	static MGValue* name(MGInstance *instance, size_t argc, const MGValue* const* argv) \
+	{ \
+		mgCheckArgumentCount(instance, argc, 2, 2); \
+		return _mg_vec_component(instance, op, NULL, argv[0], argv[1]); \
+	}
+
+_MG_VEC_OP_FUNCTION(mg_vec_op_add, MG_VEC_OP_ADD)
+_MG_VEC_OP_FUNCTION(mg_vec_op_sub, MG_VEC_OP_SUB)
+_MG_VEC_OP_FUNCTION(mg_vec_op_mul, MG_VEC_OP_MUL)
+_MG_VEC_OP_FUNCTION(mg_vec_op_div, MG_VEC_OP_DIV)
+_MG_VEC_OP_FUNCTION(mg_vec_op_mod, MG_VEC_OP_MOD)
+
+#undef _MG_VEC_OP_FUNCTION
+
+
+#define _MG_VEC_FUNCTION(name, op) \
+	static MGValue* name(MGInstance *instance, size_t argc, const MGValue* const* argv) \
+	{ \
+		mgCheckArgumentCount(instance, argc, 2, 2); \
+		return _mg_vec_op(instance, op, NULL, argv[0], argv[1]); \
+	}
+
+_MG_VEC_FUNCTION(mg_vec_add, MG_VEC_OP_ADD)
+_MG_VEC_FUNCTION(mg_vec_sub, MG_VEC_OP_SUB)
+_MG_VEC_FUNCTION(mg_vec_mul, MG_VEC_OP_MUL)
+_MG_VEC_FUNCTION(mg_vec_div, MG_VEC_OP_DIV)
+_MG_VEC_FUNCTION(mg_vec_mod, MG_VEC_OP_MOD)
+_MG_VEC_FUNCTION(mg_vec_max, MG_VEC_OP_MAX)
+_MG_VEC_FUNCTION(mg_vec_min, MG_VEC_OP_MIN)
+
+#undef _MG_VEC_FUNCTION
+
+
+static MGValue* mg_vec_cast(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 2);
+
+	if ((mgValueType(argv[0]) == MG_TYPE_TUPLE) || mgIsVectorValue(argv[0]))
+		return mgReferenceValue(argv[0]);
+
+	if (argc > 1)
+		mgCheckArgumentTypes(instance, argc, argv, 0, 1, MG_TYPE_INTEGER);
+
+	const int n = (argc > 1) ? mgIntegerGet(argv[1]) : 1;
+
+	MGValue *v = mgCreateValueTuple((n > 0) ? (size_t) n : 0);
+
+	for (int i = 0; i < n; ++i)
+		mgTupleAdd(v, mgReferenceValue(argv[0]));
+
+	return v;
+}
+
+
+static MGValue* mg_vec_op_vec(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 3);
+
+	if (argc < 3)
+		return _mg_vec_op(instance, MG_VEC_OP_ADD, NULL, argv[0], argv[1]);
+
+	mgCheckArgumentTypes(instance, argc, argv, 0, 0, 4, MG_TYPE_CFUNCTION, MG_TYPE_BOUND_CFUNCTION, MG_TYPE_FUNCTION, MG_TYPE_PROCEDURE);
+
+	static const struct {
+		MGCFunction cfunc;
+		MGVecOp op;
+	} ops[] = {
+		{ mg_vec_op_add, MG_VEC_OP_ADD },
+		{ mg_vec_op_sub, MG_VEC_OP_SUB },
+		{ mg_vec_op_mul, MG_VEC_OP_MUL },
+		{ mg_vec_op_div, MG_VEC_OP_DIV },
+		{ mg_vec_op_mod, MG_VEC_OP_MOD }
+	};
+
+	// The operators of the module need not be called
+	if (mgValueType(argv[2]) == MG_TYPE_CFUNCTION)
+		for (size_t i = 0; i < (sizeof(ops) / sizeof(*ops)); ++i)
+			if (argv[2]->data.cfunc == ops[i].cfunc)
+				return _mg_vec_op(instance, ops[i].op, NULL, argv[0], argv[1]);
+
+	return _mg_vec_op(instance, MG_VEC_OP_CALL, argv[2], argv[0], argv[1]);
+}
+
+
+static MGValue* mg_vec_dot(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	return _mg_vec_dot(instance, argv[0], argv[1]);
+}
+
+
+static MGValue* mg_vec_length_squared(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	return _mg_vec_dot(instance, argv[0], argv[0]);
+}
+
+
+static MGValue* mg_vec_length(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+
+	return _mg_vec_length(instance, argv[0]);
+}
+
+
+static MGValue* mg_vec_distance_squared(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	MGValue *difference = _mg_vec_op(instance, MG_VEC_OP_SUB, NULL, argv[0], argv[1]);
+	MGValue *distance = _mg_vec_dot(instance, difference, difference);
+
+	mgDestroyValue(difference);
+
+	return distance;
+}
+
+
+static MGValue* mg_vec_distance(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	MGValue *difference = _mg_vec_op(instance, MG_VEC_OP_SUB, NULL, argv[0], argv[1]);
+	MGValue *distance = _mg_vec_length(instance, difference);
+
+	mgDestroyValue(difference);
+
+	return distance;
+}
+
+
+static MGValue* mg_vec_normalize(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 2);
+	mgCheckArgumentTypes(instance, argc, argv, 4, MG_TYPE_TUPLE, MG_TYPE_VEC2, MG_TYPE_VEC3, MG_TYPE_VEC4, 0);
+
+	const MGValue *length = _mg_vec_length(instance, argv[0]);
+	const MGValue *to = (argc > 1) ? argv[1] : mgCreateValueInteger(1);
+
+	MGValue *scale = mgValueDiv(to, length);
+	MGValue *normalized = _mg_vec_op(instance, MG_VEC_OP_MUL, NULL, argv[0], scale);
+
+	mgDestroyValue(scale);
+
+	return normalized;
+}
+
+
+static MGValue* mg_vec_cross(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	const MGValue *a = argv[0], *b = argv[1];
+
+	if ((_mgVecLength(a) != 3) || (_mgVecLength(b) != 3))
+		mgFatalError("Error: cross expected vec3 and vec3, received vec%zu and vec%zu", _mgVecLength(a), _mgVecLength(b));
+
+	MGValue *items[3];
+
+	float fa[4] = { 0.0f }, fb[4] = { 0.0f };
+	MGbool floats = MG_TRUE;
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		floats &= (_mgValueTag(_mgVecGet(a, i)) == _MG_VALUE_TAG_FLOAT) && (_mgValueTag(_mgVecGet(b, i)) == _MG_VALUE_TAG_FLOAT);
+
+		if (floats)
+		{
+			fa[i] = mgFloatGet(_mgVecGet(a, i));
+			fb[i] = mgFloatGet(_mgVecGet(b, i));
+		}
+	}
+
+	if (floats)
+	{
+		const MGFloat4 va = mgFloat4Load(fa), vb = mgFloat4Load(fb);
+
+		float fr[4];
+		mgFloat4Store(fr, mgFloat4Sub(mgFloat4Mul(mgFloat4YZX(va), mgFloat4ZXY(vb)), mgFloat4Mul(mgFloat4ZXY(va), mgFloat4YZX(vb))));
+
+		for (size_t i = 0; i < 3; ++i)
+			items[i] = mgCreateValueFloat(fr[i]);
+	}
+	else
+	{
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const size_t j = (i + 1) % 3, k = (i + 2) % 3;
+
+			MGValue *lhs = mgValueMul(_mgVecGet(a, j), _mgVecGet(b, k));
+			MGValue *rhs = mgValueMul(_mgVecGet(a, k), _mgVecGet(b, j));
+
+			items[i] = mgValueSub(lhs, rhs);
+
+			mgDestroyValue(lhs);
+			mgDestroyValue(rhs);
+		}
+	}
+
+	return _mg_vec_result(a, b, 3, items);
+}
+
+
+static MGValue* mg_vec_vec2(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 2, 2);
+
+	return mgCreateValueTupleEx(2, mgReferenceValue(argv[0]), mgReferenceValue(argv[1]));
+}
+
+
+static MGValue* mg_vec_vec3(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 3, 3);
+
+	return mgCreateValueTupleEx(3, mgReferenceValue(argv[0]), mgReferenceValue(argv[1]), mgReferenceValue(argv[2]));
+}
+
+
+static MGValue* mg_vec_vec4(MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 3, 4);
+
+	return mgCreateValueTupleEx(4, mgReferenceValue(argv[0]), mgReferenceValue(argv[1]), mgReferenceValue(argv[2]),
+	                            (argc > 3) ? mgReferenceValue(argv[3]) : mgCreateValueInteger(1));
+}
+
+
+MGValue* mgCreateVecLib(void)
+{
+	MGValue *module = mgCreateValueModule();
+
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+
+	mgModuleSetCFunction(module, "op_add", mg_vec_op_add);
+	mgModuleSetCFunction(module, "op_sub", mg_vec_op_sub);
+	mgModuleSetCFunction(module, "op_mul", mg_vec_op_mul);
+	mgModuleSetCFunction(module, "op_div", mg_vec_op_div);
+	mgModuleSetCFunction(module, "op_mod", mg_vec_op_mod);
+
+	mgModuleSetCFunction(module, "_cast", mg_vec_cast); // _cast(v, n = 1)
+	mgModuleSetCFunction(module, "op_vec", mg_vec_op_vec); // op_vec(a, b, op = op_add)
+
+	mgModuleSetCFunction(module, "add", mg_vec_add);
+	mgModuleSetCFunction(module, "sub", mg_vec_sub);
+	mgModuleSetCFunction(module, "mul", mg_vec_mul);
+	mgModuleSetCFunction(module, "div", mg_vec_div);
+	mgModuleSetCFunction(module, "mod", mg_vec_mod);
+
+	mgModuleSetCFunction(module, "max", mg_vec_max);
+	mgModuleSetCFunction(module, "min", mg_vec_min);
+
+	mgModuleSetCFunction(module, "dot", mg_vec_dot);
+	mgModuleSetCFunction(module, "length_squared", mg_vec_length_squared);
+	mgModuleSetCFunction(module, "length", mg_vec_length);
+	mgModuleSetCFunction(module, "distance_squared", mg_vec_distance_squared);
+	mgModuleSetCFunction(module, "distance", mg_vec_distance);
+	mgModuleSetCFunction(module, "normalize", mg_vec_normalize); // normalize(a, to = 1)
+
+	mgModuleSetCFunction(module, "cross", mg_vec_cross);
+
+	mgModuleSetCFunction(module, "vec2", mg_vec_vec2);
+	mgModuleSetCFunction(module, "vec3", mg_vec_vec3);
+	mgModuleSetCFunction(module, "vec4", mg_vec_vec4); // vec4(x, y, z, w = 1)
+
+	return module;
+}
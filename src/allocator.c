@@ -0,0 +1,250 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "allocator.h"
+#include "thread.h"
+#include "debug.h"
+
+
+#define _MG_ALLOCATOR_SLAB_SIZE (1 << 16)
+
+// Every block is preceded by a header pointing to the size class
+// that owns it, or NULL if the block was allocated using malloc.
+// The header keeps the payload 8-byte aligned, which the tag bits
+// of immediate values rely on.
+typedef union MGAllocatorHeader {
+	MGAllocatorClass *owner;
+	uint64_t align;
+} MGAllocatorHeader;
+
+typedef struct MGAllocatorSlab {
+	struct MGAllocatorSlab *next;
+	uint64_t align;
+} MGAllocatorSlab;
+
+
+static const size_t _mgAllocatorClassSizes[_MG_ALLOCATOR_CLASS_COUNT] = {
+#define _MG_AC(size) size,
+	_MG_ALLOCATOR_CLASSES
+#undef _MG_AC
+};
+
+
+// Instances are confined to their thread, so each thread has its own current allocator
+static MG_THREAD_LOCAL MGAllocator *_mgCurrentAllocator = NULL;
+
+
+#define _mgAllocatorHeader(ptr) (((MGAllocatorHeader*) (ptr)) - 1)
+#define _mgAllocatorBlockSize(cls) (sizeof(MGAllocatorHeader) + (cls)->size)
+
+
+void mgCreateAllocator(MGAllocator *allocator)
+{
+	MG_ASSERT(allocator);
+
+	memset(allocator, 0, sizeof(MGAllocator));
+
+	for (int i = 0; i < _MG_ALLOCATOR_CLASS_COUNT; ++i)
+	{
+		allocator->classes[i].allocator = allocator;
+		allocator->classes[i].size = _mgAllocatorClassSizes[i];
+	}
+}
+
+
+void mgDestroyAllocator(MGAllocator *allocator)
+{
+	MG_ASSERT(allocator);
+
+	// Blocks still in use are released along with their slab
+	for (MGAllocatorSlab *slab = (MGAllocatorSlab*) allocator->slabs, *next; slab; slab = next)
+	{
+		next = slab->next;
+		free(slab);
+	}
+
+	if (_mgCurrentAllocator == allocator)
+		_mgCurrentAllocator = NULL;
+
+	memset(allocator, 0, sizeof(MGAllocator));
+}
+
+
+MGAllocator* mgSetAllocator(MGAllocator *allocator)
+{
+	MGAllocator *previous = _mgCurrentAllocator;
+	_mgCurrentAllocator = allocator;
+	return previous;
+}
+
+
+MGAllocator* mgGetAllocator(void)
+{
+	return _mgCurrentAllocator;
+}
+
+
+#if MG_POOL_ALLOCATOR
+
+static inline MGAllocatorClass* _mgAllocatorClass(MGAllocator *allocator, size_t size)
+{
+	for (int i = 0; i < _MG_ALLOCATOR_CLASS_COUNT; ++i)
+		if (size <= allocator->classes[i].size)
+			return &allocator->classes[i];
+
+	return NULL;
+}
+
+
+static void _mgAllocatorReclaimRemote(MGAllocatorClass *cls)
+{
+	void *freeList = mgAtomicExchangePointer(&cls->remoteFreeList, NULL);
+
+	if (!freeList)
+		return;
+
+	size_t count = 0;
+	void *last = freeList;
+
+	for (; *(void**) last; last = *(void**) last)
+		++count;
+
+	MG_ASSERT(cls->live > count);
+
+	cls->live -= count + 1;
+	cls->allocator->live -= (count + 1) * cls->size;
+
+	*(void**) last = cls->freeList;
+	cls->freeList = freeList;
+}
+
+
+static void _mgAllocatorAddSlab(MGAllocatorClass *cls)
+{
+	MGAllocator *allocator = cls->allocator;
+
+	MGAllocatorSlab *slab = (MGAllocatorSlab*) malloc(_MG_ALLOCATOR_SLAB_SIZE);
+	MG_ASSERT(slab);
+
+	slab->next = (MGAllocatorSlab*) allocator->slabs;
+	allocator->slabs = slab;
+	++allocator->slabCount;
+
+	// Blocks are carved from the slab on demand
+	cls->next = (char*) (slab + 1);
+	cls->end = cls->next + ((_MG_ALLOCATOR_SLAB_SIZE - sizeof(MGAllocatorSlab)) / _mgAllocatorBlockSize(cls)) * _mgAllocatorBlockSize(cls);
+}
+
+
+void* mgAllocate(size_t size)
+{
+	MGAllocator *allocator = _mgCurrentAllocator;
+	MGAllocatorClass *cls = (allocator && (size <= _MG_ALLOCATOR_MAX_SIZE)) ? _mgAllocatorClass(allocator, size) : NULL;
+
+	MGAllocatorHeader *header;
+
+	if (cls)
+	{
+		if (!cls->freeList && mgAtomicLoadPointer(&cls->remoteFreeList))
+			_mgAllocatorReclaimRemote(cls);
+
+		if (cls->freeList)
+		{
+			header = _mgAllocatorHeader(cls->freeList);
+			cls->freeList = *(void**) cls->freeList;
+		}
+		else
+		{
+			if (cls->next == cls->end)
+				_mgAllocatorAddSlab(cls);
+
+			header = (MGAllocatorHeader*) cls->next;
+			cls->next += _mgAllocatorBlockSize(cls);
+		}
+
+		if (++cls->live > cls->peak)
+			cls->peak = cls->live;
+
+		if ((allocator->live += cls->size) > allocator->peak)
+			allocator->peak = allocator->live;
+	}
+	else
+	{
+		header = (MGAllocatorHeader*) malloc(sizeof(MGAllocatorHeader) + size);
+		MG_ASSERT(header);
+	}
+
+	header->owner = cls;
+
+	return header + 1;
+}
+
+
+void* mgReallocate(void *ptr, size_t size)
+{
+	if (!ptr)
+		return mgAllocate(size);
+
+	MGAllocatorClass *cls = _mgAllocatorHeader(ptr)->owner;
+
+	if (cls)
+	{
+		if (size <= cls->size)
+			return ptr;
+
+		void *block = mgAllocate(size);
+		memcpy(block, ptr, cls->size);
+		mgFree(ptr);
+
+		return block;
+	}
+
+	// The size of a malloc fallback isn't known, so it stays one
+	MGAllocatorHeader *header = (MGAllocatorHeader*) realloc(_mgAllocatorHeader(ptr), sizeof(MGAllocatorHeader) + size);
+	MG_ASSERT(header);
+
+	return header + 1;
+}
+
+
+void mgFree(void *ptr)
+{
+	if (!ptr)
+		return;
+
+	MGAllocatorHeader *header = _mgAllocatorHeader(ptr);
+	MGAllocatorClass *cls = header->owner;
+
+	if (!cls)
+	{
+		free(header);
+		return;
+	}
+
+	// Blocks owned by another thread's allocator are handed back to it,
+	// and count as live until it reclaims them
+	if (cls->allocator != _mgCurrentAllocator)
+	{
+		void *freeList;
+
+		do
+		{
+			freeList = mgAtomicLoadPointer(&cls->remoteFreeList);
+			*(void**) ptr = freeList;
+		} while (!mgAtomicCompareExchangePointer(&cls->remoteFreeList, freeList, ptr));
+
+		return;
+	}
+
+	MG_ASSERT(cls->live > 0);
+
+	--cls->live;
+	cls->allocator->live -= cls->size;
+
+	*(void**) ptr = cls->freeList;
+	cls->freeList = ptr;
+}
+
+#endif
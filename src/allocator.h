@@ -0,0 +1,70 @@
+#ifndef MODELGEN_ALLOCATOR_H
+#define MODELGEN_ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdlib.h>
+
+// Small allocations (values, list storage, map pairs) are served from
+// per-instance slabs split into size classes, with a free list for each.
+// Allocations larger than the largest size class or made while no
+// allocator is current fall back to malloc. Define MG_POOL_ALLOCATOR
+// as 0 to always use malloc, e.g. when running under a sanitizer.
+
+#ifndef MG_POOL_ALLOCATOR
+#   define MG_POOL_ALLOCATOR 1
+#endif
+
+#define _MG_ALLOCATOR_CLASSES \
+	_MG_AC(16) \
+	_MG_AC(32) \
+	_MG_AC(64) \
+	_MG_AC(96) \
+	_MG_AC(128) \
+	_MG_AC(256) \
+	_MG_AC(512)
+
+#define _MG_ALLOCATOR_CLASS_COUNT 7
+#define _MG_ALLOCATOR_MAX_SIZE 512
+
+typedef struct MGAllocator MGAllocator;
+
+typedef struct MGAllocatorClass {
+	MGAllocator *allocator;
+	size_t size;
+	void *freeList;
+	// Blocks freed by other threads, pushed atomically and
+	// reclaimed by the owning thread once freeList runs out
+	void *remoteFreeList;
+	char *next, *end;
+	size_t live, peak;
+} MGAllocatorClass;
+
+typedef struct MGAllocator {
+	MGAllocatorClass classes[_MG_ALLOCATOR_CLASS_COUNT];
+	void *slabs;
+	size_t slabCount;
+	// Live and peak bytes in use by pooled blocks
+	size_t live, peak;
+} MGAllocator;
+
+void mgCreateAllocator(MGAllocator *allocator);
+void mgDestroyAllocator(MGAllocator *allocator);
+
+MGAllocator* mgSetAllocator(MGAllocator *allocator);
+MGAllocator* mgGetAllocator(void);
+
+#if MG_POOL_ALLOCATOR
+
+void* mgAllocate(size_t size);
+void* mgReallocate(void *ptr, size_t size);
+void mgFree(void *ptr);
+
+#else
+
+#   define mgAllocate(size) malloc(size)
+#   define mgReallocate(ptr, size) realloc(ptr, size)
+#   define mgFree(ptr) free(ptr)
+
+#endif
+
+#endif
\ No newline at end of file
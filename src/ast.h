@@ -15,6 +15,7 @@
 	_MG_N(INTEGER, "Integer") \
 	_MG_N(FLOAT, "Float") \
 	_MG_N(STRING, "String") \
+	_MG_N(CONSTANT, "Constant") \
 	_MG_N(UNARY_OP_POS, "UnaryOpPos") \
 	_MG_N(UNARY_OP_NEG, "UnaryOpNeg") \
 	_MG_N(UNARY_OP_NOT, "UnaryOpNot") \
@@ -84,6 +85,8 @@ typedef struct MGNode {
 	MGToken *tokenEnd;
 	MGNode *parent;
 	_MGList(MGNode*) children;
+	struct MGValue *value;
+	struct MGCode *code;
 } MGNode;
 
 #endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "callable.h"
 #include "frame.h"
+#include "vm.h"
+#include "parallel.h"
 #include "error.h"
 #include "utilities.h"
 
@@ -31,12 +33,13 @@ MGValue* mgCall(MGInstance *instance, const MGValue *callable, size_t argc, cons
 	MGValue *module = (MGValue*) _mgLastModule(instance);
 	MG_ASSERT(module);
 
+	if (mgIsCFunction(callable))
+		return mgCallCFunction(instance, module, NULL, NULL, callable, argc, argv);
+
 	MGStackFrame frame;
 
-	if (((callable->type == MG_TYPE_FUNCTION) || (callable->type == MG_TYPE_PROCEDURE)) && callable->data.func.locals)
-		mgCreateStackFrameEx(&frame, mgReferenceValue(module), mgReferenceValue(callable->data.func.locals));
-	else
-		mgCreateStackFrame(&frame, mgReferenceValue(module));
+	mgCreateStackFrame(&frame, mgReferenceValue(module));
+	mgSetCallLocals(instance, &frame, callable);
 
 	mgPushStackFrame(instance, &frame);
 
@@ -49,56 +52,53 @@ MGValue* mgCall(MGInstance *instance, const MGValue *callable, size_t argc, cons
 }
 
 
-MGValue* mgCallEx(MGInstance *instance, MGStackFrame *frame, const MGValue *callable, size_t argc, const MGValue* const* argv)
+static void _mgCallScriptFunction(MGInstance *instance, MGStackFrame *frame, MGValue *module, const MGValue *callable, size_t argc, const MGValue* const* argv)
 {
-	MG_ASSERT(instance);
-	MG_ASSERT(callable);
-	MG_ASSERT((argc == 0) || (argv != NULL));
+	MG_ASSERT(callable->data.func.module);
+	MG_ASSERT(callable->data.func.node);
 
-	if (!mgIsCallable(callable))
-		mgFatalError("Error: \"%s\" is not callable", mgGetTypeName(callable->type));
+	MGNode *callableNode = callable->data.func.node;
+	MG_ASSERT((callableNode->type == MG_NODE_PROCEDURE) || (callableNode->type == MG_NODE_FUNCTION));
 
-	MGValue *module = (MGValue*) _mgLastModule(instance);
-	MG_ASSERT(module);
-
-	if (callable->type == MG_TYPE_CFUNCTION)
-		frame->value = callable->data.cfunc(module->data.module.instance, argc, argv);
-	else if (callable->type == MG_TYPE_BOUND_CFUNCTION)
-		frame->value = callable->data.bcfunc.cfunc(module->data.module.instance, callable->data.bcfunc.bound, argc, argv);
-	else
+	if ((callableNode->type == MG_NODE_PROCEDURE) || (callableNode->type == MG_NODE_FUNCTION))
 	{
-		MG_ASSERT(callable->data.func.module);
-		MG_ASSERT(callable->data.func.node);
+		MG_ASSERT((_mgListLength(callableNode->children) == 2) || (_mgListLength(callableNode->children) == 3));
 
-		MGNode *callableNode = callable->data.func.node;
-		MG_ASSERT((callableNode->type == MG_NODE_PROCEDURE) || (callableNode->type == MG_NODE_FUNCTION));
+		MGNode *funcParametersNode = _mgListGet(callableNode->children, 1);
+		MG_ASSERT(funcParametersNode->type == MG_NODE_TUPLE);
 
-		if ((callableNode->type == MG_NODE_PROCEDURE) || (callableNode->type == MG_NODE_FUNCTION))
+		if (_mgListLength(funcParametersNode->children) < argc)
 		{
-			MG_ASSERT((_mgListLength(callableNode->children) == 2) || (_mgListLength(callableNode->children) == 3));
+			MGNode *funcNameNode = _mgListGet(callableNode->children, 0);
+			const char *funcName = NULL;
 
-			MGNode *funcParametersNode = _mgListGet(callableNode->children, 1);
-			MG_ASSERT(funcParametersNode->type == MG_NODE_TUPLE);
-
-			if (_mgListLength(funcParametersNode->children) < argc)
+			if (funcNameNode->type == MG_NODE_NAME)
 			{
-				MGNode *funcNameNode = _mgListGet(callableNode->children, 0);
-				const char *funcName = NULL;
+				MG_ASSERT(funcNameNode->token);
 
-				if (funcNameNode->type == MG_NODE_NAME)
-				{
-					MG_ASSERT(funcNameNode->token);
+				funcName = funcNameNode->token->value.s;
+			}
 
-					funcName = funcNameNode->token->value.s;
-				}
+			mgFatalError("Error: %s expected at most %zu argument%s, received %zu",
+			             funcName ? funcName : "<anonymous>",
+			             _mgListLength(funcParametersNode->children),
+			             (_mgListLength(funcParametersNode->children) == 1) ? "" : "s",
+			             argc);
+		}
 
-				mgFatalError("Error: %s expected at most %zu argument%s, received %zu",
-				             funcName ? funcName : "<anonymous>",
-				             _mgListLength(funcParametersNode->children),
-				             (_mgListLength(funcParametersNode->children) == 1) ? "" : "s",
-				             argc);
-			}
+		if (!instance->walkAST)
+		{
+			const MGCode *code = mgCompile(callableNode);
+
+			// Functions given a locals map, e.g. by setting an
+			// attribute on them, must run without resolved slots
+			if (code->resolved && !callable->data.func.locals)
+				code = code->resolved;
 
+			frame->value = mgExecute(instance, callable->data.func.module, code, argc, argv);
+		}
+		else
+		{
 			for (size_t i = 0; i < _mgListLength(funcParametersNode->children); ++i)
 			{
 				MGNode *funcParameterNode = _mgListGet(funcParametersNode->children, i);
@@ -140,11 +140,94 @@ MGValue* mgCallEx(MGInstance *instance, MGStackFrame *frame, const MGValue *call
 				_mgVisitNode(callable->data.func.module, _mgListGet(callableNode->children, 2));
 		}
 	}
+}
+
+
+MGValue* mgCallEx(MGInstance *instance, MGStackFrame *frame, const MGValue *callable, size_t argc, const MGValue* const* argv)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(callable);
+	MG_ASSERT((argc == 0) || (argv != NULL));
+
+	if (!mgIsCallable(callable))
+		mgFatalError("Error: \"%s\" is not callable", mgGetTypeName(mgValueType(callable)));
+
+	MGValue *module = (MGValue*) _mgLastModule(instance);
+	MG_ASSERT(module);
+
+	if (mgValueType(callable) == MG_TYPE_CFUNCTION)
+		frame->value = callable->data.cfunc(instance, argc, argv);
+	else if (mgValueType(callable) == MG_TYPE_BOUND_CFUNCTION)
+		frame->value = callable->data.bcfunc.cfunc(instance, callable->data.bcfunc.bound, argc, argv);
+	else
+	{
+		_mgCallScriptFunction(instance, frame, module, callable, argc, argv);
+
+		// Calls in tail position are made in place of the call which
+		// deferred them, which keeps tail recursion in constant space
+		MGValue *tailCall = NULL;
+
+		while (frame->tailCall)
+		{
+			if (tailCall)
+				mgDestroyValue(tailCall);
+
+			tailCall = frame->tailCall;
+			frame->tailCall = NULL;
+			frame->state = MG_STACK_FRAME_STATE_ACTIVE;
+
+			if (frame->value)
+			{
+				mgDestroyValue(frame->value);
+				frame->value = NULL;
+			}
+
+			callable = mgTupleGet(tailCall, 0);
+
+			mgSetCallLocals(instance, frame, callable);
+
+			_mgCallScriptFunction(instance, frame, frame->module, callable, mgTupleLength(tailCall) - 1,
+			                      (const MGValue* const*) _mgListItems(tailCall->data.a) + 1);
+		}
+
+		if (tailCall)
+			mgDestroyValue(tailCall);
+	}
 
 	return frame->value ? mgReferenceValue(frame->value) : MG_NULL_VALUE;
 }
 
 
+void mgDeferTailCall(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                     const MGValue *callable, size_t argc, const MGValue* const* argv)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(instance->callStackTop);
+	MG_ASSERT((mgValueType(callable) == MG_TYPE_FUNCTION) || (mgValueType(callable) == MG_TYPE_PROCEDURE));
+
+	MGStackFrame *frame = instance->callStackTop;
+	MG_ASSERT(frame->tailCall == NULL);
+
+	MGValue *tailCall = mgCreateValueTuple(argc + 1);
+
+	mgTupleAdd(tailCall, mgReferenceValue(callable));
+
+	for (size_t i = 0; i < argc; ++i)
+		mgTupleAdd(tailCall, mgReferenceValue(argv[i]));
+
+	frame->tailCall = tailCall;
+	frame->state = MG_STACK_FRAME_STATE_RETURN;
+
+	// The frame is reused for the deferred call, which is made from the module of the caller
+	MGValue *lastModule = frame->module;
+	frame->module = mgReferenceValue(module);
+	mgDestroyValue(lastModule);
+
+	frame->caller = caller;
+	frame->callerName = callerName;
+}
+
+
 void mgCheckArgumentCount(MGInstance *instance, size_t argc, size_t min, size_t max)
 {
 	MG_ASSERT(instance);
@@ -173,9 +256,14 @@ void mgCheckArgumentTypes(MGInstance *instance, size_t argc, const MGValue* cons
 
 		MGbool match = types == 0;
 
+		// Iterators stand in for the lists they replace
 		for (int j = 0; j < types; ++j)
-			if (argv[i]->type == va_arg(args, MGType))
+		{
+			const MGType type = va_arg(args, MGType);
+
+			if ((mgValueType(argv[i]) == type) || ((type == MG_TYPE_LIST) && (mgValueType(argv[i]) == MG_TYPE_ITERATOR)))
 				match = MG_TRUE;
+		}
 
 		if (!match)
 		{
@@ -188,7 +276,7 @@ void mgCheckArgumentTypes(MGInstance *instance, size_t argc, const MGValue* cons
 			for (int j = 0; j < types; ++j)
 				end += snprintf(end, messageLength - (end - message), "%s \"%s\"", (j > 0) ? " or" : "", mgGetTypeName(va_arg(args2, MGType)));
 
-			end += snprintf(end, messageLength - (end - message), ", received \"%s\"", mgGetTypeName(argv[i]->type));
+			end += snprintf(end, messageLength - (end - message), ", received \"%s\"", mgGetTypeName(mgValueType(argv[i])));
 
 			message[messageLength - 1] = '\0';
 			*end = '\0';
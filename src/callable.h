@@ -3,8 +3,9 @@
 
 #include "value.h"
 #include "frame.h"
+#include "instance.h"
 
-#define mgIsCallable(value) ((value->type == MG_TYPE_CFUNCTION) || (value->type == MG_TYPE_BOUND_CFUNCTION) || (value->type == MG_TYPE_PROCEDURE) || (value->type == MG_TYPE_FUNCTION))
+#define mgIsCallable(value) ((mgValueType(value) == MG_TYPE_CFUNCTION) || (mgValueType(value) == MG_TYPE_BOUND_CFUNCTION) || (mgValueType(value) == MG_TYPE_PROCEDURE) || (mgValueType(value) == MG_TYPE_FUNCTION))
 
 #define mgGetCalleeName(instance) (instance->callStackTop->callerName ? (const char*) instance->callStackTop->callerName : "<anonymous>")
 #define mgGetCallerName(instance) (instance->callStackTop->last->callerName ? (const char*) instance->callStackTop->last->callerName : "<anonymous>")
@@ -12,6 +13,66 @@
 MGValue* mgCall(MGInstance *instance, const MGValue *callable, size_t argc, const MGValue* const* argv);
 MGValue* mgCallEx(MGInstance *instance, MGStackFrame *frame, const MGValue *callable, size_t argc, const MGValue* const* argv);
 
+#define mgIsCFunction(value) ((mgValueType(value) == MG_TYPE_CFUNCTION) || (mgValueType(value) == MG_TYPE_BOUND_CFUNCTION))
+
+// C functions never use locals, so they are called with a frame which only
+// holds the caller, for argument errors and traceback(). The frame borrows
+// the module, which the caller must keep alive for the duration of the call
+#define _mgInitCFunctionFrame(instance, frame, _module, _caller, _callerName) \
+	do { \
+		(frame).state = MG_STACK_FRAME_STATE_ACTIVE; \
+		(frame).last = (instance)->callStackTop; \
+		(frame).module = (_module); \
+		(frame).caller = (_caller); \
+		(frame).callerName = (_callerName); \
+		(frame).value = NULL; \
+		(frame).tailCall = NULL; \
+		(frame).locals = NULL; \
+		(frame).slots = NULL; \
+		(frame).code = NULL; \
+	} while (0)
+
+static inline MGValue* mgCallCFunction(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                                       const MGValue *callable, size_t argc, const MGValue* const* argv)
+{
+	MGStackFrame frame;
+	_mgInitCFunctionFrame(instance, frame, module, caller, callerName);
+
+	instance->callStackTop = &frame;
+
+	MGValue *value;
+
+	if (mgValueType(callable) == MG_TYPE_CFUNCTION)
+		value = callable->data.cfunc(instance, argc, argv);
+	else
+		value = callable->data.bcfunc.cfunc(instance, callable->data.bcfunc.bound, argc, argv);
+
+	instance->callStackTop = frame.last;
+
+	return value ? value : MG_NULL_VALUE;
+}
+
+// Same as calling a bound C function, without creating one
+static inline MGValue* mgCallMethod(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                                    MGBoundCFunction method, const MGValue *bound, size_t argc, const MGValue* const* argv)
+{
+	MGStackFrame frame;
+	_mgInitCFunctionFrame(instance, frame, module, caller, callerName);
+
+	instance->callStackTop = &frame;
+
+	MGValue *value = method(instance, bound, argc, argv);
+
+	instance->callStackTop = frame.last;
+
+	return value ? value : MG_NULL_VALUE;
+}
+
+// Defers calling a script function in tail position until the current
+// frame has returned, after which mgCallEx calls it in the same frame
+void mgDeferTailCall(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                     const MGValue *callable, size_t argc, const MGValue* const* argv);
+
 void mgCheckArgumentCount(MGInstance *instance, size_t argc, size_t min, size_t max);
 void mgCheckArgumentTypes(MGInstance *instance, size_t argc, const MGValue* const* argv, ...);
 
@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "allocator.h"
+
 #define _MGList(type) \
 	struct { size_t length, capacity; type *items; }
 
@@ -11,20 +13,20 @@
 	((list).length = 0, (list).capacity = 0, (list).items = NULL)
 
 #define _mgListCreate(type, list, n) \
-	((list).length = 0, (list).capacity = (n), (list).items = (type*) malloc((n) * sizeof(type)))
+	((list).length = 0, (list).capacity = (n), (list).items = (type*) mgAllocate((n) * sizeof(type)))
 
 #define _mgListDestroy(list) \
-	free((list).items)
+	mgFree((list).items)
 
 #define _mgListClear(list) \
 	(list).length = 0
 
 #define _mgListResize(type, list, n) \
-	((list).capacity = (n), (list).items = (type*) realloc((list).items, (n) * sizeof(type)))
+	((list).capacity = (n), (list).items = (type*) mgReallocate((list).items, (n) * sizeof(type)))
 
 #define _mgListGrow(type, list) \
 	((list).capacity = (list).capacity ? (list).capacity << 1 : 2, \
-	(list).items = (type*) realloc((list).items, (list).capacity * sizeof(type)))
+	(list).items = (type*) mgReallocate((list).items, (list).capacity * sizeof(type)))
 
 #define _mgListLength(list) (list).length
 #define _mgListCapacity(list) (list).capacity
@@ -88,6 +90,6 @@
 #define _MGPair(k, v) struct { k key; v value; }
 
 
-#define _mgMapSize(map) _mgListLength(map)
+#define _mgMapSize(map) _mgListLength((map).pairs)
 
 #endif
\ No newline at end of file
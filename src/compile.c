@@ -0,0 +1,1291 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "compile.h"
+#include "types/primitive.h"
+#include "parallel.h"
+#include "error.h"
+#include "utilities.h"
+
+
+const char* const _MG_OPCODE_NAMES[] = {
+#define _MG_OPC(opcode, name) name,
+	_MG_OPCODES
+#undef _MG_OPC
+};
+
+
+typedef struct MGLoop MGLoop;
+
+typedef struct MGLoop {
+	MGLoop *outer;
+	size_t start;
+	uint16_t result;
+	_MGList(size_t) breaks;
+	_MGList(size_t) valueBreaks;
+} MGLoop;
+
+typedef struct MGCompiler {
+	MGCode *code;
+	size_t top;
+	MGLoop *loop;
+} MGCompiler;
+
+
+#define _MG_NO_REGISTER MG_CODE_MAX
+
+
+static void _mgCompileNode(MGCompiler *compiler, const MGNode *node, uint16_t result);
+
+
+static size_t _mgEmit(MGCompiler *compiler, const MGNode *node, MGOpcode opcode, uint16_t a, uint16_t b, uint16_t c)
+{
+	MGCode *code = compiler->code;
+
+	if (_mgListLength(code->instructions) >= MG_CODE_MAX)
+		mgFatalError("Error: Code too large to compile");
+
+	MGInstruction instruction;
+	instruction.opcode = (uint8_t) opcode;
+	instruction.a = a;
+	instruction.b = b;
+	instruction.c = c;
+
+	_mgListAdd(MGInstruction, code->instructions, instruction);
+	_mgListAdd(const MGNode*, code->nodes, node);
+
+	return _mgListLength(code->instructions) - 1;
+}
+
+
+static inline size_t _mgEmitLabel(MGCompiler *compiler)
+{
+	return _mgListLength(compiler->code->instructions);
+}
+
+
+static inline void _mgPatchJump(MGCompiler *compiler, size_t jump, size_t target)
+{
+	MGInstruction *instruction = &_mgListGet(compiler->code->instructions, jump);
+
+	if (instruction->opcode == MG_OPCODE_JUMP)
+		instruction->a = (uint16_t) target;
+	else
+		instruction->c = (uint16_t) target;
+}
+
+
+static uint16_t _mgAllocateRegisters(MGCompiler *compiler, size_t count)
+{
+	const size_t index = compiler->top;
+
+	compiler->top += count;
+
+	if (compiler->top >= MG_CODE_MAX)
+		mgFatalError("Error: Expression too complex to compile");
+
+	if (compiler->top > compiler->code->registerCount)
+		compiler->code->registerCount = compiler->top;
+
+	return (uint16_t) index;
+}
+
+#define _mgAllocateRegister(compiler) _mgAllocateRegisters(compiler, 1)
+#define _mgFreeRegisters(compiler, index) ((compiler)->top = (index))
+
+
+static uint16_t _mgAddConstant(MGCompiler *compiler, MGValue *value)
+{
+	MGCode *code = compiler->code;
+
+	if (_mgListLength(code->constants) >= MG_CODE_MAX)
+		mgFatalError("Error: Too many constants to compile");
+
+	_mgListAdd(MGValue*, code->constants, value);
+
+	return (uint16_t) (_mgListLength(code->constants) - 1);
+}
+
+
+static uint16_t _mgAddName(MGCompiler *compiler, const char *name)
+{
+	MG_ASSERT(name);
+
+	MGCode *code = compiler->code;
+
+	for (size_t i = 0; i < _mgListLength(code->names); ++i)
+		if (!strcmp(_mgListGet(code->names, i), name))
+			return (uint16_t) i;
+
+	if (_mgListLength(code->names) >= MG_CODE_MAX)
+		mgFatalError("Error: Too many names to compile");
+
+	_mgListAdd(const char*, code->names, name);
+
+	return (uint16_t) (_mgListLength(code->names) - 1);
+}
+
+
+static inline uint16_t _mgAddNodeName(MGCompiler *compiler, const MGNode *node)
+{
+	MG_ASSERT(node->type == MG_NODE_NAME);
+	MG_ASSERT(node->token);
+
+	return _mgAddName(compiler, node->token->value.s);
+}
+
+
+static MGValue* _mgCreateLiteral(const MGNode *node)
+{
+	MG_ASSERT(node->token);
+
+	if (node->type == MG_NODE_STRING)
+		return mgCreateValueInternedString(node->token->value.s);
+
+	MG_ASSERT(node->value);
+
+	return mgReferenceValue(node->value);
+}
+
+
+static void _mgCompileAssignment(MGCompiler *compiler, const MGNode *names, uint16_t value, MGbool local)
+{
+	MG_ASSERT((names->type == MG_NODE_NAME) || (names->type == MG_NODE_SUBSCRIPT) || (names->type == MG_NODE_ATTRIBUTE) || (names->type == MG_NODE_TUPLE));
+
+	const size_t top = compiler->top;
+
+	if (names->type == MG_NODE_NAME)
+		_mgEmit(compiler, names, local ? MG_OPCODE_STORE_LOCAL : MG_OPCODE_STORE_NAME, value, _mgAddNodeName(compiler, names), 0);
+	else if (names->type == MG_NODE_SUBSCRIPT)
+	{
+		MG_ASSERT(_mgListLength(names->children) == 2);
+
+		const uint16_t index = _mgAllocateRegister(compiler);
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(names->children, 1), index);
+		_mgCompileNode(compiler, _mgListGet(names->children, 0), collection);
+
+		_mgEmit(compiler, names, MG_OPCODE_SET_SUBSCRIPT, value, collection, index);
+	}
+	else if (names->type == MG_NODE_ATTRIBUTE)
+	{
+		MG_ASSERT(_mgListLength(names->children) == 2);
+
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(names->children, 0), collection);
+
+		_mgEmit(compiler, names, MG_OPCODE_SET_ATTRIBUTE, value, collection, _mgAddNodeName(compiler, _mgListGet(names->children, 1)));
+	}
+	else if (names->type == MG_NODE_TUPLE)
+	{
+		const size_t count = _mgListLength(names->children);
+
+		if (count > MG_CODE_MAX)
+			mgFatalError("Error: Too many names for parallel assignment");
+
+		_mgEmit(compiler, names, MG_OPCODE_UNPACK, value, (uint16_t) count, 0);
+
+		const uint16_t item = _mgAllocateRegister(compiler);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			_mgEmit(compiler, names, MG_OPCODE_GET_ITEM, item, value, (uint16_t) i);
+			_mgCompileAssignment(compiler, _mgListGet(names->children, i), item, local);
+		}
+	}
+
+	_mgFreeRegisters(compiler, top);
+}
+
+
+static void _mgCompileDelete(MGCompiler *compiler, const MGNode *node)
+{
+	const size_t top = compiler->top;
+
+	if (node->type == MG_NODE_NAME)
+		_mgEmit(compiler, node, MG_OPCODE_DELETE_NAME, 0, _mgAddNodeName(compiler, node), 0);
+	else if (node->type == MG_NODE_TUPLE)
+	{
+		for (size_t i = 0; i < _mgListLength(node->children); ++i)
+			_mgCompileDelete(compiler, _mgListGet(node->children, i));
+	}
+	else if (node->type == MG_NODE_SUBSCRIPT)
+	{
+		MG_ASSERT(_mgListLength(node->children) == 2);
+
+		const uint16_t index = _mgAllocateRegister(compiler);
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 1), index);
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), collection);
+
+		_mgEmit(compiler, node, MG_OPCODE_DELETE_SUBSCRIPT, 0, collection, index);
+	}
+	else if (node->type == MG_NODE_ATTRIBUTE)
+	{
+		MG_ASSERT(_mgListLength(node->children) == 2);
+
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), collection);
+
+		_mgEmit(compiler, node, MG_OPCODE_DELETE_ATTRIBUTE, 0, collection, _mgAddNodeName(compiler, _mgListGet(node->children, 1)));
+	}
+	else
+		mgFatalError("Error: Cannot delete \"%s\"", _MG_NODE_NAMES[node->type]);
+
+	_mgFreeRegisters(compiler, top);
+}
+
+
+static void _mgCompileStatements(MGCompiler *compiler, const MGNode *node, size_t begin)
+{
+	const uint16_t result = _mgAllocateRegister(compiler);
+
+	for (size_t i = begin; i < _mgListLength(node->children); ++i)
+		_mgCompileNode(compiler, _mgListGet(node->children, i), result);
+
+	_mgFreeRegisters(compiler, result);
+}
+
+
+static void _mgBeginLoop(MGCompiler *compiler, MGLoop *loop, uint16_t result)
+{
+	loop->outer = compiler->loop;
+	loop->start = _mgEmitLabel(compiler);
+	loop->result = result;
+
+	_mgListInitialize(loop->breaks);
+	_mgListInitialize(loop->valueBreaks);
+
+	compiler->loop = loop;
+}
+
+
+static void _mgEndLoop(MGCompiler *compiler, MGLoop *loop, size_t exit, size_t end)
+{
+	for (size_t i = 0; i < _mgListLength(loop->breaks); ++i)
+		_mgPatchJump(compiler, _mgListGet(loop->breaks, i), exit);
+
+	for (size_t i = 0; i < _mgListLength(loop->valueBreaks); ++i)
+		_mgPatchJump(compiler, _mgListGet(loop->valueBreaks, i), end);
+
+	_mgListDestroy(loop->breaks);
+	_mgListDestroy(loop->valueBreaks);
+
+	compiler->loop = loop->outer;
+}
+
+
+#define _mgIsIterableCall(node) (((node)->type == MG_NODE_CALL) && (_mgListGet((node)->children, 0)->type != MG_NODE_ATTRIBUTE))
+
+
+// Compiles the callee and arguments of a call which a loop iterates,
+// where nested calls return iterators if their functions have lazy
+// counterparts, e.g. map(f, filter(g, items)). The caller emits the
+// call and frees the returned registers.
+static uint16_t _mgCompileIterableCall(MGCompiler *compiler, const MGNode *node)
+{
+	MG_ASSERT(_mgIsIterableCall(node));
+
+	const size_t argc = _mgListLength(node->children) - 1;
+
+	if (argc > MG_CODE_MAX)
+		mgFatalError("Error: Too many arguments to compile");
+
+	const uint16_t callee = _mgAllocateRegisters(compiler, argc + 1);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), callee);
+
+	for (size_t i = 1; i <= argc; ++i)
+	{
+		const MGNode *argument = _mgListGet(node->children, i);
+
+		if (_mgIsIterableCall(argument))
+		{
+			const uint16_t argumentCallee = _mgCompileIterableCall(compiler, argument);
+
+			_mgEmit(compiler, argument, MG_OPCODE_CALL_ITERATE, (uint16_t) (callee + i), argumentCallee, (uint16_t) (_mgListLength(argument->children) - 1));
+
+			_mgFreeRegisters(compiler, argumentCallee);
+		}
+		else
+			_mgCompileNode(compiler, argument, (uint16_t) (callee + i));
+	}
+
+	return callee;
+}
+
+
+static void _mgCompileFor(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	MG_ASSERT(_mgListLength(node->children) >= 2);
+
+	const size_t top = compiler->top;
+
+	// The register after the iterable holds the iteration index, while
+	// ranges keep their start in place of the iterable, followed by the
+	// index, step and length, such that they are never created as lists
+	const uint16_t iterable = _mgAllocateRegisters(compiler, 4);
+	const uint16_t item = _mgAllocateRegister(compiler);
+
+	const MGNode *iterableNode = _mgListGet(node->children, 1);
+
+	if (iterableNode->type == MG_NODE_RANGE)
+	{
+		MG_ASSERT((_mgListLength(iterableNode->children) == 2) || (_mgListLength(iterableNode->children) == 3));
+
+		for (size_t i = 0; i < _mgListLength(iterableNode->children); ++i)
+			_mgCompileNode(compiler, _mgListGet(iterableNode->children, i), (uint16_t) (iterable + i));
+
+		_mgEmit(compiler, iterableNode, MG_OPCODE_FOR_PREPARE_RANGE, iterable, 0, (uint16_t) _mgListLength(iterableNode->children));
+	}
+	else if (_mgIsIterableCall(iterableNode))
+	{
+		// Calls are checked for range() and other lazy functions when the loop starts
+		const uint16_t callee = _mgCompileIterableCall(compiler, iterableNode);
+
+		_mgEmit(compiler, iterableNode, MG_OPCODE_FOR_PREPARE_CALL, iterable, callee, (uint16_t) (_mgListLength(iterableNode->children) - 1));
+
+		_mgFreeRegisters(compiler, callee);
+	}
+	else
+	{
+		_mgCompileNode(compiler, iterableNode, iterable);
+
+		_mgEmit(compiler, node, MG_OPCODE_FOR_PREPARE, iterable, 0, 0);
+	}
+	_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, item, 0, 0);
+
+	MGLoop loop;
+	_mgBeginLoop(compiler, &loop, result);
+
+	const size_t next = _mgEmit(compiler, node, MG_OPCODE_FOR_NEXT, item, iterable, 0);
+
+	_mgCompileAssignment(compiler, _mgListGet(node->children, 0), item, MG_TRUE);
+	_mgCompileStatements(compiler, node, 2);
+
+	_mgEmit(compiler, node, MG_OPCODE_JUMP, (uint16_t) loop.start, 0, 0);
+
+	const size_t exit = _mgEmitLabel(compiler);
+	_mgPatchJump(compiler, next, exit);
+
+	_mgEmit(compiler, node, MG_OPCODE_MOVE, result, item, 0);
+
+	_mgEndLoop(compiler, &loop, exit, _mgEmitLabel(compiler));
+
+	_mgFreeRegisters(compiler, top);
+}
+
+
+static void _mgCompileWhile(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	MG_ASSERT((_mgListLength(node->children) >= 1));
+
+	const size_t top = compiler->top;
+	const uint16_t condition = _mgAllocateRegister(compiler);
+
+	MGLoop loop;
+	_mgBeginLoop(compiler, &loop, result);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), condition);
+	const size_t test = _mgEmit(compiler, node, MG_OPCODE_JUMP_IF_FALSE, 0, condition, 0);
+
+	_mgCompileStatements(compiler, node, 1);
+
+	_mgEmit(compiler, node, MG_OPCODE_JUMP, (uint16_t) loop.start, 0, 0);
+
+	const size_t exit = _mgEmitLabel(compiler);
+	_mgPatchJump(compiler, test, exit);
+
+	_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+
+	_mgEndLoop(compiler, &loop, exit, _mgEmitLabel(compiler));
+
+	_mgFreeRegisters(compiler, top);
+}
+
+
+static void _mgCompileBreak(MGCompiler *compiler, const MGNode *node)
+{
+	MG_ASSERT(_mgListLength(node->children) < 2);
+
+	MGLoop *loop = compiler->loop;
+
+	if (loop == NULL)
+	{
+		// Outside of a loop, break ends the function like return
+		if (_mgListLength(node->children) > 0)
+		{
+			const uint16_t value = _mgAllocateRegister(compiler);
+			_mgCompileNode(compiler, _mgListGet(node->children, 0), value);
+			_mgEmit(compiler, node, MG_OPCODE_RETURN, value, 0, 0);
+			_mgFreeRegisters(compiler, value);
+		}
+		else
+			_mgEmit(compiler, node, MG_OPCODE_RETURN_NULL, 0, 0, 0);
+	}
+	else if (_mgListLength(node->children) > 0)
+	{
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), loop->result);
+		_mgListAdd(size_t, loop->valueBreaks, _mgEmit(compiler, node, MG_OPCODE_JUMP, 0, 0, 0));
+	}
+	else
+		_mgListAdd(size_t, loop->breaks, _mgEmit(compiler, node, MG_OPCODE_JUMP, 0, 0, 0));
+}
+
+
+static void _mgCompileIf(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	MG_ASSERT(_mgListLength(node->children) > 0);
+
+	const uint16_t condition = _mgAllocateRegister(compiler);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), condition);
+
+	if (_mgListLength(node->children) > 1)
+	{
+		const size_t test = _mgEmit(compiler, node, MG_OPCODE_JUMP_IF_FALSE, 0, condition, 0);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 1), result);
+
+		const size_t skip = _mgEmit(compiler, node, MG_OPCODE_JUMP, 0, 0, 0);
+
+		_mgPatchJump(compiler, test, _mgEmitLabel(compiler));
+
+		if (_mgListLength(node->children) > 2)
+			_mgCompileNode(compiler, _mgListGet(node->children, 2), result);
+		else
+			_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+
+		_mgPatchJump(compiler, skip, _mgEmitLabel(compiler));
+	}
+	else
+		_mgEmit(compiler, node, MG_OPCODE_BOOL, result, condition, 0);
+
+	_mgFreeRegisters(compiler, condition);
+}
+
+
+static void _mgCompileConditional(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	MG_ASSERT((_mgListLength(node->children) == 2) || (_mgListLength(node->children) == 3));
+
+	if (_mgListLength(node->children) == 3)
+	{
+		_mgCompileIf(compiler, node, result);
+		return;
+	}
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), result);
+
+	const size_t test = _mgEmit(compiler, node, MG_OPCODE_JUMP_IF_TRUE, 0, result, 0);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 1), result);
+
+	_mgPatchJump(compiler, test, _mgEmitLabel(compiler));
+}
+
+
+static void _mgCompileLogical(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	MG_ASSERT(_mgListLength(node->children) == 2);
+
+	if (node->type == MG_NODE_BIN_OP_COALESCE)
+	{
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), result);
+
+		const size_t test = _mgEmit(compiler, node, MG_OPCODE_JUMP_IF_NOT_NULL, 0, result, 0);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 1), result);
+
+		_mgPatchJump(compiler, test, _mgEmitLabel(compiler));
+
+		return;
+	}
+
+	const uint16_t operand = _mgAllocateRegister(compiler);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), operand);
+	_mgEmit(compiler, node, MG_OPCODE_BOOL, result, operand, 0);
+
+	const size_t test = _mgEmit(compiler, node, (node->type == MG_NODE_BIN_OP_AND) ? MG_OPCODE_JUMP_IF_FALSE : MG_OPCODE_JUMP_IF_TRUE, 0, result, 0);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 1), operand);
+	_mgEmit(compiler, node, MG_OPCODE_BOOL, result, operand, 0);
+
+	_mgPatchJump(compiler, test, _mgEmitLabel(compiler));
+
+	_mgFreeRegisters(compiler, operand);
+}
+
+
+static void _mgCompileBinaryOp(MGCompiler *compiler, const MGNode *node, MGOpcode opcode, uint16_t result)
+{
+	MG_ASSERT(_mgListLength(node->children) == 2);
+
+	const uint16_t lhs = _mgAllocateRegister(compiler);
+	const uint16_t rhs = _mgAllocateRegister(compiler);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), lhs);
+	_mgCompileNode(compiler, _mgListGet(node->children, 1), rhs);
+
+	_mgEmit(compiler, node, opcode, result, lhs, rhs);
+
+	_mgFreeRegisters(compiler, lhs);
+}
+
+
+static void _mgCompileUnaryOp(MGCompiler *compiler, const MGNode *node, MGOpcode opcode, uint16_t result)
+{
+	MG_ASSERT(_mgListLength(node->children) == 1);
+
+	const uint16_t operand = _mgAllocateRegister(compiler);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), operand);
+
+	_mgEmit(compiler, node, opcode, result, operand, 0);
+
+	_mgFreeRegisters(compiler, operand);
+}
+
+
+static void _mgCompileAugmentedAssignment(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	static const MGOpcode opcodes[] = {
+		MG_OPCODE_ADD,
+		MG_OPCODE_SUB,
+		MG_OPCODE_MUL,
+		MG_OPCODE_DIV,
+		MG_OPCODE_INT_DIV,
+		MG_OPCODE_MOD,
+	};
+
+	MG_ASSERT(_mgListLength(node->children) == 2);
+
+	const MGOpcode opcode = opcodes[node->type - MG_NODE_ASSIGN_ADD];
+
+	const uint16_t rhs = _mgAllocateRegister(compiler);
+	const uint16_t lhs = _mgAllocateRegister(compiler);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 1), rhs);
+
+	const MGNode *lhsNode = _mgListGet(node->children, 0);
+
+	if (lhsNode->type == MG_NODE_NAME)
+	{
+		const uint16_t name = _mgAddNodeName(compiler, lhsNode);
+
+		_mgEmit(compiler, lhsNode, MG_OPCODE_LOAD_NAME, lhs, name, 0);
+		_mgEmit(compiler, node, opcode, result, lhs, rhs);
+		_mgEmit(compiler, lhsNode, MG_OPCODE_STORE_NAME, result, name, 0);
+	}
+	else if (lhsNode->type == MG_NODE_SUBSCRIPT)
+	{
+		const uint16_t index = _mgAllocateRegister(compiler);
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(lhsNode->children, 1), index);
+		_mgCompileNode(compiler, _mgListGet(lhsNode->children, 0), collection);
+
+		_mgEmit(compiler, lhsNode, MG_OPCODE_GET_SUBSCRIPT, lhs, collection, index);
+		_mgEmit(compiler, node, opcode, result, lhs, rhs);
+		_mgEmit(compiler, lhsNode, MG_OPCODE_SET_SUBSCRIPT, result, collection, index);
+	}
+	else if (lhsNode->type == MG_NODE_ATTRIBUTE)
+	{
+		const uint16_t collection = _mgAllocateRegister(compiler);
+		const uint16_t name = _mgAddNodeName(compiler, _mgListGet(lhsNode->children, 1));
+
+		_mgCompileNode(compiler, _mgListGet(lhsNode->children, 0), collection);
+
+		_mgEmit(compiler, lhsNode, MG_OPCODE_GET_ATTRIBUTE, lhs, collection, name);
+		_mgEmit(compiler, node, opcode, result, lhs, rhs);
+		_mgEmit(compiler, lhsNode, MG_OPCODE_SET_ATTRIBUTE, result, collection, name);
+	}
+	else
+		mgFatalError("Error: Unsupported augmented assignment with \"%s\"", _MG_NODE_NAMES[lhsNode->type]);
+
+	_mgFreeRegisters(compiler, rhs);
+}
+
+
+static void _mgCompileCall(MGCompiler *compiler, const MGNode *node, uint16_t result, MGOpcode opcode)
+{
+	MG_ASSERT(_mgListLength(node->children) > 0);
+
+	const size_t argc = _mgListLength(node->children) - 1;
+
+	if (argc > MG_CODE_MAX)
+		mgFatalError("Error: Too many arguments to compile");
+
+	const MGNode *calleeNode = _mgListGet(node->children, 0);
+
+	// Calling an attribute looks it up on the receiver during the call,
+	// which lets native methods run without creating a bound function
+	if (calleeNode->type == MG_NODE_ATTRIBUTE)
+	{
+		MG_ASSERT(_mgListLength(calleeNode->children) == 2);
+
+		// The receiver is followed by the arguments, and replaced by the result
+		const uint16_t receiver = _mgAllocateRegisters(compiler, argc + 1);
+
+		_mgCompileNode(compiler, _mgListGet(calleeNode->children, 0), receiver);
+
+		for (size_t i = 1; i <= argc; ++i)
+			_mgCompileNode(compiler, _mgListGet(node->children, i), (uint16_t) (receiver + i));
+
+		_mgEmit(compiler, node, MG_OPCODE_CALL_METHOD, receiver, _mgAddNodeName(compiler, _mgListGet(calleeNode->children, 1)), (uint16_t) argc);
+		_mgEmit(compiler, node, MG_OPCODE_MOVE, result, receiver, 0);
+
+		_mgFreeRegisters(compiler, receiver);
+
+		return;
+	}
+
+	// The callee is followed by its arguments
+	const uint16_t callee = _mgAllocateRegisters(compiler, argc + 1);
+
+	for (size_t i = 0; i <= argc; ++i)
+		_mgCompileNode(compiler, _mgListGet(node->children, i), (uint16_t) (callee + i));
+
+	_mgEmit(compiler, node, opcode, result, callee, (uint16_t) argc);
+
+	_mgFreeRegisters(compiler, callee);
+}
+
+
+static void _mgCompileFunction(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	MG_ASSERT((_mgListLength(node->children) == 2) || (_mgListLength(node->children) == 3));
+
+	const MGNode *nameNode = _mgListGet(node->children, 0);
+	MG_ASSERT((nameNode->type == MG_NODE_INVALID) || (nameNode->type == MG_NODE_NAME) || (nameNode->type == MG_NODE_ATTRIBUTE));
+
+	MGbool isNested = MG_FALSE;
+
+	for (const MGNode *parent = node->parent; parent; parent = parent->parent)
+	{
+		if ((parent->type == MG_NODE_FUNCTION) || (parent->type == MG_NODE_PROCEDURE))
+		{
+			isNested = MG_TRUE;
+			break;
+		}
+	}
+
+	_mgEmit(compiler, node, MG_OPCODE_MAKE_FUNCTION, result, isNested, 0);
+
+	if (nameNode->type == MG_NODE_NAME)
+		_mgEmit(compiler, nameNode, MG_OPCODE_STORE_NAME, result, _mgAddNodeName(compiler, nameNode), 0);
+	else if (nameNode->type == MG_NODE_ATTRIBUTE)
+	{
+		MG_ASSERT(_mgListLength(nameNode->children) == 2);
+
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(nameNode->children, 0), collection);
+
+		_mgEmit(compiler, nameNode, MG_OPCODE_SET_ATTRIBUTE, result, collection, _mgAddNodeName(compiler, _mgListGet(nameNode->children, 1)));
+
+		_mgFreeRegisters(compiler, collection);
+	}
+}
+
+
+static void _mgCompileCollection(MGCompiler *compiler, const MGNode *node, MGOpcode opcode, uint16_t result)
+{
+	const size_t count = _mgListLength(node->children);
+
+	if (count > MG_CODE_MAX)
+		mgFatalError("Error: Too many items to compile");
+
+	const uint16_t items = _mgAllocateRegisters(compiler, count);
+
+	if (opcode == MG_OPCODE_BUILD_MAP)
+	{
+		MG_ASSERT((count % 2) == 0);
+
+		// Values are evaluated before their keys
+		for (size_t i = 0; i < count; i += 2)
+		{
+			_mgCompileNode(compiler, _mgListGet(node->children, i + 1), (uint16_t) (items + i + 1));
+			_mgCompileNode(compiler, _mgListGet(node->children, i), (uint16_t) (items + i));
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+			_mgCompileNode(compiler, _mgListGet(node->children, i), (uint16_t) (items + i));
+	}
+
+	_mgEmit(compiler, node, opcode, result, items, (uint16_t) count);
+
+	_mgFreeRegisters(compiler, items);
+}
+
+
+static void _mgCompileImport(MGCompiler *compiler, const MGNode *node)
+{
+	MG_ASSERT((node->type == MG_NODE_IMPORT) || (node->type == MG_NODE_IMPORT_FROM));
+	MG_ASSERT(_mgListLength(node->children) > 0);
+
+	const uint16_t module = _mgAllocateRegister(compiler);
+
+	if (node->type == MG_NODE_IMPORT)
+	{
+		for (size_t i = 0; i < _mgListLength(node->children); ++i)
+		{
+			const MGNode *nameNode = _mgListGet(node->children, i);
+			const MGNode *aliasNode = nameNode;
+
+			MG_ASSERT((nameNode->type == MG_NODE_NAME) || (nameNode->type == MG_NODE_AS));
+
+			if (nameNode->type == MG_NODE_AS)
+			{
+				MG_ASSERT(_mgListLength(nameNode->children) == 2);
+
+				aliasNode = _mgListGet(nameNode->children, 1);
+				nameNode = _mgListGet(nameNode->children, 0);
+			}
+
+			_mgEmit(compiler, nameNode, MG_OPCODE_IMPORT, module, _mgAddNodeName(compiler, nameNode), 0);
+			_mgEmit(compiler, aliasNode, MG_OPCODE_STORE_NAME, module, _mgAddNodeName(compiler, aliasNode), 0);
+		}
+	}
+	else
+	{
+		const MGNode *moduleNode = _mgListGet(node->children, 0);
+
+		_mgEmit(compiler, moduleNode, MG_OPCODE_IMPORT, module, _mgAddNodeName(compiler, moduleNode), 0);
+
+		if (_mgListLength(node->children) > 1)
+		{
+			const uint16_t value = _mgAllocateRegister(compiler);
+
+			for (size_t i = 1; i < _mgListLength(node->children); ++i)
+			{
+				const MGNode *nameNode = _mgListGet(node->children, i);
+				const MGNode *aliasNode = nameNode;
+
+				MG_ASSERT((nameNode->type == MG_NODE_NAME) || (nameNode->type == MG_NODE_AS));
+
+				if (nameNode->type == MG_NODE_AS)
+				{
+					MG_ASSERT(_mgListLength(nameNode->children) == 2);
+
+					aliasNode = _mgListGet(nameNode->children, 1);
+					nameNode = _mgListGet(nameNode->children, 0);
+				}
+
+				_mgEmit(compiler, nameNode, MG_OPCODE_IMPORT_NAME, value, module, _mgAddNodeName(compiler, nameNode));
+				_mgEmit(compiler, aliasNode, MG_OPCODE_STORE_NAME, value, _mgAddNodeName(compiler, aliasNode), 0);
+			}
+		}
+		else
+			_mgEmit(compiler, node, MG_OPCODE_IMPORT_ALL, module, 0, 0);
+	}
+
+	_mgFreeRegisters(compiler, module);
+}
+
+
+static void _mgCompileAssert(MGCompiler *compiler, const MGNode *node)
+{
+#if MG_DEBUG
+	MG_ASSERT((_mgListLength(node->children) == 1) || (_mgListLength(node->children) == 2));
+
+	const uint16_t expression = _mgAllocateRegister(compiler);
+
+	_mgCompileNode(compiler, _mgListGet(node->children, 0), expression);
+
+	const size_t test = _mgEmit(compiler, node, MG_OPCODE_JUMP_IF_TRUE, 0, expression, 0);
+
+	if (_mgListLength(node->children) == 2)
+	{
+		_mgCompileNode(compiler, _mgListGet(node->children, 1), expression);
+		_mgEmit(compiler, node, MG_OPCODE_ASSERT, expression, 1, 0);
+	}
+	else
+		_mgEmit(compiler, node, MG_OPCODE_ASSERT, expression, 0, 0);
+
+	_mgPatchJump(compiler, test, _mgEmitLabel(compiler));
+
+	_mgFreeRegisters(compiler, expression);
+#endif
+}
+
+
+static void _mgCompileNode(MGCompiler *compiler, const MGNode *node, uint16_t result)
+{
+	const size_t top = compiler->top;
+
+	switch (node->type)
+	{
+	case MG_NODE_MODULE:
+	case MG_NODE_BLOCK:
+		if (_mgListLength(node->children) == 0)
+			_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+		for (size_t i = 0; i < _mgListLength(node->children); ++i)
+			_mgCompileNode(compiler, _mgListGet(node->children, i), result);
+		break;
+	case MG_NODE_NAME:
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_NAME, result, _mgAddNodeName(compiler, node), 0);
+		break;
+	case MG_NODE_INTEGER:
+	case MG_NODE_FLOAT:
+	case MG_NODE_STRING:
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_CONST, result, _mgAddConstant(compiler, _mgCreateLiteral(node)), 0);
+		break;
+	case MG_NODE_CONSTANT:
+		MG_ASSERT(node->value);
+		// Tuples and lists can be mutated, so each evaluation gets a copy
+		_mgEmit(compiler, node, ((mgValueType(node->value) == MG_TYPE_TUPLE) || (mgValueType(node->value) == MG_TYPE_LIST)) ? MG_OPCODE_COPY_CONST : MG_OPCODE_LOAD_CONST,
+		        result, _mgAddConstant(compiler, mgReferenceValue(node->value)), 0);
+		break;
+	case MG_NODE_TUPLE:
+		_mgCompileCollection(compiler, node, MG_OPCODE_BUILD_TUPLE, result);
+		break;
+	case MG_NODE_LIST:
+		_mgCompileCollection(compiler, node, MG_OPCODE_BUILD_LIST, result);
+		break;
+	case MG_NODE_MAP:
+		_mgCompileCollection(compiler, node, MG_OPCODE_BUILD_MAP, result);
+		break;
+	case MG_NODE_RANGE:
+		MG_ASSERT((_mgListLength(node->children) == 2) || (_mgListLength(node->children) == 3));
+		_mgCompileCollection(compiler, node, MG_OPCODE_BUILD_RANGE, result);
+		break;
+	case MG_NODE_BIN_OP_ADD:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_ADD, result);
+		break;
+	case MG_NODE_BIN_OP_SUB:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_SUB, result);
+		break;
+	case MG_NODE_BIN_OP_MUL:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_MUL, result);
+		break;
+	case MG_NODE_BIN_OP_DIV:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_DIV, result);
+		break;
+	case MG_NODE_BIN_OP_INT_DIV:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_INT_DIV, result);
+		break;
+	case MG_NODE_BIN_OP_MOD:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_MOD, result);
+		break;
+	case MG_NODE_BIN_OP_EQ:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_EQ, result);
+		break;
+	case MG_NODE_BIN_OP_NOT_EQ:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_NOT_EQ, result);
+		break;
+	case MG_NODE_BIN_OP_LESS:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_LESS, result);
+		break;
+	case MG_NODE_BIN_OP_LESS_EQ:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_LESS_EQ, result);
+		break;
+	case MG_NODE_BIN_OP_GREATER:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_GREATER, result);
+		break;
+	case MG_NODE_BIN_OP_GREATER_EQ:
+		_mgCompileBinaryOp(compiler, node, MG_OPCODE_GREATER_EQ, result);
+		break;
+	case MG_NODE_BIN_OP_AND:
+	case MG_NODE_BIN_OP_OR:
+	case MG_NODE_BIN_OP_COALESCE:
+		_mgCompileLogical(compiler, node, result);
+		break;
+	case MG_NODE_BIN_OP_CONDITIONAL:
+	case MG_NODE_TERNARY_OP_CONDITIONAL:
+		_mgCompileConditional(compiler, node, result);
+		break;
+	case MG_NODE_UNARY_OP_POS:
+		_mgCompileUnaryOp(compiler, node, MG_OPCODE_POS, result);
+		break;
+	case MG_NODE_UNARY_OP_NEG:
+		_mgCompileUnaryOp(compiler, node, MG_OPCODE_NEG, result);
+		break;
+	case MG_NODE_UNARY_OP_NOT:
+		_mgCompileUnaryOp(compiler, node, MG_OPCODE_NOT, result);
+		break;
+	case MG_NODE_ASSIGN:
+		MG_ASSERT(_mgListLength(node->children) == 2);
+		_mgCompileNode(compiler, _mgListGet(node->children, 1), result);
+		_mgCompileAssignment(compiler, _mgListGet(node->children, 0), result, MG_FALSE);
+		break;
+	case MG_NODE_ASSIGN_ADD:
+	case MG_NODE_ASSIGN_SUB:
+	case MG_NODE_ASSIGN_MUL:
+	case MG_NODE_ASSIGN_DIV:
+	case MG_NODE_ASSIGN_INT_DIV:
+	case MG_NODE_ASSIGN_MOD:
+		_mgCompileAugmentedAssignment(compiler, node, result);
+		break;
+	case MG_NODE_CALL:
+		_mgCompileCall(compiler, node, result, MG_OPCODE_CALL);
+		break;
+	case MG_NODE_FOR:
+		_mgCompileFor(compiler, node, result);
+		break;
+	case MG_NODE_WHILE:
+		_mgCompileWhile(compiler, node, result);
+		break;
+	case MG_NODE_BREAK:
+		_mgCompileBreak(compiler, node);
+		break;
+	case MG_NODE_CONTINUE:
+		MG_ASSERT(_mgListLength(node->children) == 0);
+		if (compiler->loop)
+			_mgEmit(compiler, node, MG_OPCODE_JUMP, (uint16_t) compiler->loop->start, 0, 0);
+		else
+			_mgEmit(compiler, node, MG_OPCODE_RETURN_NULL, 0, 0, 0);
+		break;
+	case MG_NODE_IF:
+		_mgCompileIf(compiler, node, result);
+		break;
+	case MG_NODE_FUNCTION:
+	case MG_NODE_PROCEDURE:
+		_mgCompileFunction(compiler, node, result);
+		break;
+	case MG_NODE_EMIT:
+		MG_ASSERT(_mgListLength(node->children) == 1);
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), result);
+		_mgEmit(compiler, node, MG_OPCODE_EMIT, result, 0, 0);
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+		break;
+	case MG_NODE_RETURN:
+		if (_mgListLength(node->children) > 0)
+		{
+			const MGNode *valueNode = _mgListGet(node->children, 0);
+
+			// Calls in tail position of functions reuse the frame of the returning call
+			if ((valueNode->type == MG_NODE_CALL) && ((compiler->code->node->type == MG_NODE_FUNCTION) || (compiler->code->node->type == MG_NODE_PROCEDURE)))
+				_mgCompileCall(compiler, valueNode, result, MG_OPCODE_TAIL_CALL);
+			else
+				_mgCompileNode(compiler, valueNode, result);
+
+			_mgEmit(compiler, node, MG_OPCODE_RETURN, result, 0, 0);
+		}
+		else
+			_mgEmit(compiler, node, MG_OPCODE_RETURN_NULL, 0, 0, 0);
+		break;
+	case MG_NODE_DELETE:
+		MG_ASSERT(_mgListLength(node->children) == 1);
+		_mgCompileDelete(compiler, _mgListGet(node->children, 0));
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+		break;
+	case MG_NODE_SUBSCRIPT:
+	{
+		MG_ASSERT(_mgListLength(node->children) == 2);
+
+		const uint16_t index = _mgAllocateRegister(compiler);
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 1), index);
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), collection);
+
+		_mgEmit(compiler, node, MG_OPCODE_GET_SUBSCRIPT, result, collection, index);
+		break;
+	}
+	case MG_NODE_ATTRIBUTE:
+	{
+		MG_ASSERT(_mgListLength(node->children) == 2);
+
+		const uint16_t collection = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), collection);
+
+		_mgEmit(compiler, node, MG_OPCODE_GET_ATTRIBUTE, result, collection, _mgAddNodeName(compiler, _mgListGet(node->children, 1)));
+		break;
+	}
+	case MG_NODE_AS:
+	{
+		MG_ASSERT(_mgListLength(node->children) == 2);
+
+		const MGNode *typeNameNode = _mgListGet(node->children, 1);
+		MG_ASSERT(typeNameNode->type == MG_NODE_NAME);
+		MG_ASSERT(typeNameNode->token);
+
+		const uint16_t value = _mgAllocateRegister(compiler);
+
+		_mgCompileNode(compiler, _mgListGet(node->children, 0), value);
+
+		_mgEmit(compiler, node, MG_OPCODE_CONVERT, result, value, (uint16_t) mgLookupType(typeNameNode->token->value.s));
+		break;
+	}
+	case MG_NODE_IMPORT:
+	case MG_NODE_IMPORT_FROM:
+		_mgCompileImport(compiler, node);
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+		break;
+	case MG_NODE_ASSERT:
+		_mgCompileAssert(compiler, node);
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+		break;
+	case MG_NODE_NULL:
+	case MG_NODE_NOP:
+		_mgEmit(compiler, node, MG_OPCODE_LOAD_NULL, result, 0, 0);
+		break;
+	default:
+		mgFatalError("Error: Unknown node \"%s\"", _MG_NODE_NAMES[node->type]);
+	}
+
+	_mgFreeRegisters(compiler, top);
+}
+
+
+static void _mgCompileParameters(MGCompiler *compiler, const MGNode *node)
+{
+	const MGNode *parametersNode = _mgListGet(node->children, 1);
+	MG_ASSERT(parametersNode->type == MG_NODE_TUPLE);
+
+	const uint16_t value = _mgAllocateRegister(compiler);
+
+	for (size_t i = 0; i < _mgListLength(parametersNode->children); ++i)
+	{
+		const MGNode *parameterNode = _mgListGet(parametersNode->children, i);
+		MG_ASSERT((parameterNode->type == MG_NODE_NAME) || (parameterNode->type == MG_NODE_ASSIGN));
+
+		const MGNode *nameNode = parameterNode;
+
+		if (parameterNode->type == MG_NODE_ASSIGN)
+		{
+			MG_ASSERT(_mgListLength(parameterNode->children) == 2);
+			nameNode = _mgListGet(parameterNode->children, 0);
+		}
+
+		const uint16_t name = _mgAddNodeName(compiler, nameNode);
+
+		// Loads the argument and skips the default when it was passed
+		const size_t argument = _mgEmit(compiler, parameterNode, MG_OPCODE_ARGUMENT, value, (uint16_t) i, 0);
+
+		if (parameterNode->type == MG_NODE_ASSIGN)
+			_mgCompileNode(compiler, _mgListGet(parameterNode->children, 1), value);
+		else
+			_mgEmit(compiler, parameterNode, MG_OPCODE_MISSING_ARGUMENT, 0, name, 0);
+
+		_mgPatchJump(compiler, argument, _mgEmitLabel(compiler));
+
+		_mgEmit(compiler, parameterNode, MG_OPCODE_STORE_LOCAL, value, name, 0);
+	}
+
+	_mgFreeRegisters(compiler, value);
+}
+
+
+static MGbool _mgIsResolvable(const MGCode *code)
+{
+	const MGNode *node = code->node;
+
+	if ((node->type != MG_NODE_FUNCTION) && (node->type != MG_NODE_PROCEDURE))
+		return MG_FALSE;
+
+	// Nested functions run with the locals map of their enclosing call
+	for (const MGNode *parent = node->parent; parent; parent = parent->parent)
+		if ((parent->type == MG_NODE_FUNCTION) || (parent->type == MG_NODE_PROCEDURE))
+			return MG_FALSE;
+
+	// Closures capture the locals map, and importing
+	// everything sets names which are not known here
+	for (size_t i = 0; i < _mgListLength(code->instructions); ++i)
+	{
+		const MGOpcode opcode = (MGOpcode) _mgListGet(code->instructions, i).opcode;
+
+		if ((opcode == MG_OPCODE_MAKE_FUNCTION) || (opcode == MG_OPCODE_IMPORT_ALL))
+			return MG_FALSE;
+	}
+
+	return MG_TRUE;
+}
+
+
+static void _mgResolveLocals(MGCode *code)
+{
+	const size_t nameCount = _mgListLength(code->names);
+
+	uint16_t *slots = (uint16_t*) malloc(nameCount * sizeof(uint16_t));
+	MG_ASSERT(!nameCount || slots);
+
+	for (size_t i = 0; i < nameCount; ++i)
+		slots[i] = MG_CODE_MAX;
+
+	// Every name assigned or deleted within the function is local
+	for (size_t i = 0; i < _mgListLength(code->instructions); ++i)
+	{
+		const MGInstruction *instruction = &_mgListGet(code->instructions, i);
+
+		switch (instruction->opcode)
+		{
+		case MG_OPCODE_STORE_NAME:
+		case MG_OPCODE_STORE_LOCAL:
+		case MG_OPCODE_DELETE_NAME:
+			if (slots[instruction->b] == MG_CODE_MAX)
+			{
+				slots[instruction->b] = (uint16_t) _mgListLength(code->locals);
+				_mgListAdd(const char*, code->locals, _mgListGet(code->names, instruction->b));
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < _mgListLength(code->instructions); ++i)
+	{
+		MGInstruction *instruction = &_mgListGet(code->instructions, i);
+
+		switch (instruction->opcode)
+		{
+		case MG_OPCODE_LOAD_NAME:
+			if (slots[instruction->b] != MG_CODE_MAX)
+			{
+				instruction->opcode = MG_OPCODE_LOAD_SLOT;
+				instruction->b = slots[instruction->b];
+			}
+			break;
+		case MG_OPCODE_STORE_NAME:
+			instruction->opcode = MG_OPCODE_STORE_SLOT;
+			instruction->b = slots[instruction->b];
+			break;
+		case MG_OPCODE_STORE_LOCAL:
+			instruction->opcode = MG_OPCODE_STORE_SLOT_LOCAL;
+			instruction->b = slots[instruction->b];
+			break;
+		case MG_OPCODE_DELETE_NAME:
+			instruction->opcode = MG_OPCODE_DELETE_SLOT;
+			instruction->b = slots[instruction->b];
+			break;
+		default:
+			break;
+		}
+	}
+
+	free(slots);
+}
+
+
+static MGCode* _mgCompileCode(MGNode *node)
+{
+	MGCode *code = (MGCode*) calloc(1, sizeof(MGCode));
+	MG_ASSERT(code);
+
+	code->node = node;
+
+	_mgListCreate(MGInstruction, code->instructions, 1 << 4);
+	_mgListCreate(const MGNode*, code->nodes, 1 << 4);
+	_mgListInitialize(code->constants);
+	_mgListInitialize(code->names);
+	_mgListInitialize(code->locals);
+
+	MGCompiler compiler;
+	compiler.code = code;
+	compiler.top = 0;
+	compiler.loop = NULL;
+
+	const uint16_t result = _mgAllocateRegister(&compiler);
+
+	if ((node->type == MG_NODE_FUNCTION) || (node->type == MG_NODE_PROCEDURE))
+	{
+		MG_ASSERT((_mgListLength(node->children) == 2) || (_mgListLength(node->children) == 3));
+
+		_mgCompileParameters(&compiler, node);
+
+		if (_mgListLength(node->children) == 3)
+			_mgCompileNode(&compiler, _mgListGet(node->children, 2), result);
+
+		_mgEmit(&compiler, node, MG_OPCODE_RETURN_NULL, 0, 0, 0);
+	}
+	else
+	{
+		_mgCompileNode(&compiler, node, result);
+		_mgEmit(&compiler, node, MG_OPCODE_RETURN, result, 0, 0);
+	}
+
+	MG_ASSERT(compiler.loop == NULL);
+
+	for (size_t i = 0; i < _mgListLength(code->instructions); ++i)
+	{
+		const MGOpcode opcode = (MGOpcode) _mgListGet(code->instructions, i).opcode;
+
+		if ((opcode == MG_OPCODE_GET_ATTRIBUTE) || (opcode == MG_OPCODE_CALL_METHOD))
+		{
+			code->caches = (MGInlineCache*) calloc(_mgListLength(code->instructions), sizeof(MGInlineCache));
+			MG_ASSERT(code->caches);
+			break;
+		}
+	}
+
+	return code;
+}
+
+
+static MGCode* _mgCompile(MGNode *node)
+{
+	MGCode *code = _mgCompileCode(node);
+
+	if (_mgIsResolvable(code))
+	{
+		code->resolved = _mgCompileCode(node);
+		_mgResolveLocals(code->resolved);
+	}
+
+	return code;
+}
+
+
+MGCode* mgCompile(MGNode *node)
+{
+	MG_ASSERT(node);
+
+	if (!mgIsParallel())
+	{
+		if (!node->code)
+			node->code = _mgCompile(node);
+
+		return node->code;
+	}
+
+	// Threads of a parallel map may call the same function
+	// for the first time, so only one of them compiles it
+	MGCode *code = (MGCode*) mgAtomicLoadPointer(&node->code);
+
+	if (code)
+		return code;
+
+	mgLockMutex(&_mgParallelMap->compileMutex);
+
+	if (!(code = node->code))
+	{
+		code = _mgCompile(node);
+		mgAtomicStorePointer(&node->code, code);
+	}
+
+	mgUnlockMutex(&_mgParallelMap->compileMutex);
+
+	return code;
+}
+
+
+void mgDestroyCode(MGCode *code)
+{
+	MG_ASSERT(code);
+
+	for (size_t i = 0; i < _mgListLength(code->constants); ++i)
+		mgDestroyValue(_mgListGet(code->constants, i));
+
+	_mgListDestroy(code->instructions);
+	_mgListDestroy(code->nodes);
+	_mgListDestroy(code->constants);
+	_mgListDestroy(code->names);
+	_mgListDestroy(code->locals);
+
+	if (code->resolved)
+		mgDestroyCode(code->resolved);
+
+	free(code->caches);
+	free(code);
+}
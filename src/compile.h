@@ -0,0 +1,125 @@
+#ifndef MODELGEN_COMPILE_H
+#define MODELGEN_COMPILE_H
+
+#include <stdint.h>
+
+#include "value.h"
+
+#define _MG_OPCODES \
+	_MG_OPC(NOP, "Nop") \
+	_MG_OPC(LOAD_NULL, "LoadNull") \
+	_MG_OPC(LOAD_CONST, "LoadConst") \
+	_MG_OPC(COPY_CONST, "CopyConst") \
+	_MG_OPC(LOAD_NAME, "LoadName") \
+	_MG_OPC(STORE_NAME, "StoreName") \
+	_MG_OPC(STORE_LOCAL, "StoreLocal") \
+	_MG_OPC(DELETE_NAME, "DeleteName") \
+	_MG_OPC(LOAD_SLOT, "LoadSlot") \
+	_MG_OPC(STORE_SLOT, "StoreSlot") \
+	_MG_OPC(STORE_SLOT_LOCAL, "StoreSlotLocal") \
+	_MG_OPC(DELETE_SLOT, "DeleteSlot") \
+	_MG_OPC(MOVE, "Move") \
+	_MG_OPC(BUILD_TUPLE, "BuildTuple") \
+	_MG_OPC(BUILD_LIST, "BuildList") \
+	_MG_OPC(BUILD_MAP, "BuildMap") \
+	_MG_OPC(BUILD_RANGE, "BuildRange") \
+	_MG_OPC(POS, "Pos") \
+	_MG_OPC(NEG, "Neg") \
+	_MG_OPC(NOT, "Not") \
+	_MG_OPC(BOOL, "Bool") \
+	_MG_OPC(ADD, "Add") \
+	_MG_OPC(SUB, "Sub") \
+	_MG_OPC(MUL, "Mul") \
+	_MG_OPC(DIV, "Div") \
+	_MG_OPC(INT_DIV, "IntDiv") \
+	_MG_OPC(MOD, "Mod") \
+	_MG_OPC(EQ, "Eq") \
+	_MG_OPC(NOT_EQ, "NotEq") \
+	_MG_OPC(LESS, "Less") \
+	_MG_OPC(LESS_EQ, "LessEq") \
+	_MG_OPC(GREATER, "Greater") \
+	_MG_OPC(GREATER_EQ, "GreaterEq") \
+	_MG_OPC(CONVERT, "Convert") \
+	_MG_OPC(GET_SUBSCRIPT, "GetSubscript") \
+	_MG_OPC(SET_SUBSCRIPT, "SetSubscript") \
+	_MG_OPC(DELETE_SUBSCRIPT, "DeleteSubscript") \
+	_MG_OPC(GET_ATTRIBUTE, "GetAttribute") \
+	_MG_OPC(SET_ATTRIBUTE, "SetAttribute") \
+	_MG_OPC(DELETE_ATTRIBUTE, "DeleteAttribute") \
+	_MG_OPC(UNPACK, "Unpack") \
+	_MG_OPC(GET_ITEM, "GetItem") \
+	_MG_OPC(JUMP, "Jump") \
+	_MG_OPC(JUMP_IF_FALSE, "JumpIfFalse") \
+	_MG_OPC(JUMP_IF_TRUE, "JumpIfTrue") \
+	_MG_OPC(JUMP_IF_NOT_NULL, "JumpIfNotNull") \
+	_MG_OPC(FOR_PREPARE, "ForPrepare") \
+	_MG_OPC(FOR_PREPARE_RANGE, "ForPrepareRange") \
+	_MG_OPC(FOR_PREPARE_CALL, "ForPrepareCall") \
+	_MG_OPC(FOR_NEXT, "ForNext") \
+	_MG_OPC(ARGUMENT, "Argument") \
+	_MG_OPC(MISSING_ARGUMENT, "MissingArgument") \
+	_MG_OPC(CALL, "Call") \
+	_MG_OPC(TAIL_CALL, "TailCall") \
+	_MG_OPC(CALL_METHOD, "CallMethod") \
+	_MG_OPC(CALL_ITERATE, "CallIterate") \
+	_MG_OPC(MAKE_FUNCTION, "MakeFunction") \
+	_MG_OPC(EMIT, "Emit") \
+	_MG_OPC(IMPORT, "Import") \
+	_MG_OPC(IMPORT_NAME, "ImportName") \
+	_MG_OPC(IMPORT_ALL, "ImportAll") \
+	_MG_OPC(ASSERT, "Assert") \
+	_MG_OPC(RETURN, "Return") \
+	_MG_OPC(RETURN_NULL, "ReturnNull")
+
+#define _MG_LONGEST_OPCODE_NAME_LENGTH 15
+
+extern const char* const _MG_OPCODE_NAMES[];
+
+typedef enum MGOpcode {
+#define _MG_OPC(opcode, name) MG_OPCODE_##opcode,
+	_MG_OPCODES
+#undef _MG_OPC
+} MGOpcode;
+
+#define MG_CODE_MAX 0xFFFF
+
+// Operands are register indices, except where an opcode
+// uses them as a constant, name, jump target or count
+typedef struct MGInstruction {
+	uint8_t opcode;
+	uint16_t a;
+	uint16_t b;
+	uint16_t c;
+} MGInstruction;
+
+// Caches the last lookup of an attribute instruction, keyed on the
+// module it was found in, or the type of the receiver of a method
+typedef struct MGInlineCache {
+	const void *key;
+	size_t index;
+	MGBoundCFunction method;
+} MGInlineCache;
+
+typedef struct MGCode MGCode;
+
+typedef struct MGCode {
+	const MGNode *node;
+	_MGList(MGInstruction) instructions;
+	_MGList(const MGNode*) nodes;
+	_MGList(MGValue*) constants;
+	_MGList(const char*) names;
+	// Names of the local variable slots
+	_MGList(const char*) locals;
+	size_t registerCount;
+	// One per instruction, if any instruction looks up attributes
+	MGInlineCache *caches;
+	// Same code with locals resolved to slots, used
+	// when calling a function which has no locals map
+	MGCode *resolved;
+} MGCode;
+
+// The code is kept by node, and destroyed along with it
+MGCode* mgCompile(MGNode *node);
+void mgDestroyCode(MGCode *code);
+
+#endif
\ No newline at end of file
@@ -15,17 +15,25 @@ void mgTraceback(const MGInstance *instance)
 
 	printf("Traceback:\n");
 
-	const MGStackFrame *frame = instance->callStackTop;
+	// Frames only link to their caller, so collect
+	// them to print the outermost frame first
+	size_t frameCount = 0;
+	for (const MGStackFrame *frame = instance->callStackTop; frame; frame = frame->last)
+		++frameCount;
 
-	if (frame)
+	if (frameCount)
 	{
-		while (frame->last)
-			frame = frame->last;
+		const MGStackFrame **frames = (const MGStackFrame**) malloc(frameCount * sizeof(MGStackFrame*));
+		MG_ASSERT(frames);
 
-		size_t depth = 0;
+		size_t depth = frameCount;
+		for (const MGStackFrame *frame = instance->callStackTop; frame; frame = frame->last)
+			frames[--depth] = frame;
 
-		while (frame)
+		for (; depth < frameCount; ++depth)
 		{
+			const MGStackFrame *frame = frames[depth];
+
 			if (frame->callerName || (frame->caller && frame->caller->tokenBegin))
 			{
 				printf("%zu:", depth);
@@ -40,7 +48,7 @@ void mgTraceback(const MGInstance *instance)
 					if (token)
 					{
 						MG_ASSERT(frame->module);
-						MG_ASSERT(frame->module->type == MG_TYPE_MODULE);
+						MG_ASSERT(mgValueType(frame->module) == MG_TYPE_MODULE);
 						MG_ASSERT(frame->module->data.module.filename);
 
 						if (frame->callerName)
@@ -55,10 +63,9 @@ void mgTraceback(const MGInstance *instance)
 
 				putchar('\n');
 			}
-
-			frame = frame->next;
-			++depth;
 		}
+
+		free(frames);
 	}
 
 	fflush(stdout);
@@ -2,10 +2,12 @@
 #define MODELGEN_ERROR_H
 
 #include "instance.h"
+#include "thread.h"
 #include "error.h"
 #include "debug.h"
 
-extern MGInstance *_mgLastInstance;
+// Instance which errors are reported for, if they are raised without one
+extern MG_THREAD_LOCAL MGInstance *_mgLastInstance;
 
 void mgTraceback(const MGInstance *instance);
 
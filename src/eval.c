@@ -2,42 +2,44 @@
 #include "eval.h"
 #include "value.h"
 #include "types/module.h"
+#include "interpret.h"
 #include "debug.h"
 
 
-extern MGValue* _mgVisitNode(MGValue *module, MGNode *node);
-
-
 MGValue* mgEvalEx(MGInstance *instance, const char *string, const MGValue *locals)
 {
 	MG_ASSERT(instance);
 	MG_ASSERT(string);
-	MG_ASSERT(!locals || (locals->type == MG_TYPE_MAP));
+	MG_ASSERT(!locals || (mgValueType(locals) == MG_TYPE_MAP));
 
 	MGValue *module = mgCreateValueModule();
 	module->data.module.instance = instance;
 
-	MGNode *root = mgParseString(&module->data.module.parser, string);
-	MG_ASSERT(root);
-	MG_ASSERT(_mgListLength(root->children) == 1);
+	if (!mgParseString(&module->data.module.parser, string))
+	{
+		mgDestroyValue(module);
+		return MG_NULL_VALUE;
+	}
+
+	MG_ASSERT(_mgListLength(module->data.module.parser.root->children) == 1);
 
 	MGStackFrame frame;
 	mgCreateStackFrame(&frame, mgReferenceValue(module));
 
 	if (locals)
-		mgMapMerge(frame.locals, locals, MG_TRUE);
+		mgMapMerge(mgStackFrameCaptureLocals(&frame), locals, MG_TRUE);
 
 	mgPushStackFrame(instance, &frame);
 
-	MGValue *value = _mgVisitNode(module, _mgListGet(root->children, 0));
+	MGValue *value = mgInterpret(module);
 	MG_ASSERT(value);
 
-	if ((value->type == MG_TYPE_FUNCTION) && locals && mgMapSize(locals))
+	if ((mgValueType(value) == MG_TYPE_FUNCTION) && locals && mgMapSize(locals))
 	{
 		if (value->data.func.locals)
 			mgMapMerge(value->data.func.locals, locals, MG_TRUE);
 		else
-			value->data.func.locals = mgReferenceValue(module->data.module.instance->callStackTop->locals);
+			value->data.func.locals = mgReferenceValue(mgStackFrameCaptureLocals(module->data.module.instance->callStackTop));
 	}
 
 	mgPopStackFrame(instance, &frame);
@@ -1,8 +1,10 @@
-
 #include "format.h"
+#include "weld.h"
 #include "debug.h"
 
 
+// Positions and normals are welded separately, as faces index them
+// separately, while normals of flat triangles are rarely shared
 void mgExportOBJ(MGInstance *instance, FILE *file)
 {
 	const size_t vertexCount = _mgListLength(instance->vertices);
@@ -13,17 +15,36 @@ void mgExportOBJ(MGInstance *instance, FILE *file)
 	MG_ASSERT(instance->vertexSize.normal == 3);
 	MG_ASSERT(instance->vertexSize.color == 0);
 
-	for (size_t j = 0; j < vertexCount; ++j)
-		fprintf(file, "v %f %f %f\n", vertices[j][0], vertices[j][1], vertices[j][2]);
+	uint32_t *indices = (uint32_t*) malloc((vertexCount * 4 + 1) * sizeof(uint32_t));
+	MG_ASSERT(indices);
+
+	uint32_t *positions = indices, *normals = indices + vertexCount;
+	uint32_t *uniquePositions = indices + vertexCount * 2, *uniqueNormals = indices + vertexCount * 3;
+
+	const float *components = (const float*) vertices;
+
+	const size_t positionCount = mgWeldVertices(components, vertexCount, 6, 3, MG_WELD_EPSILON, positions, uniquePositions);
+	const size_t normalCount = mgWeldVertices(components + 3, vertexCount, 6, 3, MG_WELD_EPSILON, normals, uniqueNormals);
+
+	for (size_t j = 0; j < positionCount; ++j)
+	{
+		const float *v = vertices[uniquePositions[j]];
+		fprintf(file, "v %f %f %f\n", v[0], v[1], v[2]);
+	}
 
-	for (size_t j = 0; j < vertexCount; ++j)
-		fprintf(file, "vn %f %f %f\n", vertices[j][3], vertices[j][4], vertices[j][5]);
+	for (size_t j = 0; j < normalCount; ++j)
+	{
+		const float *v = vertices[uniqueNormals[j]];
+		fprintf(file, "vn %f %f %f\n", v[3], v[4], v[5]);
+	}
 
-	for (size_t j = 0; j < vertexCount / 3; ++j)
-		fprintf(file, "f %zu//%zu %zu//%zu %zu//%zu\n",
-		        j * 3 + 1, j * 3 + 1,
-		        j * 3 + 2, j * 3 + 2,
-		        j * 3 + 3, j * 3 + 3);
+	for (size_t j = 0; j < (vertexCount / 3) * 3; j += 3)
+		fprintf(file, "f %u//%u %u//%u %u//%u\n",
+		        positions[j] + 1, normals[j] + 1,
+		        positions[j + 1] + 1, normals[j + 1] + 1,
+		        positions[j + 2] + 1, normals[j + 2] + 1);
+
+	free(indices);
 }
 
 
@@ -34,3 +55,32 @@ void mgExportTriangles(MGInstance *instance, FILE *file)
 
 	fwrite(vertices, vertexCount * sizeof(MGVertex), 1, file);
 }
+
+
+void mgExportIndexedTriangles(MGInstance *instance, FILE *file)
+{
+	const size_t vertexCount = _mgListLength(instance->vertices);
+	MGVertex *const vertices = _mgListItems(instance->vertices);
+
+	const uint32_t vertexSize = mgInstanceGetVertexSize(instance);
+
+	uint32_t *indices = (uint32_t*) malloc((vertexCount * 2 + 1) * sizeof(uint32_t));
+	MG_ASSERT(indices);
+
+	uint32_t *uniques = indices + vertexCount;
+
+	const uint32_t uniqueCount = (uint32_t) mgWeldVertices((const float*) vertices, vertexCount,
+	                                                       sizeof(MGVertex) / sizeof(float), vertexSize,
+	                                                       MG_WELD_EPSILON, indices, uniques);
+	const uint32_t indexCount = (uint32_t) ((vertexCount / 3) * 3);
+
+	fwrite(&uniqueCount, sizeof(uint32_t), 1, file);
+
+	for (size_t j = 0; j < uniqueCount; ++j)
+		fwrite(vertices[uniques[j]], sizeof(MGVertex), 1, file);
+
+	fwrite(&indexCount, sizeof(uint32_t), 1, file);
+	fwrite(indices, indexCount * sizeof(uint32_t), 1, file);
+
+	free(indices);
+}
@@ -8,4 +8,8 @@
 void mgExportOBJ(MGInstance *instance, FILE *file);
 void mgExportTriangles(MGInstance *instance, FILE *file);
 
+// The unique vertices welded by mgWeldVertices, preceded by their count,
+// followed by the number of indices and 32-bit indices, three per triangle
+void mgExportIndexedTriangles(MGInstance *instance, FILE *file);
+
 #endif
\ No newline at end of file
@@ -1,7 +1,9 @@
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "frame.h"
+#include "compile.h"
 #include "debug.h"
 
 
@@ -9,8 +11,7 @@ void mgCreateStackFrameEx(MGStackFrame *frame, MGValue *module, MGValue *locals)
 {
 	MG_ASSERT(frame);
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
-	MG_ASSERT(locals);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 
 	memset(frame, 0, sizeof(MGStackFrame));
 
@@ -27,6 +28,189 @@ void mgDestroyStackFrame(MGStackFrame *frame)
 	if (frame->value)
 		mgDestroyValue(frame->value);
 
+	if (frame->tailCall)
+		mgDestroyValue(frame->tailCall);
+
 	mgDestroyValue(frame->module);
-	mgDestroyValue(frame->locals);
+
+	if (frame->locals)
+		mgDestroyValue(frame->locals);
+
+	if (frame->captured)
+		mgDestroyValue(frame->captured);
+}
+
+
+MGValue* mgStackFrameGetLocals(const MGStackFrame *frame)
+{
+	MG_ASSERT(frame);
+
+	if (!frame->slots && !frame->captured)
+		return frame->locals ? mgReferenceValue(frame->locals) : mgCreateValueMap(0);
+
+	MGValue *locals = mgCreateValueMap((frame->code ? _mgListLength(frame->code->locals) : 0) +
+	                                   (frame->locals ? mgMapSize(frame->locals) : 0) +
+	                                   (frame->captured ? mgMapSize(frame->captured) : 0));
+
+	if (frame->captured)
+		mgMapMerge(locals, frame->captured, MG_TRUE);
+
+	if (frame->locals)
+		mgMapMerge(locals, frame->locals, MG_TRUE);
+
+	if (!frame->slots)
+		return locals;
+
+	MG_ASSERT(frame->code);
+
+	for (size_t i = 0; i < _mgListLength(frame->code->locals); ++i)
+		if (frame->slots[i])
+			mgMapSet(locals, _mgListGet(frame->code->locals, i), mgReferenceValue(frame->slots[i]));
+
+	return locals;
+}
+
+
+MGValue* mgStackFrameCreateLocals(MGStackFrame *frame)
+{
+	MG_ASSERT(frame);
+
+	if (!frame->locals)
+		frame->locals = mgCreateValueMap(1 << 4);
+
+	return frame->locals;
+}
+
+
+// Closures created by a call reading captured locals capture a copy of
+// them, from then on modified by the call like any of its own locals
+MGValue* mgStackFrameCaptureLocals(MGStackFrame *frame)
+{
+	MG_ASSERT(frame);
+
+	MGValue *locals = mgStackFrameCreateLocals(frame);
+
+	if (frame->captured)
+	{
+		mgMapMerge(locals, frame->captured, MG_FALSE);
+
+		mgDestroyValue(frame->captured);
+		frame->captured = NULL;
+	}
+
+	return locals;
+}
+
+
+#define _MG_VALUE_STACK_SEGMENT_SIZE (1 << 12)
+
+struct MGValueStackSegment {
+	MGValueStackSegment *last;
+	MGValueStackSegment *next;
+	size_t capacity;
+	size_t top;
+	MGValue *values[];
+};
+
+
+static MGValueStackSegment* _mgCreateValueStackSegment(MGValueStackSegment *last, size_t capacity)
+{
+	MGValueStackSegment *segment = (MGValueStackSegment*) malloc(sizeof(MGValueStackSegment) + capacity * sizeof(MGValue*));
+	MG_ASSERT(segment);
+
+	segment->last = last;
+	segment->next = NULL;
+	segment->capacity = capacity;
+	segment->top = 0;
+
+	return segment;
+}
+
+
+void mgCreateValueStack(MGValueStack *stack)
+{
+	MG_ASSERT(stack);
+
+	stack->segment = _mgCreateValueStackSegment(NULL, _MG_VALUE_STACK_SEGMENT_SIZE);
+}
+
+
+void mgDestroyValueStack(MGValueStack *stack)
+{
+	MG_ASSERT(stack);
+	MG_ASSERT(stack->segment);
+
+	MGValueStackSegment *segment = stack->segment;
+
+	while (segment->last)
+		segment = segment->last;
+
+	for (MGValueStackSegment *next; segment; segment = next)
+	{
+		next = segment->next;
+		free(segment);
+	}
+
+	stack->segment = NULL;
+}
+
+
+MGValue** mgValueStackPush(MGValueStack *stack, size_t count)
+{
+	MG_ASSERT(stack);
+	MG_ASSERT(stack->segment);
+
+	MGValueStackSegment *segment = stack->segment;
+
+	if ((segment->top + count) > segment->capacity)
+	{
+		// Segments left behind by deeper calls are reused if they fit
+		MGValueStackSegment *next = segment->next;
+
+		if (next && (next->capacity < count))
+		{
+			for (MGValueStackSegment *unused = next, *after; unused; unused = after)
+			{
+				after = unused->next;
+				free(unused);
+			}
+
+			next = NULL;
+		}
+
+		if (!next)
+		{
+			next = _mgCreateValueStackSegment(segment, (count > _MG_VALUE_STACK_SEGMENT_SIZE) ? count : _MG_VALUE_STACK_SEGMENT_SIZE);
+			segment->next = next;
+		}
+
+		MG_ASSERT(next->top == 0);
+
+		segment = next;
+		stack->segment = segment;
+	}
+
+	MGValue **values = segment->values + segment->top;
+	segment->top += count;
+
+	memset(values, 0, count * sizeof(MGValue*));
+
+	return values;
+}
+
+
+void mgValueStackPop(MGValueStack *stack, MGValue **values, size_t count)
+{
+	MG_ASSERT(stack);
+	MG_ASSERT(stack->segment);
+
+	MGValueStackSegment *segment = stack->segment;
+
+	MG_ASSERT(segment->top >= count);
+	MG_ASSERT(values == (segment->values + segment->top - count));
+
+	segment->top -= count;
+
+	if ((segment->top == 0) && segment->last)
+		stack->segment = segment->last;
 }
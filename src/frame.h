@@ -29,16 +29,45 @@ typedef struct MGStackFrame MGStackFrame;
 typedef struct MGStackFrame {
 	MGStackFrameState state;
 	MGStackFrame *last;
-	MGStackFrame *next;
 	MGValue *module;
 	const MGNode *caller;
 	const char *callerName;
 	MGValue *value;
+	// Call in tail position made once the frame has returned, as
+	// a tuple holding the callable followed by its arguments
+	MGValue *tailCall;
+	// Created on demand, as resolved code keeps its
+	// locals in slots unless a closure captures them
 	MGValue *locals;
+	// Locals captured by a closure outside of the parallel map or
+	// task calling it, which the call reads but never modifies
+	MGValue *captured;
+	// Local variable slots of the executing code, if resolved
+	MGValue **slots;
+	const struct MGCode *code;
 } MGStackFrame;
 
-#define mgCreateStackFrame(frame, module) mgCreateStackFrameEx(frame, module, mgCreateValueMap(1 << 4))
+#define mgCreateStackFrame(frame, module) mgCreateStackFrameEx(frame, module, NULL)
 void mgCreateStackFrameEx(MGStackFrame *frame, MGValue *module, MGValue *locals);
 void mgDestroyStackFrame(MGStackFrame *frame);
 
+MGValue* mgStackFrameGetLocals(const MGStackFrame *frame);
+MGValue* mgStackFrameCreateLocals(MGStackFrame *frame);
+MGValue* mgStackFrameCaptureLocals(MGStackFrame *frame);
+
+typedef struct MGValueStackSegment MGValueStackSegment;
+
+// Registers, local slots and arguments of every active call are
+// reserved from one stack, which grows by adding segments so that
+// earlier reservations never move
+typedef struct MGValueStack {
+	MGValueStackSegment *segment;
+} MGValueStack;
+
+void mgCreateValueStack(MGValueStack *stack);
+void mgDestroyValueStack(MGValueStack *stack);
+
+MGValue** mgValueStackPush(MGValueStack *stack, size_t count);
+void mgValueStackPop(MGValueStack *stack, MGValue **values, size_t count);
+
 #endif
\ No newline at end of file
@@ -5,6 +5,8 @@
 
 #include "inspect.h"
 #include "file.h"
+#include "types/primitive.h"
+#include "intern.h"
 #include "utilities.h"
 #include "debug.h"
 
@@ -82,7 +84,25 @@ static void _mgInspectNode(const MGNode *node, char *prefix, char *prefixEnd, MG
 
 	width += printf("%s", _MG_NODE_NAMES[node->type]);
 
-	if (node->token)
+	if (node->type == MG_NODE_CONSTANT)
+	{
+		MG_ASSERT(node->value);
+
+		if (mgValueType(node->value) == MG_TYPE_STRING)
+		{
+			char *str = (char*) malloc((mgInlineRepresentationLength(node->value->data.str.s, NULL) + 1) * sizeof(char));
+			mgInlineRepresentation(str, node->value->data.str.s, NULL);
+			width += printf(" \"%s\"", str);
+			free(str);
+		}
+		else
+		{
+			char *str = mgValueToString(node->value);
+			width += printf(" %s", str);
+			free(str);
+		}
+	}
+	else if (node->token)
 	{
 		switch (node->token->type)
 		{
@@ -176,6 +196,112 @@ void mgInspectNode(const MGNode *node)
 }
 
 
+static void _mgInspectCode(const MGCode *code, const char *name)
+{
+	printf("Code %s [%zu registers, %zu slots]\n", name, code->registerCount, _mgListLength(code->locals));
+
+	for (size_t i = 0; i < _mgListLength(code->instructions); ++i)
+	{
+		const MGInstruction *instruction = &_mgListGet(code->instructions, i);
+		const MGNode *node = _mgListGet(code->nodes, i);
+
+		int width = printf("%5zu %-*s %u %u %u", i, _MG_LONGEST_OPCODE_NAME_LENGTH, _MG_OPCODE_NAMES[instruction->opcode],
+		                   instruction->a, instruction->b, instruction->c);
+
+		switch (instruction->opcode)
+		{
+		case MG_OPCODE_LOAD_NAME:
+		case MG_OPCODE_STORE_NAME:
+		case MG_OPCODE_STORE_LOCAL:
+		case MG_OPCODE_DELETE_NAME:
+		case MG_OPCODE_MISSING_ARGUMENT:
+		case MG_OPCODE_CALL_METHOD:
+		case MG_OPCODE_IMPORT:
+			width += printf(" %s", _mgListGet(code->names, instruction->b));
+			break;
+		case MG_OPCODE_LOAD_SLOT:
+		case MG_OPCODE_STORE_SLOT:
+		case MG_OPCODE_STORE_SLOT_LOCAL:
+		case MG_OPCODE_DELETE_SLOT:
+			width += printf(" %s", _mgListGet(code->locals, instruction->b));
+			break;
+		case MG_OPCODE_GET_ATTRIBUTE:
+		case MG_OPCODE_SET_ATTRIBUTE:
+		case MG_OPCODE_DELETE_ATTRIBUTE:
+		case MG_OPCODE_IMPORT_NAME:
+			width += printf(" %s", _mgListGet(code->names, instruction->c));
+			break;
+		case MG_OPCODE_LOAD_CONST:
+		case MG_OPCODE_COPY_CONST:
+		{
+			const MGValue *constant = _mgListGet(code->constants, instruction->b);
+
+			if (mgValueType(constant) == MG_TYPE_STRING)
+				width += printf(" \"%s\"", constant->data.str.s);
+			else
+			{
+				char *str = mgValueToString(constant);
+				width += printf(" %s", str);
+				free(str);
+			}
+
+			break;
+		}
+		case MG_OPCODE_CONVERT:
+			width += printf(" %s", mgGetTypeName(instruction->c));
+			break;
+		default:
+			break;
+		}
+
+		if (width < _MG_NODE_PADDING)
+			printf("%*s", _MG_NODE_PADDING - width, "");
+		else
+			putchar(' ');
+
+#if MG_ANSI_COLORS
+		fputs("\e[90m", stdout);
+#endif
+
+		if (node && node->tokenBegin)
+			printf("%u:%u\n", node->tokenBegin->begin.line, node->tokenBegin->begin.character);
+		else
+			putchar('\n');
+
+#if MG_ANSI_COLORS
+		fputs("\e[0m", stdout);
+#endif
+	}
+
+	for (size_t i = 0; i < _mgListLength(code->instructions); ++i)
+	{
+		if (_mgListGet(code->instructions, i).opcode != MG_OPCODE_MAKE_FUNCTION)
+			continue;
+
+		MGNode *funcNode = (MGNode*) _mgListGet(code->nodes, i);
+		const MGNode *nameNode = _mgListGet(funcNode->children, 0);
+
+		const MGCode *funcCode = mgCompile(funcNode);
+
+		if (funcCode->resolved)
+			funcCode = funcCode->resolved;
+
+		putchar('\n');
+
+		if ((nameNode->type == MG_NODE_NAME) && nameNode->token)
+			_mgInspectCode(funcCode, nameNode->token->value.s);
+		else
+			_mgInspectCode(funcCode, "<anonymous>");
+	}
+}
+
+
+void mgInspectCode(const MGCode *code)
+{
+	_mgInspectCode(code, "<module>");
+}
+
+
 typedef struct _MGInspectValueMetadata {
 	_MGList(const MGValue*) references;
 } _MGInspectValueMetadata;
@@ -220,13 +346,13 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 
 static inline void _mgInspectValueType(const MGValue *value)
 {
-	fputs(mgGetTypeName(value->type), stdout);
+	fputs(mgGetTypeName(mgValueType(value)), stdout);
 
-	if ((value->type == MG_TYPE_TUPLE) || (value->type == MG_TYPE_LIST))
+	if ((mgValueType(value) == MG_TYPE_TUPLE) || (mgValueType(value) == MG_TYPE_LIST))
 		printf("[%zu]", _mgListLength(value->data.a));
-	else if (value->type == MG_TYPE_MAP)
-		printf("[%zu]", _mgListLength(value->data.m));
-	else if ((value->type == MG_TYPE_MODULE) && value->data.module.filename)
+	else if (mgValueType(value) == MG_TYPE_MAP)
+		printf("[%zu]", _mgMapSize(value->data.m));
+	else if ((mgValueType(value) == MG_TYPE_MODULE) && value->data.module.filename)
 		printf(" \"%s\"", value->data.module.filename);
 }
 
@@ -259,16 +385,16 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 
 	char *s;
 
-	switch (value->type)
+	switch (mgValueType(value))
 	{
 	case MG_TYPE_NULL:
 		fputs("null", stdout);
 		break;
 	case MG_TYPE_INTEGER:
-		printf("%d", value->data.i);
+		printf("%d", mgIntegerGet(value));
 		break;
 	case MG_TYPE_FLOAT:
-		printf("%G", value->data.f);
+		printf("%G", mgFloatGet(value));
 		break;
 	case MG_TYPE_STRING:
 	{
@@ -280,8 +406,8 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 	}
 	case MG_TYPE_TUPLE:
 	case MG_TYPE_LIST:
-		putchar((value->type == MG_TYPE_TUPLE) ? '(' : '[');
-		if (_mgListLength(value->data.m))
+		putchar((mgValueType(value) == MG_TYPE_TUPLE) ? '(' : '[');
+		if (_mgListLength(value->data.a))
 		{
 			_mgMetadataAdd(metadata, value);
 			for (size_t i = 0; i < _mgListLength(value->data.a); ++i)
@@ -291,9 +417,9 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 				_mgInspectValue(_mgListGet(value->data.a, i), depth, metadata);
 			}
 		}
-		if ((_mgListLength(value->data.a) == 1) && (value->type == MG_TYPE_TUPLE))
+		if ((_mgListLength(value->data.a) == 1) && (mgValueType(value) == MG_TYPE_TUPLE))
 			putchar(',');
-		putchar((value->type == MG_TYPE_TUPLE) ? ')' : ']');
+		putchar((mgValueType(value) == MG_TYPE_TUPLE) ? ')' : ']');
 		break;
 	case MG_TYPE_MAP:
 		putchar('{');
@@ -302,7 +428,7 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 			_mgMetadataAdd(metadata, value);
 			putchar('\n');
 			for (size_t i = 0; i < _mgMapSize(value->data.m); ++i)
-				_mgInspectName(&_mgListGet(value->data.m, i), depth + 1, metadata);
+				_mgInspectName(&_mgListGet(value->data.m.pairs, i), depth + 1, metadata);
 			for (unsigned int i = 0; i < depth; ++i)
 				fputs("    ", stdout);
 		}
@@ -312,7 +438,7 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 		printf("cfunc %p()", value->data.cfunc);
 		break;
 	case MG_TYPE_BOUND_CFUNCTION:
-		printf("cfunc %p() bound to %s %p", value->data.bcfunc.cfunc, mgGetTypeName(value->data.bcfunc.bound->type), value->data.bcfunc.bound);
+		printf("cfunc %p() bound to %s %p", value->data.bcfunc.cfunc, mgGetTypeName(mgValueType(value->data.bcfunc.bound)), value->data.bcfunc.bound);
 		break;
 	case MG_TYPE_PROCEDURE:
 	case MG_TYPE_FUNCTION:
@@ -322,9 +448,9 @@ static void _mgInspectValue(const MGValue *value, unsigned int depth, _MGInspect
 			const MGNode *nameNode = _mgListGet(funcNode->children, 0);
 
 			if (nameNode->type == MG_NODE_NAME)
-				printf("%s %s(%zu)", mgGetTypeName(value->type), nameNode->token->value.s, _mgListLength(_mgListGet(funcNode->children, 1)->children));
+				printf("%s %s(%zu)", mgGetTypeName(mgValueType(value)), nameNode->token->value.s, _mgListLength(_mgListGet(funcNode->children, 1)->children));
 			else
-				printf("%s %p(%zu)", mgGetTypeName(value->type), funcNode, _mgListLength(_mgListGet(funcNode->children, 1)->children));
+				printf("%s %p(%zu)", mgGetTypeName(mgValueType(value)), funcNode, _mgListLength(_mgListGet(funcNode->children, 1)->children));
 		}
 
 		if (value->data.func.locals && mgListLength(value->data.func.locals))
@@ -393,7 +519,7 @@ void mgInspectStackFrame(const MGStackFrame *frame)
 		if (token)
 		{
 			MG_ASSERT(frame->module);
-			MG_ASSERT(frame->module->type == MG_TYPE_MODULE);
+			MG_ASSERT(mgValueType(frame->module) == MG_TYPE_MODULE);
 			MG_ASSERT(frame->module->data.module.filename);
 
 			printf("Caller: %s:%u:%u\n",
@@ -457,6 +583,9 @@ void _mgDebugTokenizePrint(const char *filename, char *str, size_t len)
 		{
 			mgTokenizeNext(&token);
 			mgInspectTokenEx(&token, filename, MG_TRUE);
+
+			if (((token.type == MG_TOKEN_NAME) || (token.type == MG_TOKEN_STRING)) && token.value.s)
+				mgReleaseInternedString(token.value.s);
 		}
 		while (token.type != MG_TOKEN_EOF);
 	}
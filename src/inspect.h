@@ -8,9 +8,11 @@
 #include "value.h"
 #include "frame.h"
 #include "instance.h"
+#include "compile.h"
 
 void mgInspectToken(const MGToken *token);
 void mgInspectNode(const MGNode *node);
+void mgInspectCode(const MGCode *code);
 void mgInspectValue(const MGValue *value);
 void mgInspectInstance(const MGInstance *instance);
 void mgInspectStackFrame(const MGStackFrame *frame);
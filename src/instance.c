@@ -9,15 +9,21 @@
 #include "callable.h"
 #include "interpret.h"
 #include "file.h"
+#include "intern.h"
+#include "thread.h"
+#include "parallel.h"
+#include "error.h"
 #include "utilities.h"
 #include "debug.h"
 
 
 extern MGValue* mgCreateBaseLib(void);
 extern MGValue* mgCreateMathLib(void);
+extern MGValue* mgCreateVecLib(void);
+extern MGValue* mgCreateMatLib(void);
 
 
-MGInstance *_mgLastInstance = NULL;
+MG_THREAD_LOCAL MGInstance *_mgLastInstance = NULL;
 
 
 struct {
@@ -26,6 +32,8 @@ struct {
 } _mgStaticModules[] = {
 	{ "base", mgCreateBaseLib },
 	{ "math", mgCreateMathLib },
+	{ "vec", mgCreateVecLib },
+	{ "mat", mgCreateMatLib },
 	{ NULL, NULL }
 };
 
@@ -62,16 +70,43 @@ static inline char* _mgImportNameToFilename(const char *name)
 }
 
 
+// Instances are current on their thread while they are created, run or
+// destroyed, after which whatever was current before is restored, such
+// that instances existing at the same time never use each other's state
+typedef struct MGInstanceScope {
+	MGAllocator *allocator;
+	MGInstance *instance;
+} MGInstanceScope;
+
+
+static inline void _mgEnterInstance(MGInstance *instance, MGInstanceScope *scope)
+{
+	scope->allocator = mgSetAllocator(&instance->allocator);
+
+	scope->instance = _mgLastInstance;
+	_mgLastInstance = instance;
+}
+
+
+static inline void _mgLeaveInstance(const MGInstanceScope *scope)
+{
+	mgSetAllocator(scope->allocator);
+	_mgLastInstance = scope->instance;
+}
+
+
 void mgCreateInstance(MGInstance *instance)
 {
 	MG_ASSERT(instance);
 
 	memset(instance, 0, sizeof(MGInstance));
 
-	if (_mgNullValue == NULL)
-		_mgNullValue = mgCreateValueNull();
-	else
-		mgReferenceValue(_mgNullValue);
+	mgCreateAllocator(&instance->allocator);
+
+	MGInstanceScope scope;
+	_mgEnterInstance(instance, &scope);
+
+	mgCreateValueStack(&instance->valueStack);
 
 	_mgListCreate(char*, instance->path, 1 << 2);
 
@@ -80,8 +115,16 @@ void mgCreateInstance(MGInstance *instance)
 
 	instance->uniforms = mgCreateValueMap(0);
 
+	for (int type = 0; type < MG_TYPE_COUNT; ++type)
+		instance->typeNames[type] = mgInternString(mgGetTypeName((MGType) type));
+
 	_mgListCreate(MGVertex, instance->vertices, 1 << 9);
 
+	mgResetTransforms(instance, MG_NULL_VALUE);
+
+	_mgListInitialize(instance->workerAllocators);
+	_mgListInitialize(instance->tasks);
+
 	char path[MG_PATH_MAX + 1];
 
 #ifdef _WIN32
@@ -125,7 +168,7 @@ void mgCreateInstance(MGInstance *instance)
 
 		MGValue *module = _mgStaticModules[i].create();
 		MG_ASSERT(module);
-		MG_ASSERT(module->type == MG_TYPE_MODULE);
+		MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 
 		module->data.module.isStatic = MG_TRUE;
 		MG_ASSERT(mgMapGet(instance->staticModules, _mgStaticModules[i].name) == NULL);
@@ -135,7 +178,7 @@ void mgCreateInstance(MGInstance *instance)
 
 	instance->base = mgMapGet(instance->staticModules, "base");
 
-	_mgLastInstance = instance;
+	_mgLeaveInstance(&scope);
 }
 
 
@@ -143,24 +186,70 @@ void mgDestroyInstance(MGInstance *instance)
 {
 	MG_ASSERT(instance);
 
-	if (_mgNullValue->refCount == 1)
-	{
-		mgDestroyValue(_mgNullValue);
-		_mgNullValue = NULL;
-	}
-	else
-		mgDestroyValue(_mgNullValue);
+	MGInstanceScope scope;
+	_mgEnterInstance(instance, &scope);
 
 	for (int i = 0; i < _mgListLength(instance->path); ++i)
 		free(_mgListGet(instance->path, i));
 	_mgListDestroy(instance->path);
 
+	for (size_t i = 0; i < _mgListLength(instance->tasks); ++i)
+		mgDestroyValue(_mgListGet(instance->tasks, i));
+	_mgListDestroy(instance->tasks);
+
 	mgDestroyValue(instance->modules);
 	mgDestroyValue(instance->staticModules);
 
+	for (int type = 0; type < MG_TYPE_COUNT; ++type)
+		mgReleaseInternedString(instance->typeNames[type]);
+
 	mgDestroyValue(instance->uniforms);
 
 	_mgListDestroy(instance->vertices);
+
+	for (size_t i = 0; i < _mgListLength(instance->transforms); ++i)
+		mgDestroyValue(_mgListGet(instance->transforms, i));
+	_mgListDestroy(instance->transforms);
+
+	mgDestroyValueStack(&instance->valueStack);
+
+	_mgLeaveInstance(&scope);
+
+	for (size_t i = 0; i < _mgListLength(instance->workerAllocators); ++i)
+	{
+		mgDestroyAllocator(_mgListGet(instance->workerAllocators, i));
+		free(_mgListGet(instance->workerAllocators, i));
+	}
+	_mgListDestroy(instance->workerAllocators);
+
+	// Releases anything still alive, e.g. values kept alive by reference cycles
+	mgDestroyAllocator(&instance->allocator);
+}
+
+
+MGValueList mgResetTransforms(MGInstance *instance, const MGValue *transform)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(transform);
+
+	const MGValueList transforms = instance->transforms;
+
+	_mgListCreate(MGValue*, instance->transforms, 1 << 2);
+	_mgListAdd(MGValue*, instance->transforms, mgReferenceValue(transform));
+
+	return transforms;
+}
+
+
+void mgRestoreTransforms(MGInstance *instance, MGValueList transforms)
+{
+	MG_ASSERT(instance);
+
+	for (size_t i = 0; i < _mgListLength(instance->transforms); ++i)
+		mgDestroyValue(_mgListGet(instance->transforms, i));
+	_mgListDestroy(instance->transforms);
+
+	instance->transforms = transforms;
 }
 
 
@@ -170,13 +259,8 @@ void mgPushStackFrame(MGInstance *instance, MGStackFrame *frame)
 	MG_ASSERT(frame);
 	MG_ASSERT(instance->callStackTop != frame);
 	MG_ASSERT(frame->last == NULL);
-	MG_ASSERT(frame->next == NULL);
 
 	frame->last = instance->callStackTop;
-
-	if (instance->callStackTop)
-		instance->callStackTop->next = frame;
-
 	instance->callStackTop = frame;
 }
 
@@ -186,13 +270,8 @@ void mgPopStackFrame(MGInstance *instance, MGStackFrame *frame)
 	MG_ASSERT(instance);
 	MG_ASSERT(frame);
 	MG_ASSERT(instance->callStackTop == frame);
-	MG_ASSERT(frame->next == NULL);
 
 	instance->callStackTop = frame->last;
-
-	if (instance->callStackTop)
-		instance->callStackTop->next = NULL;
-
 	frame->last = NULL;
 }
 
@@ -304,7 +383,7 @@ static inline void _mgRunModule(MGInstance *instance, MGValue *module)
 {
 	MG_ASSERT(instance);
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(module->data.module.instance == instance);
 	MG_ASSERT(module->data.module.parser.root);
 
@@ -326,6 +405,11 @@ static inline MGValue* _mgImportModuleFile(MGInstance *instance, const char *nam
 
 	const MGValue *module = mgMapGet(instance->modules, name);
 
+	// Static modules take precedence over files, e.g. the
+	// native vec over the reference implementation vec.mg
+	if (module == NULL)
+		module = mgMapGet(instance->staticModules, name);
+
 	if (module == NULL)
 	{
 		char filename[MG_PATH_MAX + 1];
@@ -344,6 +428,10 @@ static inline MGValue* _mgImportModuleFile(MGInstance *instance, const char *nam
 
 			if (mgFileExists(filename))
 			{
+				// Modules are shared by the threads of parallel maps and tasks
+				if (instance->sharedGlobals)
+					mgFatalError("Error: Cannot import \"%s\" in a parallel map or task, as it has not been imported before", name);
+
 				MGValue *_module = mgCreateValueModule();
 
 				_module->data.module.instance = instance;
@@ -364,13 +452,8 @@ static inline MGValue* _mgImportModuleFile(MGInstance *instance, const char *nam
 			}
 		}
 
-		module = mgMapGet(instance->staticModules, name);
-
-		if (module == NULL)
-		{
-			fprintf(stderr, "Error: Failed loading module \"%s\"\n", name);
-			return NULL;
-		}
+		fprintf(stderr, "Error: Failed loading module \"%s\"\n", name);
+		return NULL;
 	}
 
 	MG_ASSERT(module);
@@ -402,12 +485,18 @@ void mgRunFile(MGInstance *instance, const char *filename, const char *name)
 	MG_ASSERT(instance);
 	MG_ASSERT(filename);
 
+	MGInstanceScope scope;
+	_mgEnterInstance(instance, &scope);
+
 	char *_name = NULL;
 	MGValue *module = _mgModuleLoadFile(instance, filename, name ? name : (_name = _mgFilenameToImportName(filename)));
 	_mgRunModule(instance, module);
 	_mgCallMain(instance, module);
+	mgWaitTasks(instance);
 	mgDestroyValue(module);
 	free(_name);
+
+	_mgLeaveInstance(&scope);
 }
 
 
@@ -417,10 +506,16 @@ void mgRunFileHandle(MGInstance *instance, FILE *file, const char *name)
 	MG_ASSERT(file);
 	MG_ASSERT(name);
 
+	MGInstanceScope scope;
+	_mgEnterInstance(instance, &scope);
+
 	MGValue *module = _mgModuleLoadFileHandle(instance, file, name);
 	_mgRunModule(instance, module);
 	_mgCallMain(instance, module);
+	mgWaitTasks(instance);
 	mgDestroyValue(module);
+
+	_mgLeaveInstance(&scope);
 }
 
 
@@ -430,10 +525,16 @@ void mgRunString(MGInstance *instance, const char *string, const char *name)
 	MG_ASSERT(string);
 	MG_ASSERT(name);
 
+	MGInstanceScope scope;
+	_mgEnterInstance(instance, &scope);
+
 	MGValue *module = _mgModuleLoadString(instance, string, name);
 	_mgRunModule(instance, module);
 	_mgCallMain(instance, module);
+	mgWaitTasks(instance);
 	mgDestroyValue(module);
+
+	_mgLeaveInstance(&scope);
 }
 
 
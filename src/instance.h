@@ -3,25 +3,59 @@
 
 #include "value.h"
 #include "frame.h"
+#include "allocator.h"
 
 typedef float MGVertex[3 + 3];
+typedef _MGList(MGVertex) MGVertexList;
 
 typedef struct MGInstance {
+	// Current while the instance runs, values and
+	// composite payloads are allocated from it
+	MGAllocator allocator;
 	MGStackFrame *callStackTop;
+	MGValueStack valueStack;
+	// Last name looked up by the tree walker, used by errors raised without a node
+	const MGNode *currentNode;
 	_MGList(char*) path;
 	MGValue *modules;
 	MGValue *staticModules;
 	const MGValue *base;
 	MGValue *uniforms;
-	_MGList(MGVertex) vertices;
+	// Interned type names, returned by type()
+	const char *typeNames[MG_TYPE_COUNT];
+	MGVertexList vertices;
+	// Stack of the transforms geom applies, the last of which is current.
+	// Transforms are kept as the values set, e.g. a mat4 or the tuples of
+	// mat.mg, and are null until one is set. Map items and tasks each get
+	// a stack of their own, starting with the transform current when pmap
+	// or spawn was called
+	MGValueList transforms;
 	struct {
 		unsigned int position : 3;
 		unsigned int uv : 2;
 		unsigned int normal : 3;
 		unsigned int color : 3;
 	} vertexSize;
+	MGbool walkAST;
+	// State of random(), which seed() replaces
+	uint64_t randomState;
+	// Threads used by pmap, or 0 to use one per processor
+	unsigned int threadCount;
+	// Set while running a parallel map, during which globals
+	// are shared between threads and must not be assigned
+	MGbool sharedGlobals;
+	// Containers created before this epoch are shared as well, see parallel.h
+	uint32_t sharedEpoch;
+	// Allocators of the worker instances of parallel maps, which
+	// own the values they created, so live as long as the instance
+	_MGList(MGAllocator*) workerAllocators;
+	// Futures returned by spawn whose tasks haven't run yet,
+	// which run together once any of them is waited for
+	MGValueList tasks;
 } MGInstance;
 
+#define mgInstanceGetTransform(instance) _mgListGet((instance)->transforms, _mgListLength((instance)->transforms) - 1)
+
 #define mgInstanceGetVertexSize(instance) ((instance)->vertexSize.position + (instance)->vertexSize.uv + (instance)->vertexSize.normal + (instance)->vertexSize.color)
 
 void mgCreateInstance(MGInstance *instance);
@@ -30,6 +64,11 @@ void mgDestroyInstance(MGInstance *instance);
 void mgPushStackFrame(MGInstance *instance, MGStackFrame *frame);
 void mgPopStackFrame(MGInstance *instance, MGStackFrame *frame);
 
+// Replaces the transforms with a stack of only transform, returning the previous ones
+MGValueList mgResetTransforms(MGInstance *instance, const MGValue *transform);
+// Destroys the transforms, replacing them with those returned by mgResetTransforms
+void mgRestoreTransforms(MGInstance *instance, MGValueList transforms);
+
 void mgRunFile(MGInstance *instance, const char *filename, const char *name);
 void mgRunFileHandle(MGInstance *instance, FILE *file, const char *name);
 void mgRunString(MGInstance *instance, const char *string, const char *name);
@@ -0,0 +1,342 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "intern.h"
+#include "thread.h"
+#include "utilities.h"
+#include "debug.h"
+
+
+#define _MG_INTERN_MIN_CAPACITY 64
+
+
+typedef struct MGInternedString {
+	struct MGInternedString *next;
+	size_t refCount;
+	size_t length;
+	uint32_t hash;
+	char str[];
+} MGInternedString;
+
+
+// Chained hash table of every interned string of the thread,
+// which is freed when the last interned string is released
+struct MGInternTable {
+	MGInternedString **buckets;
+	size_t capacity;
+	size_t size;
+};
+
+static MG_THREAD_LOCAL MGInternTable _mgThreadInternTable = { NULL, 0, 0 };
+
+// Threads running a parallel map use the table of the thread which
+// started it instead, guarded by the mutex of the parallel map
+static MG_THREAD_LOCAL MGInternTable *_mgSharedInternTable = NULL;
+static MG_THREAD_LOCAL MGMutex *_mgSharedInternMutex = NULL;
+
+#define _mgInternTable (*(_mgSharedInternTable ? _mgSharedInternTable : &_mgThreadInternTable))
+
+// While the table is shared, reference counts are changed atomically,
+// such that only interning a string missing from the cache below, and
+// releasing the last reference of a string, lock the mutex
+#define _mgIsInternTableShared() (_mgSharedInternMutex != NULL)
+
+
+// Strings recently interned by the thread while sharing a table, each
+// holding a reference, such that interning them again needs no lock
+#define _MG_INTERN_CACHE_SIZE 256
+
+static MG_THREAD_LOCAL MGInternedString *_mgInternCache[_MG_INTERN_CACHE_SIZE];
+
+
+#define _mgInternedStringHeader(str) ((MGInternedString*) ((str) - offsetof(MGInternedString, str)))
+
+
+static void _mgInternTableResize(size_t capacity)
+{
+	MG_ASSERT(capacity >= _MG_INTERN_MIN_CAPACITY);
+
+	MGInternedString **buckets = (MGInternedString**) calloc(capacity, sizeof(MGInternedString*));
+	MG_ASSERT(buckets);
+
+	for (size_t i = 0; i < _mgInternTable.capacity; ++i)
+	{
+		MGInternedString *interned = _mgInternTable.buckets[i], *next;
+
+		for (; interned; interned = next)
+		{
+			next = interned->next;
+
+			MGInternedString **bucket = &buckets[interned->hash & (capacity - 1)];
+			interned->next = *bucket;
+			*bucket = interned;
+		}
+	}
+
+	free(_mgInternTable.buckets);
+
+	_mgInternTable.buckets = buckets;
+	_mgInternTable.capacity = capacity;
+}
+
+
+const char* mgInternString(const char *str)
+{
+	MG_ASSERT(str);
+
+	return mgInternStringHashed(str, strlen(str), mgStringHash(str));
+}
+
+
+const char* mgInternStringEx(const char *str, size_t length)
+{
+	MG_ASSERT(str);
+
+	return mgInternStringHashed(str, length, mgStringHashEx(str, length));
+}
+
+
+static MGInternedString* _mgInternTableFind(const char *str, size_t length, uint32_t hash)
+{
+	if (!_mgInternTable.buckets)
+		return NULL;
+
+	for (MGInternedString *interned = _mgInternTable.buckets[hash & (_mgInternTable.capacity - 1)]; interned; interned = interned->next)
+	{
+		if ((interned->hash != hash) || (interned->length != length) || memcmp(interned->str, str, length))
+			continue;
+
+		if (!_mgIsInternTableShared())
+		{
+			++interned->refCount;
+			return interned;
+		}
+
+		// A string whose last reference is being released stays in the
+		// table until the thread releasing it gets the lock, so it is
+		// skipped rather than referenced again
+		if (mgAtomicIncrement(&interned->refCount) > 1)
+			return interned;
+
+		mgAtomicDecrement(&interned->refCount);
+	}
+
+	return NULL;
+}
+
+
+static MGInternedString* _mgInternTableInsert(const char *str, size_t length, uint32_t hash)
+{
+	if (_mgInternTable.size >= _mgInternTable.capacity)
+		_mgInternTableResize(_mgInternTable.capacity ? (_mgInternTable.capacity * 2) : _MG_INTERN_MIN_CAPACITY);
+
+	MGInternedString *interned = (MGInternedString*) malloc(sizeof(MGInternedString) + (length + 1) * sizeof(char));
+	MG_ASSERT(interned);
+
+	interned->refCount = 1;
+	interned->length = length;
+	interned->hash = hash;
+
+	memcpy(interned->str, str, length * sizeof(char));
+	interned->str[length] = '\0';
+
+	MGInternedString **bucket = &_mgInternTable.buckets[hash & (_mgInternTable.capacity - 1)];
+	interned->next = *bucket;
+	*bucket = interned;
+
+	++_mgInternTable.size;
+
+	return interned;
+}
+
+
+static void _mgInternTableRemove(MGInternedString *interned)
+{
+	MGInternedString **bucket = &_mgInternTable.buckets[interned->hash & (_mgInternTable.capacity - 1)];
+
+	while (*bucket != interned)
+		bucket = &(*bucket)->next;
+
+	*bucket = interned->next;
+
+	free(interned);
+
+	if (--_mgInternTable.size == 0)
+	{
+		free(_mgInternTable.buckets);
+
+		_mgInternTable.buckets = NULL;
+		_mgInternTable.capacity = 0;
+	}
+}
+
+
+static const char* _mgInternSharedString(const char *str, size_t length, uint32_t hash)
+{
+	MGInternedString **cached = &_mgInternCache[hash & (_MG_INTERN_CACHE_SIZE - 1)];
+	MGInternedString *interned = *cached;
+
+	if (interned && (interned->hash == hash) && (interned->length == length) && !memcmp(interned->str, str, length))
+	{
+		mgAtomicIncrement(&interned->refCount);
+		return interned->str;
+	}
+
+	mgLockMutex(_mgSharedInternMutex);
+
+	if (!(interned = _mgInternTableFind(str, length, hash)))
+		interned = _mgInternTableInsert(str, length, hash);
+
+	mgUnlockMutex(_mgSharedInternMutex);
+
+	// The string replaced is released after unlocking,
+	// as releasing its last reference locks again
+	MGInternedString *replaced = *cached;
+
+	mgAtomicIncrement(&interned->refCount);
+	*cached = interned;
+
+	if (replaced)
+		mgReleaseInternedString(replaced->str);
+
+	return interned->str;
+}
+
+
+static void _mgClearInternCache(void)
+{
+	for (size_t i = 0; i < _MG_INTERN_CACHE_SIZE; ++i)
+	{
+		if (_mgInternCache[i])
+		{
+			mgReleaseInternedString(_mgInternCache[i]->str);
+			_mgInternCache[i] = NULL;
+		}
+	}
+}
+
+
+const char* mgInternStringHashed(const char *str, size_t length, uint32_t hash)
+{
+	MG_ASSERT(str);
+
+	if (_mgIsInternTableShared())
+		return _mgInternSharedString(str, length, hash);
+
+	MGInternedString *interned = _mgInternTableFind(str, length, hash);
+
+	if (!interned)
+		interned = _mgInternTableInsert(str, length, hash);
+
+	return interned->str;
+}
+
+
+const char* mgReferenceInternedString(const char *str)
+{
+	MG_ASSERT(str);
+	MG_ASSERT(mgIsInternedString(str));
+
+	if (_mgIsInternTableShared())
+		mgAtomicIncrement(&_mgInternedStringHeader(str)->refCount);
+	else
+		++_mgInternedStringHeader(str)->refCount;
+
+	return str;
+}
+
+
+void mgReleaseInternedString(const char *str)
+{
+	MG_ASSERT(str);
+	MG_ASSERT(mgIsInternedString(str));
+
+	MGInternedString *interned = _mgInternedStringHeader(str);
+
+	if (!_mgIsInternTableShared())
+	{
+		MG_ASSERT(interned->refCount > 0);
+
+		if (--interned->refCount == 0)
+			_mgInternTableRemove(interned);
+
+		return;
+	}
+
+	// Only one thread releases the last reference, as the
+	// string is never referenced again once it reached zero
+	if (mgAtomicDecrement(&interned->refCount) > 0)
+		return;
+
+	mgLockMutex(_mgSharedInternMutex);
+	_mgInternTableRemove(interned);
+	mgUnlockMutex(_mgSharedInternMutex);
+}
+
+
+uint32_t mgInternedStringHash(const char *str)
+{
+	MG_ASSERT(str);
+	MG_ASSERT(mgIsInternedString(str));
+
+	return _mgInternedStringHeader(str)->hash;
+}
+
+
+size_t mgInternedStringLength(const char *str)
+{
+	MG_ASSERT(str);
+	MG_ASSERT(mgIsInternedString(str));
+
+	return _mgInternedStringHeader(str)->length;
+}
+
+
+MGbool mgIsInternedString(const char *str)
+{
+	MG_ASSERT(str);
+
+	MGbool found = MG_FALSE;
+
+	if (_mgIsInternTableShared())
+		mgLockMutex(_mgSharedInternMutex);
+
+	if (_mgInternTable.buckets)
+	{
+		const uint32_t hash = mgStringHash(str);
+
+		for (MGInternedString *interned = _mgInternTable.buckets[hash & (_mgInternTable.capacity - 1)]; interned; interned = interned->next)
+		{
+			if (interned->str == str)
+			{
+				found = MG_TRUE;
+				break;
+			}
+		}
+	}
+
+	if (_mgIsInternTableShared())
+		mgUnlockMutex(_mgSharedInternMutex);
+
+	return found;
+}
+
+
+MGInternTable* mgGetInternTable(void)
+{
+	return &_mgInternTable;
+}
+
+
+void mgShareInternTable(MGInternTable *table, MGMutex *mutex)
+{
+	MG_ASSERT((table == NULL) == (mutex == NULL));
+
+	// The cached strings hold references in the table shared until now
+	if (_mgIsInternTableShared())
+		_mgClearInternCache();
+
+	_mgSharedInternTable = table;
+	_mgSharedInternMutex = mutex;
+}
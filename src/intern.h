@@ -0,0 +1,38 @@
+#ifndef MODELGEN_INTERN_H
+#define MODELGEN_INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "thread.h"
+
+// Interned strings are shared, immutable and reference counted.
+// Equal interned strings are always the same pointer. Each thread
+// has its own table, so strings must not be shared between threads,
+// unless they share a table using mgShareInternTable.
+
+const char* mgInternString(const char *str);
+const char* mgInternStringEx(const char *str, size_t length);
+const char* mgInternStringHashed(const char *str, size_t length, uint32_t hash);
+
+const char* mgReferenceInternedString(const char *str);
+void mgReleaseInternedString(const char *str);
+
+uint32_t mgInternedStringHash(const char *str);
+size_t mgInternedStringLength(const char *str);
+
+MGbool mgIsInternedString(const char *str);
+
+typedef struct MGInternTable MGInternTable;
+
+MGInternTable* mgGetInternTable(void);
+
+// Makes the calling thread use the table of another thread, guarded
+// by mutex, or its own table again if both are NULL. While sharing,
+// the thread caches the strings it interned, and only locks mutex
+// when interning a string it has not cached, or releasing a string
+// for the last time
+void mgShareInternTable(MGInternTable *table, MGMutex *mutex);
+
+#endif
\ No newline at end of file
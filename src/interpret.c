@@ -9,23 +9,24 @@
 #include "types/primitive.h"
 #include "types/composite.h"
 #include "types/module.h"
+#include "types/vector.h"
 #include "callable.h"
+#include "range.h"
+#include "iterator.h"
+#include "parallel.h"
+#include "vm.h"
+#include "optimize.h"
 #include "error.h"
 #include "utilities.h"
 
 
 extern MGNode* mgReferenceNode(const MGNode *node);
 
-extern MGValue* _mg_rangei(int start, int stop, int step);
 
-
-static MGNode *_mgCurrentNode = NULL;
-
-
-static void _mgPushFatalStackFrame(const MGValue *module, const MGNode *node)
+void _mgPushFatalStackFrameEx(MGInstance *instance, const MGValue *module, const MGNode *node)
 {
 	if (node == NULL)
-		node = _mgCurrentNode;
+		node = instance->currentNode;
 
 	if (node)
 	{
@@ -36,11 +37,17 @@ static void _mgPushFatalStackFrame(const MGValue *module, const MGNode *node)
 
 		frame->caller = node;
 
-		mgPushStackFrame(module->data.module.instance, frame);
+		mgPushStackFrame(instance, frame);
 	}
 }
 
 
+void _mgPushFatalStackFrame(const MGValue *module, const MGNode *node)
+{
+	_mgPushFatalStackFrameEx(module->data.module.instance, module, node);
+}
+
+
 #define mgInterpreterFatalError(module, node, format, ...) \
 	do { \
 		_mgPushFatalStackFrame(module, node); \
@@ -65,51 +72,100 @@ static const MGBinOpType _MG_AUG_TO_BIN_OP_TYPES[] = {
 MGValue* _mgVisitNode(MGValue *module, MGNode *node);
 
 
+// Names passed to these are always interned strings. The instance
+// running the code is given explicitly by the VM, as it is not the
+// instance of the module in the worker instances of a parallel map
+void _mgSetLocalValueEx(MGInstance *instance, MGValue *module, const MGNode *node, const char *name, MGValue *value)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(instance->callStackTop);
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+	MG_ASSERT(name);
+
+	MGValue *locals = mgStackFrameCreateLocals(instance->callStackTop);
+
+	if (mgIsSharedValue(instance, locals))
+	{
+		_mgPushFatalStackFrameEx(instance, module, node);
+		mgFatalError("Error: Cannot modify local \"%s\" in a parallel map or task, as it was created outside of it", name);
+	}
+
+	mgMapSetInterned(locals, name, value);
+}
+
+
+void _mgSetValueEx(MGInstance *instance, MGValue *module, const MGNode *node, const char *name, MGValue *value)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(instance->callStackTop);
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+	MG_ASSERT(name);
+
+	const MGStackFrame *frame = instance->callStackTop;
+
+	// Locals captured outside of the running map or task are shared
+	// by its threads, while new locals are created in the call
+	const MGbool captured = frame->captured && mgMapGetInterned(frame->captured, name);
+
+	if ((frame->locals && mgMapGetInterned(frame->locals, name)) || (!captured && !mgModuleGetInterned(module, name)))
+		_mgSetLocalValueEx(instance, module, node, name, value);
+	else if (captured)
+	{
+		_mgPushFatalStackFrameEx(instance, module, node);
+		mgFatalError("Error: Cannot modify local \"%s\" in a parallel map or task, as it was created outside of it", name);
+	}
+	else
+	{
+		if (instance->sharedGlobals)
+		{
+			_mgPushFatalStackFrameEx(instance, module, node);
+			mgFatalError("Error: Cannot assign global \"%s\" in a parallel map or task", name);
+		}
+
+		mgModuleSetInterned(module, name, value);
+	}
+}
+
+
 void _mgSetLocalValue(MGValue *module, const char *name, MGValue *value)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
 	MG_ASSERT(module->data.module.instance);
-	MG_ASSERT(module->data.module.instance->callStackTop);
-	MG_ASSERT(module->data.module.instance->callStackTop->locals);
-	MG_ASSERT(name);
 
-	mgMapSet(module->data.module.instance->callStackTop->locals, name, value);
+	_mgSetLocalValueEx(module->data.module.instance, module, NULL, name, value);
 }
 
 
 void _mgSetValue(MGValue *module, const char *name, MGValue *value)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
 	MG_ASSERT(module->data.module.instance);
-	MG_ASSERT(module->data.module.instance->callStackTop);
-	MG_ASSERT(module->data.module.instance->callStackTop->locals);
-	MG_ASSERT(name);
 
-	if (mgMapGet(module->data.module.instance->callStackTop->locals, name) || !mgModuleGet(module, name))
-		_mgSetLocalValue(module, name, value);
-	else
-		mgModuleSet(module, name, value);
+	_mgSetValueEx(module->data.module.instance, module, NULL, name, value);
 }
 
 
 const MGValue* _mgGetValue(MGValue *module, const char *name)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(module->data.module.instance);
 	MG_ASSERT(module->data.module.instance->callStackTop);
-	MG_ASSERT(module->data.module.instance->callStackTop->locals);
 	MG_ASSERT(name);
 
-	const MGValue *value = mgMapGet(module->data.module.instance->callStackTop->locals, name);
+	const MGStackFrame *frame = module->data.module.instance->callStackTop;
+	const MGValue *value = frame->locals ? mgMapGetInterned(frame->locals, name) : NULL;
+
+	if (!value && frame->captured)
+		value = mgMapGetInterned(frame->captured, name);
 
 	if (!value)
-		value = mgModuleGet(module, name);
+		value = mgModuleGetInterned(module, name);
 
 	if (!value)
-		value = mgModuleGet(module->data.module.instance->base, name);
+		value = mgModuleGetInterned(module->data.module.instance->base, name);
 
 	if (!value)
 		_MG_FAIL(module, NULL, "Error: Undefined name \"%s\"", name);
@@ -124,7 +180,7 @@ static inline MGValue* _mgResolveSubscriptGet(MGValue *module, MGNode *node, MGV
 
 	if (!(value = mgValueSubscriptGet(collection, index)))
 		MG_FAIL("Error: %s is not subscriptable with %s",
-		        mgGetTypeName(collection->type), mgGetTypeName(index->type));
+		        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(index)));
 
 	return value;
 }
@@ -132,9 +188,16 @@ static inline MGValue* _mgResolveSubscriptGet(MGValue *module, MGNode *node, MGV
 
 static inline void _mgResolveSubscriptSet(MGValue *module, MGNode *node, MGValue *collection, MGValue *index, MGValue *value)
 {
+	if (mgIsSharedValue(module->data.module.instance, collection))
+		MG_FAIL("Error: Cannot modify %s in a parallel map or task, as it was created outside of it", mgGetTypeName(mgValueType(collection)));
+
+	if (mgIsImmutableValue(collection))
+		MG_FAIL("Error: %s is immutable, create a new %s instead of assigning its items",
+		        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(collection)));
+
 	if (!mgValueSubscriptSet(collection, index, value))
 		MG_FAIL("Error: %s is not subscriptable with %s",
-		        mgGetTypeName(collection->type), mgGetTypeName(index->type));
+		        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(index)));
 }
 
 
@@ -144,7 +207,7 @@ static inline MGValue* _mgResolveAttributeGet(MGValue *module, MGNode *node, MGV
 
 	if (!(value = mgValueAttributeGet(collection, key)))
 		MG_FAIL("Error: %s has no attribute %s",
-		        mgGetTypeName(collection->type), key);
+		        mgGetTypeName(mgValueType(collection)), key);
 
 	return value;
 }
@@ -152,16 +215,19 @@ static inline MGValue* _mgResolveAttributeGet(MGValue *module, MGNode *node, MGV
 
 static inline void _mgResolveAttributeSet(MGValue *module, MGNode *node, MGValue *collection, const char *key, MGValue *value)
 {
+	if (mgIsSharedValue(module->data.module.instance, collection))
+		MG_FAIL("Error: Cannot modify %s in a parallel map or task, as it was created outside of it", mgGetTypeName(mgValueType(collection)));
+
 	if (!mgValueAttributeSet(collection, key, value))
 		MG_FAIL("Error: %s has no attribute %s",
-		        mgGetTypeName(collection->type), key);
+		        mgGetTypeName(mgValueType(collection)), key);
 }
 
 
 static void _mgResolveAssignment(MGValue *module, MGNode *names, MGValue *values, MGbool local)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(names);
 	MG_ASSERT((names->type == MG_NODE_NAME) || (names->type == MG_NODE_SUBSCRIPT) || (names->type == MG_NODE_ATTRIBUTE) || (names->type == MG_NODE_TUPLE));
 	MG_ASSERT(values);
@@ -207,8 +273,19 @@ static void _mgResolveAssignment(MGValue *module, MGNode *names, MGValue *values
 	}
 	else if (names->type == MG_NODE_TUPLE)
 	{
-		if ((values->type != MG_TYPE_TUPLE) && (values->type != MG_TYPE_LIST))
-			_MG_FAIL(module, names, "Error: %s is not iterable", mgGetTypeName(values->type));
+		if (mgIsVectorValue(values))
+		{
+			if (_mgListLength(names->children) != mgVectorLength(values))
+				_MG_FAIL(module, names, "Error: Mismatched lengths for parallel assignment (%zu != %zu)", _mgListLength(names->children), mgVectorLength(values));
+
+			for (size_t i = 0; i < _mgListLength(names->children); ++i)
+				_mgResolveAssignment(module, _mgListGet(names->children, i), mgCreateValueFloat(mgVectorGet(values, i)), local);
+
+			return;
+		}
+
+		if ((mgValueType(values) != MG_TYPE_TUPLE) && (mgValueType(values) != MG_TYPE_LIST))
+			_MG_FAIL(module, names, "Error: %s is not iterable", mgGetTypeName(mgValueType(values)));
 
 		if (_mgListLength(names->children) != mgListLength(values))
 			_MG_FAIL(module, names, "Error: Mismatched lengths for parallel assignment (%zu != %zu)", _mgListLength(names->children), mgListLength(values));
@@ -222,7 +299,7 @@ static void _mgResolveAssignment(MGValue *module, MGNode *names, MGValue *values
 static MGValue* _mgVisitBlock(MGValue *module, MGNode *node)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(module->data.module.instance);
 	MG_ASSERT(module->data.module.instance->callStackTop);
 
@@ -244,7 +321,34 @@ static MGValue* _mgVisitBlock(MGValue *module, MGNode *node)
 }
 
 
-static MGValue* _mgVisitCall(MGValue *module, MGNode *node)
+static MGValue* _mgCallFunction(MGValue *module, MGNode *node, const char *name, const MGValue *func, size_t argc, const MGValue* const* argv)
+{
+	MGInstance *instance = module->data.module.instance;
+
+	if (mgIsCFunction(func))
+		return mgCallCFunction(instance, module, node, name, func, argc, argv);
+
+	MGStackFrame frame;
+
+	mgCreateStackFrame(&frame, mgReferenceValue(module));
+	mgSetCallLocals(instance, &frame, func);
+
+	frame.caller = node;
+	frame.callerName = name;
+
+	mgPushStackFrame(instance, &frame);
+
+	MGValue *value = mgCallEx(instance, &frame, func, argc, argv);
+
+	mgPopStackFrame(instance, &frame);
+	mgDestroyStackFrame(&frame);
+
+	return value;
+}
+
+
+// Script functions called in tail position are deferred until the calling frame has returned
+static MGValue* _mgVisitCallEx(MGValue *module, MGNode *node, MGbool isTailCall)
 {
 	MG_ASSERT(module);
 	MG_ASSERT(module->data.module.instance);
@@ -257,11 +361,16 @@ static MGValue* _mgVisitCall(MGValue *module, MGNode *node)
 	const MGValue *func = NULL;
 	const char *name = NULL;
 
+	// Values evaluated for the call, which are released after it
+	MGValue *callee = NULL;
+	MGValue *receiver = NULL;
+	MGBoundCFunction method = NULL;
+
 	if (nameNode->type == MG_NODE_NAME)
 	{
 		MG_ASSERT(nameNode->token);
 
-		_mgCurrentNode = node;
+		module->data.module.instance->currentNode = node;
 
 		name = nameNode->token->value.s;
 		func = _mgGetValue(module, name);
@@ -269,49 +378,75 @@ static MGValue* _mgVisitCall(MGValue *module, MGNode *node)
 		if (!func)
 			MG_FAIL("Error: Undefined name \"%s\"", name);
 	}
+	else if (nameNode->type == MG_NODE_ATTRIBUTE)
+	{
+		MG_ASSERT(_mgListLength(nameNode->children) == 2);
+
+		const MGNode *attributeNode = _mgListGet(nameNode->children, 1);
+		MG_ASSERT(attributeNode->type == MG_NODE_NAME);
+		MG_ASSERT(attributeNode->token);
+
+		receiver = _mgVisitNode(module, _mgListGet(nameNode->children, 0));
+
+		// Native methods are called without creating a bound function
+		const MGTypeData *type = mgGetType(mgValueType(receiver));
+		if (type->methodGet)
+			method = type->methodGet(attributeNode->token->value.s);
+
+		if (!method)
+		{
+			func = callee = _mgResolveAttributeGet(module, nameNode, receiver, attributeNode->token->value.s);
+
+			mgDestroyValue(receiver);
+			receiver = NULL;
+		}
+	}
 	else
-		func = _mgVisitNode(module, nameNode);
+		func = callee = _mgVisitNode(module, nameNode);
 
-	MG_ASSERT(func);
+	MG_ASSERT(func || method);
 
 	if (name == NULL)
 		name = "<anonymous>";
 
-	_MGList(MGValue*) args;
-	_mgListCreate(MGValue*, args, _mgListLength(node->children) - 1);
+	const size_t argc = _mgListLength(node->children) - 1;
+	MGValue **argv = mgValueStackPush(&instance->valueStack, argc);
 
-	for (size_t i = 0; i < _mgListCapacity(args); ++i)
+	for (size_t i = 0; i < argc; ++i)
 	{
-		_mgListAdd(MGValue*, args, _mgVisitNode(module, _mgListGet(node->children, i + 1)));
-		MG_ASSERT(_mgListGet(args, i));
+		argv[i] = _mgVisitNode(module, _mgListGet(node->children, i + 1));
+		MG_ASSERT(argv[i]);
 	}
 
-	MGStackFrame frame;
+	MGValue *value;
 
-	if (((func->type == MG_TYPE_FUNCTION) || (func->type == MG_TYPE_PROCEDURE)) && func->data.func.locals)
-		mgCreateStackFrameEx(&frame, mgReferenceValue(module), mgReferenceValue(func->data.func.locals));
+	if (method)
+		value = mgCallMethod(instance, module, node, name, method, receiver, argc, (const MGValue* const*) argv);
+	else if (isTailCall && ((mgValueType(func) == MG_TYPE_FUNCTION) || (mgValueType(func) == MG_TYPE_PROCEDURE)))
+	{
+		mgDeferTailCall(instance, module, node, name, func, argc, (const MGValue* const*) argv);
+		value = MG_NULL_VALUE;
+	}
 	else
-		mgCreateStackFrame(&frame, mgReferenceValue(module));
-
-	frame.caller = node;
-	frame.callerName = name;
-
-	mgPushStackFrame(instance, &frame);
+		value = _mgCallFunction(module, node, name, func, argc, (const MGValue* const*) argv);
 
-	MGValue *value = mgCallEx(instance, &frame, func, _mgListLength(args), (const MGValue* const*) _mgListItems(args));
+	for (size_t i = 0; i < argc; ++i)
+		mgDestroyValue(argv[i]);
+	mgValueStackPop(&instance->valueStack, argv, argc);
 
-	mgPopStackFrame(instance, &frame);
-	mgDestroyStackFrame(&frame);
+	if (callee)
+		mgDestroyValue(callee);
 
-	for (size_t i = 0; i < _mgListLength(args); ++i)
-		mgDestroyValue(_mgListGet(args, i));
-	_mgListDestroy(args);
+	if (receiver)
+		mgDestroyValue(receiver);
 
 	MG_ASSERT(value);
 
 	return value;
 }
 
+#define _mgVisitCall(module, node) _mgVisitCallEx(module, node, MG_FALSE)
+
 
 static MGValue* _mgVisitEmit(MGValue *module, MGNode *node)
 {
@@ -327,28 +462,53 @@ static MGValue* _mgVisitEmit(MGValue *module, MGNode *node)
 	MGValue *tuple = _mgVisitNode(module, _mgListGet(node->children, 0));
 	MG_ASSERT(tuple);
 
-	if (tuple->type != MG_TYPE_TUPLE)
+	if (mgIsVectorValue(tuple))
+	{
+		if (mgVectorLength(tuple) != vertexSize)
+			MG_FAIL("Error: Expected tuple with a length of %u, received \"%s\"",
+			        vertexSize, mgGetTypeName(mgValueType(tuple)));
+	}
+	else if (mgValueType(tuple) != MG_TYPE_TUPLE)
 		MG_FAIL("Error: Expected \"%s\", received \"%s\"",
-		        mgGetTypeName(MG_TYPE_TUPLE), mgGetTypeName(tuple->type));
-	else if (mgTupleLength(tuple) != vertexSize)
-		MG_FAIL("Error: Expected tuple with a length of %u, received a tuple with a length of %zu",
-		        vertexSize, mgTupleLength(tuple));
+		        mgGetTypeName(MG_TYPE_TUPLE), mgGetTypeName(mgValueType(tuple)));
 
 	const size_t vertexCount = _mgListLength(instance->vertices);
 
 	_mgListAddUninitialized(MGVertex, instance->vertices);
 	MGVertex *vertices = _mgListItems(instance->vertices);
 
-	for (unsigned int i = 0; i < vertexSize; ++i)
+	if (mgIsVectorValue(tuple))
+		memcpy(vertices[vertexCount], tuple->data.vec, vertexSize * sizeof(float));
+	else
 	{
-		if (mgTupleGet(tuple, i)->type == MG_TYPE_INTEGER)
-			vertices[vertexCount][i] = (float) mgTupleGet(tuple, i)->data.i;
-		else if (mgTupleGet(tuple, i)->type == MG_TYPE_FLOAT)
-			vertices[vertexCount][i] = mgTupleGet(tuple, i)->data.f;
-		else
-			MG_FAIL("Error: Expected \"%s\" or \"%s\", received \"%s\"",
-			        mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
-			        mgGetTypeName(tuple->type));
+		// Vectors in the tuple are flattened into their components
+		unsigned int count = 0;
+
+		for (size_t i = 0; i < mgTupleLength(tuple); ++i)
+		{
+			const MGValue *component = mgTupleGet(tuple, i);
+
+			if (mgIsVectorValue(component))
+			{
+				for (size_t j = 0; j < mgVectorLength(component); ++j, ++count)
+					if (count < vertexSize)
+						vertices[vertexCount][count] = mgVectorGet(component, j);
+			}
+			else if (mgIsNumericValue(component))
+			{
+				if (count < vertexSize)
+					vertices[vertexCount][count] = _mgNumericGet(component);
+				++count;
+			}
+			else
+				MG_FAIL("Error: Expected \"%s\" or \"%s\", received \"%s\"",
+				        mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
+				        mgGetTypeName(mgValueType(tuple)));
+		}
+
+		if (count != vertexSize)
+			MG_FAIL("Error: Expected tuple with a length of %u, received a tuple with a length of %u",
+			        vertexSize, count);
 	}
 
 	++_mgListLength(instance->vertices);
@@ -374,7 +534,22 @@ static inline MGValue* _mgVisitReturn(MGValue *module, MGNode *node)
 	}
 
 	if (_mgListLength(node->children) > 0)
-		frame->value = _mgVisitNode(module, _mgListGet(node->children, 0));
+	{
+		MGNode *valueNode = _mgListGet(node->children, 0);
+
+		if (valueNode->type == MG_NODE_CALL)
+		{
+			// Only calls returned from functions reuse the frame
+			MGbool isTailCall = MG_FALSE;
+
+			for (const MGNode *parent = node->parent; parent && !isTailCall; parent = parent->parent)
+				isTailCall = (parent->type == MG_NODE_FUNCTION) || (parent->type == MG_NODE_PROCEDURE);
+
+			frame->value = _mgVisitCallEx(module, valueNode, isTailCall);
+		}
+		else
+			frame->value = _mgVisitNode(module, valueNode);
+	}
 
 	frame->state = MG_STACK_FRAME_STATE_RETURN;
 
@@ -389,7 +564,7 @@ static void _mgDelete(MGValue *module, MGNode *node)
 		MG_ASSERT(node->token);
 
 #if MG_DEBUG
-		_mgCurrentNode = node;
+		module->data.module.instance->currentNode = node;
 
 		// Check if the name is defined
 		_mgGetValue(module, node->token->value.s);
@@ -457,6 +632,150 @@ static inline MGValue* _mgVisitDelete(MGValue *module, MGNode *node)
 }
 
 
+static void _mgVisitRangeBounds(MGValue *module, MGNode *node, MGRange *range)
+{
+	MG_ASSERT((_mgListLength(node->children) == 2) || (_mgListLength(node->children) == 3));
+
+	MGValue *start = NULL, *stop = NULL, *step = NULL;
+
+	start = _mgVisitNode(module, _mgListGet(node->children, 0));
+	MG_ASSERT(start);
+	MG_ASSERT(mgValueType(start) == MG_TYPE_INTEGER);
+
+	stop = _mgVisitNode(module, _mgListGet(node->children, 1));
+	MG_ASSERT(stop);
+	MG_ASSERT(mgValueType(stop) == MG_TYPE_INTEGER);
+
+	if (_mgListLength(node->children) == 3)
+	{
+		step = _mgVisitNode(module, _mgListGet(node->children, 2));
+		MG_ASSERT(step);
+		MG_ASSERT(mgValueType(step) == MG_TYPE_INTEGER);
+	}
+
+	mgCreateRangeInteger(range, mgIntegerGet(start), mgIntegerGet(stop), (_mgListLength(node->children) == 3) ? mgIntegerGet(step) : 0);
+}
+
+
+// Loops over range(...) step through the range instead of creating
+// the list, unless range has been rebound to something else
+static MGbool _mgVisitRangeCall(MGValue *module, MGNode *node, MGRange *range)
+{
+	if ((node->type != MG_NODE_CALL) || (_mgListGet(node->children, 0)->type != MG_NODE_NAME))
+		return MG_FALSE;
+
+	MGInstance *instance = module->data.module.instance;
+
+	const MGNode *nameNode = _mgListGet(node->children, 0);
+	MG_ASSERT(nameNode->token);
+
+	const MGValue *func = _mgGetValue(module, nameNode->token->value.s);
+
+	if (!func || !mgIsRangeFunction(func))
+		return MG_FALSE;
+
+	const size_t argc = _mgListLength(node->children) - 1;
+	MGValue **argv = mgValueStackPush(&instance->valueStack, argc);
+
+	for (size_t i = 0; i < argc; ++i)
+	{
+		argv[i] = _mgVisitNode(module, _mgListGet(node->children, i + 1));
+		MG_ASSERT(argv[i]);
+	}
+
+	mgCallRange(instance, module, node, nameNode->token->value.s, argc, (const MGValue* const*) argv, range);
+
+	for (size_t i = 0; i < argc; ++i)
+		mgDestroyValue(argv[i]);
+	mgValueStackPop(&instance->valueStack, argv, argc);
+
+	return MG_TRUE;
+}
+
+
+#define _mgIsIterableCall(node) (((node)->type == MG_NODE_CALL) && (_mgListGet((node)->children, 0)->type != MG_NODE_ATTRIBUTE))
+
+
+// Visits a call which a loop iterates, returning an iterator instead if its
+// function has a lazy counterpart, e.g. map(f, filter(g, items)), while
+// other functions receive lists
+static MGValue* _mgVisitIterableCall(MGValue *module, MGNode *node)
+{
+	MG_ASSERT(_mgIsIterableCall(node));
+
+	MGInstance *instance = module->data.module.instance;
+
+	MGNode *nameNode = _mgListGet(node->children, 0);
+
+	const MGValue *func = NULL;
+	const char *name = "<anonymous>";
+
+	MGValue *callee = NULL;
+
+	if (nameNode->type == MG_NODE_NAME)
+	{
+		MG_ASSERT(nameNode->token);
+
+		module->data.module.instance->currentNode = node;
+
+		name = nameNode->token->value.s;
+		func = _mgGetValue(module, name);
+
+		if (!func)
+			MG_FAIL("Error: Undefined name \"%s\"", name);
+	}
+	else
+		func = callee = _mgVisitNode(module, nameNode);
+
+	const size_t argc = _mgListLength(node->children) - 1;
+	MGValue **argv = mgValueStackPush(&instance->valueStack, argc);
+
+	for (size_t i = 0; i < argc; ++i)
+	{
+		MGNode *argument = _mgListGet(node->children, i + 1);
+
+		argv[i] = _mgIsIterableCall(argument) ? _mgVisitIterableCall(module, argument) : _mgVisitNode(module, argument);
+		MG_ASSERT(argv[i]);
+	}
+
+	MGIteratorCFunction iterate = mgGetIteratorFunction(func);
+	MGValue *value;
+
+	if (iterate)
+		value = mgCallIterator(instance, module, node, name, iterate, argc, (const MGValue* const*) argv);
+	else
+	{
+		mgMaterializeIterators(argc, argv);
+
+		value = _mgCallFunction(module, node, name, func, argc, (const MGValue* const*) argv);
+	}
+
+	for (size_t i = 0; i < argc; ++i)
+		mgDestroyValue(argv[i]);
+	mgValueStackPop(&instance->valueStack, argv, argc);
+
+	if (callee)
+		mgDestroyValue(callee);
+
+	MG_ASSERT(value);
+
+	return value;
+}
+
+
+// Returns a new reference to the next item of a list, tuple,
+// iterator or, if there is no iterable, the range, or NULL
+static inline MGValue* _mgIterableNext(MGValue *iterable, const MGRange *range, size_t index)
+{
+	if (!iterable)
+		return (index < (size_t) range->length) ? mgRangeGet(range, (int) index) : NULL;
+	else if (mgValueType(iterable) == MG_TYPE_ITERATOR)
+		return mgIteratorNext(iterable);
+	else
+		return (index < _mgListLength(iterable->data.a)) ? mgReferenceValue(_mgListGet(iterable->data.a, index)) : NULL;
+}
+
+
 static MGValue* _mgVisitFor(MGValue *module, MGNode *node)
 {
 	MG_ASSERT(module);
@@ -466,18 +785,42 @@ static MGValue* _mgVisitFor(MGValue *module, MGNode *node)
 	MGNode *name = _mgListGet(node->children, 0);
 	MG_ASSERT(name);
 
-	MGValue *iterable = _mgVisitNode(module, _mgListGet(node->children, 1));
-	MG_ASSERT(iterable);
-	MG_ASSERT((iterable->type == MG_TYPE_TUPLE) || (iterable->type == MG_TYPE_LIST));
+	MGNode *iterableNode = _mgListGet(node->children, 1);
+	MG_ASSERT(iterableNode);
+
+	MGValue *iterable = NULL;
+	MGRange range;
+
+	if (iterableNode->type == MG_NODE_RANGE)
+		_mgVisitRangeBounds(module, iterableNode, &range);
+	else if (!_mgVisitRangeCall(module, iterableNode, &range))
+	{
+		iterable = _mgIsIterableCall(iterableNode) ? _mgVisitIterableCall(module, iterableNode) : _mgVisitNode(module, iterableNode);
+		MG_ASSERT(iterable);
+
+		// Lists and tuples are indexed directly
+		if ((mgValueType(iterable) != MG_TYPE_TUPLE) && (mgValueType(iterable) != MG_TYPE_LIST))
+		{
+			MGValue *iterator = mgCreateIterator(iterable);
+
+			if (!iterator)
+				MG_FAIL("Error: %s is not iterable", mgGetTypeName(mgValueType(iterable)));
+
+			mgDestroyValue(iterable);
+			iterable = iterator;
+		}
+	}
 
 	MGStackFrame *frame = module->data.module.instance->callStackTop;
 
-	MGValue *value = NULL;
+	MGValue *value = NULL, *item;
 
-	for (size_t i = 0; i < _mgListLength(iterable->data.a); ++i)
+	for (size_t i = 0; (item = _mgIterableNext(iterable, &range, i)); ++i)
 	{
-		value = _mgListGet(iterable->data.a, i);
-		MG_ASSERT(value);
+		if (value)
+			mgDestroyValue(value);
+
+		value = item;
 
 		_mgResolveAssignment(module, name, value, MG_TRUE);
 
@@ -489,13 +832,20 @@ static MGValue* _mgVisitFor(MGValue *module, MGNode *node)
 
 			if (frame->state == MG_STACK_FRAME_STATE_RETURN)
 			{
+				mgDestroyValue(value);
 				value = frame->value ? mgReferenceValue(frame->value) : MG_NULL_VALUE;
 				goto end;
 			}
 			else if (frame->state == MG_STACK_FRAME_STATE_BREAK)
 			{
 				frame->state = MG_STACK_FRAME_STATE_ACTIVE;
-				value = frame->value ? mgReferenceValue(frame->value) : mgReferenceValue(value);
+
+				if (frame->value)
+				{
+					mgDestroyValue(value);
+					value = mgReferenceValue(frame->value);
+				}
+
 				goto end;
 			}
 			else if (frame->state == MG_STACK_FRAME_STATE_CONTINUE)
@@ -506,12 +856,10 @@ static MGValue* _mgVisitFor(MGValue *module, MGNode *node)
 		}
 	}
 
-	if (value)
-		value = mgReferenceValue(value);
-
 end:
 
-	mgDestroyValue(iterable);
+	if (iterable)
+		mgDestroyValue(iterable);
 
 	return value ? value : MG_NULL_VALUE;
 }
@@ -527,9 +875,9 @@ static MGValue* _mgVisitWhile(MGValue *module, MGNode *node)
 	{
 		MGValue *condition = _mgVisitNode(module, _mgListGet(node->children, 0));
 		MG_ASSERT(condition);
-		MG_ASSERT(condition->type == MG_TYPE_INTEGER);
+		MG_ASSERT(mgValueType(condition) == MG_TYPE_INTEGER);
 
-		if (!condition->data.i)
+		if (!mgIntegerGet(condition))
 		{
 			mgDestroyValue(condition);
 			break;
@@ -652,8 +1000,8 @@ static MGValue* _mgVisitFunction(MGValue *module, MGNode *node)
 		}
 	}
 
-	if (isClosure && module->data.module.instance->callStackTop && module->data.module.instance->callStackTop->locals)
-		func->data.func.locals = mgReferenceValue(module->data.module.instance->callStackTop->locals);
+	if (isClosure && module->data.module.instance->callStackTop)
+		func->data.func.locals = mgReferenceValue(mgStackFrameCaptureLocals(module->data.module.instance->callStackTop));
 	else
 		func->data.func.locals = NULL;
 
@@ -761,57 +1109,56 @@ static inline MGValue* _mgVisitName(MGValue *module, MGNode *node)
 {
 	MG_ASSERT(node->token);
 
-	_mgCurrentNode = node;
+	module->data.module.instance->currentNode = node;
 
 	return mgReferenceValue(_mgGetValue(module, node->token->value.s));
 }
 
 
-static MGValue* _mgVisitInteger(MGValue *module, MGNode *node)
+#if defined(__GNUC__)
+static inline __attribute__((always_inline)) MGValue* _mgVisitNumber(MGValue *module, MGNode *node)
+#elif defined(_MSC_VER)
+static __forceinline MGValue* _mgVisitNumber(MGValue *module, MGNode *node)
+#else
+static inline MGValue* _mgVisitNumber(MGValue *module, MGNode *node)
+#endif
 {
-	MG_ASSERT(node->token);
-
-	const size_t _valueLength = node->token->end.string - node->token->begin.string;
-	MG_ASSERT(_valueLength > 0);
-	char *_value = mgStringDuplicateFixed(node->token->begin.string, _valueLength);
-	MG_ASSERT(_value);
+	// Decoded once by the parser, and owned by the node
+	MG_ASSERT(node->value);
 
-	MGValue *value = mgCreateValueInteger(strtol(_value, NULL, 10));
-
-	free(_value);
-
-	return value;
+	return mgReferenceValue(node->value);
 }
 
 
-static MGValue* _mgVisitFloat(MGValue *module, MGNode *node)
+#if defined(__GNUC__)
+static inline __attribute__((always_inline)) MGValue* _mgVisitString(MGValue *module, MGNode *node)
+#elif defined(_MSC_VER)
+static __forceinline MGValue* _mgVisitString(MGValue *module, MGNode *node)
+#else
+static inline MGValue* _mgVisitString(MGValue *module, MGNode *node)
+#endif
 {
 	MG_ASSERT(node->token);
 
-	const size_t _valueLength = node->token->end.string - node->token->begin.string;
-	MG_ASSERT(_valueLength > 0);
-	char *_value = mgStringDuplicateFixed(node->token->begin.string, _valueLength);
-	MG_ASSERT(_value);
-
-	MGValue *value = mgCreateValueFloat(strtof(_value, NULL));
-
-	free(_value);
-
-	return value;
+	return mgCreateValueInternedString(node->token->value.s);
 }
 
 
 #if defined(__GNUC__)
-static inline __attribute__((always_inline)) MGValue* _mgVisitString(MGValue *module, MGNode *node)
+static inline __attribute__((always_inline)) MGValue* _mgVisitConstant(MGValue *module, MGNode *node)
 #elif defined(_MSC_VER)
-static __forceinline MGValue* _mgVisitString(MGValue *module, MGNode *node)
+static __forceinline MGValue* _mgVisitConstant(MGValue *module, MGNode *node)
 #else
-static inline MGValue* _mgVisitString(MGValue *module, MGNode *node)
+static inline MGValue* _mgVisitConstant(MGValue *module, MGNode *node)
 #endif
 {
-	MG_ASSERT(node->token);
+	MG_ASSERT(node->value);
+
+	// Tuples and lists can be mutated, so each evaluation gets a copy
+	if ((mgValueType(node->value) == MG_TYPE_TUPLE) || (mgValueType(node->value) == MG_TYPE_LIST))
+		return mgListConstantCopy(node->value);
 
-	return mgCreateValueString(node->token->value.s);
+	return mgReferenceValue(node->value);
 }
 
 
@@ -831,26 +1178,10 @@ static MGValue* _mgVisitTuple(MGValue *module, MGNode *node)
 
 static MGValue* _mgVisitRange(MGValue *module, MGNode *node)
 {
-	MG_ASSERT((_mgListLength(node->children) == 2) || (_mgListLength(node->children) == 3));
+	MGRange range;
+	_mgVisitRangeBounds(module, node, &range);
 
-	MGValue *start = NULL, *stop = NULL, *step = NULL;
-
-	start = _mgVisitNode(module, _mgListGet(node->children, 0));
-	MG_ASSERT(start);
-	MG_ASSERT(start->type == MG_TYPE_INTEGER);
-
-	stop = _mgVisitNode(module, _mgListGet(node->children, 1));
-	MG_ASSERT(stop);
-	MG_ASSERT(stop->type == MG_TYPE_INTEGER);
-
-	if (_mgListLength(node->children) == 3)
-	{
-		step = _mgVisitNode(module, _mgListGet(node->children, 2));
-		MG_ASSERT(step);
-		MG_ASSERT(step->type == MG_TYPE_INTEGER);
-	}
-
-	return _mg_rangei(start->data.i, stop->data.i, (_mgListLength(node->children) == 3) ? step->data.i : 0);
+	return mgRangeToList(&range);
 }
 
 
@@ -867,11 +1198,14 @@ static MGValue* _mgVisitMap(MGValue *module, MGNode *node)
 		MGValue *key = _mgVisitNode(module, _mgListGet(node->children, i));
 
 		MG_ASSERT(key);
-		MG_ASSERT(key->type == MG_TYPE_STRING);
+		MG_ASSERT(mgValueType(key) == MG_TYPE_STRING);
 		MG_ASSERT(key->data.str.s);
 		MG_ASSERT(value);
 
-		mgMapSet(map, key->data.str.s, value);
+		if (key->data.str.usage == MG_STRING_USAGE_INTERNED)
+			mgMapSetInterned(map, key->data.str.s, value);
+		else
+			mgMapSet(map, key->data.str.s, value);
 
 		mgDestroyValue(key);
 	}
@@ -1023,7 +1357,7 @@ static MGValue* _mgVisitBinOpLogical(MGValue *module, MGNode *node)
 		}
 		break;
 	case MG_NODE_BIN_OP_COALESCE:
-		if (lhs->type != MG_TYPE_NULL)
+		if (mgValueType(lhs) != MG_TYPE_NULL)
 			value = mgReferenceValue(lhs);
 		else
 		{
@@ -1040,10 +1374,10 @@ static MGValue* _mgVisitBinOpLogical(MGValue *module, MGNode *node)
 	{
 		if (rhs)
 			MG_FAIL("Error: Unsupported binary operator %s for left-hand type %s and right-hand type %s",
-			        _MG_NODE_NAMES[node->type], mgGetTypeName(lhs->type), mgGetTypeName(rhs->type));
+			        _MG_NODE_NAMES[node->type], mgGetTypeName(mgValueType(lhs)), mgGetTypeName(mgValueType(rhs)));
 		else
 			MG_FAIL("Error: Unsupported binary operator %s for left-hand type %s",
-			        _MG_NODE_NAMES[node->type], mgGetTypeName(lhs->type));
+			        _MG_NODE_NAMES[node->type], mgGetTypeName(mgValueType(lhs)));
 	}
 
 	mgDestroyValue(lhs);
@@ -1089,7 +1423,7 @@ static inline void _mgResolveImportAs(MGValue *module, MGToken *name, MGToken *a
 
 	MGValue *importedModule = mgImportModule(module->data.module.instance, name->value.s);
 	MG_ASSERT(importedModule);
-	MG_ASSERT(importedModule->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(importedModule) == MG_TYPE_MODULE);
 
 	_mgSetValue(module, alias->value.s, importedModule);
 }
@@ -1098,7 +1432,7 @@ static inline void _mgResolveImportAs(MGValue *module, MGToken *name, MGToken *a
 static MGValue* _mgVisitImport(MGValue *module, MGNode *node)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(node);
 	MG_ASSERT((node->type == MG_NODE_IMPORT) || (node->type == MG_NODE_IMPORT_FROM));
 	MG_ASSERT(_mgListLength(node->children) > 0);
@@ -1129,7 +1463,7 @@ static MGValue* _mgVisitImport(MGValue *module, MGNode *node)
 
 		MGValue *importedModule = mgImportModule(module->data.module.instance, nameNode->token->value.s);
 		MG_ASSERT(importedModule);
-		MG_ASSERT(importedModule->type == MG_TYPE_MODULE);
+		MG_ASSERT(mgValueType(importedModule) == MG_TYPE_MODULE);
 
 		if (_mgListLength(node->children) > 1)
 		{
@@ -1154,7 +1488,7 @@ static MGValue* _mgVisitImport(MGValue *module, MGNode *node)
 				MG_ASSERT(nameNode->type == MG_NODE_NAME);
 				MG_ASSERT(nameNode->token);
 
-				const MGValue *value = mgModuleGet(importedModule, nameNode->token->value.s);
+				const MGValue *value = mgModuleGetInterned(importedModule, nameNode->token->value.s);
 
 				if (!value)
 					// _MG_FAIL(module, NULL, "Error: Undefined name \"%s\"", nameNode->token->value.s);
@@ -1191,14 +1525,14 @@ static MGValue* _mgVisitAssert(MGValue *module, MGNode *node)
 	MG_ASSERT((_mgListLength(node->children) == 1) || (_mgListLength(node->children) == 2));
 
 	MGValue *expression = _mgVisitNode(module, _mgListGet(node->children, 0));
-	MG_ASSERT(expression->type == MG_TYPE_INTEGER);
+	MG_ASSERT(mgValueType(expression) == MG_TYPE_INTEGER);
 
-	if (!expression->data.i)
+	if (!mgIntegerGet(expression))
 	{
 		if (_mgListLength(node->children) == 2)
 		{
 			MGValue *message = _mgVisitNode(module, _mgListGet(node->children, 1));
-			MG_ASSERT(message->type == MG_TYPE_STRING);
+			MG_ASSERT(mgValueType(message) == MG_TYPE_STRING);
 
 			MG_FAIL("Error: %s", message->data.str.s);
 
@@ -1226,11 +1560,12 @@ MGValue* _mgVisitNode(MGValue *module, MGNode *node)
 	case MG_NODE_NAME:
 		return _mgVisitName(module, node);
 	case MG_NODE_INTEGER:
-		return _mgVisitInteger(module, node);
 	case MG_NODE_FLOAT:
-		return _mgVisitFloat(module, node);
+		return _mgVisitNumber(module, node);
 	case MG_NODE_STRING:
 		return _mgVisitString(module, node);
+	case MG_NODE_CONSTANT:
+		return _mgVisitConstant(module, node);
 	case MG_NODE_TUPLE:
 	case MG_NODE_LIST:
 		return _mgVisitTuple(module, node);
@@ -1330,11 +1665,16 @@ MGValue* _mgVisitNode(MGValue *module, MGNode *node)
 inline MGValue* mgInterpret(MGValue *module)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(module->data.module.instance);
 	MG_ASSERT(module->data.module.parser.root);
 
-	return _mgVisitNode(module, module->data.module.parser.root);
+	mgOptimize(module->data.module.parser.root);
+
+	if (module->data.module.instance->walkAST)
+		return _mgVisitNode(module, module->data.module.parser.root);
+
+	return mgExecute(module->data.module.instance, module, mgCompile(module->data.module.parser.root), 0, NULL);
 }
 
 
@@ -0,0 +1,127 @@
+
+#include "iterator.h"
+#include "types/composite.h"
+#include "debug.h"
+
+
+extern MGIteratorCFunction _mg_iterator_function(MGCFunction func);
+
+
+MGValue* mgCreateValueIterator(MGInstance *instance, MGIteratorNext next, size_t capacity)
+{
+	MG_ASSERT(next);
+
+	MGValue *iterator = mgCreateValue(MG_TYPE_ITERATOR);
+
+	iterator->data.iter = (MGIteratorState*) mgAllocate(sizeof(MGIteratorState));
+	MG_ASSERT(iterator->data.iter);
+
+	iterator->data.iter->next = next;
+	iterator->data.iter->instance = instance;
+	iterator->data.iter->module = NULL;
+	iterator->data.iter->caller = NULL;
+	iterator->data.iter->callerName = NULL;
+	iterator->data.iter->callable = NULL;
+	iterator->data.iter->window = NULL;
+	iterator->data.iter->index = 0;
+	iterator->data.iter->count = 0;
+
+	if (capacity > 0)
+		_mgListCreate(MGValue*, iterator->data.iter->values, capacity);
+	else
+		_mgListInitialize(iterator->data.iter->values);
+
+	return iterator;
+}
+
+
+MGValue* mgCreateIterator(const MGValue *value)
+{
+	const MGTypeData *type = mgGetType(mgValueType(value));
+
+	return type->iterate ? type->iterate(value) : NULL;
+}
+
+
+static MGValue* _mgRangeIteratorNext(MGValue *iterator)
+{
+	if (iterator->data.iter->index >= iterator->data.iter->count)
+		return NULL;
+
+	return mgRangeItem(_mgListGet(iterator->data.iter->values, 0), _mgListGet(iterator->data.iter->values, 1), (int) iterator->data.iter->index++);
+}
+
+
+MGValue* mgCreateRangeIterator(const MGRange *range)
+{
+	MGValue *iterator = mgCreateValueIterator(NULL, _mgRangeIteratorNext, 2);
+
+	_mgListAdd(MGValue*, iterator->data.iter->values, range->start);
+	_mgListAdd(MGValue*, iterator->data.iter->values, range->step);
+
+	iterator->data.iter->count = range->length;
+
+	return iterator;
+}
+
+
+MGValue* mgIteratorIterate(const MGValue *iterator)
+{
+	return mgReferenceValue(iterator);
+}
+
+
+MGValue* mgIteratorToList(MGValue *iterator)
+{
+	MG_ASSERT(mgValueType(iterator) == MG_TYPE_ITERATOR);
+
+	MGValue *list = mgCreateValueList(0);
+
+	for (MGValue *item; (item = mgIteratorNext(iterator));)
+		mgListAdd(list, item);
+
+	return list;
+}
+
+
+MGIteratorCFunction mgGetIteratorFunction(const MGValue *func)
+{
+	return (mgValueType(func) == MG_TYPE_CFUNCTION) ? _mg_iterator_function(func->data.cfunc) : NULL;
+}
+
+
+MGValue* mgCallIterator(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                        MGIteratorCFunction func, size_t argc, const MGValue* const* argv)
+{
+	MGStackFrame frame;
+	_mgInitCFunctionFrame(instance, frame, module, caller, callerName);
+
+	instance->callStackTop = &frame;
+
+	MGValue *iterator = func(instance, argc, argv);
+	MG_ASSERT(mgValueType(iterator) == MG_TYPE_ITERATOR);
+
+	instance->callStackTop = frame.last;
+
+	iterator->data.iter->instance = instance;
+	iterator->data.iter->module = module;
+	iterator->data.iter->caller = caller;
+	iterator->data.iter->callerName = callerName;
+
+	return iterator;
+}
+
+
+void mgMaterializeIterators(size_t argc, MGValue **argv)
+{
+	for (size_t i = 0; i < argc; ++i)
+	{
+		if (mgValueType(argv[i]) == MG_TYPE_ITERATOR)
+		{
+			MGValue *list = mgIteratorToList(argv[i]);
+
+			mgDestroyValue(argv[i]);
+			argv[i] = list;
+		}
+	}
+}
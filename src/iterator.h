@@ -0,0 +1,63 @@
+#ifndef MODELGEN_ITERATOR_H
+#define MODELGEN_ITERATOR_H
+
+#include "value.h"
+#include "instance.h"
+#include "callable.h"
+#include "range.h"
+
+// Iterators are only created for loops, which step through collections
+// and the results of functions such as map() and filter() without
+// creating intermediate lists. They are never exposed to scripts, as
+// iterators passed to other functions are turned into lists.
+//
+// Iterators over lists, maps and buffers stop at the length they had
+// when the iterator was created, so items added by the loop body are
+// not iterated. Callbacks of map() and filter() in a loop are called
+// as each item is reached, between iterations of the loop body, rather
+// than for every item before the loop starts.
+
+// Creates an iterator over what calling the C function it replaces would return
+typedef MGValue* (*MGIteratorCFunction)(MGInstance *instance, size_t argc, const MGValue* const* argv);
+
+MGValue* mgCreateValueIterator(MGInstance *instance, MGIteratorNext next, size_t capacity);
+
+static inline MGValue* mgIteratorNext(MGValue *iterator)
+{
+	if (!iterator->data.iter->caller)
+		return iterator->data.iter->next(iterator);
+
+	MGInstance *instance = iterator->data.iter->instance;
+
+	MGStackFrame frame;
+	_mgInitCFunctionFrame(instance, frame, iterator->data.iter->module, iterator->data.iter->caller, iterator->data.iter->callerName);
+
+	instance->callStackTop = &frame;
+
+	MGValue *item = iterator->data.iter->next(iterator);
+
+	instance->callStackTop = frame.last;
+
+	return item;
+}
+
+// Returns an iterator over value, or NULL if it is not iterable
+MGValue* mgCreateIterator(const MGValue *value);
+MGValue* mgCreateRangeIterator(const MGRange *range);
+
+MGValue* mgIteratorIterate(const MGValue *iterator);
+
+// Returns a list of the remaining items
+MGValue* mgIteratorToList(MGValue *iterator);
+
+// Returns the lazy counterpart of func, e.g. of map() and filter(), if any
+MGIteratorCFunction mgGetIteratorFunction(const MGValue *func);
+
+MGValue* mgCallIterator(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                        MGIteratorCFunction func, size_t argc, const MGValue* const* argv);
+
+// Replaces iterators with lists, before passing
+// them to functions without lazy counterparts
+void mgMaterializeIterators(size_t argc, MGValue **argv);
+
+#endif
\ No newline at end of file
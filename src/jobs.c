@@ -0,0 +1,296 @@
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#   define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "jobs.h"
+#include "instance.h"
+#include "thread.h"
+#include "format.h"
+#include "file.h"
+#include "types/primitive.h"
+#include "types/composite.h"
+#include "debug.h"
+
+
+typedef struct MGJobQueue {
+	const MGJobOptions *options;
+	MGJob *jobs;
+	size_t jobCount;
+	size_t next;
+	MGMutex mutex;
+} MGJobQueue;
+
+
+static double _mgJobTime(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER time, frequency;
+
+	QueryPerformanceCounter(&time);
+	QueryPerformanceFrequency(&frequency);
+
+	return (double) time.QuadPart / (double) frequency.QuadPart;
+#else
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+#endif
+}
+
+
+static char* _mgJobExportFilename(const char *exportFilename, const char *filename)
+{
+	const char *name = mgBasename(filename);
+	const char *extension = strrchr(name, '.');
+	const size_t nameLength = extension ? (size_t) (extension - name) : strlen(name);
+
+	const size_t placeholderLength = strlen(MG_JOB_EXPORT_NAME);
+
+	size_t length = 0;
+
+	for (const char *s = exportFilename; *s;)
+	{
+		if (!strncmp(s, MG_JOB_EXPORT_NAME, placeholderLength))
+		{
+			length += nameLength;
+			s += placeholderLength;
+		}
+		else
+		{
+			++length;
+			++s;
+		}
+	}
+
+	char *result = (char*) malloc((length + 1) * sizeof(char));
+	MG_ASSERT(result);
+
+	char *end = result;
+
+	for (const char *s = exportFilename; *s;)
+	{
+		if (!strncmp(s, MG_JOB_EXPORT_NAME, placeholderLength))
+		{
+			memcpy(end, name, nameLength * sizeof(char));
+			end += nameLength;
+			s += placeholderLength;
+		}
+		else
+			*end++ = *s++;
+	}
+
+	*end = '\0';
+
+	return result;
+}
+
+
+static void _mgRunJob(const MGJobOptions *options, MGJob *job)
+{
+	const double start = _mgJobTime();
+
+	if (!mgFileExists(job->filename))
+	{
+		fprintf(stderr, "Error: File not found \"%s\"\n", job->filename);
+		job->failed = MG_TRUE;
+		return;
+	}
+
+	MGInstance instance;
+	mgCreateInstance(&instance);
+
+	instance.vertexSize.position = 3;
+	instance.vertexSize.normal = 3;
+	instance.walkAST = options->walkAST;
+
+	// Files already run in parallel, so pmap runs sequentially
+	instance.threadCount = 1;
+
+	// Uniforms are strings given by --set, which are copied as values
+	// must not be shared between instances on different threads
+	if (options->uniforms)
+	{
+		const MGValueMap *uniforms = &options->uniforms->data.m;
+
+		for (size_t i = 0; i < _mgMapSize(*uniforms); ++i)
+		{
+			const MGValueMapPair *pair = &_mgListGet(uniforms->pairs, i);
+			MG_ASSERT(mgValueType(pair->value) == MG_TYPE_STRING);
+
+			mgMapSet(instance.uniforms, pair->key, mgCreateValueString(mgStringGet(pair->value)));
+		}
+	}
+
+	mgRunFile(&instance, job->filename, NULL);
+
+	job->vertexCount = _mgListLength(instance.vertices);
+
+	if (job->exportFilename)
+	{
+		FILE *f = fopen(job->exportFilename, options->exportOBJ ? "w" : "wb");
+
+		if (f)
+		{
+			if (options->exportOBJ)
+				mgExportOBJ(&instance, f);
+			else if (options->exportTriangles)
+				mgExportTriangles(&instance, f);
+			else if (options->exportIndexedTriangles)
+				mgExportIndexedTriangles(&instance, f);
+
+			fclose(f);
+		}
+		else
+		{
+			fprintf(stderr, "Error: Failed opening file \"%s\"\n", job->exportFilename);
+			job->failed = MG_TRUE;
+		}
+	}
+
+	mgDestroyInstance(&instance);
+
+	job->seconds = _mgJobTime() - start;
+}
+
+
+static void _mgJobWorker(void *data)
+{
+	MGJobQueue *queue = (MGJobQueue*) data;
+
+	for (;;)
+	{
+		mgLockMutex(&queue->mutex);
+		const size_t index = queue->next++;
+		mgUnlockMutex(&queue->mutex);
+
+		if (index >= queue->jobCount)
+			break;
+
+		_mgRunJob(queue->options, &queue->jobs[index]);
+	}
+}
+
+
+static MGbool _mgJobsHaveDuplicateExports(const MGJob *jobs, size_t jobCount)
+{
+	for (size_t i = 0; i < jobCount; ++i)
+	{
+		if (!jobs[i].exportFilename)
+			continue;
+
+		for (size_t j = 0; j < i; ++j)
+		{
+			if (!strcmp(jobs[i].exportFilename, jobs[j].exportFilename))
+			{
+				fprintf(stderr, "Error: \"%s\" and \"%s\" both export to \"%s\"\n",
+				        jobs[j].filename, jobs[i].filename, jobs[i].exportFilename);
+				return MG_TRUE;
+			}
+		}
+	}
+
+	return MG_FALSE;
+}
+
+
+int mgRunJobs(const MGJobOptions *options, size_t filenameCount, char **filenames)
+{
+	MG_ASSERT(options);
+	MG_ASSERT(options->threadCount > 0);
+	MG_ASSERT((filenameCount == 0) || filenames);
+
+	const double start = _mgJobTime();
+
+	MGJobQueue queue;
+	queue.options = options;
+	queue.jobs = (MGJob*) calloc(filenameCount ? filenameCount : 1, sizeof(MGJob));
+	queue.jobCount = filenameCount;
+	queue.next = 0;
+	MG_ASSERT(queue.jobs);
+
+	mgCreateMutex(&queue.mutex);
+
+	for (size_t i = 0; i < filenameCount; ++i)
+	{
+		queue.jobs[i].filename = filenames[i];
+
+		if (options->exportFilename)
+			queue.jobs[i].exportFilename = _mgJobExportFilename(options->exportFilename, filenames[i]);
+	}
+
+	// Files with the same name would otherwise overwrite each other's export
+	if (_mgJobsHaveDuplicateExports(queue.jobs, filenameCount))
+	{
+		for (size_t i = 0; i < filenameCount; ++i)
+			free(queue.jobs[i].exportFilename);
+
+		free(queue.jobs);
+
+		mgDestroyMutex(&queue.mutex);
+
+		return EXIT_FAILURE;
+	}
+
+	const size_t threadCount = (options->threadCount < filenameCount) ? options->threadCount : filenameCount;
+
+	MGThread *threads = (MGThread*) malloc((threadCount ? threadCount : 1) * sizeof(MGThread));
+	MG_ASSERT(threads);
+
+	size_t startedCount = 0;
+
+	for (; startedCount < threadCount; ++startedCount)
+		if (!mgCreateThread(&threads[startedCount], _mgJobWorker, &queue))
+			break;
+
+	// Jobs are run on the main thread if no thread could be started
+	if (startedCount == 0)
+		_mgJobWorker(&queue);
+
+	for (size_t i = 0; i < startedCount; ++i)
+		mgJoinThread(&threads[i]);
+
+	free(threads);
+
+	mgDestroyMutex(&queue.mutex);
+
+	int err = EXIT_SUCCESS;
+
+	// Summaries are printed in the order the files were given
+	for (size_t i = 0; i < filenameCount; ++i)
+	{
+		const MGJob *job = &queue.jobs[i];
+
+		if (job->failed)
+		{
+			printf("%s: Failed\n", job->filename);
+			err = EXIT_FAILURE;
+		}
+		else
+		{
+			printf("%s: %zu vertices in %.3fms", job->filename, job->vertexCount, job->seconds * 1000.0);
+
+			if (job->exportFilename)
+				printf(" -> %s", job->exportFilename);
+
+			putchar('\n');
+		}
+
+		free(job->exportFilename);
+	}
+
+	printf("Ran %zu job%s in %.3fms using %zu thread%s\n",
+	       filenameCount, (filenameCount == 1) ? "" : "s",
+	       (_mgJobTime() - start) * 1000.0,
+	       startedCount, (startedCount == 1) ? "" : "s");
+
+	free(queue.jobs);
+
+	return err;
+}
@@ -0,0 +1,36 @@
+#ifndef MODELGEN_JOBS_H
+#define MODELGEN_JOBS_H
+
+#include <stddef.h>
+
+#include "value.h"
+
+// Batch mode, which runs every file in its own instance on a pool
+// of threads, as instances are independent of each other
+
+#define MG_JOB_EXPORT_NAME "{name}"
+
+typedef struct MGJobOptions {
+	unsigned int threadCount;
+	MGbool walkAST;
+	MGbool exportOBJ;
+	MGbool exportTriangles;
+	MGbool exportIndexedTriangles;
+	// Filename each job is exported to, with MG_JOB_EXPORT_NAME
+	// replaced by the name of the file without its extension
+	const char *exportFilename;
+	// Copied into every instance, and only read while jobs run
+	const MGValue *uniforms;
+} MGJobOptions;
+
+typedef struct MGJob {
+	const char *filename;
+	char *exportFilename;
+	size_t vertexCount;
+	double seconds;
+	MGbool failed;
+} MGJob;
+
+int mgRunJobs(const MGJobOptions *options, size_t filenameCount, char **filenames);
+
+#endif
\ No newline at end of file
@@ -6,8 +6,11 @@
 #include "modelgen.h"
 #include "types/primitive.h"
 #include "types/composite.h"
+#include "optimize.h"
 #include "inspect.h"
 #include "format.h"
+#include "weld.h"
+#include "jobs.h"
 #include "debug.h"
 #include "version.h"
 
@@ -29,21 +32,32 @@ void usage(void)
 		"    - --stdin         Read stdin as a file\n"
 		"    --tokens          Print tokens and exit\n"
 		"    --ast             Print ast and exit\n"
+		"    --optimized-ast   Print optimized ast and exit\n"
+		"    --bytecode        Print bytecode and exit\n"
+		"    --threads <n>     Run pmap using <n> threads, defaults to one per processor\n"
+		"    --jobs <n>        Run each file in its own instance using <n> threads,\n"
+		"                      exporting each to --export <file> with \"" MG_JOB_EXPORT_NAME "\"\n"
+		"                      replaced by the name of the file\n"
 		"\n"
 		"Formats:\n"
 		"\n"
-		"    obj       Wavefront .obj format\n"
+		"    obj       Wavefront .obj format, with positions and normals welded within %g\n"
 		"    triangles Tightly packed triangles 32-bit floats\n"
 		"              Format: xyz nxnynz (interleaved vertices)\n"
+		"    indexed   Triangles sharing vertices welded within %g\n"
+		"              Format: vertex count, vertices like triangles,\n"
+		"              index count, indices (32-bit unsigned integers)\n"
 		"\n"
 		"Introspection:\n"
 		"\n"
-		"    --profile Print elapsed time\n"
+		"    --profile Print elapsed time and peak memory\n"
 		"    --inspect Print modules and their contents on exit\n"
 		"\n"
 		"Debugging:\n"
 		"\n"
 		"    --debug-read  Print file contents and exit\n"
+		"    --walk-ast    Interpret the ast directly instead of compiling to bytecode\n",
+		(double) MG_WELD_EPSILON, (double) MG_WELD_EPSILON
 	);
 }
 
@@ -54,13 +68,18 @@ int main(int argc, char *argv[])
 	MGbool debugRead = MG_FALSE;
 	MGbool debugTokens = MG_FALSE;
 	MGbool debugAST = MG_FALSE;
+	MGbool debugOptimizedAST = MG_FALSE;
+	MGbool debugBytecode = MG_FALSE;
 	MGbool profileTime = MG_FALSE;
 	MGbool inspectModules = MG_FALSE;
 
 	MGbool exportOBJ = MG_FALSE;
 	MGbool exportTriangles = MG_FALSE;
+	MGbool exportIndexedTriangles = MG_FALSE;
 	const char *exportFilename = NULL;
 
+	int jobThreadCount = 0;
+
 	MGInstance instance;
 	mgCreateInstance(&instance);
 
@@ -70,7 +89,7 @@ int main(int argc, char *argv[])
 	const MGValue *uniforms = instance.uniforms;
 
 	MG_ASSERT(uniforms);
-	MG_ASSERT(uniforms->type == MG_TYPE_MAP);
+	MG_ASSERT(mgValueType(uniforms) == MG_TYPE_MAP);
 
 	int i = 1;
 	const char *arg;
@@ -108,8 +127,14 @@ int main(int argc, char *argv[])
 			debugTokens = MG_TRUE;
 		else if (!strcmp("--ast", arg))
 			debugAST = MG_TRUE;
+		else if (!strcmp("--optimized-ast", arg))
+			debugOptimizedAST = MG_TRUE;
+		else if (!strcmp("--bytecode", arg))
+			debugBytecode = MG_TRUE;
 		else if (!strcmp("--debug-read", arg))
 			debugRead = MG_TRUE;
+		else if (!strcmp("--walk-ast", arg))
+			instance.walkAST = MG_TRUE;
 		else if (!strcmp("--export", arg) || !strncmp("--export=", arg, 9))
 		{
 			exportFilename = NULL;
@@ -142,12 +167,48 @@ int main(int argc, char *argv[])
 				exportOBJ = MG_TRUE;
 			else if (!strcmp(format, "triangles"))
 				exportTriangles = MG_TRUE;
+			else if (!strcmp(format, "indexed"))
+				exportIndexedTriangles = MG_TRUE;
 			else
 			{
 				fprintf(stderr, "Error: Unknown format \"%s\"\n", format);
 				return EXIT_FAILURE;
 			}
 		}
+		else if (!strcmp("--threads", arg))
+		{
+			if (i >= (argc - 1))
+			{
+				fputs("Error: Missing count after --threads\n", stderr);
+				return EXIT_FAILURE;
+			}
+
+			const int threadCount = atoi(argv[++i]);
+
+			if (threadCount < 1)
+			{
+				fprintf(stderr, "Error: Invalid thread count \"%s\"\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+
+			instance.threadCount = (unsigned int) threadCount;
+		}
+		else if (!strcmp("--jobs", arg))
+		{
+			if (i >= (argc - 1))
+			{
+				fputs("Error: Missing count after --jobs\n", stderr);
+				return EXIT_FAILURE;
+			}
+
+			jobThreadCount = atoi(argv[++i]);
+
+			if (jobThreadCount < 1)
+			{
+				fprintf(stderr, "Error: Invalid job count \"%s\"\n", argv[i]);
+				return EXIT_FAILURE;
+			}
+		}
 		else if (!strcmp("--profile", arg))
 			profileTime = MG_TRUE;
 		else if (!strcmp("--inspect", arg))
@@ -216,7 +277,7 @@ int main(int argc, char *argv[])
 			if (!mgDebugTokenize(argv[i]))
 				err = 1;
 	}
-	else if (debugAST)
+	else if (debugAST || debugOptimizedAST || debugBytecode)
 	{
 		MGParser parser;
 		MGNode *root;
@@ -226,7 +287,18 @@ int main(int argc, char *argv[])
 			mgCreateParser(&parser);
 
 			if ((root = mgParseFileHandle(&parser, stdin)))
-				mgInspectNode(root);
+			{
+				// The bytecode is compiled from the optimized ast, like when running
+				if (!debugAST)
+					mgOptimize(root);
+
+				// The code compiled is kept by root, and destroyed
+				// along with it by mgDestroyParser
+				if (debugAST || debugOptimizedAST)
+					mgInspectNode(root);
+				else
+					mgInspectCode(mgCompile(root));
+			}
 			else
 				err = 1;
 
@@ -240,13 +312,51 @@ int main(int argc, char *argv[])
 			mgCreateParser(&parser);
 
 			if ((root = mgParseFile(&parser, filename)))
-				mgInspectNode(root);
+			{
+				if (!debugAST)
+					mgOptimize(root);
+
+				// Like above, mgDestroyParser destroys the code
+				if (debugAST || debugOptimizedAST)
+					mgInspectNode(root);
+				else
+					mgInspectCode(mgCompile(root));
+			}
 			else
 				err = 1;
 
 			mgDestroyParser(&parser);
 		}
 	}
+	else if (jobThreadCount)
+	{
+		if (runStdin)
+		{
+			fputs("Error: --jobs cannot read stdin\n", stderr);
+			return EXIT_FAILURE;
+		}
+		else if ((exportOBJ || exportTriangles || exportIndexedTriangles) && !exportFilename)
+		{
+			fputs("Error: --jobs requires exporting with --export <file>\n", stderr);
+			return EXIT_FAILURE;
+		}
+		else if (exportFilename && !strstr(exportFilename, MG_JOB_EXPORT_NAME) && ((argc - i) > 1))
+		{
+			fprintf(stderr, "Error: Export filename \"%s\" must contain \"" MG_JOB_EXPORT_NAME "\" to export multiple files\n", exportFilename);
+			return EXIT_FAILURE;
+		}
+
+		MGJobOptions options;
+		options.threadCount = (unsigned int) jobThreadCount;
+		options.walkAST = instance.walkAST;
+		options.exportOBJ = exportOBJ;
+		options.exportTriangles = exportTriangles;
+		options.exportIndexedTriangles = exportIndexedTriangles;
+		options.exportFilename = exportFilename;
+		options.uniforms = uniforms;
+
+		err = mgRunJobs(&options, (size_t) (argc - i), argv + i);
+	}
 	else
 	{
 		if (runStdin)
@@ -271,6 +381,8 @@ int main(int argc, char *argv[])
 					mgExportOBJ(&instance, f);
 				else if (exportTriangles)
 					mgExportTriangles(&instance, f);
+				else if (exportIndexedTriangles)
+					mgExportIndexedTriangles(&instance, f);
 
 				fclose(f);
 			}
@@ -285,30 +397,35 @@ int main(int argc, char *argv[])
 				mgExportOBJ(&instance, stdout);
 			else if (exportTriangles)
 				mgExportTriangles(&instance, stdout);
+			else if (exportIndexedTriangles)
+				mgExportIndexedTriangles(&instance, stdout);
 		}
 	}
 
-#ifdef _WIN32
 	if (profileTime)
 	{
+#ifdef _WIN32
 		QueryPerformanceCounter(&timeStop);
 		QueryPerformanceFrequency(&timerResolution);
 
 		const int64_t timeInterval = timeStop.QuadPart - timeStart.QuadPart;
 		const double timeSeconds = (double) timeInterval / (double) timerResolution.QuadPart;
+#endif
 
 #if MG_ANSI_COLORS
 		fputs("\e[90m", stdout);
 #endif
 
 		putchar('\n');
+#ifdef _WIN32
 		printf("Time Elapsed: %.6fms\n", timeSeconds * 1000.0);
+#endif
+		printf("Memory Peak: %zu bytes (%zu slabs)\n", instance.allocator.peak, instance.allocator.slabCount);
 
 #if MG_ANSI_COLORS
 		fputs("\e[0m", stdout);
 #endif
 	}
-#endif
 
 	mgDestroyInstance(&instance);
 
@@ -0,0 +1,495 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "optimize.h"
+#include "parse.h"
+#include "value.h"
+#include "types/primitive.h"
+#include "types/composite.h"
+#include "intern.h"
+#include "debug.h"
+
+
+typedef struct MGOptimizer {
+	// True and false are names in the base module, which are
+	// only folded if the module never binds either of them
+	MGbool constantBooleans;
+} MGOptimizer;
+
+
+static MGNode* _mgOptimizeNode(const MGOptimizer *optimizer, MGNode *node);
+
+
+static inline MGbool _mgIsBooleanName(const MGNode *node)
+{
+	return (node->type == MG_NODE_NAME) && node->token &&
+	       (!strcmp(node->token->value.s, "true") || !strcmp(node->token->value.s, "false"));
+}
+
+
+static MGbool _mgTargetBindsBoolean(const MGNode *node)
+{
+	if (_mgIsBooleanName(node))
+		return MG_TRUE;
+
+	if ((node->type == MG_NODE_TUPLE) || (node->type == MG_NODE_LIST))
+		for (size_t i = 0; i < _mgListLength(node->children); ++i)
+			if (_mgTargetBindsBoolean(_mgListGet(node->children, i)))
+				return MG_TRUE;
+
+	return MG_FALSE;
+}
+
+
+static MGbool _mgImportBindsBoolean(const MGNode *node)
+{
+	if (node->token && (node->token->type == MG_TOKEN_NAME) &&
+	    (!strcmp(node->token->value.s, "true") || !strcmp(node->token->value.s, "false")))
+		return MG_TRUE;
+
+	for (size_t i = 0; i < _mgListLength(node->children); ++i)
+		if (_mgImportBindsBoolean(_mgListGet(node->children, i)))
+			return MG_TRUE;
+
+	return MG_FALSE;
+}
+
+
+static MGbool _mgBindsBoolean(const MGNode *node)
+{
+	switch (node->type)
+	{
+	case MG_NODE_ASSIGN:
+	case MG_NODE_ASSIGN_ADD:
+	case MG_NODE_ASSIGN_SUB:
+	case MG_NODE_ASSIGN_MUL:
+	case MG_NODE_ASSIGN_DIV:
+	case MG_NODE_ASSIGN_INT_DIV:
+	case MG_NODE_ASSIGN_MOD:
+	case MG_NODE_FOR:
+	case MG_NODE_DELETE:
+		if (_mgTargetBindsBoolean(_mgListGet(node->children, 0)))
+			return MG_TRUE;
+		break;
+	case MG_NODE_FUNCTION:
+	case MG_NODE_PROCEDURE:
+		if (_mgIsBooleanName(_mgListGet(node->children, 0)) || _mgTargetBindsBoolean(_mgListGet(node->children, 1)))
+			return MG_TRUE;
+		break;
+	case MG_NODE_IMPORT:
+		return _mgImportBindsBoolean(node);
+	case MG_NODE_IMPORT_FROM:
+		// Importing everything could bind anything
+		return (_mgListLength(node->children) == 1) || _mgImportBindsBoolean(node);
+	default:
+		break;
+	}
+
+	for (size_t i = 0; i < _mgListLength(node->children); ++i)
+		if (_mgBindsBoolean(_mgListGet(node->children, i)))
+			return MG_TRUE;
+
+	return MG_FALSE;
+}
+
+
+// Returns a new reference to the value of a constant node, or NULL
+static MGValue* _mgCreateNodeConstant(const MGOptimizer *optimizer, const MGNode *node)
+{
+	switch (node->type)
+	{
+	case MG_NODE_NULL:
+		return MG_NULL_VALUE;
+	case MG_NODE_INTEGER:
+	case MG_NODE_FLOAT:
+	case MG_NODE_CONSTANT:
+		MG_ASSERT(node->value);
+		return mgReferenceValue(node->value);
+	case MG_NODE_STRING:
+		MG_ASSERT(node->token);
+		return mgCreateValueInternedString(node->token->value.s);
+	case MG_NODE_NAME:
+		if (optimizer->constantBooleans && _mgIsBooleanName(node))
+			return mgCreateValueBoolean(!strcmp(node->token->value.s, "true"));
+		return NULL;
+	default:
+		return NULL;
+	}
+}
+
+
+static inline MGbool _mgIsNodeConstant(const MGOptimizer *optimizer, const MGNode *node)
+{
+	switch (node->type)
+	{
+	case MG_NODE_NULL:
+	case MG_NODE_INTEGER:
+	case MG_NODE_FLOAT:
+	case MG_NODE_STRING:
+	case MG_NODE_CONSTANT:
+		return MG_TRUE;
+	case MG_NODE_NAME:
+		return optimizer->constantBooleans && _mgIsBooleanName(node);
+	default:
+		return MG_FALSE;
+	}
+}
+
+
+static MGNode* _mgReplaceNode(MGNode *node, MGNode *replacement)
+{
+	replacement->parent = node->parent;
+
+	mgDestroyNode(node);
+
+	return replacement;
+}
+
+
+static MGNode* _mgReplaceNodeWithConstant(MGNode *node, MGValue *value)
+{
+	// Folded strings are interned like string literals
+	if ((mgValueType(value) == MG_TYPE_STRING) && (value->data.str.usage != MG_STRING_USAGE_INTERNED))
+	{
+		const char *s = mgInternString(value->data.str.s);
+		mgDestroyValue(value);
+		value = mgCreateValueStringEx(s, MG_STRING_USAGE_INTERNED);
+	}
+
+	MGNode *constant = mgCreateNode(node->token, MG_NODE_CONSTANT);
+	constant->tokenBegin = node->tokenBegin;
+	constant->tokenEnd = node->tokenEnd;
+	constant->value = value;
+
+	return _mgReplaceNode(node, constant);
+}
+
+
+static MGNode* _mgReplaceNodeWithChild(MGNode *node, size_t index)
+{
+	MGNode *child = _mgListGet(node->children, index);
+	_mgListSet(node->children, index, NULL);
+
+	return _mgReplaceNode(node, child);
+}
+
+
+static MGNode* _mgReplaceNodeWithNop(MGNode *node)
+{
+	MGNode *nop = mgCreateNode(NULL, MG_NODE_NOP);
+	nop->tokenBegin = node->tokenBegin;
+	nop->tokenEnd = node->tokenEnd;
+
+	return _mgReplaceNode(node, nop);
+}
+
+
+static inline MGbool _mgIsScalar(const MGValue *value)
+{
+	return mgIsNumericValue(value) || (mgValueType(value) == MG_TYPE_STRING);
+}
+
+
+// Only operations which cannot fail are folded, anything
+// else is left to raise its error when it is evaluated
+static MGValue* _mgFoldBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
+{
+	if (mgIsNumericValue(lhs) && mgIsNumericValue(rhs))
+		return mgNumericBinaryOp(lhs, rhs, operation);
+
+	if (!_mgIsScalar(lhs) || !_mgIsScalar(rhs))
+		return NULL;
+
+	switch (operation)
+	{
+	case MG_BIN_OP_ADD:
+		return mgValueBinaryOp(lhs, rhs, operation);
+	case MG_BIN_OP_EQ:
+	case MG_BIN_OP_NOT_EQ:
+	case MG_BIN_OP_LESS:
+	case MG_BIN_OP_LESS_EQ:
+	case MG_BIN_OP_GREATER:
+	case MG_BIN_OP_GREATER_EQ:
+		if ((mgValueType(lhs) == MG_TYPE_STRING) && (mgValueType(rhs) == MG_TYPE_STRING))
+			return mgValueBinaryOp(lhs, rhs, operation);
+	default:
+		return NULL;
+	}
+}
+
+
+static MGNode* _mgOptimizeBinaryOp(const MGOptimizer *optimizer, MGNode *node, MGBinOpType operation)
+{
+	MG_ASSERT(_mgListLength(node->children) == 2);
+
+	MGValue *lhs = _mgCreateNodeConstant(optimizer, _mgListGet(node->children, 0));
+	MGValue *rhs = lhs ? _mgCreateNodeConstant(optimizer, _mgListGet(node->children, 1)) : NULL;
+	MGValue *result = (lhs && rhs) ? _mgFoldBinaryOp(lhs, rhs, operation) : NULL;
+
+	if (lhs)
+		mgDestroyValue(lhs);
+	if (rhs)
+		mgDestroyValue(rhs);
+
+	return result ? _mgReplaceNodeWithConstant(node, result) : node;
+}
+
+
+static MGNode* _mgOptimizeUnaryOp(const MGOptimizer *optimizer, MGNode *node, MGUnaryOpType operation)
+{
+	MG_ASSERT(_mgListLength(node->children) == 1);
+
+	MGValue *operand = _mgCreateNodeConstant(optimizer, _mgListGet(node->children, 0));
+
+	if (!operand)
+		return node;
+
+	MGValue *result = NULL;
+
+	if (operation == MG_UNARY_OP_INVERSE)
+		result = mgCreateValueBoolean(!mgValueTruthValue(operand));
+	else if (mgIsNumericValue(operand))
+		result = mgValueUnaryOp(operand, operation);
+
+	mgDestroyValue(operand);
+
+	return result ? _mgReplaceNodeWithConstant(node, result) : node;
+}
+
+
+static MGNode* _mgOptimizeLogical(const MGOptimizer *optimizer, MGNode *node)
+{
+	MG_ASSERT(_mgListLength(node->children) == 2);
+
+	MGValue *lhs = _mgCreateNodeConstant(optimizer, _mgListGet(node->children, 0));
+
+	if (!lhs)
+		return node;
+
+	const MGbool isNull = mgValueType(lhs) == MG_TYPE_NULL;
+	const MGbool truth = mgValueTruthValue(lhs);
+
+	mgDestroyValue(lhs);
+
+	if (node->type == MG_NODE_BIN_OP_COALESCE)
+		return _mgReplaceNodeWithChild(node, isNull ? 1 : 0);
+
+	// The result is decided by the left-hand side
+	if ((node->type == MG_NODE_BIN_OP_AND) ? !truth : truth)
+		return _mgReplaceNodeWithConstant(node, mgCreateValueBoolean(truth));
+
+	MGValue *rhs = _mgCreateNodeConstant(optimizer, _mgListGet(node->children, 1));
+
+	if (!rhs)
+		return node;
+
+	MGValue *result = mgCreateValueBoolean(mgValueTruthValue(rhs));
+	mgDestroyValue(rhs);
+
+	return _mgReplaceNodeWithConstant(node, result);
+}
+
+
+static MGNode* _mgOptimizeConditional(const MGOptimizer *optimizer, MGNode *node)
+{
+	MGValue *condition = _mgCreateNodeConstant(optimizer, _mgListGet(node->children, 0));
+
+	if (!condition)
+		return node;
+
+	const MGbool truth = mgValueTruthValue(condition);
+	mgDestroyValue(condition);
+
+	switch (node->type)
+	{
+	case MG_NODE_TERNARY_OP_CONDITIONAL:
+		MG_ASSERT(_mgListLength(node->children) == 3);
+		return _mgReplaceNodeWithChild(node, truth ? 1 : 2);
+	case MG_NODE_BIN_OP_CONDITIONAL:
+		MG_ASSERT(_mgListLength(node->children) == 2);
+		return _mgReplaceNodeWithChild(node, truth ? 0 : 1);
+	case MG_NODE_IF:
+		// Without a body, the if evaluates to its condition
+		if (_mgListLength(node->children) == 1)
+			return _mgReplaceNodeWithConstant(node, mgCreateValueBoolean(truth));
+		else if (truth)
+			return _mgReplaceNodeWithChild(node, 1);
+		else if (_mgListLength(node->children) > 2)
+			return _mgReplaceNodeWithChild(node, 2);
+		return _mgReplaceNodeWithNop(node);
+	case MG_NODE_WHILE:
+		return truth ? node : _mgReplaceNodeWithNop(node);
+	default:
+		return node;
+	}
+}
+
+
+// Constant tuples and lists are built once, and copied when evaluated
+static MGNode* _mgOptimizeCollection(const MGOptimizer *optimizer, MGNode *node)
+{
+	for (size_t i = 0; i < _mgListLength(node->children); ++i)
+		if (!_mgIsNodeConstant(optimizer, _mgListGet(node->children, i)))
+			return node;
+
+	MGValue *collection = (node->type == MG_NODE_TUPLE) ?
+		mgCreateValueTuple(_mgListLength(node->children)) :
+		mgCreateValueList(_mgListLength(node->children));
+
+	for (size_t i = 0; i < _mgListLength(node->children); ++i)
+		mgListAdd(collection, _mgCreateNodeConstant(optimizer, _mgListGet(node->children, i)));
+
+	return _mgReplaceNodeWithConstant(node, collection);
+}
+
+
+static void _mgOptimizeChild(const MGOptimizer *optimizer, MGNode *node, size_t index)
+{
+	MGNode *child = _mgListGet(node->children, index);
+
+	if (child)
+		_mgListSet(node->children, index, _mgOptimizeNode(optimizer, child));
+}
+
+
+static void _mgOptimizeChildren(const MGOptimizer *optimizer, MGNode *node, size_t begin, size_t step)
+{
+	for (size_t i = begin; i < _mgListLength(node->children); i += step)
+		_mgOptimizeChild(optimizer, node, i);
+}
+
+
+// Targets are left as is, apart from the expressions within them
+static void _mgOptimizeTarget(const MGOptimizer *optimizer, MGNode *node)
+{
+	switch (node->type)
+	{
+	case MG_NODE_TUPLE:
+	case MG_NODE_LIST:
+		for (size_t i = 0; i < _mgListLength(node->children); ++i)
+			_mgOptimizeTarget(optimizer, _mgListGet(node->children, i));
+		break;
+	case MG_NODE_SUBSCRIPT:
+		_mgOptimizeChildren(optimizer, node, 0, 1);
+		break;
+	case MG_NODE_ATTRIBUTE:
+		_mgOptimizeChild(optimizer, node, 0);
+		break;
+	default:
+		break;
+	}
+}
+
+
+static MGNode* _mgOptimizeNode(const MGOptimizer *optimizer, MGNode *node)
+{
+	MG_ASSERT(node);
+
+	switch (node->type)
+	{
+	case MG_NODE_NAME:
+	case MG_NODE_IMPORT:
+	case MG_NODE_IMPORT_FROM:
+		return node;
+	case MG_NODE_ASSIGN:
+	case MG_NODE_ASSIGN_ADD:
+	case MG_NODE_ASSIGN_SUB:
+	case MG_NODE_ASSIGN_MUL:
+	case MG_NODE_ASSIGN_DIV:
+	case MG_NODE_ASSIGN_INT_DIV:
+	case MG_NODE_ASSIGN_MOD:
+	case MG_NODE_FOR:
+		_mgOptimizeTarget(optimizer, _mgListGet(node->children, 0));
+		_mgOptimizeChildren(optimizer, node, 1, 1);
+		return node;
+	case MG_NODE_DELETE:
+		_mgOptimizeTarget(optimizer, _mgListGet(node->children, 0));
+		return node;
+	case MG_NODE_FUNCTION:
+	case MG_NODE_PROCEDURE:
+	{
+		_mgOptimizeTarget(optimizer, _mgListGet(node->children, 0));
+
+		// Only default arguments are optimized within the parameters
+		MGNode *parameters = _mgListGet(node->children, 1);
+		for (size_t i = 0; i < _mgListLength(parameters->children); ++i)
+			if (_mgListGet(parameters->children, i)->type == MG_NODE_ASSIGN)
+				_mgOptimizeChild(optimizer, _mgListGet(parameters->children, i), 1);
+
+		_mgOptimizeChildren(optimizer, node, 2, 1);
+		return node;
+	}
+	case MG_NODE_ATTRIBUTE:
+	case MG_NODE_AS:
+		_mgOptimizeChild(optimizer, node, 0);
+		return node;
+	case MG_NODE_MAP:
+		// Keys are names or strings
+		_mgOptimizeChildren(optimizer, node, 1, 2);
+		return node;
+	default:
+		_mgOptimizeChildren(optimizer, node, 0, 1);
+		break;
+	}
+
+	switch (node->type)
+	{
+	case MG_NODE_UNARY_OP_POS:
+		return _mgOptimizeUnaryOp(optimizer, node, MG_UNARY_OP_POSITIVE);
+	case MG_NODE_UNARY_OP_NEG:
+		return _mgOptimizeUnaryOp(optimizer, node, MG_UNARY_OP_NEGATIVE);
+	case MG_NODE_UNARY_OP_NOT:
+		return _mgOptimizeUnaryOp(optimizer, node, MG_UNARY_OP_INVERSE);
+	case MG_NODE_BIN_OP_ADD:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_ADD);
+	case MG_NODE_BIN_OP_SUB:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_SUB);
+	case MG_NODE_BIN_OP_MUL:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_MUL);
+	case MG_NODE_BIN_OP_DIV:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_DIV);
+	case MG_NODE_BIN_OP_INT_DIV:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_INT_DIV);
+	case MG_NODE_BIN_OP_MOD:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_MOD);
+	case MG_NODE_BIN_OP_EQ:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_EQ);
+	case MG_NODE_BIN_OP_NOT_EQ:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_NOT_EQ);
+	case MG_NODE_BIN_OP_LESS:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_LESS);
+	case MG_NODE_BIN_OP_LESS_EQ:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_LESS_EQ);
+	case MG_NODE_BIN_OP_GREATER:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_GREATER);
+	case MG_NODE_BIN_OP_GREATER_EQ:
+		return _mgOptimizeBinaryOp(optimizer, node, MG_BIN_OP_GREATER_EQ);
+	case MG_NODE_BIN_OP_AND:
+	case MG_NODE_BIN_OP_OR:
+	case MG_NODE_BIN_OP_COALESCE:
+		return _mgOptimizeLogical(optimizer, node);
+	case MG_NODE_BIN_OP_CONDITIONAL:
+	case MG_NODE_TERNARY_OP_CONDITIONAL:
+	case MG_NODE_IF:
+	case MG_NODE_WHILE:
+		return _mgOptimizeConditional(optimizer, node);
+	case MG_NODE_TUPLE:
+	case MG_NODE_LIST:
+		return _mgOptimizeCollection(optimizer, node);
+	default:
+		return node;
+	}
+}
+
+
+void mgOptimize(MGNode *root)
+{
+	MG_ASSERT(root);
+
+	MGOptimizer optimizer;
+	optimizer.constantBooleans = !_mgBindsBoolean(root);
+
+	// Modules are never folded, so the root is kept
+	_mgOptimizeNode(&optimizer, root);
+}
@@ -0,0 +1,10 @@
+#ifndef MODELGEN_OPTIMIZE_H
+#define MODELGEN_OPTIMIZE_H
+
+#include "ast.h"
+
+// Folds constant expressions, hoists constant tuples and lists,
+// and removes branches with constant conditions, in place
+void mgOptimize(MGNode *root);
+
+#endif
\ No newline at end of file
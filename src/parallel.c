@@ -0,0 +1,625 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "parallel.h"
+#include "instance.h"
+#include "callable.h"
+#include "intern.h"
+#include "types/composite.h"
+#include "error.h"
+#include "utilities.h"
+#include "debug.h"
+
+
+#define _MG_PARALLEL_MAP_MAX_LISTS 8
+
+
+MG_THREAD_LOCAL MGParallelMap *_mgParallelMap = NULL;
+MG_THREAD_LOCAL uint32_t _mgValueEpoch = 0;
+
+
+typedef struct MGParallelWorker {
+	MGInstance instance;
+	MGAllocator *allocator;
+	MGThread thread;
+	MGbool started;
+	// State of the thread before it became a worker
+	MGParallelMap *lastMap;
+	MGAllocator *lastAllocator;
+	MGInstance *lastInstance;
+	uint32_t lastValueEpoch;
+} MGParallelWorker;
+
+typedef struct MGParallelMapState {
+	MGParallelMap map;
+	MGInstance *instance;
+	MGInternTable *internTable;
+	// Module, caller and name of the frame which called the map,
+	// which are used for the first frame of each worker instance
+	MGValue *module;
+	const MGNode *caller;
+	const char *callerName;
+	const MGValue *callable;
+	size_t listCount;
+	const MGValue* const* lists;
+	MGValue **results;
+	uint64_t seed;
+	const MGValue *transform;
+} MGParallelMapState;
+
+typedef struct MGParallelMapChunk {
+	MGParallelWorker worker;
+	MGParallelMapState *state;
+	size_t begin, end;
+} MGParallelMapChunk;
+
+typedef struct MGTaskPoolState {
+	MGParallelMap map;
+	MGInstance *instance;
+	MGInternTable *internTable;
+	const MGValueList *tasks;
+	// Vertices emitted by each task
+	MGVertexList *vertices;
+	// Index of the next task to be taken by a thread
+	size_t next;
+} MGTaskPoolState;
+
+typedef struct MGTaskPoolThread {
+	MGParallelWorker worker;
+	MGTaskPoolState *state;
+} MGTaskPoolThread;
+
+
+static void _mgCreateWorkerInstance(MGInstance *worker, const MGInstance *instance)
+{
+	memset(worker, 0, sizeof(MGInstance));
+
+	mgCreateValueStack(&worker->valueStack);
+
+	// Everything but the call stack and vertices is shared, and
+	// must therefore outlive the worker without being destroyed
+	worker->path = instance->path;
+	worker->modules = instance->modules;
+	worker->staticModules = instance->staticModules;
+	worker->base = instance->base;
+	worker->uniforms = instance->uniforms;
+
+	memcpy(worker->typeNames, instance->typeNames, sizeof(worker->typeNames));
+
+	_mgListCreate(MGVertex, worker->vertices, 1 << 9);
+
+	worker->vertexSize = instance->vertexSize;
+	worker->walkAST = instance->walkAST;
+	worker->threadCount = instance->threadCount;
+	worker->sharedGlobals = MG_TRUE;
+	worker->sharedEpoch = instance->sharedEpoch;
+
+	_mgListInitialize(worker->workerAllocators);
+	_mgListInitialize(worker->tasks);
+}
+
+
+// Workers whose thread failed to start run on the
+// calling thread, which already shares its intern table
+static void _mgBeginWorker(MGParallelWorker *worker, MGParallelMap *map, MGInternTable *internTable, const MGInstance *instance)
+{
+	worker->lastMap = _mgParallelMap;
+	_mgParallelMap = map;
+
+	if (!worker->lastMap)
+		mgShareInternTable(internTable, &map->internMutex);
+
+	worker->lastAllocator = mgSetAllocator(worker->allocator);
+
+	worker->lastInstance = _mgLastInstance;
+	_mgLastInstance = &worker->instance;
+
+	// Values created by the worker belong to the map or task
+	worker->lastValueEpoch = _mgValueEpoch;
+	_mgValueEpoch = instance->sharedEpoch;
+
+	_mgCreateWorkerInstance(&worker->instance, instance);
+}
+
+
+static void _mgEndWorker(MGParallelWorker *worker)
+{
+	mgDestroyValueStack(&worker->instance.valueStack);
+
+	_mgValueEpoch = worker->lastValueEpoch;
+	_mgLastInstance = worker->lastInstance;
+
+	mgSetAllocator(worker->lastAllocator);
+
+	if (!worker->lastMap)
+		mgShareInternTable(NULL, NULL);
+
+	_mgParallelMap = worker->lastMap;
+}
+
+
+// Allocators are reused by later maps and tasks
+static void _mgReserveWorkerAllocators(MGInstance *instance, size_t count)
+{
+	while (_mgListLength(instance->workerAllocators) < count)
+	{
+		MGAllocator *allocator = (MGAllocator*) malloc(sizeof(MGAllocator));
+		MG_ASSERT(allocator);
+
+		mgCreateAllocator(allocator);
+
+		_mgListAdd(MGAllocator*, instance->workerAllocators, allocator);
+	}
+}
+
+
+// The calling thread must share its state before any worker starts
+static MGInternTable* _mgBeginParallel(MGParallelMap *map)
+{
+	mgCreateMutex(&map->internMutex);
+	mgCreateMutex(&map->compileMutex);
+
+	MGInternTable *internTable = mgGetInternTable();
+
+	_mgParallelMap = map;
+	mgShareInternTable(internTable, &map->internMutex);
+
+	return internTable;
+}
+
+
+static void _mgEndParallel(MGParallelMap *map)
+{
+	mgShareInternTable(NULL, NULL);
+	_mgParallelMap = NULL;
+
+	mgDestroyMutex(&map->internMutex);
+	mgDestroyMutex(&map->compileMutex);
+}
+
+
+void mgCheckUnsharedValue(MGInstance *instance, const MGValue *value)
+{
+	if (mgIsSharedValue(instance, value))
+		mgFatalError("Error: Cannot modify %s in a parallel map or task, as it was created outside of it",
+		             mgGetTypeName(mgValueType(value)));
+}
+
+
+void mgSetCallLocals(MGInstance *instance, MGStackFrame *frame, const MGValue *callable)
+{
+	if (frame->locals)
+	{
+		mgDestroyValue(frame->locals);
+		frame->locals = NULL;
+	}
+
+	if (frame->captured)
+	{
+		mgDestroyValue(frame->captured);
+		frame->captured = NULL;
+	}
+
+	if (((mgValueType(callable) != MG_TYPE_FUNCTION) && (mgValueType(callable) != MG_TYPE_PROCEDURE)) || !callable->data.func.locals)
+		return;
+
+	if (mgIsSharedValue(instance, callable->data.func.locals))
+		frame->captured = mgReferenceValue(callable->data.func.locals);
+	else
+		frame->locals = mgReferenceValue(callable->data.func.locals);
+}
+
+
+// Maps and tasks which aren't nested in another begin a new epoch
+static void _mgBeginSharedGlobals(MGInstance *instance)
+{
+	if (!instance->sharedGlobals)
+		instance->sharedEpoch = ++_mgValueEpoch;
+
+	instance->sharedGlobals = MG_TRUE;
+}
+
+
+static void _mgAppendVertices(MGInstance *instance, MGVertexList *vertices)
+{
+	const size_t vertexCount = _mgListLength(*vertices);
+
+	while (_mgListCapacity(instance->vertices) < (_mgListLength(instance->vertices) + vertexCount))
+		_mgListGrow(MGVertex, instance->vertices);
+
+	memcpy(_mgListItems(instance->vertices) + _mgListLength(instance->vertices), _mgListItems(*vertices), vertexCount * sizeof(MGVertex));
+	_mgListLength(instance->vertices) += vertexCount;
+
+	_mgListDestroy(*vertices);
+}
+
+
+// Tasks spawned by the call are pending only during it, and are run
+// before the call returns, while the call starts with only transform
+// and leaves the transforms of the instance as they were
+static MGValue* _mgCallIsolated(MGInstance *instance, const MGValue *transform, const MGValue *callable, size_t argc, const MGValue* const* argv)
+{
+	const MGValueList tasks = instance->tasks;
+	_mgListInitialize(instance->tasks);
+
+	const MGValueList transforms = mgResetTransforms(instance, transform);
+
+	MGValue *result = mgCall(instance, callable, argc, argv);
+
+	mgWaitTasks(instance);
+
+	mgRestoreTransforms(instance, transforms);
+
+	instance->tasks = tasks;
+
+	return result;
+}
+
+
+// Each item reseeds random() from its index, so that the results
+// don't depend on how the items are split into chunks
+static void _mgParallelMapRange(MGInstance *instance, const MGParallelMapState *state, size_t begin, size_t end)
+{
+	const MGValue *argv[_MG_PARALLEL_MAP_MAX_LISTS];
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		for (size_t j = 0; j < state->listCount; ++j)
+			argv[j] = _mgListGet(state->lists[j]->data.a, i); // Purposely not referenced
+
+		uint64_t seed = state->seed + i;
+		instance->randomState = mgRandomNext(&seed);
+
+		state->results[i] = _mgCallIsolated(instance, state->transform, state->callable, state->listCount, argv);
+	}
+}
+
+
+static void _mgParallelMapWorker(void *data)
+{
+	MGParallelMapChunk *chunk = (MGParallelMapChunk*) data;
+	MGParallelMapState *state = chunk->state;
+	MGInstance *worker = &chunk->worker.instance;
+
+	_mgBeginWorker(&chunk->worker, &state->map, state->internTable, state->instance);
+
+	MGStackFrame frame;
+	mgCreateStackFrame(&frame, mgReferenceValue(state->module));
+
+	frame.caller = state->caller;
+	frame.callerName = state->callerName;
+
+	mgPushStackFrame(worker, &frame);
+
+	_mgParallelMapRange(worker, state, chunk->begin, chunk->end);
+
+	mgPopStackFrame(worker, &frame);
+	mgDestroyStackFrame(&frame);
+
+	_mgEndWorker(&chunk->worker);
+}
+
+
+static void _mgParallelMapThreaded(MGParallelMapState *state, size_t length, size_t chunkCount)
+{
+	MGInstance *instance = state->instance;
+
+	MGParallelMapChunk *chunks = (MGParallelMapChunk*) calloc(chunkCount, sizeof(MGParallelMapChunk));
+	MG_ASSERT(chunks);
+
+	_mgReserveWorkerAllocators(instance, chunkCount - 1);
+
+	for (size_t i = 0; i < chunkCount; ++i)
+	{
+		chunks[i].state = state;
+		chunks[i].begin = (length * i) / chunkCount;
+		chunks[i].end = (length * (i + 1)) / chunkCount;
+		chunks[i].worker.allocator = (i > 0) ? _mgListGet(instance->workerAllocators, i - 1) : NULL;
+	}
+
+	state->internTable = _mgBeginParallel(&state->map);
+
+	for (size_t i = 1; i < chunkCount; ++i)
+		chunks[i].worker.started = mgCreateThread(&chunks[i].worker.thread, _mgParallelMapWorker, &chunks[i]);
+
+	// The first chunk runs in the calling instance
+	_mgParallelMapRange(instance, state, chunks[0].begin, chunks[0].end);
+
+	for (size_t i = 1; i < chunkCount; ++i)
+	{
+		if (chunks[i].worker.started)
+			mgJoinThread(&chunks[i].worker.thread);
+		else
+			_mgParallelMapWorker(&chunks[i]);
+	}
+
+	_mgEndParallel(&state->map);
+
+	// Vertices are appended in the order of the chunks
+	for (size_t i = 1; i < chunkCount; ++i)
+		_mgAppendVertices(instance, &chunks[i].worker.instance.vertices);
+
+	free(chunks);
+}
+
+
+MGValue* mgParallelMap(MGInstance *instance, const MGValue *callable, size_t argc, const MGValue* const* argv)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(instance->callStackTop);
+	MG_ASSERT(callable);
+	MG_ASSERT((argc > 0) && (argc <= _MG_PARALLEL_MAP_MAX_LISTS));
+
+	MGParallelMapState state;
+	memset(&state, 0, sizeof(MGParallelMapState));
+
+	state.instance = instance;
+	state.callable = callable;
+	state.listCount = argc;
+	state.lists = argv;
+
+	for (const MGStackFrame *frame = instance->callStackTop; (state.module == NULL) && frame; frame = frame->last)
+		state.module = frame->module;
+	MG_ASSERT(state.module);
+
+	state.caller = instance->callStackTop->caller;
+	state.callerName = instance->callStackTop->callerName;
+
+	size_t length = SIZE_MAX;
+
+	for (size_t i = 0; i < argc; ++i)
+		length = (length > mgListLength(argv[i])) ? mgListLength(argv[i]) : length;
+
+	state.results = (MGValue**) malloc((length ? length : 1) * sizeof(MGValue*));
+	MG_ASSERT(state.results);
+
+	state.seed = mgRandomNext(&instance->randomState);
+
+	state.transform = mgInstanceGetTransform(instance);
+
+	const uint64_t randomState = instance->randomState;
+	const MGbool sharedGlobals = instance->sharedGlobals;
+
+	size_t chunkCount = instance->threadCount ? instance->threadCount : mgGetProcessorCount();
+
+	// The tree walker isn't thread-safe, while nested maps
+	// already run on every thread given to the outer map
+	if (instance->walkAST || instance->sharedGlobals)
+		chunkCount = 1;
+	else if (chunkCount > length)
+		chunkCount = length;
+
+	_mgBeginSharedGlobals(instance);
+
+	if (chunkCount > 1)
+		_mgParallelMapThreaded(&state, length, chunkCount);
+	else
+		_mgParallelMapRange(instance, &state, 0, length);
+
+	instance->sharedGlobals = sharedGlobals;
+	instance->randomState = randomState;
+
+	MGValue *mapped = mgCreateValueList(length);
+
+	for (size_t i = 0; i < length; ++i)
+		mgListAdd(mapped, state.results[i]);
+
+	free(state.results);
+
+	return mapped;
+}
+
+
+MGValue* mgSpawnTask(MGInstance *instance, const MGValue *callable, size_t argc, const MGValue* const* argv)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(instance->callStackTop);
+	MG_ASSERT(callable);
+
+	MGValue *future = mgCreateValue(MG_TYPE_FUTURE);
+
+	_mgListCreate(MGValue*, future->data.future.values, argc + 1);
+
+	_mgListAdd(MGValue*, future->data.future.values, mgReferenceValue(callable));
+
+	for (size_t i = 0; i < argc; ++i)
+		_mgListAdd(MGValue*, future->data.future.values, mgReferenceValue(argv[i]));
+
+	future->data.future.module = NULL;
+
+	for (const MGStackFrame *frame = instance->callStackTop; (future->data.future.module == NULL) && frame; frame = frame->last)
+		future->data.future.module = frame->module;
+	MG_ASSERT(future->data.future.module);
+
+	mgReferenceValue(future->data.future.module);
+
+	future->data.future.caller = instance->callStackTop->caller;
+	future->data.future.callerName = instance->callStackTop->callerName;
+
+	// Each task gets its own random() sequence in the order they were
+	// spawned, so that the results don't depend on which thread runs it
+	future->data.future.seed = mgRandomNext(&instance->randomState);
+
+	future->data.future.transform = mgReferenceValue(mgInstanceGetTransform(instance));
+
+	future->data.future.result = NULL;
+
+	_mgListAdd(MGValue*, instance->tasks, mgReferenceValue(future));
+
+	return future;
+}
+
+
+static void _mgRunTask(MGInstance *instance, MGValue *future)
+{
+	MGStackFrame frame;
+	mgCreateStackFrame(&frame, mgReferenceValue(future->data.future.module));
+
+	frame.caller = future->data.future.caller;
+	frame.callerName = future->data.future.callerName;
+
+	mgPushStackFrame(instance, &frame);
+
+	instance->randomState = future->data.future.seed;
+
+	const MGValueList *values = &future->data.future.values;
+	MGValue *result = _mgCallIsolated(instance, future->data.future.transform, _mgListGet(*values, 0), _mgListLength(*values) - 1, (const MGValue* const*) _mgListItems(*values) + 1);
+
+	mgPopStackFrame(instance, &frame);
+	mgDestroyStackFrame(&frame);
+
+	mgAtomicStorePointer(&future->data.future.result, result);
+}
+
+
+// Threads take the next task not yet taken by any other thread, each
+// emitting into its own list of vertices, until every task has run
+static void _mgTaskPoolRun(MGInstance *instance, MGTaskPoolState *state)
+{
+	const size_t count = _mgListLength(*state->tasks);
+
+	for (size_t i = mgAtomicIncrement(&state->next) - 1; i < count; i = mgAtomicIncrement(&state->next) - 1)
+	{
+		_mgListCreate(MGVertex, instance->vertices, 1 << 9);
+
+		_mgRunTask(instance, _mgListGet(*state->tasks, i));
+
+		state->vertices[i] = instance->vertices;
+	}
+}
+
+
+static void _mgTaskPoolWorker(void *data)
+{
+	MGTaskPoolThread *thread = (MGTaskPoolThread*) data;
+	MGTaskPoolState *state = thread->state;
+
+	_mgBeginWorker(&thread->worker, &state->map, state->internTable, state->instance);
+	_mgListDestroy(thread->worker.instance.vertices);
+
+	_mgTaskPoolRun(&thread->worker.instance, state);
+
+	_mgEndWorker(&thread->worker);
+}
+
+
+static void _mgTaskPoolThreaded(MGTaskPoolState *state, size_t threadCount)
+{
+	MGInstance *instance = state->instance;
+	const size_t count = _mgListLength(*state->tasks);
+
+	MGTaskPoolThread *threads = (MGTaskPoolThread*) calloc(threadCount, sizeof(MGTaskPoolThread));
+	MG_ASSERT(threads);
+
+	state->vertices = (MGVertexList*) calloc(count, sizeof(MGVertexList));
+	MG_ASSERT(state->vertices);
+
+	_mgReserveWorkerAllocators(instance, threadCount - 1);
+
+	for (size_t i = 1; i < threadCount; ++i)
+	{
+		threads[i].state = state;
+		threads[i].worker.allocator = _mgListGet(instance->workerAllocators, i - 1);
+	}
+
+	state->internTable = _mgBeginParallel(&state->map);
+
+	for (size_t i = 1; i < threadCount; ++i)
+		threads[i].worker.started = mgCreateThread(&threads[i].worker.thread, _mgTaskPoolWorker, &threads[i]);
+
+	// The calling thread takes tasks as well
+	const MGVertexList vertices = instance->vertices;
+
+	_mgTaskPoolRun(instance, state);
+
+	instance->vertices = vertices;
+
+	for (size_t i = 1; i < threadCount; ++i)
+	{
+		if (threads[i].worker.started)
+			mgJoinThread(&threads[i].worker.thread);
+		else
+			_mgTaskPoolWorker(&threads[i]);
+	}
+
+	_mgEndParallel(&state->map);
+
+	// Vertices are appended in the order the tasks were spawned
+	for (size_t i = 0; i < count; ++i)
+		_mgAppendVertices(instance, &state->vertices[i]);
+
+	free(state->vertices);
+	free(threads);
+}
+
+
+void mgWaitTasks(MGInstance *instance)
+{
+	MG_ASSERT(instance);
+
+	if (_mgListLength(instance->tasks) == 0)
+		return;
+
+	// Tasks spawned while running these are pending in a list of their own
+	const MGValueList tasks = instance->tasks;
+	_mgListInitialize(instance->tasks);
+
+	MGTaskPoolState state;
+	memset(&state, 0, sizeof(MGTaskPoolState));
+
+	state.instance = instance;
+	state.tasks = &tasks;
+
+	const uint64_t randomState = instance->randomState;
+	const MGbool sharedGlobals = instance->sharedGlobals;
+
+	size_t threadCount = instance->threadCount ? instance->threadCount : mgGetProcessorCount();
+
+	// Like nested maps, tasks spawned by tasks
+	// run on the thread which spawned them
+	if (instance->walkAST || instance->sharedGlobals)
+		threadCount = 1;
+	else if (threadCount > _mgListLength(tasks))
+		threadCount = _mgListLength(tasks);
+
+	_mgBeginSharedGlobals(instance);
+
+	if (threadCount > 1)
+		_mgTaskPoolThreaded(&state, threadCount);
+	else
+	{
+		for (size_t i = 0; i < _mgListLength(tasks); ++i)
+			_mgRunTask(instance, _mgListGet(tasks, i));
+	}
+
+	instance->sharedGlobals = sharedGlobals;
+	instance->randomState = randomState;
+
+	for (size_t i = 0; i < _mgListLength(tasks); ++i)
+		mgDestroyValue(_mgListGet(tasks, i));
+
+	_mgListDestroy(tasks);
+}
+
+
+MGValue* mgWaitFuture(MGInstance *instance, const MGValue *future)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(mgValueType(future) == MG_TYPE_FUTURE);
+
+	MGValue *result = mgAtomicLoadPointer(&future->data.future.result);
+
+	if (result == NULL)
+	{
+		mgWaitTasks(instance);
+
+		result = mgAtomicLoadPointer(&future->data.future.result);
+
+		// The future was spawned outside of the current task or map
+		if (result == NULL)
+			mgFatalError("Error: Cannot wait for a future spawned outside of the current task");
+	}
+
+	return mgReferenceValue(result);
+}
@@ -0,0 +1,59 @@
+#ifndef MODELGEN_PARALLEL_H
+#define MODELGEN_PARALLEL_H
+
+#include "value.h"
+#include "frame.h"
+#include "thread.h"
+
+// A parallel map splits the items it maps into contiguous chunks, each run
+// by its own thread. The first chunk runs in the calling instance, while the
+// others run in worker instances sharing its modules, which must be treated
+// as read-only. Vertices emitted by each chunk are appended in order, so the
+// output is the same as when mapping the items sequentially.
+//
+// Tasks spawned by a script are pending until any of them is waited for, at
+// which point all of them run, each taken by the next thread which is free.
+// Vertices emitted by each task are appended in the order they were spawned.
+// Tasks spawned by a task or by a parallel map are run before it returns.
+
+typedef struct MGParallelMap {
+	MGMutex internMutex;
+	MGMutex compileMutex;
+} MGParallelMap;
+
+// Values are stamped with the epoch of the thread creating them, which maps
+// and tasks not nested in another advance. Containers created before the
+// epoch of the running map or task are shared by its threads, and modifying
+// them is an error like assigning globals, as it would race with the other
+// threads and make the results depend on the order they run in
+extern MG_THREAD_LOCAL uint32_t _mgValueEpoch;
+
+#define mgIsSharedValue(instance, value) \
+	((instance)->sharedGlobals && !mgIsImmediateValue(value) && ((value)->epoch < (instance)->sharedEpoch))
+
+// Fails if value is shared by the threads of the running map or task
+void mgCheckUnsharedValue(MGInstance *instance, const MGValue *value);
+
+// Sets the locals of the frame calling callable. Calls of a closure share
+// the locals it captured, unless the closure was created outside of the
+// running map or task, in which case each call has locals of its own
+void mgSetCallLocals(MGInstance *instance, MGStackFrame *frame, const MGValue *callable);
+
+// Set on each thread running a chunk or tasks, during which values and nodes
+// have their reference counts updated atomically, while strings are interned
+// and code is compiled while holding the mutexes of the map
+extern MG_THREAD_LOCAL MGParallelMap *_mgParallelMap;
+
+#define mgIsParallel() (_mgParallelMap != NULL)
+
+// Calls callable with the items at each index of the lists, like base.map
+MGValue* mgParallelMap(MGInstance *instance, const MGValue *callable, size_t argc, const MGValue* const* argv);
+
+// Returns a future of calling callable with the arguments
+MGValue* mgSpawnTask(MGInstance *instance, const MGValue *callable, size_t argc, const MGValue* const* argv);
+// Runs all pending tasks
+void mgWaitTasks(MGInstance *instance);
+// Returns the result of the task of future, running it if pending
+MGValue* mgWaitFuture(MGInstance *instance, const MGValue *future);
+
+#endif
\ No newline at end of file
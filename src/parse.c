@@ -4,7 +4,10 @@
 #include <stdarg.h>
 
 #include "parse.h"
+#include "compile.h"
+#include "types/primitive.h"
 #include "inspect.h"
+#include "parallel.h"
 #include "error.h"
 
 
@@ -97,7 +100,7 @@ void mgDestroyNode(MGNode *node)
 {
 	MG_ASSERT(node);
 
-	if (--node->refCount > 0)
+	if ((mgIsParallel() ? mgAtomicDecrement(&node->refCount) : --node->refCount) > 0)
 		return;
 
 	for (size_t i = 0; i < _mgListLength(node->children); ++i)
@@ -106,6 +109,12 @@ void mgDestroyNode(MGNode *node)
 
 	_mgListDestroy(node->children);
 
+	if (node->value)
+		mgDestroyValue(node->value);
+
+	if (node->code)
+		mgDestroyCode(node->code);
+
 	free(node);
 }
 
@@ -157,6 +166,10 @@ static inline MGNode* _mgDeepCopyNode(const MGNode *node)
 
 	*copy = *node;
 	copy->refCount = 1;
+	copy->code = NULL;
+
+	if (node->value)
+		mgReferenceValue(node->value);
 
 	if (_mgListLength(node->children))
 	{
@@ -176,7 +189,11 @@ MGNode* mgReferenceNode(const MGNode *node)
 	MG_ASSERT(node);
 
 	MGNode *referenced = (MGNode*) node;
-	++referenced->refCount;
+
+	if (mgIsParallel())
+		mgAtomicIncrement(&referenced->refCount);
+	else
+		++referenced->refCount;
 
 	return referenced;
 }
@@ -429,7 +446,17 @@ static MGNode* _mgParseSubexpression(MGParser *parser, MGToken *token)
 	else if ((token->type == MG_TOKEN_INTEGER) ||
 	         (token->type == MG_TOKEN_FLOAT))
 	{
-		node = mgCreateNode(token, (token->type == MG_TOKEN_INTEGER) ? MG_NODE_INTEGER : MG_NODE_FLOAT);
+		if (token->type == MG_TOKEN_INTEGER)
+		{
+			node = mgCreateNode(token, MG_NODE_INTEGER);
+			node->value = mgCreateValueInteger(token->value.i);
+		}
+		else
+		{
+			node = mgCreateNode(token, MG_NODE_FLOAT);
+			node->value = mgCreateValueFloat(token->value.f);
+		}
+
 		++token;
 	}
 	else if (token->type == MG_TOKEN_STRING)
@@ -0,0 +1,127 @@
+
+#include <string.h>
+#include <math.h>
+
+#include "range.h"
+#include "callable.h"
+#include "types/composite.h"
+#include "error.h"
+#include "utilities.h"
+
+
+extern MGValue* mg_range(MGInstance *instance, size_t argc, const MGValue* const* argv);
+
+
+void mgCreateRangeInteger(MGRange *range, int start, int stop, int step)
+{
+	const int difference = stop - start;
+
+	if (step == 0)
+		step = (difference > 0) - (difference < 0);
+
+	range->start = mgCreateValueInteger(start);
+	range->step = mgCreateValueInteger(step);
+
+	if ((difference == 0) || ((difference ^ step) < 0))
+		range->length = 0;
+	else
+		range->length = difference / step + ((difference % step) != 0);
+}
+
+
+void mgCreateRangeFloat(MGRange *range, float start, float stop, float step)
+{
+	const float difference = stop - start;
+
+	if (MG_FEQUAL(step, 0.0f))
+		step = (float) ((difference > 0) - (difference < 0));
+
+	range->start = mgCreateValueFloat(start);
+	range->step = mgCreateValueFloat(step);
+
+	const int length = MG_FEQUAL(difference, 0.0f) ? 0 : (int) ceilf(difference / step);
+
+	range->length = (length > 0) ? length : 0;
+}
+
+
+void mgCreateRangeFromArguments(MGRange *range, MGInstance *instance, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 3);
+	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT, 2, MG_TYPE_INTEGER, MG_TYPE_FLOAT);
+
+	if (argc < 1)
+		mgFatalError("Error: range expected at least 1 argument, received %zu", argc);
+	else if (argc > 3)
+		mgFatalError("Error: range expected at most 3 arguments, received %zu", argc);
+
+	MGbool isInt = MG_TRUE;
+
+	for (size_t i = 0; i < argc; ++i)
+		if (mgValueType(argv[i]) == MG_TYPE_FLOAT)
+			isInt = MG_FALSE;
+
+	union {
+		int i[3];
+		float f[3];
+	} bounds;
+
+	memset(&bounds, 0, sizeof(bounds));
+
+	if (isInt)
+	{
+		if (argc > 1)
+			for (size_t i = 0; i < argc; ++i)
+				bounds.i[i] = mgIntegerGet(argv[i]);
+		else
+			bounds.i[1] = mgIntegerGet(argv[0]);
+	}
+	else
+	{
+		if (argc > 1)
+			for (size_t i = 0; i < argc; ++i)
+				bounds.f[i] = (mgValueType(argv[i]) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(argv[i]) : mgFloatGet(argv[i]);
+		else
+			bounds.f[1] = (mgValueType(argv[0]) == MG_TYPE_INTEGER) ? (float) mgIntegerGet(argv[0]) : mgFloatGet(argv[0]);
+	}
+
+	if (argc > 2)
+		if ((isInt && (bounds.i[2] == 0)) || (!isInt && MG_FEQUAL(bounds.f[2], 0.0f)))
+			mgFatalError("Error: step cannot be 0");
+
+	if (isInt)
+		mgCreateRangeInteger(range, bounds.i[0], bounds.i[1], bounds.i[2]);
+	else
+		mgCreateRangeFloat(range, bounds.f[0], bounds.f[1], bounds.f[2]);
+}
+
+
+MGValue* mgRangeToList(const MGRange *range)
+{
+	MGValue *list = mgCreateValueList((size_t) range->length);
+
+	for (int i = 0; i < range->length; ++i)
+		mgListAdd(list, mgRangeGet(range, i));
+
+	return list;
+}
+
+
+MGbool mgIsRangeFunction(const MGValue *func)
+{
+	return (mgValueType(func) == MG_TYPE_CFUNCTION) && (func->data.cfunc == mg_range);
+}
+
+
+void mgCallRange(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                 size_t argc, const MGValue* const* argv, MGRange *range)
+{
+	MGStackFrame frame;
+	_mgInitCFunctionFrame(instance, frame, module, caller, callerName);
+
+	instance->callStackTop = &frame;
+
+	mgCreateRangeFromArguments(range, instance, argc, argv);
+
+	instance->callStackTop = frame.last;
+}
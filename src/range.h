@@ -0,0 +1,42 @@
+#ifndef MODELGEN_RANGE_H
+#define MODELGEN_RANGE_H
+
+#include "value.h"
+#include "instance.h"
+#include "types/primitive.h"
+
+// The half-closed interval [start, stop) stepped through without
+// creating a list, where start and step are either both integers
+// or both floats
+typedef struct MGRange {
+	MGValue *start;
+	MGValue *step;
+	int length;
+} MGRange;
+
+void mgCreateRangeInteger(MGRange *range, int start, int stop, int step);
+void mgCreateRangeFloat(MGRange *range, float start, float stop, float step);
+
+void mgCreateRangeFromArguments(MGRange *range, MGInstance *instance, size_t argc, const MGValue* const* argv);
+
+static inline MGValue* mgRangeItem(const MGValue *start, const MGValue *step, int index)
+{
+	if (_mgValueTag(start) == _MG_VALUE_TAG_INTEGER)
+		return mgCreateValueInteger(mgIntegerGet(start) + mgIntegerGet(step) * index);
+	else
+		return mgCreateValueFloat(mgFloatGet(start) + mgFloatGet(step) * (float) index);
+}
+
+#define mgRangeGet(range, index) mgRangeItem((range)->start, (range)->step, index)
+
+MGValue* mgRangeToList(const MGRange *range);
+
+// Checks whether func is range() of the base module, which
+// loops step through lazily instead of calling it
+MGbool mgIsRangeFunction(const MGValue *func);
+
+// Resolves the arguments of a range() call like calling it, but without creating the list
+void mgCallRange(MGInstance *instance, MGValue *module, const MGNode *caller, const char *callerName,
+                 size_t argc, const MGValue* const* argv, MGRange *range);
+
+#endif
\ No newline at end of file
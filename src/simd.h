@@ -0,0 +1,135 @@
+#ifndef MODELGEN_SIMD_H
+#define MODELGEN_SIMD_H
+
+// Four float lanes, operated on using SSE when available and otherwise
+// one lane at a time. Each lane yields exactly the same result as the
+// scalar operation would. Define MG_SIMD as 0 to always use the latter.
+
+#ifndef MG_SIMD
+#   if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#       define MG_SIMD 1
+#   else
+#       define MG_SIMD 0
+#   endif
+#endif
+
+#if MG_SIMD
+
+#include <xmmintrin.h>
+
+typedef __m128 MGFloat4;
+
+#define mgFloat4Load(p) _mm_loadu_ps(p)
+#define mgFloat4Store(p, v) _mm_storeu_ps(p, v)
+#define mgFloat4Set1(f) _mm_set1_ps(f)
+
+#define mgFloat4Add(a, b) _mm_add_ps(a, b)
+#define mgFloat4Sub(a, b) _mm_sub_ps(a, b)
+#define mgFloat4Mul(a, b) _mm_mul_ps(a, b)
+#define mgFloat4Div(a, b) _mm_div_ps(a, b)
+
+// Lanes of a which are greater (or less) than b, otherwise of b
+#define mgFloat4Max(a, b) _mm_max_ps(a, b)
+#define mgFloat4Min(a, b) _mm_min_ps(a, b)
+
+#define mgFloat4Negate(v) _mm_xor_ps(v, _mm_set1_ps(-0.0f))
+
+// Bit i is set if lane i of a and b are equal within tolerance, like MG_APPROXIMATELY
+#define mgFloat4Approximately(a, b, tolerance) \
+	_mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(a, _mm_sub_ps(b, _mm_set1_ps(tolerance))), \
+	                           _mm_cmple_ps(a, _mm_add_ps(b, _mm_set1_ps(tolerance)))))
+
+// Rotates the first three lanes, i.e. (y, z, x, w) and (z, x, y, w)
+#define mgFloat4YZX(v) _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1))
+#define mgFloat4ZXY(v) _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 0, 2))
+
+// Transposes the 4x4 matrix whose rows (or columns) are the four variables
+#define mgFloat4Transpose(v0, v1, v2, v3) _MM_TRANSPOSE4_PS(v0, v1, v2, v3)
+
+#else
+
+#include "utilities.h"
+
+typedef struct MGFloat4 {
+	float v[4];
+} MGFloat4;
+
+static inline MGFloat4 mgFloat4Load(const float *p)
+{
+	MGFloat4 r = { { p[0], p[1], p[2], p[3] } };
+	return r;
+}
+
+static inline void mgFloat4Store(float *p, MGFloat4 v)
+{
+	p[0] = v.v[0], p[1] = v.v[1], p[2] = v.v[2], p[3] = v.v[3];
+}
+
+static inline MGFloat4 mgFloat4Set1(float f)
+{
+	MGFloat4 r = { { f, f, f, f } };
+	return r;
+}
+
+#define _MG_FLOAT4_OP(name, lane) \
+	static inline MGFloat4 name(MGFloat4 a, MGFloat4 b) \
+	{ \
+		MGFloat4 r; \
+		for (int i = 0; i < 4; ++i) \
+			r.v[i] = lane; \
+		return r; \
+	}
+
+_MG_FLOAT4_OP(mgFloat4Add, a.v[i] + b.v[i])
+_MG_FLOAT4_OP(mgFloat4Sub, a.v[i] - b.v[i])
+_MG_FLOAT4_OP(mgFloat4Mul, a.v[i] * b.v[i])
+_MG_FLOAT4_OP(mgFloat4Div, a.v[i] / b.v[i])
+
+_MG_FLOAT4_OP(mgFloat4Max, (a.v[i] > b.v[i]) ? a.v[i] : b.v[i])
+_MG_FLOAT4_OP(mgFloat4Min, (a.v[i] < b.v[i]) ? a.v[i] : b.v[i])
+
+#undef _MG_FLOAT4_OP
+
+static inline MGFloat4 mgFloat4Negate(MGFloat4 v)
+{
+	MGFloat4 r = { { -v.v[0], -v.v[1], -v.v[2], -v.v[3] } };
+	return r;
+}
+
+static inline int mgFloat4Approximately(MGFloat4 a, MGFloat4 b, float tolerance)
+{
+	int mask = 0;
+	for (int i = 0; i < 4; ++i)
+		mask |= MG_APPROXIMATELY(a.v[i], b.v[i], tolerance) << i;
+	return mask;
+}
+
+static inline MGFloat4 mgFloat4YZX(MGFloat4 v)
+{
+	MGFloat4 r = { { v.v[1], v.v[2], v.v[0], v.v[3] } };
+	return r;
+}
+
+static inline MGFloat4 mgFloat4ZXY(MGFloat4 v)
+{
+	MGFloat4 r = { { v.v[2], v.v[0], v.v[1], v.v[3] } };
+	return r;
+}
+
+static inline void _mgFloat4Transpose(MGFloat4 *v0, MGFloat4 *v1, MGFloat4 *v2, MGFloat4 *v3)
+{
+	MGFloat4 *v[4] = { v0, v1, v2, v3 };
+	for (int i = 0; i < 4; ++i)
+		for (int j = i + 1; j < 4; ++j)
+		{
+			const float f = v[i]->v[j];
+			v[i]->v[j] = v[j]->v[i];
+			v[j]->v[i] = f;
+		}
+}
+
+#define mgFloat4Transpose(v0, v1, v2, v3) _mgFloat4Transpose(&(v0), &(v1), &(v2), &(v3))
+
+#endif
+
+#endif
\ No newline at end of file
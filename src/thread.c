@@ -0,0 +1,119 @@
+
+#ifndef _WIN32
+#   include <unistd.h>
+#endif
+
+#include "thread.h"
+#include "debug.h"
+
+
+#ifdef _WIN32
+static DWORD WINAPI _mgThreadMain(LPVOID data)
+#else
+static void* _mgThreadMain(void *data)
+#endif
+{
+	MGThread *thread = (MGThread*) data;
+
+	thread->func(thread->data);
+
+#ifdef _WIN32
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
+
+MGbool mgCreateThread(MGThread *thread, MGThreadFunction func, void *data)
+{
+	MG_ASSERT(thread);
+	MG_ASSERT(func);
+
+	thread->func = func;
+	thread->data = data;
+
+#ifdef _WIN32
+	thread->handle = CreateThread(NULL, 0, _mgThreadMain, thread, 0, NULL);
+
+	return thread->handle != NULL;
+#else
+	return pthread_create(&thread->handle, NULL, _mgThreadMain, thread) == 0;
+#endif
+}
+
+
+void mgJoinThread(MGThread *thread)
+{
+	MG_ASSERT(thread);
+
+#ifdef _WIN32
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->handle, NULL);
+#endif
+}
+
+
+void mgCreateMutex(MGMutex *mutex)
+{
+	MG_ASSERT(mutex);
+
+#ifdef _WIN32
+	InitializeCriticalSection(&mutex->handle);
+#else
+	pthread_mutex_init(&mutex->handle, NULL);
+#endif
+}
+
+
+void mgDestroyMutex(MGMutex *mutex)
+{
+	MG_ASSERT(mutex);
+
+#ifdef _WIN32
+	DeleteCriticalSection(&mutex->handle);
+#else
+	pthread_mutex_destroy(&mutex->handle);
+#endif
+}
+
+
+void mgLockMutex(MGMutex *mutex)
+{
+	MG_ASSERT(mutex);
+
+#ifdef _WIN32
+	EnterCriticalSection(&mutex->handle);
+#else
+	pthread_mutex_lock(&mutex->handle);
+#endif
+}
+
+
+void mgUnlockMutex(MGMutex *mutex)
+{
+	MG_ASSERT(mutex);
+
+#ifdef _WIN32
+	LeaveCriticalSection(&mutex->handle);
+#else
+	pthread_mutex_unlock(&mutex->handle);
+#endif
+}
+
+
+unsigned int mgGetProcessorCount(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	return (info.dwNumberOfProcessors > 0) ? (unsigned int) info.dwNumberOfProcessors : 1;
+#else
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (count > 0) ? (unsigned int) count : 1;
+#endif
+}
@@ -0,0 +1,81 @@
+#ifndef MODELGEN_THREAD_H
+#define MODELGEN_THREAD_H
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#endif
+
+#include "types.h"
+
+// State which would otherwise be global is kept per thread, as an
+// instance must only be used by the thread which created it
+
+#if defined(_MSC_VER)
+#   define MG_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#   define MG_THREAD_LOCAL __thread
+#else
+#   define MG_THREAD_LOCAL _Thread_local
+#endif
+
+// Reference counts shared between threads are updated using these,
+// returning the new count, and pointers published to other threads
+// are stored with release semantics and loaded with acquire semantics
+
+#if defined(_MSC_VER)
+#   ifdef _WIN64
+#       define mgAtomicIncrement(count) ((size_t) InterlockedIncrement64((volatile LONG64*) (count)))
+#       define mgAtomicDecrement(count) ((size_t) InterlockedDecrement64((volatile LONG64*) (count)))
+#   else
+#       define mgAtomicIncrement(count) ((size_t) InterlockedIncrement((volatile LONG*) (count)))
+#       define mgAtomicDecrement(count) ((size_t) InterlockedDecrement((volatile LONG*) (count)))
+#   endif
+#   define mgAtomicLoadPointer(ptr) InterlockedCompareExchangePointer((PVOID volatile*) (ptr), NULL, NULL)
+#   define mgAtomicStorePointer(ptr, value) InterlockedExchangePointer((PVOID volatile*) (ptr), (PVOID) (value))
+#   define mgAtomicExchangePointer(ptr, value) InterlockedExchangePointer((PVOID volatile*) (ptr), (PVOID) (value))
+#   define mgAtomicCompareExchangePointer(ptr, expected, value) \
+	(InterlockedCompareExchangePointer((PVOID volatile*) (ptr), (PVOID) (value), (PVOID) (expected)) == (PVOID) (expected))
+#else
+#   define mgAtomicIncrement(count) __atomic_add_fetch(count, 1, __ATOMIC_RELAXED)
+#   define mgAtomicDecrement(count) __atomic_sub_fetch(count, 1, __ATOMIC_ACQ_REL)
+#   define mgAtomicLoadPointer(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#   define mgAtomicStorePointer(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#   define mgAtomicExchangePointer(ptr, value) __atomic_exchange_n(ptr, value, __ATOMIC_ACQ_REL)
+#   define mgAtomicCompareExchangePointer(ptr, expected, value) \
+	__sync_bool_compare_and_swap(ptr, expected, value)
+#endif
+
+typedef void (*MGThreadFunction)(void *data);
+
+typedef struct MGThread {
+#ifdef _WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+	MGThreadFunction func;
+	void *data;
+} MGThread;
+
+MGbool mgCreateThread(MGThread *thread, MGThreadFunction func, void *data);
+void mgJoinThread(MGThread *thread);
+
+typedef struct MGMutex {
+#ifdef _WIN32
+	CRITICAL_SECTION handle;
+#else
+	pthread_mutex_t handle;
+#endif
+} MGMutex;
+
+void mgCreateMutex(MGMutex *mutex);
+void mgDestroyMutex(MGMutex *mutex);
+
+void mgLockMutex(MGMutex *mutex);
+void mgUnlockMutex(MGMutex *mutex);
+
+unsigned int mgGetProcessorCount(void);
+
+#endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "tokenize.h"
 #include "file.h"
+#include "intern.h"
 #include "utilities.h"
 
 
@@ -64,10 +65,8 @@ void _mgParseString(MGToken *token)
 {
 	const size_t len = token->end.string - token->begin.string - 2;
 
-	token->value.s = (char*) malloc((len + 1) * sizeof(char));
-	token->value.s[0] = '\0';
-
-	char c, *str = token->value.s;
+	char *buffer = (char*) malloc((len + 1) * sizeof(char));
+	char c, *str = buffer;
 
 	for (size_t i = 0; i < len; ++i)
 	{
@@ -113,7 +112,29 @@ void _mgParseString(MGToken *token)
 		*str++ = c;
 	}
 
-	*str = '\0';
+	token->value.s = mgInternStringEx(buffer, str - buffer);
+
+	free(buffer);
+}
+
+
+static inline void _mgParseInteger(MGToken *token, int base)
+{
+	// Skip the 0x, 0b and 0o prefixes, as strtol
+	// only understands the hexadecimal one
+	const size_t prefix = (base != 10) ? 2 : 0;
+
+	char *str = mgStringDuplicateFixed(token->begin.string + prefix, token->end.string - token->begin.string - prefix);
+	token->value.i = (int) strtol(str, NULL, base);
+	free(str);
+}
+
+
+static inline void _mgParseFloat(MGToken *token)
+{
+	char *str = mgStringDuplicateFixed(token->begin.string, token->end.string - token->begin.string);
+	token->value.f = strtof(str, NULL);
+	free(str);
 }
 
 
@@ -392,9 +413,7 @@ void mgTokenizeNext(MGToken *token)
 
 		if (token->type == MG_TOKEN_NAME)
 		{
-			token->value.s = (char*) malloc((len + 1) * sizeof(char));
-			strncpy(token->value.s, token->begin.string, len);
-			token->value.s[len] = '\0';
+			token->value.s = mgInternStringEx(token->begin.string, len);
 		}
 	}
 	else if (isdigit(c))
@@ -412,6 +431,7 @@ void mgTokenizeNext(MGToken *token)
 				while (_mgIsHexadecimal(*token->end.string))
 					_mgTokenNextCharacter(token);
 
+				_mgParseInteger(token, 16);
 				return;
 			}
 			else if ((*token->end.string == 'b') || (*token->end.string == 'B'))
@@ -421,6 +441,7 @@ void mgTokenizeNext(MGToken *token)
 				while (_mgIsBinary(*token->end.string))
 					_mgTokenNextCharacter(token);
 
+				_mgParseInteger(token, 2);
 				return;
 			}
 			else if ((*token->end.string == 'o') || (*token->end.string == 'O'))
@@ -430,6 +451,7 @@ void mgTokenizeNext(MGToken *token)
 				while (_mgIsOctal(*token->end.string))
 					_mgTokenNextCharacter(token);
 
+				_mgParseInteger(token, 8);
 				return;
 			}
 		}
@@ -458,6 +480,11 @@ decimal:
 			while (isdigit(*token->end.string))
 				_mgTokenNextCharacter(token);
 		}
+
+		if (token->type == MG_TOKEN_INTEGER)
+			_mgParseInteger(token, 10);
+		else
+			_mgParseFloat(token);
 	}
 	else if (c == '"')
 	{
@@ -537,7 +564,7 @@ void mgDestroyTokenizer(MGTokenizer *tokenizer)
 {
 	for (size_t i = 0; i < _mgListLength(tokenizer->tokens); ++i)
 		if (((_mgListGet(tokenizer->tokens, i).type == MG_TOKEN_NAME) || (_mgListGet(tokenizer->tokens, i).type == MG_TOKEN_STRING)) && _mgListGet(tokenizer->tokens, i).value.s)
-			free(_mgListGet(tokenizer->tokens, i).value.s);
+			mgReleaseInternedString(_mgListGet(tokenizer->tokens, i).value.s);
 
 	_mgListDestroy(tokenizer->tokens);
 
@@ -566,7 +593,7 @@ static inline MGToken* _mgTokenizeString(MGTokenizer *tokenizer, size_t *tokenCo
 			capacity = capacity ? capacity << 1 : 2;
 
 			// Out of memory is an unrecoverable state and will currently result in a graceless crash
-			tokens = (MGToken*) realloc(tokens, capacity * sizeof(MGToken));
+			tokens = (MGToken*) mgReallocate(tokens, capacity * sizeof(MGToken));
 		}
 
 		mgTokenizeNext(&token);
@@ -89,7 +89,7 @@ typedef struct MGToken {
 	union {
 		int i;
 		float f;
-		char *s;
+		const char *s;
 	} value;
 } MGToken;
 
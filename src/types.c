@@ -6,7 +6,12 @@
 #include "value.h"
 #include "types/primitive.h"
 #include "types/composite.h"
+#include "types/vector.h"
+#include "types/matrix.h"
+#include "types/buffer.h"
+#include "intern.h"
 #include "callable.h"
+#include "iterator.h"
 #include "error.h"
 #include "utilities.h"
 #include "debug.h"
@@ -20,20 +25,66 @@ extern MGValue* mgListMul(const MGValue *lhs, const MGValue *rhs);
 extern MGValue* mgListSubscriptGet(const MGValue *list, const MGValue *index);
 extern MGbool mgListSubscriptSet(const MGValue *list, const MGValue *index, MGValue *value);
 extern MGValue* mgListAttributeGet(const MGValue *list, const char *key);
+extern MGBoundCFunction mgListMethodGet(const char *key);
+extern MGValue* mgListIterate(const MGValue *list);
 
 extern MGValue* mgMapAdd(const MGValue *lhs, const MGValue *rhs);
 extern MGValue* mgMapSubscriptGet(const MGValue *map, const MGValue *key);
 extern MGbool mgMapSubscriptSet(const MGValue *map, const MGValue *key, MGValue *value);
 extern MGValue* mgMapAttributeGet(const MGValue *map, const char *key);
 extern MGbool mgMapAttributeSet(const MGValue *map, const char *key, MGValue *value);
+extern MGBoundCFunction mgMapMethodGet(const char *key);
+extern MGValue* mgMapIterate(const MGValue *map);
+
+extern MGValue* mgVectorConvert(const MGValue *value, MGType type);
+extern char* mgVectorToString(const MGValue *vector);
+extern MGValue* mgVectorPositive(const MGValue *operand);
+extern MGValue* mgVectorNegative(const MGValue *operand);
+extern MGValue* mgVectorAdd(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgVectorSub(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgVectorMul(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgVectorDiv(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgVectorMod(const MGValue *lhs, const MGValue *rhs);
+extern MGtribool mgVectorEqual(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgVectorSubscriptGet(const MGValue *vector, const MGValue *index);
+extern MGValue* mgVectorAttributeGet(const MGValue *vector, const char *key);
+extern MGValue* mgVectorIterate(const MGValue *vector);
+
+extern MGValue* mgMatrixConvert(const MGValue *value, MGType type);
+extern char* mgMatrixToString(const MGValue *matrix);
+extern MGValue* mgMatrixMul(const MGValue *lhs, const MGValue *rhs);
+extern MGtribool mgMatrixEqual(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgMatrixSubscriptGet(const MGValue *matrix, const MGValue *index);
+extern MGValue* mgMatrixIterate(const MGValue *matrix);
+
+extern void mgBufferCopy(MGValue *copy, const MGValue *buffer, MGbool shallow);
+extern void mgBufferDestroy(MGValue *buffer);
+extern MGValue* mgBufferConvert(const MGValue *buffer, MGType type);
+extern MGbool mgBufferTruthValue(const MGValue *buffer);
+extern char* mgBufferToString(const MGValue *buffer);
+extern MGValue* mgBufferPositive(const MGValue *operand);
+extern MGValue* mgBufferNegative(const MGValue *operand);
+extern MGValue* mgBufferAdd(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgBufferSub(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgBufferMul(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgBufferDiv(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgBufferMod(const MGValue *lhs, const MGValue *rhs);
+extern MGtribool mgBufferEqual(const MGValue *lhs, const MGValue *rhs);
+extern MGValue* mgBufferSubscriptGet(const MGValue *buffer, const MGValue *index);
+extern MGbool mgBufferSubscriptSet(const MGValue *buffer, const MGValue *index, MGValue *value);
+extern MGValue* mgBufferAttributeGet(const MGValue *buffer, const char *key);
+extern MGBoundCFunction mgBufferMethodGet(const char *key);
+extern MGValue* mgBufferIterate(const MGValue *buffer);
 
 
 void mgAnyCopy(MGValue *copy, const MGValue *value, MGbool shallow)
 {
-	switch (copy->type)
+	switch (mgValueType(copy))
 	{
 	case MG_TYPE_STRING:
-		if (value->data.str.usage != MG_STRING_USAGE_STATIC)
+		if (value->data.str.usage == MG_STRING_USAGE_INTERNED)
+			mgReferenceInternedString(value->data.str.s);
+		else if (value->data.str.usage != MG_STRING_USAGE_STATIC)
 			copy->data.str.s = mgStringDuplicate(value->data.str.s);
 		break;
 	case MG_TYPE_TUPLE:
@@ -57,6 +108,8 @@ void mgAnyCopy(MGValue *copy, const MGValue *value, MGbool shallow)
 			_mgListInitialize(copy->data.a);
 		break;
 	case MG_TYPE_MAP:
+		_mgCreateMap(&copy->data.m, _mgMapSize(value->data.m));
+
 		if (_mgMapSize(value->data.m))
 		{
 			MGMapIterator iterator;
@@ -77,8 +130,6 @@ void mgAnyCopy(MGValue *copy, const MGValue *value, MGbool shallow)
 
 			mgDestroyMapIterator(&iterator);
 		}
-		else
-			_mgCreateMap(&copy->data.m, 0);
 		break;
 	case MG_TYPE_BOUND_CFUNCTION:
 		copy->data.bcfunc.bound = mgReferenceValue(value->data.bcfunc.bound);
@@ -98,11 +149,10 @@ void mgAnyCopy(MGValue *copy, const MGValue *value, MGbool shallow)
 
 void mgAnyDestroy(MGValue *value)
 {
-	switch (value->type)
+	switch (mgValueType(value))
 	{
 	case MG_TYPE_STRING:
-		if (value->data.str.usage != MG_STRING_USAGE_STATIC)
-			free(value->data.str.s);
+		mgStringRelease(value);
 		break;
 	case MG_TYPE_TUPLE:
 	case MG_TYPE_LIST:
@@ -129,6 +179,25 @@ void mgAnyDestroy(MGValue *value)
 		if (value->data.func.locals)
 			mgDestroyValue(value->data.func.locals);
 		break;
+	case MG_TYPE_ITERATOR:
+		for (size_t i = 0; i < _mgListLength(value->data.iter->values); ++i)
+			mgDestroyValue(_mgListGet(value->data.iter->values, i));
+		_mgListDestroy(value->data.iter->values);
+		if (value->data.iter->callable)
+			mgDestroyValue(value->data.iter->callable);
+		if (value->data.iter->window)
+			mgDestroyValue(value->data.iter->window);
+		mgFree(value->data.iter);
+		break;
+	case MG_TYPE_FUTURE:
+		for (size_t i = 0; i < _mgListLength(value->data.future.values); ++i)
+			mgDestroyValue(_mgListGet(value->data.future.values, i));
+		_mgListDestroy(value->data.future.values);
+		mgDestroyValue(value->data.future.module);
+		mgDestroyValue(value->data.future.transform);
+		if (value->data.future.result)
+			mgDestroyValue(value->data.future.result);
+		break;
 	default:
 		break;
 	}
@@ -144,12 +213,12 @@ MGValue* mgAnyConvert(const MGValue *value, MGType type)
 	}
 	else if (type == MG_TYPE_INTEGER)
 	{
-		switch (value->type)
+		switch (mgValueType(value))
 		{
 		case MG_TYPE_INTEGER:
-			return mgCreateValueInteger(value->data.i);
+			return mgCreateValueInteger(mgIntegerGet(value));
 		case MG_TYPE_FLOAT:
-			return mgCreateValueInteger((int) value->data.f);
+			return mgCreateValueInteger((int) mgFloatGet(value));
 		case MG_TYPE_STRING:
 			return mgCreateValueInteger(strtol(value->data.str.s, NULL, 10));
 		default:
@@ -158,30 +227,42 @@ MGValue* mgAnyConvert(const MGValue *value, MGType type)
 	}
 	else if (type == MG_TYPE_FLOAT)
 	{
-		switch (value->type)
+		switch (mgValueType(value))
 		{
 		case MG_TYPE_INTEGER:
-			return mgCreateValueFloat((float) value->data.i);
+			return mgCreateValueFloat((float) mgIntegerGet(value));
 		case MG_TYPE_FLOAT:
-			return mgCreateValueFloat(value->data.f);
+			return mgCreateValueFloat(mgFloatGet(value));
 		case MG_TYPE_STRING:
 			return mgCreateValueFloat(strtof(value->data.str.s, NULL));
 		default:
 			return NULL;
 		}
 	}
-	else if ((type == MG_TYPE_TUPLE) && (value->type == MG_TYPE_LIST))
+	else if ((type == MG_TYPE_TUPLE) && (mgValueType(value) == MG_TYPE_LIST))
 	{
 		MGValue *copy = mgShallowCopyValue(value);
 		copy->type = MG_TYPE_TUPLE;
 		return copy;
 	}
-	else if ((type == MG_TYPE_LIST) && (value->type == MG_TYPE_TUPLE))
+	else if ((type == MG_TYPE_LIST) && (mgValueType(value) == MG_TYPE_TUPLE))
 	{
 		MGValue *copy = mgShallowCopyValue(value);
 		copy->type = MG_TYPE_LIST;
 		return copy;
 	}
+	else if (mgIsVectorType(type) && ((mgValueType(value) == MG_TYPE_TUPLE) || (mgValueType(value) == MG_TYPE_LIST)))
+	{
+		float components[4];
+		return mgVectorLoad(value, mgVectorTypeLength(type), components) ? mgCreateValueVector(mgVectorTypeLength(type), components) : NULL;
+	}
+	else if ((type == MG_TYPE_MAT4) && ((mgValueType(value) == MG_TYPE_TUPLE) || (mgValueType(value) == MG_TYPE_LIST)))
+	{
+		float components[16];
+		return mgMatrixLoad(value, components) ? mgCreateValueMatrix(components) : NULL;
+	}
+	else if ((type == MG_TYPE_BUFFER) && ((mgValueType(value) == MG_TYPE_TUPLE) || (mgValueType(value) == MG_TYPE_LIST)))
+		return mgCreateValueBufferFrom(value, MG_BUFFER_FORMAT_FLOAT, 0);
 
 	return NULL;
 }
@@ -189,14 +270,14 @@ MGValue* mgAnyConvert(const MGValue *value, MGType type)
 
 MGbool mgAnyTruthValue(const MGValue *value)
 {
-	switch (value->type)
+	switch (mgValueType(value))
 	{
 	case MG_TYPE_NULL:
 		return MG_FALSE;
 	case MG_TYPE_INTEGER:
-		return value->data.i != 0;
+		return mgIntegerGet(value) != 0;
 	case MG_TYPE_FLOAT:
-		return !MG_FEQUAL(value->data.f, 0.0f);
+		return !MG_FEQUAL(mgFloatGet(value), 0.0f);
 	case MG_TYPE_STRING:
 		return mgStringLength(value) != 0;
 	case MG_TYPE_TUPLE:
@@ -217,14 +298,14 @@ char* mgAnyToString(const MGValue *value)
 	size_t len, len2;
 	void *p;
 
-	switch (value->type)
+	switch (mgValueType(value))
 	{
 	case MG_TYPE_NULL:
 		return mgStringDuplicateEx("null", 4);
 	case MG_TYPE_INTEGER:
-		return mgIntToString(value->data.i);
+		return mgIntToString(mgIntegerGet(value));
 	case MG_TYPE_FLOAT:
-		return mgFloatToString(value->data.f);
+		return mgFloatToString(mgFloatGet(value));
 	case MG_TYPE_STRING:
 		return mgStringDuplicateEx(value->data.str.s, value->data.str.length);
 	case MG_TYPE_TUPLE:
@@ -233,7 +314,7 @@ char* mgAnyToString(const MGValue *value)
 		s = (char*) malloc((len + 1) * sizeof(char));
 		end = s;
 
-		*end++ = (char) ((value->type == MG_TYPE_TUPLE) ? '(' : '[');
+		*end++ = (char) ((mgValueType(value) == MG_TYPE_TUPLE) ? '(' : '[');
 
 		for (size_t i = 0; i < _mgListLength(value->data.a); ++i)
 		{
@@ -242,7 +323,7 @@ char* mgAnyToString(const MGValue *value)
 
 			len2 = strlen(s2);
 			len += len2 + ((i > 0) ? 2 : 0);
-			len += ((_mgListGet(value->data.a, i)->type == MG_TYPE_STRING) ? 2 : 0);
+			len += ((mgValueType(_mgListGet(value->data.a, i)) == MG_TYPE_STRING) ? 2 : 0);
 
 			end = end - (size_t) s;
 			s = realloc(s, (len + 1) * sizeof(char));
@@ -251,19 +332,19 @@ char* mgAnyToString(const MGValue *value)
 			if (i > 0)
 				*end++ = ',', *end++ = ' ';
 
-			if (_mgListGet(value->data.a, i)->type == MG_TYPE_STRING)
+			if (mgValueType(_mgListGet(value->data.a, i)) == MG_TYPE_STRING)
 				*end++ = '"';
 
 			strcpy(end, s2);
 			end += len2;
 
-			if (_mgListGet(value->data.a, i)->type == MG_TYPE_STRING)
+			if (mgValueType(_mgListGet(value->data.a, i)) == MG_TYPE_STRING)
 				*end++ = '"';
 
 			free(s2);
 		}
 
-		*end++ = (char) ((value->type == MG_TYPE_TUPLE) ? ')' : ']');
+		*end++ = (char) ((mgValueType(value) == MG_TYPE_TUPLE) ? ')' : ']');
 		*end = '\0';
 
 		return s;
@@ -290,7 +371,7 @@ char* mgAnyToString(const MGValue *value)
 				MG_ASSERT(s2);
 				len2 = strlen(s2);
 				len += len2 + (((i == 0) && ((end - s) > 1)) ? 2 : 0);
-				len += 2 + ((value2->type == MG_TYPE_STRING) ? 2 : 0);
+				len += 2 + ((mgValueType(value2) == MG_TYPE_STRING) ? 2 : 0);
 
 				end = end - (size_t) s;
 				s = realloc(s, (len + 1) * sizeof(char));
@@ -299,13 +380,13 @@ char* mgAnyToString(const MGValue *value)
 				if ((i == 0) && ((end - s) > 1))
 					*end++ = ',', *end++ = ' ';
 
-				if (value2->type == MG_TYPE_STRING)
+				if (mgValueType(value2) == MG_TYPE_STRING)
 					*end++ = '"';
 
 				strcpy(end, s2);
 				end += len2;
 
-				if (value2->type == MG_TYPE_STRING)
+				if (mgValueType(value2) == MG_TYPE_STRING)
 					*end++ = '"';
 
 				if (i == 0)
@@ -325,7 +406,7 @@ char* mgAnyToString(const MGValue *value)
 	case MG_TYPE_FUNCTION:
 	case MG_TYPE_PROCEDURE:
 		p = NULL;
-		switch (value->type)
+		switch (mgValueType(value))
 		{
 		case MG_TYPE_CFUNCTION:
 			p = value->data.cfunc;
@@ -356,12 +437,12 @@ char* mgAnyToString(const MGValue *value)
 
 MGValue* mgAnyPositive(const MGValue *operand)
 {
-	switch (operand->type)
+	switch (mgValueType(operand))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger(+operand->data.i);
+		return mgCreateValueInteger(+mgIntegerGet(operand));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(+operand->data.f);
+		return mgCreateValueFloat(+mgFloatGet(operand));
 	default:
 		return NULL;
 	}
@@ -370,12 +451,12 @@ MGValue* mgAnyPositive(const MGValue *operand)
 
 MGValue* mgAnyNegative(const MGValue *operand)
 {
-	switch (operand->type)
+	switch (mgValueType(operand))
 	{
 	case MG_TYPE_INTEGER:
-		return mgCreateValueInteger(-operand->data.i);
+		return mgCreateValueInteger(-mgIntegerGet(operand));
 	case MG_TYPE_FLOAT:
-		return mgCreateValueFloat(-operand->data.f);
+		return mgCreateValueFloat(-mgFloatGet(operand));
 	default:
 		return NULL;
 	}
@@ -392,19 +473,27 @@ MGtribool mgAnyEqual(const MGValue *lhs, const MGValue *rhs)
 {
 	if (lhs == rhs)
 		return MG_TRUE;
-	else if ((lhs->type == MG_TYPE_NULL) || (rhs->type == MG_TYPE_NULL))
-		return lhs->type == rhs->type;
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return lhs->data.i == rhs->data.i;
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return lhs->data.f == rhs->data.i;
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return lhs->data.i == rhs->data.f;
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return MG_FEQUAL(lhs->data.f, rhs->data.f);
-	else if ((lhs->type == MG_TYPE_STRING) && (rhs->type == MG_TYPE_STRING))
-		return (lhs->data.str.s == rhs->data.str.s) || ((lhs->data.str.length == rhs->data.str.length) && !strcmp(lhs->data.str.s, rhs->data.str.s));
-	else if (((lhs->type == MG_TYPE_TUPLE) || (lhs->type == MG_TYPE_LIST)) && (lhs->type == rhs->type))
+	else if ((mgValueType(lhs) == MG_TYPE_NULL) || (mgValueType(rhs) == MG_TYPE_NULL))
+		return mgValueType(lhs) == mgValueType(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgIntegerGet(lhs) == mgIntegerGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgFloatGet(lhs) == mgIntegerGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgIntegerGet(lhs) == mgFloatGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return MG_FEQUAL(mgFloatGet(lhs), mgFloatGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_STRING) && (mgValueType(rhs) == MG_TYPE_STRING))
+	{
+		if (lhs->data.str.s == rhs->data.str.s)
+			return MG_TRUE;
+		// Equal interned strings are the same pointer
+		else if ((lhs->data.str.usage == MG_STRING_USAGE_INTERNED) && (rhs->data.str.usage == MG_STRING_USAGE_INTERNED))
+			return MG_FALSE;
+
+		return (lhs->data.str.length == rhs->data.str.length) && !strcmp(lhs->data.str.s, rhs->data.str.s);
+	}
+	else if (((mgValueType(lhs) == MG_TYPE_TUPLE) || (mgValueType(lhs) == MG_TYPE_LIST)) && (mgValueType(lhs) == mgValueType(rhs)))
 	{
 		if (mgListLength(lhs) != mgListLength(rhs))
 			return MG_FALSE;
@@ -415,7 +504,7 @@ MGtribool mgAnyEqual(const MGValue *lhs, const MGValue *rhs)
 
 		return MG_TRUE;
 	}
-	else if ((lhs->type == MG_TYPE_MAP) && (rhs->type == MG_TYPE_MAP))
+	else if ((mgValueType(lhs) == MG_TYPE_MAP) && (mgValueType(rhs) == MG_TYPE_MAP))
 	{
 		if (mgMapSize(lhs) != mgMapSize(rhs))
 			return MG_FALSE;
@@ -441,11 +530,11 @@ MGtribool mgAnyEqual(const MGValue *lhs, const MGValue *rhs)
 
 		return result;
 	}
-	else if ((lhs->type == MG_TYPE_CFUNCTION) || (rhs->type == MG_TYPE_CFUNCTION))
+	else if ((mgValueType(lhs) == MG_TYPE_CFUNCTION) || (mgValueType(rhs) == MG_TYPE_CFUNCTION))
 		return lhs->data.cfunc == rhs->data.cfunc;
-	else if ((lhs->type == MG_TYPE_BOUND_CFUNCTION) || (rhs->type == MG_TYPE_BOUND_CFUNCTION))
+	else if ((mgValueType(lhs) == MG_TYPE_BOUND_CFUNCTION) || (mgValueType(rhs) == MG_TYPE_BOUND_CFUNCTION))
 		return (lhs->data.bcfunc.cfunc == rhs->data.bcfunc.cfunc) && (lhs->data.bcfunc.bound == rhs->data.bcfunc.bound);
-	else if (((lhs->type == MG_TYPE_FUNCTION) || (lhs->type == MG_TYPE_PROCEDURE)) && (lhs->type == rhs->type))
+	else if (((mgValueType(lhs) == MG_TYPE_FUNCTION) || (mgValueType(lhs) == MG_TYPE_PROCEDURE)) && (mgValueType(lhs) == mgValueType(rhs)))
 		return lhs->data.func.node == rhs->data.func.node;
 
 	return MG_INDETERMINATE;
@@ -456,15 +545,15 @@ MGtribool mgAnyLess(const MGValue *lhs, const MGValue *rhs)
 {
 	if (lhs == rhs)
 		return MG_FALSE;
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return lhs->data.i < rhs->data.i;
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return lhs->data.f < rhs->data.i;
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return lhs->data.i < rhs->data.f;
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return lhs->data.f < rhs->data.f;
-	else if ((lhs->type == MG_TYPE_STRING) && (rhs->type == MG_TYPE_STRING))
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgIntegerGet(lhs) < mgIntegerGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgFloatGet(lhs) < mgIntegerGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgIntegerGet(lhs) < mgFloatGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgFloatGet(lhs) < mgFloatGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_STRING) && (mgValueType(rhs) == MG_TYPE_STRING))
 		return strcmp(lhs->data.str.s, rhs->data.str.s) < 0;
 	return MG_INDETERMINATE;
 }
@@ -474,15 +563,15 @@ MGtribool mgAnyLessEqual(const MGValue *lhs, const MGValue *rhs)
 {
 	if (lhs == rhs)
 		return MG_TRUE;
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return lhs->data.i <= rhs->data.i;
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return lhs->data.f <= rhs->data.i;
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return lhs->data.i <= rhs->data.f;
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return lhs->data.f <= rhs->data.f;
-	else if ((lhs->type == MG_TYPE_STRING) && (rhs->type == MG_TYPE_STRING))
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgIntegerGet(lhs) <= mgIntegerGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgFloatGet(lhs) <= mgIntegerGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgIntegerGet(lhs) <= mgFloatGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgFloatGet(lhs) <= mgFloatGet(rhs);
+	else if ((mgValueType(lhs) == MG_TYPE_STRING) && (mgValueType(rhs) == MG_TYPE_STRING))
 		return strcmp(lhs->data.str.s, rhs->data.str.s) <= 0;
 	return MG_INDETERMINATE;
 }
@@ -490,129 +579,129 @@ MGtribool mgAnyLessEqual(const MGValue *lhs, const MGValue *rhs)
 
 MGValue* mgIntAdd(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueInteger(lhs->data.i + rhs->data.i);
+	if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueInteger(mgIntegerGet(lhs) + mgIntegerGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgIntSub(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueInteger(lhs->data.i - rhs->data.i);
+	if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueInteger(mgIntegerGet(lhs) - mgIntegerGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgIntMul(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueInteger(lhs->data.i * rhs->data.i);
+	if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueInteger(mgIntegerGet(lhs) * mgIntegerGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgIntDiv(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type != MG_TYPE_INTEGER) || (rhs->type != MG_TYPE_INTEGER))
+	if ((mgValueType(lhs) != MG_TYPE_INTEGER) || (mgValueType(rhs) != MG_TYPE_INTEGER))
 		return NULL;
-	return mgCreateValueFloat(lhs->data.i / (float) rhs->data.i);
+	return mgCreateValueFloat(mgIntegerGet(lhs) / (float) mgIntegerGet(rhs));
 }
 
 
 MGValue* mgIntIntDiv(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type != MG_TYPE_INTEGER) || (rhs->type != MG_TYPE_INTEGER))
+	if ((mgValueType(lhs) != MG_TYPE_INTEGER) || (mgValueType(rhs) != MG_TYPE_INTEGER))
 		return NULL;
-	if (rhs->data.i == 0)
+	if (mgIntegerGet(rhs) == 0)
 		mgFatalError("Error: Division by zero");
-	return mgCreateValueInteger(lhs->data.i / rhs->data.i);
+	return mgCreateValueInteger(mgIntegerGet(lhs) / mgIntegerGet(rhs));
 }
 
 
 MGValue* mgIntMod(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueInteger(lhs->data.i % rhs->data.i);
+	if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueInteger(mgIntegerGet(lhs) % mgIntegerGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgFloatAdd(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueFloat(lhs->data.f + rhs->data.i);
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.i + rhs->data.f);
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.f + rhs->data.f);
+	if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueFloat(mgFloatGet(lhs) + mgIntegerGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgIntegerGet(lhs) + mgFloatGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgFloatGet(lhs) + mgFloatGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgFloatSub(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueFloat(lhs->data.f - rhs->data.i);
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.i - rhs->data.f);
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.f - rhs->data.f);
+	if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueFloat(mgFloatGet(lhs) - mgIntegerGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgIntegerGet(lhs) - mgFloatGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgFloatGet(lhs) - mgFloatGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgFloatMul(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueFloat(lhs->data.f * rhs->data.i);
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.i * rhs->data.f);
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.f * rhs->data.f);
+	if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueFloat(mgFloatGet(lhs) * mgIntegerGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgIntegerGet(lhs) * mgFloatGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgFloatGet(lhs) * mgFloatGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgFloatDiv(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueFloat(lhs->data.f / rhs->data.i);
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.i / rhs->data.f);
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(lhs->data.f / rhs->data.f);
+	if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueFloat(mgFloatGet(lhs) / mgIntegerGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgIntegerGet(lhs) / mgFloatGet(rhs));
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(mgFloatGet(lhs) / mgFloatGet(rhs));
 	return NULL;
 }
 
 
 MGValue* mgFloatIntDiv(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueInteger((int) (lhs->data.f / rhs->data.i));
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueInteger((int) (lhs->data.i / rhs->data.f));
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueInteger((int) (lhs->data.f / rhs->data.f));
+	if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueInteger((int) (mgFloatGet(lhs) / mgIntegerGet(rhs)));
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueInteger((int) (mgIntegerGet(lhs) / mgFloatGet(rhs)));
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueInteger((int) (mgFloatGet(lhs) / mgFloatGet(rhs)));
 	return NULL;
 }
 
 
 MGValue* mgFloatMod(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_INTEGER))
-		return mgCreateValueFloat(fmodf(lhs->data.f, (float) rhs->data.i));
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(fmodf((float) lhs->data.i, rhs->data.f));
-	else if ((lhs->type == MG_TYPE_FLOAT) && (rhs->type == MG_TYPE_FLOAT))
-		return mgCreateValueFloat(fmodf(lhs->data.f, rhs->data.f));
+	if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_INTEGER))
+		return mgCreateValueFloat(fmodf(mgFloatGet(lhs), (float) mgIntegerGet(rhs)));
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(fmodf((float) mgIntegerGet(lhs), mgFloatGet(rhs)));
+	else if ((mgValueType(lhs) == MG_TYPE_FLOAT) && (mgValueType(rhs) == MG_TYPE_FLOAT))
+		return mgCreateValueFloat(fmodf(mgFloatGet(lhs), mgFloatGet(rhs)));
 	return NULL;
 }
 
 
 MGValue* mgStringAdd(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_STRING) && (rhs->type == MG_TYPE_STRING))
+	if ((mgValueType(lhs) == MG_TYPE_STRING) && (mgValueType(rhs) == MG_TYPE_STRING))
 	{
 		size_t len = lhs->data.str.length + rhs->data.str.length;
 		char *s = (char*) malloc((len + 1) * sizeof(char));
@@ -622,7 +711,7 @@ MGValue* mgStringAdd(const MGValue *lhs, const MGValue *rhs)
 		s[len] = '\0';
 		return mgCreateValueStringEx(s, MG_STRING_USAGE_KEEP);
 	}
-	else if (lhs->type == MG_TYPE_STRING)
+	else if (mgValueType(lhs) == MG_TYPE_STRING)
 	{
 		char *s2 = mgValueToString(rhs);
 		MG_ASSERT(s2);
@@ -639,7 +728,7 @@ MGValue* mgStringAdd(const MGValue *lhs, const MGValue *rhs)
 
 		return mgCreateValueStringEx(s, MG_STRING_USAGE_KEEP);
 	}
-	else if (rhs->type == MG_TYPE_STRING)
+	else if (mgValueType(rhs) == MG_TYPE_STRING)
 	{
 		char *s2 = mgValueToString(lhs);
 		MG_ASSERT(s2);
@@ -667,17 +756,17 @@ MGValue* mgStringMul(const MGValue *lhs, const MGValue *rhs)
 	size_t len;
 	int times;
 
-	if ((lhs->type == MG_TYPE_STRING) && (rhs->type == MG_TYPE_INTEGER))
+	if ((mgValueType(lhs) == MG_TYPE_STRING) && (mgValueType(rhs) == MG_TYPE_INTEGER))
 	{
 		str = lhs->data.str.s;
 		len = lhs->data.str.length;
-		times = rhs->data.i;
+		times = mgIntegerGet(rhs);
 	}
-	else if ((lhs->type == MG_TYPE_INTEGER) && (rhs->type == MG_TYPE_STRING))
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) && (mgValueType(rhs) == MG_TYPE_STRING))
 	{
 		str = rhs->data.str.s;
 		len = rhs->data.str.length;
-		times = lhs->data.i;
+		times = mgIntegerGet(lhs);
 	}
 	else
 		return NULL;
@@ -754,6 +843,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -779,6 +870,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -804,6 +897,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -829,6 +924,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -854,7 +951,9 @@ const MGTypeData _mgTypes[] = {
 		mgListSubscriptGet,
 		mgListSubscriptSet,
 		NULL,
-		NULL
+		NULL,
+		NULL,
+		mgListIterate
 	},
 	{
 		"list",
@@ -879,7 +978,9 @@ const MGTypeData _mgTypes[] = {
 		mgListSubscriptGet,
 		mgListSubscriptSet,
 		mgListAttributeGet,
-		NULL
+		NULL,
+		mgListMethodGet,
+		mgListIterate
 	},
 	{
 		"map",
@@ -904,7 +1005,9 @@ const MGTypeData _mgTypes[] = {
 		mgMapSubscriptGet,
 		mgMapSubscriptSet,
 		mgMapAttributeGet,
-		mgMapAttributeSet
+		mgMapAttributeSet,
+		mgMapMethodGet,
+		mgMapIterate
 	},
 	{
 		"cfunc",
@@ -929,6 +1032,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -954,6 +1059,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		mgBoundCFunctionAttributeGet,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -979,7 +1086,9 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		mgFunctionAttributeGet,
-		mgFunctionAttributeSet
+		mgFunctionAttributeSet,
+		NULL,
+		NULL
 	},
 	{
 		"proc",
@@ -1004,6 +1113,8 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		NULL,
+		NULL,
+		NULL,
 		NULL
 	},
 	{
@@ -1029,7 +1140,198 @@ const MGTypeData _mgTypes[] = {
 		NULL,
 		NULL,
 		mgModuleAttributeGet,
-		mgModuleAttributeSet
+		mgModuleAttributeSet,
+		NULL,
+		NULL
+	},
+	{
+		"iter",
+		NULL,
+		NULL,
+		mgAnyDestroy,
+		NULL,
+		mgAnyTruthValue,
+		NULL,
+		NULL,
+		NULL,
+		mgAnyInverse,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		mgAnyEqual,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		mgIteratorIterate
+	},
+	{
+		"future",
+		NULL,
+		NULL,
+		mgAnyDestroy,
+		NULL,
+		mgAnyTruthValue,
+		NULL,
+		NULL,
+		NULL,
+		mgAnyInverse,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		mgAnyEqual,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		NULL
+	},
+	{
+		"vec2",
+		NULL,
+		NULL,
+		NULL,
+		mgVectorConvert,
+		mgAnyTruthValue,
+		mgVectorToString,
+		mgVectorPositive,
+		mgVectorNegative,
+		mgAnyInverse,
+		mgVectorAdd,
+		mgVectorSub,
+		mgVectorMul,
+		mgVectorDiv,
+		NULL,
+		mgVectorMod,
+		mgVectorEqual,
+		NULL,
+		NULL,
+		mgVectorSubscriptGet,
+		NULL,
+		mgVectorAttributeGet,
+		NULL,
+		NULL,
+		mgVectorIterate
+	},
+	{
+		"vec3",
+		NULL,
+		NULL,
+		NULL,
+		mgVectorConvert,
+		mgAnyTruthValue,
+		mgVectorToString,
+		mgVectorPositive,
+		mgVectorNegative,
+		mgAnyInverse,
+		mgVectorAdd,
+		mgVectorSub,
+		mgVectorMul,
+		mgVectorDiv,
+		NULL,
+		mgVectorMod,
+		mgVectorEqual,
+		NULL,
+		NULL,
+		mgVectorSubscriptGet,
+		NULL,
+		mgVectorAttributeGet,
+		NULL,
+		NULL,
+		mgVectorIterate
+	},
+	{
+		"vec4",
+		NULL,
+		NULL,
+		NULL,
+		mgVectorConvert,
+		mgAnyTruthValue,
+		mgVectorToString,
+		mgVectorPositive,
+		mgVectorNegative,
+		mgAnyInverse,
+		mgVectorAdd,
+		mgVectorSub,
+		mgVectorMul,
+		mgVectorDiv,
+		NULL,
+		mgVectorMod,
+		mgVectorEqual,
+		NULL,
+		NULL,
+		mgVectorSubscriptGet,
+		NULL,
+		mgVectorAttributeGet,
+		NULL,
+		NULL,
+		mgVectorIterate
+	},
+	{
+		"mat4",
+		NULL,
+		NULL,
+		NULL,
+		mgMatrixConvert,
+		mgAnyTruthValue,
+		mgMatrixToString,
+		NULL,
+		NULL,
+		mgAnyInverse,
+		NULL,
+		NULL,
+		mgMatrixMul,
+		NULL,
+		NULL,
+		NULL,
+		mgMatrixEqual,
+		NULL,
+		NULL,
+		mgMatrixSubscriptGet,
+		NULL,
+		NULL,
+		NULL,
+		NULL,
+		mgMatrixIterate
+	},
+	{
+		"buffer",
+		NULL,
+		mgBufferCopy,
+		mgBufferDestroy,
+		mgBufferConvert,
+		mgBufferTruthValue,
+		mgBufferToString,
+		mgBufferPositive,
+		mgBufferNegative,
+		mgAnyInverse,
+		mgBufferAdd,
+		mgBufferSub,
+		mgBufferMul,
+		mgBufferDiv,
+		NULL,
+		mgBufferMod,
+		mgBufferEqual,
+		NULL,
+		NULL,
+		mgBufferSubscriptGet,
+		mgBufferSubscriptSet,
+		mgBufferAttributeGet,
+		NULL,
+		mgBufferMethodGet,
+		mgBufferIterate
 	}
 };
 
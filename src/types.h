@@ -13,9 +13,21 @@ typedef enum MGType {
 	MG_TYPE_BOUND_CFUNCTION,
 	MG_TYPE_FUNCTION,
 	MG_TYPE_PROCEDURE,
-	MG_TYPE_MODULE
+	MG_TYPE_MODULE,
+	MG_TYPE_ITERATOR,
+	MG_TYPE_FUTURE,
+	MG_TYPE_VEC2,
+	MG_TYPE_VEC3,
+	MG_TYPE_VEC4,
+	MG_TYPE_MAT4,
+	MG_TYPE_BUFFER
 } MGType;
 
+#define MG_TYPE_COUNT (MG_TYPE_BUFFER + 1)
+
+#define mgIsVectorType(type) (((type) >= MG_TYPE_VEC2) && ((type) <= MG_TYPE_VEC4))
+#define mgVectorTypeLength(type) ((size_t) ((type) - MG_TYPE_VEC2 + 2))
+
 typedef char MGbool;
 typedef MGbool MGtribool;
 
@@ -49,6 +61,12 @@ typedef MGbool (*MGTypeSubscriptSet)(const MGValue *collection, const MGValue *i
 typedef MGValue* (*MGTypeAttributeGet)(const MGValue *collection, const char *key);
 typedef MGbool (*MGTypeAttributeSet)(const MGValue *collection, const char *key, MGValue *value);
 
+// Returns the native method called by collection.key(...), if any
+typedef MGBoundCFunction (*MGTypeMethodGet)(const char *key);
+
+// Returns an iterator over the items of collection, e.g. for for loops
+typedef MGValue* (*MGTypeIterate)(const MGValue *collection);
+
 typedef struct MGTypeData {
 	const char *name;
 	MGTypeCreate create;
@@ -73,6 +91,8 @@ typedef struct MGTypeData {
 	MGTypeSubscriptSet subSet;
 	MGTypeAttributeGet attrGet;
 	MGTypeAttributeSet attrSet;
+	MGTypeMethodGet methodGet;
+	MGTypeIterate iterate;
 } MGTypeData;
 
 extern const MGTypeData _mgTypes[];
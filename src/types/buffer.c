@@ -0,0 +1,892 @@
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "value.h"
+#include "primitive.h"
+#include "composite.h"
+#include "vector.h"
+#include "buffer.h"
+#include "callable.h"
+#include "iterator.h"
+#include "parallel.h"
+#include "simd.h"
+#include "error.h"
+#include "utilities.h"
+#include "debug.h"
+
+
+// buffer.add(element [, element...])
+// buffer.extend(elements)
+// buffer.slice(begin = 0, end = buffer.size, step = 0): buffer
+// buffer.copy(): buffer
+
+
+extern MGValue* mgAnyConvert(const MGValue *value, MGType type);
+extern MGtribool mgAnyEqual(const MGValue *lhs, const MGValue *rhs);
+
+
+// Both formats take as many bytes per component
+#define _MG_BUFFER_COMPONENT_SIZE sizeof(float)
+
+static const char* const _MG_BUFFER_FORMAT_NAMES[] = {
+	"float",
+	"int"
+};
+
+
+const char* mgGetBufferFormatName(MGBufferFormat format)
+{
+	return _MG_BUFFER_FORMAT_NAMES[format];
+}
+
+
+MGbool mgLookupBufferFormat(const char *name, MGBufferFormat *format)
+{
+	for (size_t i = 0; i < (sizeof(_MG_BUFFER_FORMAT_NAMES) / sizeof(*_MG_BUFFER_FORMAT_NAMES)); ++i)
+	{
+		if (!strcmp(_MG_BUFFER_FORMAT_NAMES[i], name))
+		{
+			*format = (MGBufferFormat) i;
+			return MG_TRUE;
+		}
+	}
+
+	return MG_FALSE;
+}
+
+
+MGValue* mgCreateValueBuffer(MGBufferFormat format, size_t components, size_t length)
+{
+	MG_ASSERT(components > 0);
+
+	MGValue *buffer = mgCreateValue(MG_TYPE_BUFFER);
+
+	buffer->data.buffer.items = NULL;
+	buffer->data.buffer.length = 0;
+	buffer->data.buffer.capacity = 0;
+	buffer->data.buffer.components = components;
+	buffer->data.buffer.format = format;
+
+	mgBufferResize(buffer, length);
+
+	return buffer;
+}
+
+
+void mgBufferReserve(MGValue *buffer, size_t capacity)
+{
+	if (capacity <= mgBufferCapacity(buffer))
+		return;
+
+	buffer->data.buffer.items = realloc(buffer->data.buffer.items, capacity * mgBufferComponents(buffer) * _MG_BUFFER_COMPONENT_SIZE);
+	MG_ASSERT(buffer->data.buffer.items);
+
+	buffer->data.buffer.capacity = capacity;
+}
+
+
+void mgBufferResize(MGValue *buffer, size_t length)
+{
+	const size_t previousLength = mgBufferLength(buffer);
+
+	if (length > mgBufferCapacity(buffer))
+		mgBufferReserve(buffer, (length > mgBufferCapacity(buffer) * 2) ? length : (mgBufferCapacity(buffer) * 2));
+
+	if (length > previousLength)
+	{
+		const size_t components = mgBufferComponents(buffer);
+
+		memset((char*) buffer->data.buffer.items + previousLength * components * _MG_BUFFER_COMPONENT_SIZE, 0,
+		       (length - previousLength) * components * _MG_BUFFER_COMPONENT_SIZE);
+	}
+
+	buffer->data.buffer.length = length;
+}
+
+
+// The number of components of an element, zero for a number which
+// is used for every component, or SIZE_MAX if it isn't an element
+static size_t _mgBufferElementLength(const MGValue *element)
+{
+	if (mgIsNumericValue(element))
+		return 0;
+	else if (mgIsVectorValue(element))
+		return mgVectorLength(element);
+	else if (((mgValueType(element) == MG_TYPE_TUPLE) || (mgValueType(element) == MG_TYPE_LIST)) && mgListLength(element))
+	{
+		for (size_t i = 0; i < mgListLength(element); ++i)
+			if (!mgIsNumericValue(_mgListGet(element->data.a, i)))
+				return SIZE_MAX;
+
+		return mgListLength(element);
+	}
+
+	return SIZE_MAX;
+}
+
+
+// Only valid for elements accepted by _mgBufferElementLength
+static inline const MGValue* _mgBufferElementNumber(const MGValue *element, size_t index)
+{
+	return mgIsNumericValue(element) ? element : _mgListGet(element->data.a, index);
+}
+
+
+// Loads a component of an element as both a float and an integer,
+// and returns whether it was a float
+static MGbool _mgBufferElementComponent(const MGValue *element, size_t index, float *f, int32_t *i)
+{
+	if (mgIsVectorValue(element))
+	{
+		*f = mgVectorGet(element, index);
+		*i = (int32_t) *f;
+
+		return MG_TRUE;
+	}
+
+	const MGValue *number = _mgBufferElementNumber(element, index);
+
+	if (mgValueType(number) == MG_TYPE_INTEGER)
+	{
+		*i = mgIntegerGet(number);
+		*f = (float) *i;
+
+		return MG_FALSE;
+	}
+
+	*f = mgFloatGet(number);
+	*i = (int32_t) *f;
+
+	return MG_TRUE;
+}
+
+
+MGbool mgBufferSet(MGValue *buffer, size_t index, const MGValue *element)
+{
+	MG_ASSERT(index < mgBufferLength(buffer));
+
+	const size_t components = mgBufferComponents(buffer);
+	const size_t length = _mgBufferElementLength(element);
+
+	if ((length != 0) && (length != components))
+		return MG_FALSE;
+
+	float f;
+	int32_t i;
+
+	for (size_t j = 0; j < components; ++j)
+	{
+		_mgBufferElementComponent(element, j, &f, &i);
+
+		if (mgBufferFormat(buffer) == MG_BUFFER_FORMAT_FLOAT)
+			mgBufferFloats(buffer)[index * components + j] = f;
+		else
+			mgBufferInts(buffer)[index * components + j] = i;
+	}
+
+	return MG_TRUE;
+}
+
+
+MGValue* mgBufferGet(const MGValue *buffer, size_t index)
+{
+	MG_ASSERT(index < mgBufferLength(buffer));
+
+	const size_t components = mgBufferComponents(buffer);
+
+	if (mgBufferFormat(buffer) == MG_BUFFER_FORMAT_FLOAT)
+	{
+		const float *f = mgBufferFloats(buffer) + index * components;
+
+		if (components == 1)
+			return mgCreateValueFloat(*f);
+		else if (components <= 4)
+			return mgCreateValueVector(components, f);
+
+		MGValue *element = mgCreateValueTuple(components);
+
+		for (size_t j = 0; j < components; ++j)
+			mgTupleAdd(element, mgCreateValueFloat(f[j]));
+
+		return element;
+	}
+
+	const int32_t *i = mgBufferInts(buffer) + index * components;
+
+	if (components == 1)
+		return mgCreateValueInteger(*i);
+
+	MGValue *element = mgCreateValueTuple(components);
+
+	for (size_t j = 0; j < components; ++j)
+		mgTupleAdd(element, mgCreateValueInteger(i[j]));
+
+	return element;
+}
+
+
+// Appends the elements of a buffer with the same number of components
+static void _mgBufferExtend(MGValue *buffer, const MGValue *elements)
+{
+	MG_ASSERT(mgBufferComponents(buffer) == mgBufferComponents(elements));
+
+	const size_t offset = mgBufferLength(buffer) * mgBufferComponents(buffer);
+	const size_t count = mgBufferLength(elements) * mgBufferComponents(elements);
+
+	mgBufferResize(buffer, mgBufferLength(buffer) + mgBufferLength(elements));
+
+	if (count == 0)
+		return;
+	else if (mgBufferFormat(buffer) == mgBufferFormat(elements))
+		memcpy(mgBufferFloats(buffer) + offset, mgBufferFloats(elements), count * _MG_BUFFER_COMPONENT_SIZE);
+	else if (mgBufferFormat(buffer) == MG_BUFFER_FORMAT_FLOAT)
+	{
+		for (size_t i = 0; i < count; ++i)
+			mgBufferFloats(buffer)[offset + i] = (float) mgBufferInts(elements)[i];
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+			mgBufferInts(buffer)[offset + i] = (int32_t) mgBufferFloats(elements)[i];
+	}
+}
+
+
+MGValue* mgCreateValueBufferFrom(const MGValue *elements, MGBufferFormat format, size_t components)
+{
+	if (mgIsBufferValue(elements))
+	{
+		if (components && (components != mgBufferComponents(elements)))
+			return NULL;
+
+		MGValue *buffer = mgCreateValueBuffer(format, mgBufferComponents(elements), 0);
+		_mgBufferExtend(buffer, elements);
+
+		return buffer;
+	}
+	else if ((mgValueType(elements) != MG_TYPE_TUPLE) && (mgValueType(elements) != MG_TYPE_LIST))
+		return NULL;
+
+	const size_t length = mgListLength(elements);
+
+	if ((components == 0) && (length > 0))
+	{
+		components = _mgBufferElementLength(_mgListGet(elements->data.a, 0));
+
+		if (components == SIZE_MAX)
+			return NULL;
+	}
+
+	MGValue *buffer = mgCreateValueBuffer(format, components ? components : 1, length);
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (!mgBufferSet(buffer, i, _mgListGet(elements->data.a, i)))
+		{
+			mgDestroyValue(buffer);
+			return NULL;
+		}
+	}
+
+	return buffer;
+}
+
+
+void mgBufferCopy(MGValue *copy, const MGValue *buffer, MGbool shallow)
+{
+	copy->data.buffer.items = NULL;
+
+	if (mgBufferCapacity(buffer))
+	{
+		const size_t size = mgBufferComponents(buffer) * _MG_BUFFER_COMPONENT_SIZE;
+
+		copy->data.buffer.items = malloc(mgBufferCapacity(buffer) * size);
+		MG_ASSERT(copy->data.buffer.items);
+
+		memcpy(copy->data.buffer.items, buffer->data.buffer.items, mgBufferLength(buffer) * size);
+	}
+}
+
+
+void mgBufferDestroy(MGValue *buffer)
+{
+	free(buffer->data.buffer.items);
+}
+
+
+MGValue* mgBufferConvert(const MGValue *buffer, MGType type)
+{
+	if ((type == MG_TYPE_TUPLE) || (type == MG_TYPE_LIST))
+	{
+		const size_t length = mgBufferLength(buffer);
+
+		MGValue *list = (type == MG_TYPE_TUPLE) ? mgCreateValueTuple(length) : mgCreateValueList(length);
+
+		for (size_t i = 0; i < length; ++i)
+			mgListAdd(list, mgBufferGet(buffer, i));
+
+		return list;
+	}
+
+	return mgAnyConvert(buffer, type);
+}
+
+
+MGbool mgBufferTruthValue(const MGValue *buffer)
+{
+	return mgBufferLength(buffer) > 0;
+}
+
+
+char* mgBufferToString(const MGValue *buffer)
+{
+	const size_t length = mgBufferLength(buffer);
+	const size_t components = mgBufferComponents(buffer);
+
+	// Components take at most 12 characters formatted like print formats floats,
+	// or 11 as integers, while each element is separated and may be parenthesized
+	const size_t capacity = 32 + length * (components * 14 + 4);
+
+	char *s = (char*) malloc(capacity * sizeof(char));
+	MG_ASSERT(s);
+
+	char *end = s;
+
+	end += snprintf(end, capacity - (end - s), "%s([", mgGetTypeName(mgValueType(buffer)));
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		end += snprintf(end, capacity - (end - s), "%s%s", (i > 0) ? ", " : "", (components > 1) ? "(" : "");
+
+		for (size_t j = 0; j < components; ++j)
+		{
+			if (j > 0)
+				end += snprintf(end, capacity - (end - s), ", ");
+
+			if (mgBufferFormat(buffer) == MG_BUFFER_FORMAT_FLOAT)
+				end += snprintf(end, capacity - (end - s), "%G", mgBufferFloats(buffer)[i * components + j]);
+			else
+				end += snprintf(end, capacity - (end - s), "%d", (int) mgBufferInts(buffer)[i * components + j]);
+		}
+
+		if (components > 1)
+			end += snprintf(end, capacity - (end - s), ")");
+	}
+
+	snprintf(end, capacity - (end - s), "], \"%s\", %zu)", mgGetBufferFormatName(mgBufferFormat(buffer)), components);
+
+	return s;
+}
+
+
+MGValue* mgBufferPositive(const MGValue *operand)
+{
+	return mgReferenceValue(operand);
+}
+
+
+MGValue* mgBufferNegative(const MGValue *operand)
+{
+	const size_t count = mgBufferLength(operand) * mgBufferComponents(operand);
+
+	MGValue *buffer = mgCreateValueBuffer(mgBufferFormat(operand), mgBufferComponents(operand), mgBufferLength(operand));
+
+	if (mgBufferFormat(operand) == MG_BUFFER_FORMAT_FLOAT)
+	{
+		const float *a = mgBufferFloats(operand);
+		float *r = mgBufferFloats(buffer);
+
+		size_t i = 0;
+
+		for (; (i + 4) <= count; i += 4)
+			mgFloat4Store(r + i, mgFloat4Negate(mgFloat4Load(a + i)));
+
+		for (; i < count; ++i)
+			r[i] = -a[i];
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+			mgBufferInts(buffer)[i] = -mgBufferInts(operand)[i];
+	}
+
+	return buffer;
+}
+
+
+// Either the components of a buffer, or of an element repeated for
+// every element. The latter are repeated 4 times, such that every
+// group of 4 lanes starting at a multiple of 4 is contiguous.
+typedef struct MGBufferOperand {
+	const MGValue *buffer;
+	float *floats;
+	int32_t *ints;
+	// Zero for buffers
+	size_t period;
+	MGbool isFloat;
+} MGBufferOperand;
+
+
+static MGbool _mgBufferLoadOperand(MGBufferOperand *operand, const MGValue *value, const MGValue *buffer)
+{
+	operand->buffer = NULL;
+	operand->floats = NULL;
+	operand->ints = NULL;
+	operand->period = 0;
+
+	const size_t length = mgBufferLength(buffer), components = mgBufferComponents(buffer);
+
+	if (mgIsBufferValue(value))
+	{
+		if ((mgBufferLength(value) != length) || (mgBufferComponents(value) != components))
+			mgFatalError("Error: Expected buffers of the same size, received %zu and %zu elements of %zu and %zu components",
+			             length, mgBufferLength(value), components, mgBufferComponents(value));
+
+		operand->buffer = value;
+		operand->isFloat = mgBufferFormat(value) == MG_BUFFER_FORMAT_FLOAT;
+
+		return MG_TRUE;
+	}
+
+	const size_t elementLength = _mgBufferElementLength(value);
+
+	if ((elementLength != 0) && (elementLength != components))
+		return MG_FALSE;
+
+	operand->period = components * 4;
+	operand->floats = (float*) malloc(operand->period * sizeof(float));
+	operand->ints = (int32_t*) malloc(operand->period * sizeof(int32_t));
+	operand->isFloat = MG_FALSE;
+
+	MG_ASSERT(operand->floats);
+	MG_ASSERT(operand->ints);
+
+	for (size_t i = 0; i < components; ++i)
+		operand->isFloat |= _mgBufferElementComponent(value, i, operand->floats + i, operand->ints + i);
+
+	for (size_t i = components; i < operand->period; ++i)
+	{
+		operand->floats[i] = operand->floats[i % components];
+		operand->ints[i] = operand->ints[i % components];
+	}
+
+	return MG_TRUE;
+}
+
+
+// Buffers of the other format are converted
+static const float* _mgBufferOperandFloats(MGBufferOperand *operand)
+{
+	if (!operand->buffer)
+		return operand->floats;
+	else if (mgBufferFormat(operand->buffer) == MG_BUFFER_FORMAT_FLOAT)
+		return mgBufferFloats(operand->buffer);
+
+	const size_t count = mgBufferLength(operand->buffer) * mgBufferComponents(operand->buffer);
+
+	operand->floats = (float*) malloc(count * sizeof(float));
+	MG_ASSERT(operand->floats);
+
+	for (size_t i = 0; i < count; ++i)
+		operand->floats[i] = (float) mgBufferInts(operand->buffer)[i];
+
+	return operand->floats;
+}
+
+
+static void _mgBufferFreeOperand(MGBufferOperand *operand)
+{
+	free(operand->floats);
+	free(operand->ints);
+}
+
+
+#define _MG_BUFFER_FLOAT_LOOP(simd, scalar) \
+	for (; (i + 4) <= count; i += 4) \
+	{ \
+		const MGFloat4 va = mgFloat4Load(a + ia), vb = mgFloat4Load(b + ib); \
+		mgFloat4Store(r + i, simd); \
+		if ((ia += 4) == periodA) \
+			ia = 0; \
+		if ((ib += 4) == periodB) \
+			ib = 0; \
+	} \
+	for (; i < count; ++i) \
+	{ \
+		const float fa = a[periodA ? (i % periodA) : i], fb = b[periodB ? (i % periodB) : i]; \
+		r[i] = scalar; \
+	}
+
+static void _mgBufferFloatOp(float *r, const float *a, size_t periodA, const float *b, size_t periodB, size_t count, MGBinOpType operation)
+{
+	size_t i = 0, ia = 0, ib = 0;
+
+	switch (operation)
+	{
+	case MG_BIN_OP_ADD:
+		_MG_BUFFER_FLOAT_LOOP(mgFloat4Add(va, vb), fa + fb)
+		break;
+	case MG_BIN_OP_SUB:
+		_MG_BUFFER_FLOAT_LOOP(mgFloat4Sub(va, vb), fa - fb)
+		break;
+	case MG_BIN_OP_MUL:
+		_MG_BUFFER_FLOAT_LOOP(mgFloat4Mul(va, vb), fa * fb)
+		break;
+	case MG_BIN_OP_DIV:
+		_MG_BUFFER_FLOAT_LOOP(mgFloat4Div(va, vb), fa / fb)
+		break;
+	default:
+		for (; i < count; ++i)
+			r[i] = fmodf(a[periodA ? (i % periodA) : i], b[periodB ? (i % periodB) : i]);
+		break;
+	}
+}
+
+#undef _MG_BUFFER_FLOAT_LOOP
+
+
+static void _mgBufferIntOp(int32_t *r, const int32_t *a, size_t periodA, const int32_t *b, size_t periodB, size_t count, MGBinOpType operation)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const int32_t ia = a[periodA ? (i % periodA) : i], ib = b[periodB ? (i % periodB) : i];
+
+		switch (operation)
+		{
+		case MG_BIN_OP_ADD:
+			r[i] = ia + ib;
+			break;
+		case MG_BIN_OP_SUB:
+			r[i] = ia - ib;
+			break;
+		case MG_BIN_OP_MUL:
+			r[i] = ia * ib;
+			break;
+		default:
+			if (ib == 0)
+				mgFatalError("Error: Division by zero");
+
+			r[i] = ia % ib;
+			break;
+		}
+	}
+}
+
+
+// Either operand is a buffer, while the other is a buffer of the same
+// size, or an element which is used for every element. The result is
+// of integers if both are, except for division like with numbers.
+static MGValue* _mgBufferBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
+{
+	const MGValue *buffer = mgIsBufferValue(lhs) ? lhs : rhs;
+
+	MGBufferOperand a, b;
+
+	if (!_mgBufferLoadOperand(&a, lhs, buffer))
+		return NULL;
+
+	if (!_mgBufferLoadOperand(&b, rhs, buffer))
+	{
+		_mgBufferFreeOperand(&a);
+		return NULL;
+	}
+
+	const MGBufferFormat format = (a.isFloat || b.isFloat || (operation == MG_BIN_OP_DIV)) ? MG_BUFFER_FORMAT_FLOAT : MG_BUFFER_FORMAT_INT;
+	const size_t count = mgBufferLength(buffer) * mgBufferComponents(buffer);
+
+	MGValue *result = mgCreateValueBuffer(format, mgBufferComponents(buffer), mgBufferLength(buffer));
+
+	if (format == MG_BUFFER_FORMAT_FLOAT)
+		_mgBufferFloatOp(mgBufferFloats(result), _mgBufferOperandFloats(&a), a.period, _mgBufferOperandFloats(&b), b.period, count, operation);
+	else
+		_mgBufferIntOp(mgBufferInts(result), a.buffer ? mgBufferInts(a.buffer) : a.ints, a.period,
+		               b.buffer ? mgBufferInts(b.buffer) : b.ints, b.period, count, operation);
+
+	_mgBufferFreeOperand(&a);
+	_mgBufferFreeOperand(&b);
+
+	return result;
+}
+
+
+MGValue* mgBufferAdd(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgBufferBinaryOp(lhs, rhs, MG_BIN_OP_ADD);
+}
+
+
+MGValue* mgBufferSub(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgBufferBinaryOp(lhs, rhs, MG_BIN_OP_SUB);
+}
+
+
+MGValue* mgBufferMul(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgBufferBinaryOp(lhs, rhs, MG_BIN_OP_MUL);
+}
+
+
+MGValue* mgBufferDiv(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgBufferBinaryOp(lhs, rhs, MG_BIN_OP_DIV);
+}
+
+
+MGValue* mgBufferMod(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgBufferBinaryOp(lhs, rhs, MG_BIN_OP_MOD);
+}
+
+
+// Compares the components like numbers, regardless of format
+MGtribool mgBufferEqual(const MGValue *lhs, const MGValue *rhs)
+{
+	if (!mgIsBufferValue(lhs) || !mgIsBufferValue(rhs))
+		return mgAnyEqual(lhs, rhs);
+	else if ((mgBufferLength(lhs) != mgBufferLength(rhs)) || (mgBufferComponents(lhs) != mgBufferComponents(rhs)))
+		return MG_FALSE;
+
+	const size_t count = mgBufferLength(lhs) * mgBufferComponents(lhs);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if ((mgBufferFormat(lhs) == MG_BUFFER_FORMAT_INT) && (mgBufferFormat(rhs) == MG_BUFFER_FORMAT_INT))
+		{
+			if (mgBufferInts(lhs)[i] != mgBufferInts(rhs)[i])
+				return MG_FALSE;
+		}
+		else
+		{
+			const float a = (mgBufferFormat(lhs) == MG_BUFFER_FORMAT_FLOAT) ? mgBufferFloats(lhs)[i] : (float) mgBufferInts(lhs)[i];
+			const float b = (mgBufferFormat(rhs) == MG_BUFFER_FORMAT_FLOAT) ? mgBufferFloats(rhs)[i] : (float) mgBufferInts(rhs)[i];
+
+			if (!MG_FEQUAL(a, b))
+				return MG_FALSE;
+		}
+	}
+
+	return MG_TRUE;
+}
+
+
+static inline size_t _mgBufferRelativeIndex(const MGValue *buffer, intmax_t index)
+{
+	const intmax_t length = (intmax_t) mgBufferLength(buffer);
+
+	if ((index >= length) || (index < -length))
+	{
+		if (index >= 0)
+			mgFatalError("Error: %s index out of range (0 <= %zd < %zu)",
+			             mgGetTypeName(mgValueType(buffer)), index, mgBufferLength(buffer));
+		else
+			mgFatalError("Error: %s index out of range (-%zu <= %zd < 0)",
+			             mgGetTypeName(mgValueType(buffer)), mgBufferLength(buffer), index);
+	}
+
+	return (size_t) ((index < 0) ? (length + index) : index);
+}
+
+
+MGValue* mgBufferSubscriptGet(const MGValue *buffer, const MGValue *index)
+{
+	if (mgValueType(index) != MG_TYPE_INTEGER)
+		return NULL;
+
+	return mgBufferGet(buffer, _mgBufferRelativeIndex(buffer, mgIntegerGet(index)));
+}
+
+
+// Removes the element if value is NULL
+MGbool mgBufferSubscriptSet(const MGValue *buffer, const MGValue *index, MGValue *value)
+{
+	if (mgValueType(index) != MG_TYPE_INTEGER)
+		return MG_FALSE;
+
+	const size_t i = _mgBufferRelativeIndex(buffer, mgIntegerGet(index));
+
+	if (value == NULL)
+	{
+		const size_t size = mgBufferComponents(buffer) * _MG_BUFFER_COMPONENT_SIZE;
+		char *items = (char*) buffer->data.buffer.items;
+
+		memmove(items + i * size, items + (i + 1) * size, (mgBufferLength(buffer) - i - 1) * size);
+		--((MGValue*) buffer)->data.buffer.length;
+	}
+	else if (!mgBufferSet((MGValue*) buffer, i, value))
+		mgFatalError("Error: %s expected an element of %zu numbers, received \"%s\"",
+		             mgGetTypeName(mgValueType(buffer)), mgBufferComponents(buffer), mgGetTypeName(mgValueType(value)));
+
+	return MG_TRUE;
+}
+
+
+static void _mgBufferAdd(MGInstance *instance, MGValue *buffer, const MGValue *element)
+{
+	mgBufferResize(buffer, mgBufferLength(buffer) + 1);
+
+	if (!mgBufferSet(buffer, mgBufferLength(buffer) - 1, element))
+		mgFatalError("Error: %s expected an element of %zu numbers, received \"%s\"",
+		             mgGetCalleeName(instance), mgBufferComponents(buffer), mgGetTypeName(mgValueType(element)));
+}
+
+
+static MGValue* mg_buffer_add(MGInstance *instance, const MGValue *buffer, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, SIZE_MAX);
+	mgCheckUnsharedValue(instance, buffer);
+
+	for (size_t i = 0; i < argc; ++i)
+		_mgBufferAdd(instance, (MGValue*) buffer, argv[i]);
+
+	return MG_NULL_VALUE;
+}
+
+
+static MGValue* mg_buffer_extend(MGInstance *instance, const MGValue *buffer, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 1, 1);
+	mgCheckArgumentTypes(instance, argc, argv, 3, MG_TYPE_TUPLE, MG_TYPE_LIST, MG_TYPE_BUFFER);
+	mgCheckUnsharedValue(instance, buffer);
+
+	if (mgIsBufferValue(argv[0]))
+	{
+		if (mgBufferComponents(argv[0]) != mgBufferComponents(buffer))
+			mgFatalError("Error: %s expected elements of %zu numbers, received %zu", mgGetCalleeName(instance),
+			             mgBufferComponents(buffer), mgBufferComponents(argv[0]));
+
+		_mgBufferExtend((MGValue*) buffer, argv[0]);
+	}
+	else
+	{
+		mgBufferReserve((MGValue*) buffer, mgBufferLength(buffer) + mgListLength(argv[0]));
+
+		for (size_t i = 0; i < mgListLength(argv[0]); ++i)
+			_mgBufferAdd(instance, (MGValue*) buffer, _mgListGet(argv[0]->data.a, i));
+	}
+
+	return MG_NULL_VALUE;
+}
+
+
+// Like list.slice
+static MGValue* mg_buffer_slice(MGInstance *instance, const MGValue *buffer, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 3);
+	mgCheckArgumentTypes(instance, argc, argv, 1, MG_TYPE_INTEGER, 1, MG_TYPE_INTEGER, 1, MG_TYPE_INTEGER);
+
+	const intmax_t length = (intmax_t) mgBufferLength(buffer);
+
+	intmax_t start = 0;
+	intmax_t stop = length;
+	intmax_t step = (argc > 2) ? (intmax_t) mgIntegerGet(argv[2]) : 0;
+
+	if (argc > 0)
+	{
+		start = mgIntegerGet(argv[0]);
+		start = (start < 0) ? (length + start) : start;
+		start = (start > 0) ? ((start > length) ? length : start) : 0;
+	}
+
+	if (argc > 1)
+	{
+		stop = mgIntegerGet(argv[1]);
+		stop = (stop < 0) ? (length + stop) : stop;
+		stop = (stop > 0) ? ((stop > length) ? length : stop) : 0;
+	}
+
+	const size_t components = mgBufferComponents(buffer);
+	const intmax_t difference = stop - start;
+
+	if (step == 0)
+		step = (difference > 0) - (difference < 0);
+
+	if ((difference == 0) || ((difference ^ step) < 0))
+		return mgCreateValueBuffer(mgBufferFormat(buffer), components, 0);
+
+	const intmax_t sliceLength = difference / step + ((difference % step) != 0);
+
+	MGValue *slice = mgCreateValueBuffer(mgBufferFormat(buffer), components, (size_t) sliceLength);
+
+	const size_t size = components * _MG_BUFFER_COMPONENT_SIZE;
+
+	if (step == 1)
+		memcpy(slice->data.buffer.items, (const char*) buffer->data.buffer.items + start * size, sliceLength * size);
+	else
+	{
+		for (intmax_t i = 0; i < sliceLength; ++i)
+			memcpy((char*) slice->data.buffer.items + i * size, (const char*) buffer->data.buffer.items + (start + i * step) * size, size);
+	}
+
+	return slice;
+}
+
+
+static MGValue* mg_buffer_copy(MGInstance *instance, const MGValue *buffer, size_t argc, const MGValue* const* argv)
+{
+	mgCheckArgumentCount(instance, argc, 0, 0);
+
+	return mgShallowCopyValue(buffer);
+}
+
+
+static const struct {
+	const char *name;
+	MGBoundCFunction method;
+} _mgBufferMethods[] = {
+	{ "add", mg_buffer_add },
+	{ "extend", mg_buffer_extend },
+	{ "slice", mg_buffer_slice },
+	{ "copy", mg_buffer_copy },
+	{ NULL, NULL }
+};
+
+
+MGBoundCFunction mgBufferMethodGet(const char *key)
+{
+	for (int i = 0; _mgBufferMethods[i].name; ++i)
+		if (!strcmp(_mgBufferMethods[i].name, key))
+			return _mgBufferMethods[i].method;
+
+	return NULL;
+}
+
+
+MGValue* mgBufferAttributeGet(const MGValue *buffer, const char *key)
+{
+	if (!strcmp("size", key))
+		return mgCreateValueInteger((int) mgBufferLength(buffer));
+	else if (!strcmp("components", key))
+		return mgCreateValueInteger((int) mgBufferComponents(buffer));
+	else if (!strcmp("format", key))
+		return mgCreateValueStringEx(mgGetBufferFormatName(mgBufferFormat(buffer)), MG_STRING_USAGE_STATIC);
+
+	MGBoundCFunction method = mgBufferMethodGet(key);
+	return method ? mgCreateValueBoundCFunction(method, mgReferenceValue(buffer)) : NULL;
+}
+
+
+static MGValue* _mgBufferIteratorNext(MGValue *iterator)
+{
+	const MGValue *buffer = _mgListGet(iterator->data.iter->values, 0);
+
+	if ((iterator->data.iter->index >= iterator->data.iter->count) || ((size_t) iterator->data.iter->index >= mgBufferLength(buffer)))
+		return NULL;
+
+	return mgBufferGet(buffer, (size_t) iterator->data.iter->index++);
+}
+
+
+MGValue* mgBufferIterate(const MGValue *buffer)
+{
+	MGValue *iterator = mgCreateValueIterator(NULL, _mgBufferIteratorNext, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgReferenceValue(buffer));
+
+	// Items added while iterating are not iterated, see iterator.h
+	iterator->data.iter->count = (intmax_t) mgBufferLength(buffer);
+
+	return iterator;
+}
@@ -0,0 +1,47 @@
+#ifndef MODELGEN_BUFFER_TYPES_H
+#define MODELGEN_BUFFER_TYPES_H
+
+#include <stdint.h>
+
+#include "value.h"
+
+// Buffers store elements of the same number of components contiguously,
+// as floats or 32-bit integers, compared to a list holding a tuple of
+// allocated numbers per element. Elements with a single component are
+// numbers, float elements of 2 to 4 components are vectors, and any
+// other element is a tuple. Like lists they are mutable.
+
+#define mgIsBufferValue(value) (mgValueType(value) == MG_TYPE_BUFFER)
+
+#define mgBufferLength(value) ((value)->data.buffer.length)
+#define mgBufferCapacity(value) ((value)->data.buffer.capacity)
+#define mgBufferComponents(value) ((value)->data.buffer.components)
+#define mgBufferFormat(value) ((value)->data.buffer.format)
+
+#define mgBufferFloats(value) ((float*) (value)->data.buffer.items)
+#define mgBufferInts(value) ((int32_t*) (value)->data.buffer.items)
+
+// Creates length elements with every component being zero
+MGValue* mgCreateValueBuffer(MGBufferFormat format, size_t components, size_t length);
+
+// Creates a buffer of the elements of a tuple, list or buffer, taking
+// components from the first element if zero. Returns NULL if any element
+// isn't something mgBufferSet accepts
+MGValue* mgCreateValueBufferFrom(const MGValue *elements, MGBufferFormat format, size_t components);
+
+const char* mgGetBufferFormatName(MGBufferFormat format);
+MGbool mgLookupBufferFormat(const char *name, MGBufferFormat *format);
+
+void mgBufferReserve(MGValue *buffer, size_t capacity);
+
+// Elements beyond the previous length are zero
+void mgBufferResize(MGValue *buffer, size_t length);
+
+MGValue* mgBufferGet(const MGValue *buffer, size_t index);
+
+// Stores a number in every component, or a vector, tuple or list of as
+// many numbers as there are components, and returns whether element
+// was any of those
+MGbool mgBufferSet(MGValue *buffer, size_t index, const MGValue *element);
+
+#endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "primitive.h"
 #include "composite.h"
+#include "intern.h"
 #include "utilities.h"
 #include "debug.h"
 
@@ -73,7 +74,7 @@ MGValue* mgCreateValueList(size_t capacity)
 void mgListAdd(MGValue *list, MGValue *value)
 {
 	MG_ASSERT(list);
-	MG_ASSERT((list->type == MG_TYPE_TUPLE) || (list->type == MG_TYPE_LIST));
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
 	MG_ASSERT(value);
 
 	_mgListAdd(MGValue*, list->data.a, value);
@@ -83,7 +84,7 @@ void mgListAdd(MGValue *list, MGValue *value)
 void mgListInsert(MGValue *list, intmax_t index, MGValue *value)
 {
 	MG_ASSERT(list);
-	MG_ASSERT((list->type == MG_TYPE_TUPLE) || (list->type == MG_TYPE_LIST));
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
 	MG_ASSERT(value);
 
 	index = _mgListIndexRelativeToAbsolute(list->data.a, index);
@@ -99,7 +100,7 @@ void mgListInsert(MGValue *list, intmax_t index, MGValue *value)
 void mgListRemove(MGValue *list, intmax_t index)
 {
 	MG_ASSERT(list);
-	MG_ASSERT((list->type == MG_TYPE_TUPLE) || (list->type == MG_TYPE_LIST));
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
 
 	index = _mgListIndexRelativeToAbsolute(list->data.a, index);
 	MG_ASSERT((index >= 0) && (index < _mgListLength(list->data.a)));
@@ -113,7 +114,7 @@ void mgListRemove(MGValue *list, intmax_t index)
 void mgListRemoveRange(MGValue *list, intmax_t begin, intmax_t end)
 {
 	MG_ASSERT(list);
-	MG_ASSERT((list->type == MG_TYPE_TUPLE) || (list->type == MG_TYPE_LIST));
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
 
 	begin = _mgListIndexRelativeToAbsolute(list->data.a, begin);
 	end = _mgListIndexRelativeToAbsolute(list->data.a, end);
@@ -136,7 +137,7 @@ void mgListRemoveRange(MGValue *list, intmax_t begin, intmax_t end)
 void mgListClear(MGValue *list)
 {
 	MG_ASSERT(list);
-	MG_ASSERT((list->type == MG_TYPE_TUPLE) || (list->type == MG_TYPE_LIST));
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
 
 	for (size_t i = 0; i < _mgListLength(list->data.a); ++i)
 		mgDestroyValue(_mgListGet(list->data.a, i));
@@ -148,98 +149,229 @@ void mgListClear(MGValue *list)
 MGValue* mgListShallowCopy(const MGValue *list)
 {
 	MG_ASSERT(list);
-	MG_ASSERT((list->type == MG_TYPE_TUPLE) || (list->type == MG_TYPE_LIST));
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
 
 	const size_t length = mgListLength(list);
 	MGValue *copy = mgCreateValueList(length);
 
 	for (size_t i = 0; i < length; ++i)
-		mgListAdd(copy, _mgListGet(list->data.a, i));
+		mgListAdd(copy, mgReferenceValue(_mgListGet(list->data.a, i)));
 
 	return copy;
 }
 
 
+MGValue* mgListConstantCopy(const MGValue *list)
+{
+	MG_ASSERT(list);
+	MG_ASSERT((mgValueType(list) == MG_TYPE_TUPLE) || (mgValueType(list) == MG_TYPE_LIST));
+
+	const size_t length = mgListLength(list);
+	MGValue *copy = mgCreateValueList(length);
+	copy->type = list->type;
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		const MGValue *item = _mgListGet(list->data.a, i);
+
+		if ((mgValueType(item) == MG_TYPE_TUPLE) || (mgValueType(item) == MG_TYPE_LIST))
+			mgListAdd(copy, mgListConstantCopy(item));
+		else
+			mgListAdd(copy, mgReferenceValue(item));
+	}
+
+	return copy;
+}
+
+
+// Maps up to this size are scanned linearly, comparing
+// cached hashes before keys, rather than being indexed
+#define _MG_MAP_LINEAR_SCAN_SIZE 8
+
+
 static inline void _mgDestroyMapValuePair(MGValueMapPair *pair)
 {
 	MG_ASSERT(pair);
 	MG_ASSERT(pair->key);
 	MG_ASSERT(pair->value);
 
-	free(pair->key);
+	mgReleaseInternedString(pair->key);
 	mgDestroyValue(pair->value);
 }
 
 
-void _mgMapClear(MGValueMap *map)
+static void _mgMapReindex(MGValueMap *map, size_t capacity)
 {
-	MG_ASSERT(map);
+	MG_ASSERT((capacity & (capacity - 1)) == 0);
+
+	mgFree(map->indices);
+
+	map->indices = (uint32_t*) mgAllocate(capacity * sizeof(uint32_t));
+	MG_ASSERT(map->indices);
+
+	memset(map->indices, 0, capacity * sizeof(uint32_t));
+
+	map->capacity = capacity;
+
+	const size_t mask = capacity - 1;
+
+	for (size_t i = 0; i < _mgListLength(map->pairs); ++i)
+	{
+		size_t slot = _mgListGet(map->pairs, i).hash & mask;
 
-	for (size_t i = 0; i < _mgListLength(*map); ++i)
-		_mgDestroyMapValuePair(&_mgListGet(*map, i));
+		while (map->indices[slot])
+			slot = (slot + 1) & mask;
 
-	_mgListLength(*map) = 0;
+		map->indices[slot] = (uint32_t) (i + 1);
+	}
 }
 
 
-static inline void _mgMapSetSet(MGValueMapPair *names, size_t i, const char *key, MGValue *value)
+// Keys are interned, so an interned key only needs
+// comparing by pointer, while any other key falls
+// back to comparing strings when the hashes match
+static inline MGbool _mgMapKeyEqual(const MGValueMapPair *pair, const char *key, uint32_t hash, MGbool interned)
 {
-	MG_ASSERT(names);
-	MG_ASSERT(key);
-	MG_ASSERT(value);
+	if (pair->key == key)
+		return MG_TRUE;
 
-	names[i].key = mgStringDuplicate(key);
-	names[i].value = value;
+	return !interned && (pair->hash == hash) && !strcmp(pair->key, key);
 }
 
 
-static inline void _mgMapSetAdd(MGValueMap *map, const char *key, MGValue *value)
+// Returns the index of the table slot holding the key, or
+// the empty slot it would be inserted at if not present
+static inline size_t _mgMapFindSlot(const MGValueMap *map, const char *key, uint32_t hash, MGbool interned)
 {
-	_mgListAddUninitialized(MGValueMapPair, *map);
+	const size_t mask = map->capacity - 1;
+	size_t slot = hash & mask;
 
-	_mgMapSetSet(_mgListItems(*map), _mgListLength(*map)++, key, value);
+	for (uint32_t index; (index = map->indices[slot]); slot = (slot + 1) & mask)
+	{
+		if (_mgMapKeyEqual(&_mgListGet(map->pairs, index - 1), key, hash, interned))
+			break;
+	}
+
+	return slot;
 }
 
 
-static inline void _mgMapSetSwap(MGValueMapPair *pairs, size_t i, size_t i2)
+static inline MGValueMapPair* _mgMapFind(const MGValueMap *map, const char *key, uint32_t hash, MGbool interned)
 {
-	MGValueMapPair temp;
-	memcpy(&temp, &pairs[i], sizeof(MGValueMapPair));
-	memcpy(&pairs[i], &pairs[i2], sizeof(MGValueMapPair));
-	memcpy(&pairs[i2], &temp, sizeof(MGValueMapPair));
+	if (!map->indices)
+	{
+		for (size_t i = 0; i < _mgListLength(map->pairs); ++i)
+		{
+			MGValueMapPair *pair = &_mgListGet(map->pairs, i);
+
+			if (_mgMapKeyEqual(pair, key, hash, interned))
+				return pair;
+		}
+
+		return NULL;
+	}
+
+	const uint32_t index = map->indices[_mgMapFindSlot(map, key, hash, interned)];
+
+	return index ? &_mgListGet(map->pairs, index - 1) : NULL;
 }
 
 
-void _mgMapSet(MGValueMap *map, const char *key, MGValue *value)
+void _mgMapClear(MGValueMap *map)
 {
 	MG_ASSERT(map);
-	MG_ASSERT(key);
 
-	MGValueMapPair *pair = NULL;
-	for (size_t i = 0; (pair == NULL) && (i < _mgListLength(*map)); ++i)
-		if (strcmp(_mgListGet(*map, i).key, key) == 0)
-			pair = &_mgListGet(*map, i);
+	for (size_t i = 0; i < _mgListLength(map->pairs); ++i)
+		_mgDestroyMapValuePair(&_mgListGet(map->pairs, i));
+
+	_mgListClear(map->pairs);
+
+	mgFree(map->indices);
+	map->indices = NULL;
+	map->capacity = 0;
+}
+
+
+static inline void _mgMapAdd(MGValueMap *map, const char *key, uint32_t hash, MGbool interned, MGValue *value)
+{
+	_mgListAddUninitialized(MGValueMapPair, map->pairs);
+
+	MGValueMapPair *pair = &_mgListGet(map->pairs, _mgListLength(map->pairs)++);
+	pair->key = interned ? mgReferenceInternedString(key) : mgInternStringHashed(key, strlen(key), hash);
+	pair->value = value;
+	pair->hash = hash;
+
+	const size_t size = _mgListLength(map->pairs);
+
+	if (map->indices && ((size * 2) <= map->capacity))
+	{
+		map->indices[_mgMapFindSlot(map, pair->key, hash, MG_TRUE)] = (uint32_t) size;
+		return;
+	}
+
+	// Keep the table at most half full
+	if (size > _MG_MAP_LINEAR_SCAN_SIZE)
+		_mgMapReindex(map, (size_t) mgNextPowerOfTwo((uint32_t) size) * 2);
+}
+
+
+static inline void _mgMapErase(MGValueMap *map, MGValueMapPair *pair)
+{
+	const size_t index = (size_t) (pair - _mgListItems(map->pairs));
+
+	_mgDestroyMapValuePair(pair);
+	_mgListRemove(map->pairs, index);
+
+	// Removing shifts the remaining pairs to keep insertion
+	// order, so the indices after it are rebuilt
+	if (map->indices)
+	{
+		if (_mgListLength(map->pairs) > _MG_MAP_LINEAR_SCAN_SIZE)
+			_mgMapReindex(map, map->capacity);
+		else
+		{
+			mgFree(map->indices);
+			map->indices = NULL;
+			map->capacity = 0;
+		}
+	}
+}
+
+
+static inline void _mgMapSetHashed(MGValueMap *map, const char *key, uint32_t hash, MGbool interned, MGValue *value)
+{
+	MGValueMapPair *pair = _mgMapFind(map, key, hash, interned);
 
 	if (value)
 	{
 		if (pair)
 		{
-			_mgDestroyMapValuePair(pair);
-			_mgMapSetSet(_mgListItems(*map), (size_t) (pair - _mgListItems(*map)), key, value);
+			mgDestroyValue(pair->value);
+			pair->value = value;
 		}
 		else
-			_mgMapSetAdd(map, key, value);
+			_mgMapAdd(map, key, hash, interned, value);
 	}
 	else if (pair)
-	{
-		_mgDestroyMapValuePair(pair);
+		_mgMapErase(map, pair);
+}
 
-		if (_mgListLength(*map) > 1)
-			if (pair != &_mgListItems(*map)[_mgListLength(*map) - 1])
-				_mgMapSetSwap(_mgListItems(*map), (size_t) (pair - _mgListItems(*map)), _mgListLength(*map) - 1);
 
-		--_mgListLength(*map);
-	}
+void _mgMapSet(MGValueMap *map, const char *key, MGValue *value)
+{
+	MG_ASSERT(map);
+	MG_ASSERT(key);
+
+	_mgMapSetHashed(map, key, mgStringHash(key), MG_FALSE, value);
+}
+
+
+void _mgMapSetInterned(MGValueMap *map, const char *key, MGValue *value)
+{
+	MG_ASSERT(map);
+	MG_ASSERT(key);
+
+	_mgMapSetHashed(map, key, mgInternedStringHash(key), MG_TRUE, value);
 }
 
 
@@ -248,11 +380,29 @@ const MGValue* _mgMapGet(const MGValueMap *map, const char *key)
 	MG_ASSERT(map);
 	MG_ASSERT(key);
 
-	for (size_t i = 0; i < _mgListLength(*map); ++i)
-		if (strcmp(_mgListGet(*map, i).key, key) == 0)
-			return _mgListGet(*map, i).value;
+	const MGValueMapPair *pair = _mgMapFind(map, key, mgStringHash(key), MG_FALSE);
+
+	return pair ? pair->value : NULL;
+}
+
+
+const MGValue* _mgMapGetInterned(const MGValueMap *map, const char *key)
+{
+	MG_ASSERT(map);
+	MG_ASSERT(key);
+
+	const MGValueMapPair *pair = _mgMapFind(map, key, mgInternedStringHash(key), MG_TRUE);
 
-	return NULL;
+	return pair ? pair->value : NULL;
+}
+
+
+const MGValueMapPair* _mgMapGetPairInterned(const MGValueMap *map, const char *key)
+{
+	MG_ASSERT(map);
+	MG_ASSERT(key);
+
+	return _mgMapFind(map, key, mgInternedStringHash(key), MG_TRUE);
 }
 
 
@@ -261,9 +411,12 @@ void _mgCreateMap(MGValueMap *map, size_t capacity)
 	MG_ASSERT(map);
 
 	if (capacity > 0)
-		_mgListCreate(MGValueMapPair, *map, capacity);
+		_mgListCreate(MGValueMapPair, map->pairs, capacity);
 	else
-		_mgListInitialize(*map);
+		_mgListInitialize(map->pairs);
+
+	map->indices = NULL;
+	map->capacity = 0;
 }
 
 
@@ -272,7 +425,7 @@ void _mgDestroyMap(MGValueMap *map)
 	MG_ASSERT(map);
 
 	_mgMapClear(map);
-	_mgListDestroy(*map);
+	_mgListDestroy(map->pairs);
 }
 
 
@@ -287,31 +440,24 @@ MGValue* mgCreateValueMap(size_t capacity)
 void mgMapMerge(MGValue *destination, const MGValue *source, MGbool replace)
 {
 	MG_ASSERT(destination);
-	MG_ASSERT(destination->type == MG_TYPE_MAP);
+	MG_ASSERT(mgValueType(destination) == MG_TYPE_MAP);
 	MG_ASSERT(source);
-	MG_ASSERT(source->type == MG_TYPE_MAP);
-
-	MGMapIterator iterator;
-	mgCreateMapIterator(&iterator, source);
-
-	const MGValue *k, *v;
+	MG_ASSERT(mgValueType(source) == MG_TYPE_MAP);
 
-	if (replace)
-		while (mgMapIteratorNext(&iterator, &k, &v))
-			mgMapSet(destination, k->data.str.s, mgReferenceValue(v));
-	else
-		while (mgMapIteratorNext(&iterator, &k, &v))
-			if (mgMapGet(destination, k->data.str.s) == NULL)
-				mgMapSet(destination, k->data.str.s, mgReferenceValue(v));
+	for (size_t i = 0; i < mgMapSize(source); ++i)
+	{
+		const MGValueMapPair *pair = &_mgListGet(source->data.m.pairs, i);
 
-	mgDestroyMapIterator(&iterator);
+		if (replace || (mgMapGetInterned(destination, pair->key) == NULL))
+			mgMapSetInterned(destination, pair->key, mgReferenceValue(pair->value));
+	}
 }
 
 
 MGValue* mgMapShallowCopy(const MGValue *map)
 {
 	MG_ASSERT(map);
-	MG_ASSERT(map->type == MG_TYPE_MAP);
+	MG_ASSERT(mgValueType(map) == MG_TYPE_MAP);
 
 	MGValue *copy = mgCreateValueMap(mgMapSize(map));
 	MG_ASSERT(copy);
@@ -326,7 +472,7 @@ void mgCreateMapIterator(MGMapIterator *iterator, const MGValue *map)
 {
 	MG_ASSERT(iterator);
 	MG_ASSERT(map);
-	MG_ASSERT(map->type == MG_TYPE_MAP);
+	MG_ASSERT(mgValueType(map) == MG_TYPE_MAP);
 
 	memset(iterator, 0, sizeof(MGMapIterator));
 
@@ -353,14 +499,14 @@ MGbool mgMapIteratorNext(MGMapIterator *iterator, const MGValue **key, const MGV
 	if (iterator->index == mgMapSize(iterator->map))
 		return MG_FALSE;
 
-	MGValueMapPair *pair = &_mgListGet(iterator->map->data.m, iterator->index);
+	MGValueMapPair *pair = &_mgListGet(iterator->map->data.m.pairs, iterator->index);
 
 	if (key)
 	{
 		if (iterator->key)
 			mgDestroyValue(iterator->key);
 
-		iterator->key = mgCreateValueString(pair->key);
+		iterator->key = mgCreateValueInternedString(pair->key);
 
 		*key = iterator->key;
 	}
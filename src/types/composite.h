@@ -47,6 +47,9 @@ void mgListRemoveRange(MGValue *list, intmax_t begin, intmax_t end);
 void mgListClear(MGValue *list);
 
 MGValue* mgListShallowCopy(const MGValue *list);
+// Copies nested tuples and lists, while sharing the
+// remaining immutable items, e.g. of a folded constant
+MGValue* mgListConstantCopy(const MGValue *list);
 #define mgListDeepCopy(list) mgDeepCopyValue(list)
 
 #define mgListLength(list) _mgListLength((list)->data.a)
@@ -66,6 +69,11 @@ void _mgMapClear(MGValueMap *map);
 void _mgMapSet(MGValueMap *map, const char *key, MGValue *value);
 const MGValue* _mgMapGet(const MGValueMap *map, const char *key);
 
+// Same as above, but the key must be an interned string
+void _mgMapSetInterned(MGValueMap *map, const char *key, MGValue *value);
+const MGValue* _mgMapGetInterned(const MGValueMap *map, const char *key);
+const MGValueMapPair* _mgMapGetPairInterned(const MGValueMap *map, const char *key);
+
 
 MGValue* mgCreateValueMap(size_t capacity);
 
@@ -75,6 +83,9 @@ MGValue* mgCreateValueMap(size_t capacity);
 #define mgMapSet(map, key, value) _mgMapSet(&(map)->data.m, key, value)
 #define mgMapGet(map, key) ((const MGValue*) _mgMapGet(&(map)->data.m, key))
 
+#define mgMapSetInterned(map, key, value) _mgMapSetInterned(&(map)->data.m, key, value)
+#define mgMapGetInterned(map, key) ((const MGValue*) _mgMapGetInterned(&(map)->data.m, key))
+
 #define mgMapSize(map) _mgMapSize((map)->data.m)
 
 void mgMapMerge(MGValue *destination, const MGValue *source, MGbool override);
@@ -5,6 +5,8 @@
 #include "primitive.h"
 #include "composite.h"
 #include "callable.h"
+#include "iterator.h"
+#include "parallel.h"
 #include "error.h"
 
 
@@ -26,10 +28,10 @@
 
 MGValue* mgTypeListAdd(const MGValue *lhs, const MGValue *rhs)
 {
-	if (((lhs->type == MG_TYPE_TUPLE) || (lhs->type == MG_TYPE_LIST)) && (lhs->type == rhs->type))
+	if (((mgValueType(lhs) == MG_TYPE_TUPLE) || (mgValueType(lhs) == MG_TYPE_LIST)) && (mgValueType(lhs) == mgValueType(rhs)))
 	{
 		MGValue *list = mgCreateValueList(mgListLength(lhs) + mgListLength(rhs));
-		list->type = (lhs->type == MG_TYPE_TUPLE) ? MG_TYPE_TUPLE : MG_TYPE_LIST;
+		list->type = (mgValueType(lhs) == MG_TYPE_TUPLE) ? MG_TYPE_TUPLE : MG_TYPE_LIST;
 
 		for (size_t i = 0; i < mgListLength(lhs); ++i)
 			mgListAdd(list, mgReferenceValue(_mgListGet(lhs->data.a, i)));
@@ -49,21 +51,21 @@ MGValue* mgListMul(const MGValue *lhs, const MGValue *rhs)
 	const MGValue *list;
 	int times;
 
-	if (((lhs->type == MG_TYPE_TUPLE) || (lhs->type == MG_TYPE_LIST)) && (rhs->type == MG_TYPE_INTEGER))
+	if (((mgValueType(lhs) == MG_TYPE_TUPLE) || (mgValueType(lhs) == MG_TYPE_LIST)) && (mgValueType(rhs) == MG_TYPE_INTEGER))
 	{
 		list = lhs;
-		times = rhs->data.i;
+		times = mgIntegerGet(rhs);
 	}
-	else if ((lhs->type == MG_TYPE_INTEGER) || ((rhs->type == MG_TYPE_TUPLE) || (rhs->type == MG_TYPE_LIST)))
+	else if ((mgValueType(lhs) == MG_TYPE_INTEGER) || ((mgValueType(rhs) == MG_TYPE_TUPLE) || (mgValueType(rhs) == MG_TYPE_LIST)))
 	{
 		list = rhs;
-		times = lhs->data.i;
+		times = mgIntegerGet(lhs);
 	}
 	else
 		return NULL;
 
 	const size_t len = ((mgListLength(list) > 0) && (times > 0)) ? (mgListLength(list) * times) : 0;
-	MGValue *repeated = (list->type == MG_TYPE_TUPLE) ? mgCreateValueTuple(len) : mgCreateValueList(len);
+	MGValue *repeated = (mgValueType(list) == MG_TYPE_TUPLE) ? mgCreateValueTuple(len) : mgCreateValueList(len);
 
 	for (size_t i = 0; i < len; ++i)
 		mgListAdd(repeated, mgReferenceValue(_mgListGet(list->data.a, i % mgListLength(list))));
@@ -80,10 +82,10 @@ static inline size_t _mgListRelativeIndex(const MGValue *list, intmax_t index)
 	{
 		if (index >= 0)
 			mgFatalError("Error: %s index out of range (0 <= %zd < %zu)",
-			             mgGetTypeName(list->type), index, mgListLength(list));
+			             mgGetTypeName(mgValueType(list)), index, mgListLength(list));
 		else
 			mgFatalError("Error: %s index out of range (-%zu <= %zd < 0)",
-			             mgGetTypeName(list->type), mgListLength(list), index);
+			             mgGetTypeName(mgValueType(list)), mgListLength(list), index);
 	}
 
 	return i;
@@ -98,7 +100,7 @@ static inline size_t _mgListRelativeIndexValue(const MGValue *list, const MGValu
 
 MGValue* mgListSubscriptGet(const MGValue *list, const MGValue *index)
 {
-	if (index->type != MG_TYPE_INTEGER)
+	if (mgValueType(index) != MG_TYPE_INTEGER)
 		return NULL;
 
 	MGValue *value = _mgListGet(list->data.a, _mgListRelativeIndexValue(list, index));
@@ -108,7 +110,7 @@ MGValue* mgListSubscriptGet(const MGValue *list, const MGValue *index)
 
 MGbool mgListSubscriptSet(const MGValue *list, const MGValue *index, MGValue *value)
 {
-	if (index->type == MG_TYPE_INTEGER)
+	if (mgValueType(index) == MG_TYPE_INTEGER)
 	{
 		const size_t i = _mgListRelativeIndexValue(list, index);
 
@@ -129,6 +131,7 @@ MGbool mgListSubscriptSet(const MGValue *list, const MGValue *index, MGValue *va
 static MGValue* mg_list_add(MGInstance *instance, const MGValue *list, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 1, SIZE_MAX);
+	mgCheckUnsharedValue(instance, list);
 
 	for (size_t i = 0; i < argc; ++i)
 		mgListAdd((MGValue*) list, mgReferenceValue(argv[i]));
@@ -141,6 +144,7 @@ static MGValue* mg_list_extend(MGInstance *instance, const MGValue *list, size_t
 {
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 2, MG_TYPE_TUPLE, MG_TYPE_LIST);
+	mgCheckUnsharedValue(instance, list);
 
 	for (size_t i = 0, end = mgListLength(argv[0]); i < end; ++i)
 		mgListAdd((MGValue*) list, mgReferenceValue(_mgListGet(argv[0]->data.a, i)));
@@ -153,8 +157,9 @@ static MGValue* mg_list_insert(MGInstance *instance, const MGValue *list, size_t
 {
 	mgCheckArgumentCount(instance, argc, 2, 2);
 	mgCheckArgumentTypes(instance, argc, argv, 1, MG_TYPE_INTEGER, 0);
+	mgCheckUnsharedValue(instance, list);
 
-	intmax_t index = _mgListIndexRelativeToAbsolute(list->data.a, argv[0]->data.i);
+	intmax_t index = _mgListIndexRelativeToAbsolute(list->data.a, mgIntegerGet(argv[0]));
 	index = (index > 0) ? index : 0;
 	index = (index > (intmax_t) mgListLength(list)) ? (intmax_t) mgListLength(list) : index;
 
@@ -167,6 +172,7 @@ static MGValue* mg_list_insert(MGInstance *instance, const MGValue *list, size_t
 static MGValue* mg_list_remove(MGInstance *instance, const MGValue *list, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 1, 1);
+	mgCheckUnsharedValue(instance, list);
 
 	const size_t length = mgListLength(list);
 
@@ -189,6 +195,7 @@ static MGValue* mg_list_pop(MGInstance *instance, const MGValue *list, size_t ar
 {
 	mgCheckArgumentCount(instance, argc, 0, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 1, MG_TYPE_INTEGER);
+	mgCheckUnsharedValue(instance, list);
 
 	MGValue *item;
 
@@ -212,6 +219,7 @@ static MGValue* mg_list_pop(MGInstance *instance, const MGValue *list, size_t ar
 static MGValue* mg_list_clear(MGInstance *instance, const MGValue *list, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 0, 0);
+	mgCheckUnsharedValue(instance, list);
 
 	mgListClear((MGValue*) list);
 
@@ -236,17 +244,17 @@ static MGValue* mg_list_slice(MGInstance *instance, const MGValue *list, size_t
 
 	intmax_t start = 0;
 	intmax_t stop = length;
-	intmax_t step = (argc > 2) ? (intmax_t) argv[2]->data.i : 0;
+	intmax_t step = (argc > 2) ? (intmax_t) mgIntegerGet(argv[2]) : 0;
 
 	if (argc > 0)
 	{
-		start = _mgListIndexRelativeToAbsolute(list->data.a, argv[0]->data.i);
+		start = _mgListIndexRelativeToAbsolute(list->data.a, mgIntegerGet(argv[0]));
 		start = (start > 0) ? start : 0;
 	}
 
 	if (argc > 1)
 	{
-		stop = _mgListIndexRelativeToAbsolute(list->data.a, argv[1]->data.i);
+		stop = _mgListIndexRelativeToAbsolute(list->data.a, mgIntegerGet(argv[1]));
 		stop = (stop > (intmax_t) mgListLength(list)) ? length : stop;
 	}
 
@@ -274,6 +282,7 @@ static MGValue* mg_list_slice(MGInstance *instance, const MGValue *list, size_t
 static MGValue* mg_list_reverse(MGInstance *instance, const MGValue *list, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 0, 0);
+	mgCheckUnsharedValue(instance, list);
 
 	const size_t length = mgListLength(list);
 
@@ -294,6 +303,7 @@ static MGValue* mg_list_sort(MGInstance *instance, const MGValue *list, size_t a
 {
 	mgCheckArgumentCount(instance, argc, 0, 1);
 	mgCheckArgumentTypes(instance, argc, argv, MG_TYPE_CFUNCTION, MG_TYPE_BOUND_CFUNCTION, MG_TYPE_FUNCTION);
+	mgCheckUnsharedValue(instance, list);
 
 	const intmax_t length = (intmax_t) mgListLength(list);
 
@@ -329,9 +339,9 @@ static MGValue* mg_list_sort(MGInstance *instance, const MGValue *list, size_t a
 
 				MGValue *comparison = mgCall(instance, comparator, 2, argv2);
 				MG_ASSERT(comparison);
-				MG_ASSERT(comparison->type == MG_TYPE_INTEGER);
+				MG_ASSERT(mgValueType(comparison) == MG_TYPE_INTEGER);
 
-				if (comparison->data.i)
+				if (mgIntegerGet(comparison))
 				{
 					_mgListSet(list->data.a, j - 1, item2);
 					_mgListSet(list->data.a, j, item1);
@@ -383,8 +393,8 @@ static MGValue* mg_list_index(MGInstance *instance, const MGValue *list, size_t
 
 	const size_t length = mgListLength(list);
 
-	intmax_t begin = (argc > 1) ? (intmax_t) argv[1]->data.i : 0;
-	intmax_t end = (argc > 2) ? (intmax_t) argv[2]->data.i : length;
+	intmax_t begin = (argc > 1) ? (intmax_t) mgIntegerGet(argv[1]) : 0;
+	intmax_t end = (argc > 2) ? (intmax_t) mgIntegerGet(argv[2]) : length;
 
 	begin = (begin > 0) ? ((begin > length) ? length : begin) : 0;
 	end = (end > 0) ? ((end >= length) ? (length - 1) : end) : 0;
@@ -404,8 +414,8 @@ static MGValue* mg_list_rindex(MGInstance *instance, const MGValue *list, size_t
 
 	const size_t length = mgListLength(list);
 
-	intmax_t rbegin = (argc > 1) ? (intmax_t) argv[1]->data.i : (length - 1);
-	intmax_t rend = (argc > 2) ? (intmax_t) argv[2]->data.i : -1;
+	intmax_t rbegin = (argc > 1) ? (intmax_t) mgIntegerGet(argv[1]) : (length - 1);
+	intmax_t rend = (argc > 2) ? (intmax_t) mgIntegerGet(argv[2]) : -1;
 
 	rbegin = (rbegin >= 0) ? ((rbegin >= length) ? (length - 1) : rbegin) : -1;
 	rend = (rend > 0) ? ((rend >= length) ? (length - 1) : rend) : 0;
@@ -418,38 +428,66 @@ static MGValue* mg_list_rindex(MGInstance *instance, const MGValue *list, size_t
 }
 
 
+static const struct {
+	const char *name;
+	MGBoundCFunction method;
+} _mgListMethods[] = {
+	{ "add", mg_list_add },
+	{ "extend", mg_list_extend },
+	{ "insert", mg_list_insert },
+	{ "remove", mg_list_remove },
+	{ "pop", mg_list_pop },
+	{ "clear", mg_list_clear },
+	{ "copy", mg_list_shallow_copy },
+	{ "slice", mg_list_slice },
+	{ "reverse", mg_list_reverse },
+	{ "sort", mg_list_sort },
+	{ "contains", mg_list_contains },
+	{ "count", mg_list_count },
+	{ "index", mg_list_index },
+	{ "rindex", mg_list_rindex },
+	{ NULL, NULL }
+};
+
+
+MGBoundCFunction mgListMethodGet(const char *key)
+{
+	for (int i = 0; _mgListMethods[i].name; ++i)
+		if (!strcmp(_mgListMethods[i].name, key))
+			return _mgListMethods[i].method;
+
+	return NULL;
+}
+
+
 MGValue* mgListAttributeGet(const MGValue *list, const char *key)
 {
 	if (!strcmp("size", key))
 		return mgCreateValueInteger((int) mgListLength(list));
-	else if (!strcmp("add", key))
-		return mgCreateValueBoundCFunction(mg_list_add, mgReferenceValue(list));
-	else if (!strcmp("extend", key))
-		return mgCreateValueBoundCFunction(mg_list_extend, mgReferenceValue(list));
-	else if (!strcmp("insert", key))
-		return mgCreateValueBoundCFunction(mg_list_insert, mgReferenceValue(list));
-	else if (!strcmp("remove", key))
-		return mgCreateValueBoundCFunction(mg_list_remove, mgReferenceValue(list));
-	else if (!strcmp("pop", key))
-		return mgCreateValueBoundCFunction(mg_list_pop, mgReferenceValue(list));
-	else if (!strcmp("clear", key))
-		return mgCreateValueBoundCFunction(mg_list_clear, mgReferenceValue(list));
-	else if (!strcmp("copy", key))
-		return mgCreateValueBoundCFunction(mg_list_shallow_copy, mgReferenceValue(list));
-	else if (!strcmp("slice", key))
-		return mgCreateValueBoundCFunction(mg_list_slice, mgReferenceValue(list));
-	else if (!strcmp("reverse", key))
-		return mgCreateValueBoundCFunction(mg_list_reverse, mgReferenceValue(list));
-	else if (!strcmp("sort", key))
-		return mgCreateValueBoundCFunction(mg_list_sort, mgReferenceValue(list));
-	else if (!strcmp("contains", key))
-		return mgCreateValueBoundCFunction(mg_list_contains, mgReferenceValue(list));
-	else if (!strcmp("count", key))
-		return mgCreateValueBoundCFunction(mg_list_count, mgReferenceValue(list));
-	else if (!strcmp("index", key))
-		return mgCreateValueBoundCFunction(mg_list_index, mgReferenceValue(list));
-	else if (!strcmp("rindex", key))
-		return mgCreateValueBoundCFunction(mg_list_rindex, mgReferenceValue(list));
 
-	return NULL;
+	MGBoundCFunction method = mgListMethodGet(key);
+	return method ? mgCreateValueBoundCFunction(method, mgReferenceValue(list)) : NULL;
+}
+
+
+static MGValue* _mgListIteratorNext(MGValue *iterator)
+{
+	const MGValue *list = _mgListGet(iterator->data.iter->values, 0);
+
+	if ((iterator->data.iter->index >= iterator->data.iter->count) || ((size_t) iterator->data.iter->index >= mgListLength(list)))
+		return NULL;
+
+	return mgReferenceValue(_mgListGet(list->data.a, iterator->data.iter->index++));
+}
+
+
+MGValue* mgListIterate(const MGValue *list)
+{
+	MGValue *iterator = mgCreateValueIterator(NULL, _mgListIteratorNext, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgReferenceValue(list));
+
+	// Items added while iterating are not iterated, see iterator.h
+	iterator->data.iter->count = (intmax_t) mgListLength(list);
+
+	return iterator;
 }
@@ -5,6 +5,8 @@
 #include "primitive.h"
 #include "composite.h"
 #include "callable.h"
+#include "iterator.h"
+#include "parallel.h"
 #include "error.h"
 
 
@@ -19,7 +21,7 @@
 
 MGValue* mgMapAdd(const MGValue *lhs, const MGValue *rhs)
 {
-	if ((lhs->type == MG_TYPE_MAP) && (rhs->type == MG_TYPE_MAP))
+	if ((mgValueType(lhs) == MG_TYPE_MAP) && (mgValueType(rhs) == MG_TYPE_MAP))
 	{
 		MGValue *map = mgCreateValueMap(mgMapSize(lhs) + mgMapSize(rhs));
 
@@ -35,20 +37,23 @@ MGValue* mgMapAdd(const MGValue *lhs, const MGValue *rhs)
 
 MGValue* mgMapSubscriptGet(const MGValue *map, const MGValue *key)
 {
-	if (key->type != MG_TYPE_STRING)
+	if (mgValueType(key) != MG_TYPE_STRING)
 		return NULL;
 
-	const MGValue *value = mgMapGet(map, key->data.str.s);
+	const MGValue *value = (key->data.str.usage == MG_STRING_USAGE_INTERNED) ? mgMapGetInterned(map, key->data.str.s) : mgMapGet(map, key->data.str.s);
 	return value ? mgReferenceValue(value) : MG_NULL_VALUE;
 }
 
 
 MGbool mgMapSubscriptSet(const MGValue *map, const MGValue *key, MGValue *value)
 {
-	if (key->type != MG_TYPE_STRING)
+	if (mgValueType(key) != MG_TYPE_STRING)
 		return MG_FALSE;
 
-	mgMapSet((MGValue*) map, key->data.str.s, value);
+	if (key->data.str.usage == MG_STRING_USAGE_INTERNED)
+		mgMapSetInterned((MGValue*) map, key->data.str.s, value);
+	else
+		mgMapSet((MGValue*) map, key->data.str.s, value);
 
 	return MG_TRUE;
 }
@@ -58,6 +63,7 @@ static MGValue* mg_map_pop(MGInstance *instance, const MGValue *map, size_t argc
 {
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 1, MG_TYPE_STRING);
+	mgCheckUnsharedValue(instance, map);
 
 	const MGValue *key = argv[0];
 	MGValue *item = (MGValue*) mgMapGet(map, key->data.str.s);
@@ -75,6 +81,7 @@ static MGValue* mg_map_pop(MGInstance *instance, const MGValue *map, size_t argc
 static MGValue* mg_map_clear(MGInstance *instance, const MGValue *map, size_t argc, const MGValue* const* argv)
 {
 	mgCheckArgumentCount(instance, argc, 0, 0);
+	mgCheckUnsharedValue(instance, map);
 
 	mgMapClear((MGValue*) map);
 
@@ -95,13 +102,7 @@ static MGValue* mg_map_has(MGInstance *instance, const MGValue *map, size_t argc
 	mgCheckArgumentCount(instance, argc, 1, 1);
 	mgCheckArgumentTypes(instance, argc, argv, 1, MG_TYPE_STRING);
 
-	const char *key = argv[0]->data.str.s;
-
-	for (size_t i = 0; i < _mgListLength(map->data.m); ++i)
-		if (!strcmp(_mgListGet(map->data.m, i).key, key))
-			return mgCreateValueBoolean(MG_TRUE);
-
-	return mgCreateValueBoolean(MG_FALSE);
+	return mgCreateValueBoolean(mgMapGet(map, argv[0]->data.str.s) != NULL);
 }
 
 
@@ -109,8 +110,8 @@ static MGValue* mg_map_contains(MGInstance *instance, const MGValue *map, size_t
 {
 	mgCheckArgumentCount(instance, argc, 1, 1);
 
-	for (size_t i = 0; i < _mgListLength(map->data.m); ++i)
-		if (mgValueCompare(argv[0], _mgListGet(map->data.m, i).value, MG_BIN_OP_EQ))
+	for (size_t i = 0; i < mgMapSize(map); ++i)
+		if (mgValueCompare(argv[0], _mgListGet(map->data.m.pairs, i).value, MG_BIN_OP_EQ))
 			return mgCreateValueBoolean(MG_TRUE);
 
 	return mgCreateValueBoolean(MG_FALSE);
@@ -123,8 +124,8 @@ static MGValue* mg_map_keys(MGInstance *instance, const MGValue *map, size_t arg
 
 	MGValue *keys = mgCreateValueList(mgMapSize(map));
 
-	for (size_t i = 0; i < _mgListLength(map->data.m); ++i)
-		mgListAdd(keys, mgCreateValueString(_mgListGet(map->data.m, i).key));
+	for (size_t i = 0; i < mgMapSize(map); ++i)
+		mgListAdd(keys, mgCreateValueInternedString(_mgListGet(map->data.m.pairs, i).key));
 
 	return keys;
 }
@@ -136,8 +137,8 @@ static MGValue* mg_map_values(MGInstance *instance, const MGValue *map, size_t a
 
 	MGValue *values = mgCreateValueList(mgMapSize(map));
 
-	for (size_t i = 0; i < _mgListLength(map->data.m); ++i)
-		mgListAdd(values, mgReferenceValue(_mgListGet(map->data.m, i).value));
+	for (size_t i = 0; i < mgMapSize(map); ++i)
+		mgListAdd(values, mgReferenceValue(_mgListGet(map->data.m.pairs, i).value));
 
 	return values;
 }
@@ -149,33 +150,48 @@ static MGValue* mg_map_pairs(MGInstance *instance, const MGValue *map, size_t ar
 
 	MGValue *pairs = mgCreateValueList(mgMapSize(map));
 
-	for (size_t i = 0; i < _mgListLength(map->data.m); ++i)
-		mgListAdd(pairs, mgCreateValueTupleEx(2, mgCreateValueString(_mgListGet(map->data.m, i).key), mgReferenceValue(_mgListGet(map->data.m, i).value)));
+	for (size_t i = 0; i < mgMapSize(map); ++i)
+		mgListAdd(pairs, mgCreateValueTupleEx(2, mgCreateValueInternedString(_mgListGet(map->data.m.pairs, i).key), mgReferenceValue(_mgListGet(map->data.m.pairs, i).value)));
 
 	return pairs;
 }
 
 
+static const struct {
+	const char *name;
+	MGBoundCFunction method;
+} _mgMapMethods[] = {
+	{ "pop", mg_map_pop },
+	{ "clear", mg_map_clear },
+	{ "copy", mg_map_shallow_copy },
+	{ "has", mg_map_has },
+	{ "contains", mg_map_contains },
+	{ "keys", mg_map_keys },
+	{ "values", mg_map_values },
+	{ "pairs", mg_map_pairs },
+	{ NULL, NULL }
+};
+
+
+MGBoundCFunction mgMapMethodGet(const char *key)
+{
+	for (int i = 0; _mgMapMethods[i].name; ++i)
+		if (!strcmp(_mgMapMethods[i].name, key))
+			return _mgMapMethods[i].method;
+
+	return NULL;
+}
+
+
 MGValue* mgMapAttributeGet(const MGValue *map, const char *key)
 {
 	if (!strcmp("size", key))
 		return mgCreateValueInteger((int) mgMapSize(map));
-	else if (!strcmp("pop", key))
-		return mgCreateValueBoundCFunction(mg_map_pop, mgReferenceValue(map));
-	else if (!strcmp("clear", key))
-		return mgCreateValueBoundCFunction(mg_map_clear, mgReferenceValue(map));
-	else if (!strcmp("copy", key))
-		return mgCreateValueBoundCFunction(mg_map_shallow_copy, mgReferenceValue(map));
-	else if (!strcmp("has", key))
-		return mgCreateValueBoundCFunction(mg_map_has, mgReferenceValue(map));
-	else if (!strcmp("contains", key))
-		return mgCreateValueBoundCFunction(mg_map_contains, mgReferenceValue(map));
-	else if (!strcmp("keys", key))
-		return mgCreateValueBoundCFunction(mg_map_keys, mgReferenceValue(map));
-	else if (!strcmp("values", key))
-		return mgCreateValueBoundCFunction(mg_map_values, mgReferenceValue(map));
-	else if (!strcmp("pairs", key))
-		return mgCreateValueBoundCFunction(mg_map_pairs, mgReferenceValue(map));
+
+	MGBoundCFunction method = mgMapMethodGet(key);
+
+	if (method)
+		return mgCreateValueBoundCFunction(method, mgReferenceValue(map));
 
 	const MGValue *value = mgMapGet(map, key);
 	return value ? mgReferenceValue(value) : MG_NULL_VALUE;
@@ -188,3 +204,27 @@ MGbool mgMapAttributeSet(const MGValue *map, const char *key, MGValue *value)
 
 	return MG_TRUE;
 }
+
+
+// Iterates the keys of the map in insertion order
+static MGValue* _mgMapIteratorNext(MGValue *iterator)
+{
+	const MGValue *map = _mgListGet(iterator->data.iter->values, 0);
+
+	if ((iterator->data.iter->index >= iterator->data.iter->count) || ((size_t) iterator->data.iter->index >= mgMapSize(map)))
+		return NULL;
+
+	return mgCreateValueInternedString(_mgListGet(map->data.m.pairs, iterator->data.iter->index++).key);
+}
+
+
+MGValue* mgMapIterate(const MGValue *map)
+{
+	MGValue *iterator = mgCreateValueIterator(NULL, _mgMapIteratorNext, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgReferenceValue(map));
+
+	// Items added while iterating are not iterated, see iterator.h
+	iterator->data.iter->count = (intmax_t) mgMapSize(map);
+
+	return iterator;
+}
@@ -0,0 +1,366 @@
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "value.h"
+#include "primitive.h"
+#include "composite.h"
+#include "vector.h"
+#include "matrix.h"
+#include "iterator.h"
+#include "simd.h"
+#include "error.h"
+#include "utilities.h"
+#include "debug.h"
+
+
+extern MGValue* mgAnyConvert(const MGValue *value, MGType type);
+extern MGtribool mgAnyEqual(const MGValue *lhs, const MGValue *rhs);
+
+
+MGValue* mgCreateValueMatrix(const float *components)
+{
+	MGValue *matrix = mgCreateValue(MG_TYPE_MAT4);
+
+	if (components)
+		memcpy(matrix->data.mat, components, sizeof(matrix->data.mat));
+	else
+		mgMatrixIdentity(matrix->data.mat, 1.0f);
+
+	return matrix;
+}
+
+
+MGbool mgMatrixLoad(const MGValue *value, float *m)
+{
+	if (mgIsMatrixValue(value))
+	{
+		memcpy(m, value->data.mat, 16 * sizeof(float));
+
+		return MG_TRUE;
+	}
+	else if ((mgValueType(value) == MG_TYPE_TUPLE) || (mgValueType(value) == MG_TYPE_LIST))
+	{
+		if (mgListLength(value) != 4)
+			return MG_FALSE;
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			const MGValue *column = _mgListGet(value->data.a, i);
+
+			if (mgIsNumericValue(column) || !mgVectorLoad(column, 4, m + i * 4))
+				return MG_FALSE;
+		}
+
+		return MG_TRUE;
+	}
+
+	return MG_FALSE;
+}
+
+
+void mgMatrixIdentity(float *m, float diagonal)
+{
+	for (int i = 0; i < 16; ++i)
+		m[i] = (i % 5) ? 0.0f : diagonal;
+}
+
+
+void mgMatrixMultiply(float *result, const float *a, const float *b)
+{
+	const MGFloat4 a0 = mgFloat4Load(a), a1 = mgFloat4Load(a + 4);
+	const MGFloat4 a2 = mgFloat4Load(a + 8), a3 = mgFloat4Load(a + 12);
+
+	float r[16];
+
+	for (int i = 0; i < 16; i += 4)
+	{
+		// Summed from zero like vec.dot, which never yields -0
+		MGFloat4 c = mgFloat4Set1(0.0f);
+
+		c = mgFloat4Add(c, mgFloat4Mul(a0, mgFloat4Set1(b[i])));
+		c = mgFloat4Add(c, mgFloat4Mul(a1, mgFloat4Set1(b[i + 1])));
+		c = mgFloat4Add(c, mgFloat4Mul(a2, mgFloat4Set1(b[i + 2])));
+		c = mgFloat4Add(c, mgFloat4Mul(a3, mgFloat4Set1(b[i + 3])));
+
+		mgFloat4Store(r + i, c);
+	}
+
+	memcpy(result, r, sizeof(r));
+}
+
+
+void mgMatrixTranspose(float *result, const float *m)
+{
+	MGFloat4 c0 = mgFloat4Load(m), c1 = mgFloat4Load(m + 4);
+	MGFloat4 c2 = mgFloat4Load(m + 8), c3 = mgFloat4Load(m + 12);
+
+	mgFloat4Transpose(c0, c1, c2, c3);
+
+	mgFloat4Store(result, c0);
+	mgFloat4Store(result + 4, c1);
+	mgFloat4Store(result + 8, c2);
+	mgFloat4Store(result + 12, c3);
+}
+
+
+void mgMatrixScaling(float *scaling, const float *m)
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		const float *column = m + i * 4;
+		scaling[i] = sqrtf(0.0f + column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+	}
+}
+
+
+// Like mat.mg, each row is divided by the scaling
+void mgMatrixRotation(float *result, const float *m)
+{
+	float scaling[3], r[16];
+
+	mgMatrixScaling(scaling, m);
+	mgMatrixIdentity(r, 1.0f);
+
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			r[i * 4 + j] = m[i * 4 + j] / scaling[j];
+
+	memcpy(result, r, sizeof(r));
+}
+
+
+void mgMatrixTransform(float *result, const float *m, const float *v)
+{
+	MGFloat4 c = mgFloat4Mul(mgFloat4Load(m), mgFloat4Set1(v[0]));
+
+	c = mgFloat4Add(c, mgFloat4Mul(mgFloat4Load(m + 4), mgFloat4Set1(v[1])));
+	c = mgFloat4Add(c, mgFloat4Mul(mgFloat4Load(m + 8), mgFloat4Set1(v[2])));
+	c = mgFloat4Add(c, mgFloat4Mul(mgFloat4Load(m + 12), mgFloat4Set1(v[3])));
+
+	mgFloat4Store(result, c);
+}
+
+
+static inline MGFloat4 _mgFloat4Lanes(float x, float y, float z, float w)
+{
+	const float v[4] = { x, y, z, w };
+	return mgFloat4Load(v);
+}
+
+
+#define _MG_M(column, row) m[(column) * 4 + (row)]
+
+// The 2x2 determinants of rows p and q, for the columns
+// (2, 3), (2, 3), (1, 3) and (1, 2) respectively
+static inline MGFloat4 _mgMatrixFactor(const float *m, int p, int q)
+{
+	const MGFloat4 a = _mgFloat4Lanes(_MG_M(2, p), _MG_M(2, p), _MG_M(1, p), _MG_M(1, p));
+	const MGFloat4 b = _mgFloat4Lanes(_MG_M(3, q), _MG_M(3, q), _MG_M(3, q), _MG_M(2, q));
+	const MGFloat4 c = _mgFloat4Lanes(_MG_M(3, p), _MG_M(3, p), _MG_M(3, p), _MG_M(2, p));
+	const MGFloat4 d = _mgFloat4Lanes(_MG_M(2, q), _MG_M(2, q), _MG_M(1, q), _MG_M(1, q));
+
+	return mgFloat4Sub(mgFloat4Mul(a, b), mgFloat4Mul(c, d));
+}
+
+
+// Cofactor expansion, computing a column of the adjugate at a time
+MGbool mgMatrixInverse(float *result, const float *m)
+{
+	const MGFloat4 f0 = _mgMatrixFactor(m, 2, 3);
+	const MGFloat4 f1 = _mgMatrixFactor(m, 1, 3);
+	const MGFloat4 f2 = _mgMatrixFactor(m, 1, 2);
+	const MGFloat4 f3 = _mgMatrixFactor(m, 0, 3);
+	const MGFloat4 f4 = _mgMatrixFactor(m, 0, 2);
+	const MGFloat4 f5 = _mgMatrixFactor(m, 0, 1);
+
+	const MGFloat4 v0 = _mgFloat4Lanes(_MG_M(1, 0), _MG_M(0, 0), _MG_M(0, 0), _MG_M(0, 0));
+	const MGFloat4 v1 = _mgFloat4Lanes(_MG_M(1, 1), _MG_M(0, 1), _MG_M(0, 1), _MG_M(0, 1));
+	const MGFloat4 v2 = _mgFloat4Lanes(_MG_M(1, 2), _MG_M(0, 2), _MG_M(0, 2), _MG_M(0, 2));
+	const MGFloat4 v3 = _mgFloat4Lanes(_MG_M(1, 3), _MG_M(0, 3), _MG_M(0, 3), _MG_M(0, 3));
+
+	const MGFloat4 signA = _mgFloat4Lanes(1.0f, -1.0f, 1.0f, -1.0f);
+	const MGFloat4 signB = _mgFloat4Lanes(-1.0f, 1.0f, -1.0f, 1.0f);
+
+	const MGFloat4 c0 = mgFloat4Mul(mgFloat4Add(mgFloat4Sub(mgFloat4Mul(v1, f0), mgFloat4Mul(v2, f1)), mgFloat4Mul(v3, f2)), signA);
+	const MGFloat4 c1 = mgFloat4Mul(mgFloat4Add(mgFloat4Sub(mgFloat4Mul(v0, f0), mgFloat4Mul(v2, f3)), mgFloat4Mul(v3, f4)), signB);
+	const MGFloat4 c2 = mgFloat4Mul(mgFloat4Add(mgFloat4Sub(mgFloat4Mul(v0, f1), mgFloat4Mul(v1, f3)), mgFloat4Mul(v3, f5)), signA);
+	const MGFloat4 c3 = mgFloat4Mul(mgFloat4Add(mgFloat4Sub(mgFloat4Mul(v0, f2), mgFloat4Mul(v1, f4)), mgFloat4Mul(v2, f5)), signB);
+
+	float r[16];
+
+	mgFloat4Store(r, c0);
+	mgFloat4Store(r + 4, c1);
+	mgFloat4Store(r + 8, c2);
+	mgFloat4Store(r + 12, c3);
+
+	// The first column against the first row of the adjugate
+	const float determinant = (_MG_M(0, 0) * r[0] + _MG_M(0, 1) * r[4]) + (_MG_M(0, 2) * r[8] + _MG_M(0, 3) * r[12]);
+
+	if (determinant == 0.0f)
+		return MG_FALSE;
+
+	const MGFloat4 scale = mgFloat4Set1(1.0f / determinant);
+
+	for (int i = 0; i < 16; i += 4)
+		mgFloat4Store(result + i, mgFloat4Mul(mgFloat4Load(r + i), scale));
+
+	return MG_TRUE;
+}
+
+#undef _MG_M
+
+
+MGbool mgMatrixNormal(float *result, const float *m)
+{
+	float r[16];
+
+	if (!mgMatrixInverse(r, m))
+		return MG_FALSE;
+
+	mgMatrixTranspose(r, r);
+
+	r[3] = r[7] = r[11] = 0.0f;
+	r[12] = r[13] = r[14] = 0.0f;
+	r[15] = 1.0f;
+
+	memcpy(result, r, sizeof(r));
+
+	return MG_TRUE;
+}
+
+
+MGValue* mgMatrixConvert(const MGValue *value, MGType type)
+{
+	if ((type == MG_TYPE_TUPLE) || (type == MG_TYPE_LIST))
+	{
+		MGValue *columns = (type == MG_TYPE_TUPLE) ? mgCreateValueTuple(4) : mgCreateValueList(4);
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			MGValue *column = (type == MG_TYPE_TUPLE) ? mgCreateValueTuple(4) : mgCreateValueList(4);
+
+			for (size_t j = 0; j < 4; ++j)
+				mgListAdd(column, mgCreateValueFloat(mgMatrixGet(value, i, j)));
+
+			mgListAdd(columns, column);
+		}
+
+		return columns;
+	}
+
+	return mgAnyConvert(value, type);
+}
+
+
+char* mgMatrixToString(const MGValue *matrix)
+{
+	// Formatted like print formats floats, a column at a time
+	char columns[4][4 * 16 + 8];
+	const float *m = matrix->data.mat;
+
+	for (int i = 0; i < 4; ++i)
+		snprintf(columns[i], sizeof(columns[i]), "(%G, %G, %G, %G)", m[i * 4], m[i * 4 + 1], m[i * 4 + 2], m[i * 4 + 3]);
+
+	const char *format = "%s(%s, %s, %s, %s)";
+	const char *name = mgGetTypeName(mgValueType(matrix));
+
+	const size_t len = (size_t) snprintf(NULL, 0, format, name, columns[0], columns[1], columns[2], columns[3]);
+
+	char *s = (char*) malloc((len + 1) * sizeof(char));
+	MG_ASSERT(s);
+
+	snprintf(s, len + 1, format, name, columns[0], columns[1], columns[2], columns[3]);
+	s[len] = '\0';
+
+	return s;
+}
+
+
+// Either operand is a mat4, while the other is a mat4 or the same as
+// a tuple of columns, which yields their product. Otherwise a vec4 is
+// transformed, as is a vec3 as a point, like mat.mul
+MGValue* mgMatrixMul(const MGValue *lhs, const MGValue *rhs)
+{
+	float a[16], b[16];
+
+	if (!mgMatrixLoad(lhs, a))
+		return NULL;
+
+	if (mgMatrixLoad(rhs, b))
+	{
+		MGValue *product = mgCreateValue(MG_TYPE_MAT4);
+		mgMatrixMultiply(product->data.mat, a, b);
+
+		return product;
+	}
+	else if ((mgValueType(rhs) == MG_TYPE_VEC3) || (mgValueType(rhs) == MG_TYPE_VEC4))
+	{
+		float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		memcpy(v, rhs->data.vec, mgVectorLength(rhs) * sizeof(float));
+
+		float r[4];
+		mgMatrixTransform(r, a, v);
+
+		return mgCreateValueVector(mgVectorLength(rhs), r);
+	}
+
+	return NULL;
+}
+
+
+MGtribool mgMatrixEqual(const MGValue *lhs, const MGValue *rhs)
+{
+	float a[16], b[16];
+
+	if (!mgMatrixLoad(lhs, a) || !mgMatrixLoad(rhs, b))
+		return mgAnyEqual(lhs, rhs);
+
+	for (int i = 0; i < 16; i += 4)
+		if (mgFloat4Approximately(mgFloat4Load(a + i), mgFloat4Load(b + i), MG_EPSILON) != 0xF)
+			return MG_FALSE;
+
+	return MG_TRUE;
+}
+
+
+// m[i] is the i-th column as a vec4
+MGValue* mgMatrixSubscriptGet(const MGValue *matrix, const MGValue *index)
+{
+	if (mgValueType(index) != MG_TYPE_INTEGER)
+		return NULL;
+
+	const int i = mgIntegerGet(index);
+
+	if ((i >= 4) || (i < -4))
+	{
+		if (i >= 0)
+			mgFatalError("Error: %s index out of range (0 <= %d < 4)", mgGetTypeName(mgValueType(matrix)), i);
+		else
+			mgFatalError("Error: %s index out of range (-4 <= %d < 0)", mgGetTypeName(mgValueType(matrix)), i);
+	}
+
+	return mgCreateValueVector(4, matrix->data.mat + ((i < 0) ? (4 + i) : i) * 4);
+}
+
+
+static MGValue* _mgMatrixIteratorNext(MGValue *iterator)
+{
+	const MGValue *matrix = _mgListGet(iterator->data.iter->values, 0);
+
+	if (iterator->data.iter->index >= 4)
+		return NULL;
+
+	return mgCreateValueVector(4, matrix->data.mat + (iterator->data.iter->index++) * 4);
+}
+
+
+MGValue* mgMatrixIterate(const MGValue *matrix)
+{
+	MGValue *iterator = mgCreateValueIterator(NULL, _mgMatrixIteratorNext, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgReferenceValue(matrix));
+
+	return iterator;
+}
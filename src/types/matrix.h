@@ -0,0 +1,40 @@
+#ifndef MODELGEN_MATRIX_TYPES_H
+#define MODELGEN_MATRIX_TYPES_H
+
+#include "value.h"
+
+// mat4 stores its 16 components inline as floats, one column after
+// another, i.e. m[column][row] like the tuples of modules/mat.mg.
+// Columns are operated on using SIMD. Like tuples it is immutable.
+
+#define mgIsMatrixValue(value) (mgValueType(value) == MG_TYPE_MAT4)
+
+#define mgMatrixGet(matrix, column, row) ((matrix)->data.mat[(column) * 4 + (row)])
+
+// The components may be NULL, which creates an identity matrix
+MGValue* mgCreateValueMatrix(const float *components);
+
+// Loads the components of a mat4, or of a tuple or list of 4 columns,
+// each of which mgVectorLoad accepts as 4 components, and returns
+// whether value was either of those
+MGbool mgMatrixLoad(const MGValue *value, float *m);
+
+void mgMatrixIdentity(float *m, float diagonal);
+
+// The results may be any of the operands
+void mgMatrixMultiply(float *result, const float *a, const float *b);
+void mgMatrixTranspose(float *result, const float *m);
+void mgMatrixTransform(float *result, const float *m, const float *v);
+
+// The lengths of the first three columns, and the upper 3x3 of m
+// divided by them like mat.get_rotation, with the rest of an identity
+void mgMatrixScaling(float *scaling, const float *m);
+void mgMatrixRotation(float *result, const float *m);
+
+// Returns MG_FALSE and leaves result as is if m is not invertible
+MGbool mgMatrixInverse(float *result, const float *m);
+
+// The inverse transpose without translation, which transforms normals
+MGbool mgMatrixNormal(float *result, const float *m);
+
+#endif
\ No newline at end of file
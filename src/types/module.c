@@ -22,7 +22,7 @@ MGValue* mgCreateValueModule(void)
 void mgModuleSet(MGValue *module, const char *name, MGValue *value)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(name);
 
 	_mgMapSet(&module->data.module.globals->data.m, name, value);
@@ -32,29 +32,49 @@ void mgModuleSet(MGValue *module, const char *name, MGValue *value)
 const MGValue* mgModuleGet(const MGValue *module, const char *name)
 {
 	MG_ASSERT(module);
-	MG_ASSERT(module->type == MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
 	MG_ASSERT(name);
 
 	return _mgMapGet(&module->data.module.globals->data.m, name);
 }
 
 
+void mgModuleSetInterned(MGValue *module, const char *name, MGValue *value)
+{
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+	MG_ASSERT(name);
+
+	_mgMapSetInterned(&module->data.module.globals->data.m, name, value);
+}
+
+
+const MGValue* mgModuleGetInterned(const MGValue *module, const char *name)
+{
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+	MG_ASSERT(name);
+
+	return _mgMapGetInterned(&module->data.module.globals->data.m, name);
+}
+
+
 int mgModuleGetInteger(MGValue *module, const char *name, int defaultValue)
 {
 	const MGValue *value = mgModuleGet(module, name);
-	return (value && (value->type == MG_TYPE_INTEGER)) ? value->data.i : defaultValue;
+	return (value && (mgValueType(value) == MG_TYPE_INTEGER)) ? mgIntegerGet(value) : defaultValue;
 }
 
 
 float mgModuleGetFloat(MGValue *module, const char *name, float defaultValue)
 {
 	const MGValue *value = mgModuleGet(module, name);
-	return (value && (value->type == MG_TYPE_FLOAT)) ? value->data.f : defaultValue;
+	return (value && (mgValueType(value) == MG_TYPE_FLOAT)) ? mgFloatGet(value) : defaultValue;
 }
 
 
 const char* mgModuleGetString(MGValue *module, const char *name, const char *defaultValue)
 {
 	const MGValue *value = mgModuleGet(module, name);
-	return (value && (value->type == MG_TYPE_STRING)) ? value->data.str.s : defaultValue;
+	return (value && (mgValueType(value) == MG_TYPE_STRING)) ? value->data.str.s : defaultValue;
 }
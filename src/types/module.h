@@ -9,6 +9,10 @@ MGValue* mgCreateValueModule(void);
 void mgModuleSet(MGValue *module, const char *name, MGValue *value);
 const MGValue* mgModuleGet(const MGValue *module, const char *name);
 
+// Same as above, but the name must be an interned string
+void mgModuleSetInterned(MGValue *module, const char *name, MGValue *value);
+const MGValue* mgModuleGetInterned(const MGValue *module, const char *name);
+
 #define mgModuleSetInteger(module, name, i) mgModuleSet(module, name, mgCreateValueInteger(i))
 #define mgModuleSetFloat(module, name, f) mgModuleSet(module, name, mgCreateValueFloat(f))
 #define mgModuleSetString(module, name, s) mgModuleSet(module, name, mgCreateValueString(s))
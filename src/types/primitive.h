@@ -1,23 +1,189 @@
 #ifndef MODELGEN_PRIMITIVE_TYPES_H
 #define MODELGEN_PRIMITIVE_TYPES_H
 
+#include <string.h>
+
 #include "value.h"
+#include "intern.h"
+#include "utilities.h"
+#include "debug.h"
 
-#define mgCreateValueNull() mgCreateValue(MG_TYPE_NULL)
+#define mgCreateValueNull() _MG_NULL_VALUE
 #define mgCreateValueBoolean(b) mgCreateValueInteger(b)
 
-MGValue* mgCreateValueInteger(int i);
-#define mgIntegerSet(value, _i) value->data.i = _i
-#define mgIntegerGet(value) value->data.i
+// The payload of integer and float values is stored
+// in the upper 32 bits of the tagged MGValue pointer
+
+static inline MGValue* mgCreateValueInteger(int i)
+{
+	return (MGValue*) (((uintptr_t) (uint32_t) i << 32) | _MG_VALUE_TAG_INTEGER);
+}
+
+static inline int mgIntegerGet(const MGValue *value)
+{
+	MG_ASSERT(_mgValueTag(value) == _MG_VALUE_TAG_INTEGER);
+
+	return (int) (int32_t) (uint32_t) ((uintptr_t) value >> 32);
+}
+
+static inline MGValue* mgCreateValueFloat(float f)
+{
+	uint32_t bits;
+	memcpy(&bits, &f, sizeof(float));
+
+	return (MGValue*) (((uintptr_t) bits << 32) | _MG_VALUE_TAG_FLOAT);
+}
+
+static inline float mgFloatGet(const MGValue *value)
+{
+	MG_ASSERT(_mgValueTag(value) == _MG_VALUE_TAG_FLOAT);
+
+	const uint32_t bits = (uint32_t) ((uintptr_t) value >> 32);
+
+	float f;
+	memcpy(&f, &bits, sizeof(float));
+
+	return f;
+}
+
+#define mgIsNumericValue(value) ((_mgValueTag(value) == _MG_VALUE_TAG_INTEGER) || (_mgValueTag(value) == _MG_VALUE_TAG_FLOAT))
+
+static inline float _mgNumericGet(const MGValue *value)
+{
+	return (_mgValueTag(value) == _MG_VALUE_TAG_INTEGER) ? (float) mgIntegerGet(value) : mgFloatGet(value);
+}
+
+// Compares integers and floats inline without going through the
+// type table, yielding the same result as mgAnyEqual, mgAnyLess
+// and mgAnyLessEqual, or MG_INDETERMINATE for other types
+static inline MGtribool mgNumericCompare(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
+{
+	if (!mgIsNumericValue(lhs) || !mgIsNumericValue(rhs))
+		return MG_INDETERMINATE;
+
+	MGtribool result;
+
+	if ((_mgValueTag(lhs) == _MG_VALUE_TAG_INTEGER) && (_mgValueTag(rhs) == _MG_VALUE_TAG_INTEGER))
+	{
+		const int a = mgIntegerGet(lhs), b = mgIntegerGet(rhs);
+
+		switch (operation)
+		{
+		case MG_BIN_OP_EQ:
+		case MG_BIN_OP_NOT_EQ:
+			result = a == b;
+			break;
+		case MG_BIN_OP_LESS:
+		case MG_BIN_OP_GREATER_EQ:
+			result = a < b;
+			break;
+		case MG_BIN_OP_LESS_EQ:
+		case MG_BIN_OP_GREATER:
+			result = a <= b;
+			break;
+		default:
+			return MG_INDETERMINATE;
+		}
+	}
+	else
+	{
+		const float a = _mgNumericGet(lhs), b = _mgNumericGet(rhs);
+
+		// Identical immediates compare equal, even if NaN
+		switch (operation)
+		{
+		case MG_BIN_OP_EQ:
+		case MG_BIN_OP_NOT_EQ:
+			if (lhs == rhs)
+				result = MG_TRUE;
+			else if ((_mgValueTag(lhs) == _MG_VALUE_TAG_FLOAT) && (_mgValueTag(rhs) == _MG_VALUE_TAG_FLOAT))
+				result = MG_FEQUAL(a, b);
+			else
+				result = a == b;
+			break;
+		case MG_BIN_OP_LESS:
+		case MG_BIN_OP_GREATER_EQ:
+			result = (lhs != rhs) && (a < b);
+			break;
+		case MG_BIN_OP_LESS_EQ:
+		case MG_BIN_OP_GREATER:
+			result = (lhs == rhs) || (a <= b);
+			break;
+		default:
+			return MG_INDETERMINATE;
+		}
+	}
+
+	if ((operation == MG_BIN_OP_NOT_EQ) || (operation == MG_BIN_OP_GREATER_EQ) || (operation == MG_BIN_OP_GREATER))
+		result = !result;
+
+	return result;
+}
+
+// Evaluates arithmetic and comparisons of integers and floats
+// inline, returning NULL for any other operands as well as for
+// integer division by zero, which is left to mgValueBinaryOp
+static inline MGValue* mgNumericBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
+{
+	if (!mgIsNumericValue(lhs) || !mgIsNumericValue(rhs))
+		return NULL;
+
+	if ((_mgValueTag(lhs) == _MG_VALUE_TAG_INTEGER) && (_mgValueTag(rhs) == _MG_VALUE_TAG_INTEGER))
+	{
+		const int a = mgIntegerGet(lhs), b = mgIntegerGet(rhs);
+
+		switch (operation)
+		{
+		case MG_BIN_OP_ADD:
+			return mgCreateValueInteger(a + b);
+		case MG_BIN_OP_SUB:
+			return mgCreateValueInteger(a - b);
+		case MG_BIN_OP_MUL:
+			return mgCreateValueInteger(a * b);
+		case MG_BIN_OP_DIV:
+			return mgCreateValueFloat(a / (float) b);
+		case MG_BIN_OP_INT_DIV:
+			return b ? mgCreateValueInteger(a / b) : NULL;
+		case MG_BIN_OP_MOD:
+			return b ? mgCreateValueInteger(a % b) : NULL;
+		default:
+			break;
+		}
+	}
+	else
+	{
+		const float a = _mgNumericGet(lhs), b = _mgNumericGet(rhs);
+
+		switch (operation)
+		{
+		case MG_BIN_OP_ADD:
+			return mgCreateValueFloat(a + b);
+		case MG_BIN_OP_SUB:
+			return mgCreateValueFloat(a - b);
+		case MG_BIN_OP_MUL:
+			return mgCreateValueFloat(a * b);
+		case MG_BIN_OP_DIV:
+			return mgCreateValueFloat(a / b);
+		case MG_BIN_OP_INT_DIV:
+			return mgCreateValueInteger((int) (a / b));
+		case MG_BIN_OP_MOD:
+			return mgCreateValueFloat(fmodf(a, b));
+		default:
+			break;
+		}
+	}
+
+	const MGtribool result = mgNumericCompare(lhs, rhs, operation);
 
-MGValue* mgCreateValueFloat(float f);
-#define mgFloatSet(value, _f) value->data.f = _f
-#define mgFloatGet(value) value->data.f
+	return (result != MG_INDETERMINATE) ? mgCreateValueBoolean(result) : NULL;
+}
 
 #define mgCreateValueString(s) mgCreateValueStringEx(s, MG_STRING_USAGE_COPY)
 MGValue* mgCreateValueStringEx(const char *s, MGStringUsage usage);
+#define mgCreateValueInternedString(s) mgCreateValueStringEx(mgReferenceInternedString(s), MG_STRING_USAGE_INTERNED)
 #define mgStringSet(value, s) mgStringSetEx(value, s, MG_STRING_USAGE_COPY)
 void mgStringSetEx(MGValue *value, const char *s, MGStringUsage usage);
+void mgStringRelease(MGValue *value);
 #define mgStringGet(value) ((const char*) (value)->data.str.s)
 #define mgStringLength(value) (value)->data.str.length
 
@@ -0,0 +1,285 @@
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "value.h"
+#include "primitive.h"
+#include "composite.h"
+#include "vector.h"
+#include "iterator.h"
+#include "simd.h"
+#include "error.h"
+#include "utilities.h"
+#include "debug.h"
+
+
+extern MGValue* mgAnyConvert(const MGValue *value, MGType type);
+extern MGtribool mgAnyEqual(const MGValue *lhs, const MGValue *rhs);
+
+
+static const char _MG_VECTOR_COMPONENT_NAMES[] = "xyzw";
+
+
+MGValue* mgCreateValueVector(size_t length, const float *components)
+{
+	MG_ASSERT((length >= 2) && (length <= 4));
+
+	MGValue *vector = mgCreateValue((MGType) (MG_TYPE_VEC2 + (length - 2)));
+
+	memset(vector->data.vec, 0, sizeof(vector->data.vec));
+
+	if (components)
+		memcpy(vector->data.vec, components, length * sizeof(float));
+
+	return vector;
+}
+
+
+MGbool mgVectorLoad(const MGValue *value, size_t length, float *components)
+{
+	MG_ASSERT(length <= 4);
+
+	if (mgIsNumericValue(value))
+	{
+		const float f = _mgNumericGet(value);
+
+		for (size_t i = 0; i < length; ++i)
+			components[i] = f;
+
+		return MG_TRUE;
+	}
+	else if (mgIsVectorValue(value))
+	{
+		if (mgVectorLength(value) != length)
+			return MG_FALSE;
+
+		memcpy(components, value->data.vec, length * sizeof(float));
+
+		return MG_TRUE;
+	}
+	else if ((mgValueType(value) == MG_TYPE_TUPLE) || (mgValueType(value) == MG_TYPE_LIST))
+	{
+		if (mgListLength(value) != length)
+			return MG_FALSE;
+
+		for (size_t i = 0; i < length; ++i)
+		{
+			const MGValue *item = _mgListGet(value->data.a, i);
+
+			if (!mgIsNumericValue(item))
+				return MG_FALSE;
+
+			components[i] = _mgNumericGet(item);
+		}
+
+		return MG_TRUE;
+	}
+
+	return MG_FALSE;
+}
+
+
+MGValue* mgVectorConvert(const MGValue *value, MGType type)
+{
+	if ((type == MG_TYPE_TUPLE) || (type == MG_TYPE_LIST))
+	{
+		const size_t length = mgVectorLength(value);
+
+		MGValue *list = (type == MG_TYPE_TUPLE) ? mgCreateValueTuple(length) : mgCreateValueList(length);
+
+		for (size_t i = 0; i < length; ++i)
+			mgListAdd(list, mgCreateValueFloat(value->data.vec[i]));
+
+		return list;
+	}
+
+	return mgAnyConvert(value, type);
+}
+
+
+char* mgVectorToString(const MGValue *vector)
+{
+	const char *name = mgGetTypeName(mgValueType(vector));
+	const size_t length = mgVectorLength(vector);
+
+	// Formatted like print formats floats
+	const float *v = vector->data.vec;
+	const char *format = (length == 2) ? "%s(%G, %G)" : ((length == 3) ? "%s(%G, %G, %G)" : "%s(%G, %G, %G, %G)");
+
+	const size_t len = (size_t) snprintf(NULL, 0, format, name, v[0], v[1], v[2], v[3]);
+
+	char *s = (char*) malloc((len + 1) * sizeof(char));
+	MG_ASSERT(s);
+
+	snprintf(s, len + 1, format, name, v[0], v[1], v[2], v[3]);
+	s[len] = '\0';
+
+	return s;
+}
+
+
+MGValue* mgVectorPositive(const MGValue *operand)
+{
+	return mgReferenceValue(operand);
+}
+
+
+MGValue* mgVectorNegative(const MGValue *operand)
+{
+	float r[4];
+	mgFloat4Store(r, mgFloat4Negate(mgFloat4Load(operand->data.vec)));
+
+	return mgCreateValueVector(mgVectorLength(operand), r);
+}
+
+
+// Either operand is a vector, while the other is a vector of the same
+// length, a tuple or list of as many numbers, or a number which is used
+// for every component
+static inline MGValue* _mgVectorBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
+{
+	const size_t length = mgIsVectorValue(lhs) ? mgVectorLength(lhs) : mgVectorLength(rhs);
+
+	// Unused lanes divide by one instead of zero
+	float a[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, b[4] = { 1.0f, 1.0f, 1.0f, 1.0f }, r[4];
+
+	if (!mgVectorLoad(lhs, length, a) || !mgVectorLoad(rhs, length, b))
+		return NULL;
+
+	const MGFloat4 va = mgFloat4Load(a), vb = mgFloat4Load(b);
+
+	switch (operation)
+	{
+	case MG_BIN_OP_ADD:
+		mgFloat4Store(r, mgFloat4Add(va, vb));
+		break;
+	case MG_BIN_OP_SUB:
+		mgFloat4Store(r, mgFloat4Sub(va, vb));
+		break;
+	case MG_BIN_OP_MUL:
+		mgFloat4Store(r, mgFloat4Mul(va, vb));
+		break;
+	case MG_BIN_OP_DIV:
+		mgFloat4Store(r, mgFloat4Div(va, vb));
+		break;
+	case MG_BIN_OP_MOD:
+		for (size_t i = 0; i < length; ++i)
+			r[i] = fmodf(a[i], b[i]);
+		break;
+	default:
+		return NULL;
+	}
+
+	return mgCreateValueVector(length, r);
+}
+
+
+MGValue* mgVectorAdd(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgVectorBinaryOp(lhs, rhs, MG_BIN_OP_ADD);
+}
+
+
+MGValue* mgVectorSub(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgVectorBinaryOp(lhs, rhs, MG_BIN_OP_SUB);
+}
+
+
+MGValue* mgVectorMul(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgVectorBinaryOp(lhs, rhs, MG_BIN_OP_MUL);
+}
+
+
+MGValue* mgVectorDiv(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgVectorBinaryOp(lhs, rhs, MG_BIN_OP_DIV);
+}
+
+
+MGValue* mgVectorMod(const MGValue *lhs, const MGValue *rhs)
+{
+	return _mgVectorBinaryOp(lhs, rhs, MG_BIN_OP_MOD);
+}
+
+
+// Compares the components like floats, against a vector,
+// tuple or list, while numbers aren't used for every component
+MGtribool mgVectorEqual(const MGValue *lhs, const MGValue *rhs)
+{
+	if (mgIsNumericValue(lhs) || mgIsNumericValue(rhs))
+		return mgAnyEqual(lhs, rhs);
+	else if (mgIsVectorValue(lhs) && mgIsVectorValue(rhs) && (mgVectorLength(lhs) != mgVectorLength(rhs)))
+		return MG_FALSE;
+
+	const size_t length = mgIsVectorValue(lhs) ? mgVectorLength(lhs) : mgVectorLength(rhs);
+
+	float a[4] = { 0.0f }, b[4] = { 0.0f };
+
+	if (!mgVectorLoad(lhs, length, a) || !mgVectorLoad(rhs, length, b))
+		return mgAnyEqual(lhs, rhs);
+
+	const int mask = (1 << length) - 1;
+
+	return (mgFloat4Approximately(mgFloat4Load(a), mgFloat4Load(b), MG_EPSILON) & mask) == mask;
+}
+
+
+MGValue* mgVectorSubscriptGet(const MGValue *vector, const MGValue *index)
+{
+	if (mgValueType(index) != MG_TYPE_INTEGER)
+		return NULL;
+
+	const size_t length = mgVectorLength(vector);
+	const int i = mgIntegerGet(index);
+
+	if ((i >= (int) length) || (i < -(int) length))
+	{
+		if (i >= 0)
+			mgFatalError("Error: %s index out of range (0 <= %d < %zu)",
+			             mgGetTypeName(mgValueType(vector)), i, length);
+		else
+			mgFatalError("Error: %s index out of range (-%zu <= %d < 0)",
+			             mgGetTypeName(mgValueType(vector)), length, i);
+	}
+
+	return mgCreateValueFloat(vector->data.vec[(i < 0) ? ((int) length + i) : i]);
+}
+
+
+// vec.x, vec.y, vec.z and vec.w
+MGValue* mgVectorAttributeGet(const MGValue *vector, const char *key)
+{
+	if (!key[0] || key[1])
+		return NULL;
+
+	const char *name = strchr(_MG_VECTOR_COMPONENT_NAMES, key[0]);
+
+	if (!name || ((size_t) (name - _MG_VECTOR_COMPONENT_NAMES) >= mgVectorLength(vector)))
+		return NULL;
+
+	return mgCreateValueFloat(vector->data.vec[name - _MG_VECTOR_COMPONENT_NAMES]);
+}
+
+
+static MGValue* _mgVectorIteratorNext(MGValue *iterator)
+{
+	const MGValue *vector = _mgListGet(iterator->data.iter->values, 0);
+
+	if ((size_t) iterator->data.iter->index >= mgVectorLength(vector))
+		return NULL;
+
+	return mgCreateValueFloat(vector->data.vec[iterator->data.iter->index++]);
+}
+
+
+MGValue* mgVectorIterate(const MGValue *vector)
+{
+	MGValue *iterator = mgCreateValueIterator(NULL, _mgVectorIteratorNext, 1);
+	_mgListAdd(MGValue*, iterator->data.iter->values, mgReferenceValue(vector));
+
+	return iterator;
+}
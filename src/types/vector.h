@@ -0,0 +1,23 @@
+#ifndef MODELGEN_VECTOR_TYPES_H
+#define MODELGEN_VECTOR_TYPES_H
+
+#include "value.h"
+
+// vec2, vec3 and vec4 store their components inline as floats, which
+// takes a single allocation compared to a tuple of the same values.
+// Like tuples they are immutable.
+
+#define mgIsVectorValue(value) mgIsVectorType(mgValueType(value))
+
+#define mgVectorLength(vector) mgVectorTypeLength(mgValueType(vector))
+#define mgVectorGet(vector, index) ((vector)->data.vec[index])
+
+// Components beyond length are zero, while components may be NULL
+MGValue* mgCreateValueVector(size_t length, const float *components);
+
+// Loads the components of a vector of the same length, a tuple or list
+// of as many numbers, or a number repeated length times, and returns
+// whether value was any of those
+MGbool mgVectorLoad(const MGValue *value, size_t length, float *components);
+
+#endif
\ No newline at end of file
@@ -28,6 +28,50 @@ inline uint32_t mgNextPowerOfTwo(uint32_t x)
 }
 
 
+uint64_t mgRandomNext(uint64_t *state)
+{
+	MG_ASSERT(state);
+
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+
+// FNV-1a
+uint32_t mgStringHash(const char *str)
+{
+	MG_ASSERT(str);
+
+	uint32_t hash = 2166136261u;
+
+	for (; *str; ++str)
+	{
+		hash ^= (uint8_t) *str;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
+uint32_t mgStringHashEx(const char *str, size_t length)
+{
+	MG_ASSERT(str);
+
+	uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= (uint8_t) str[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
 int mgStringEndsWith(const char *string, const char *suffix)
 {
 	size_t stringLength = strlen(string);
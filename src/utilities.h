@@ -15,6 +15,12 @@
 
 uint32_t mgNextPowerOfTwo(uint32_t x);
 
+// SplitMix64, advancing state and returning the next number of the sequence
+uint64_t mgRandomNext(uint64_t *state);
+
+uint32_t mgStringHash(const char *str);
+uint32_t mgStringHashEx(const char *str, size_t length);
+
 int mgStringEndsWith(const char *string, const char *suffix);
 
 char* mgStringReplaceCharacter(char *str, char find, char replace);
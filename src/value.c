@@ -2,6 +2,8 @@
 #include "value.h"
 #include "types/primitive.h"
 #include "error.h"
+#include "allocator.h"
+#include "parallel.h"
 
 
 const char* const _MG_UNARY_OP_NAMES[] = {
@@ -18,18 +20,18 @@ const char* const _MG_BIN_OP_NAMES[] = {
 };
 
 
-MGValue *_mgNullValue = NULL;
-
-
 MGValue* mgCreateValue(MGType type)
 {
-	MGValue *value = (MGValue*) malloc(sizeof(MGValue));
+	MG_ASSERT((type != MG_TYPE_NULL) && (type != MG_TYPE_INTEGER) && (type != MG_TYPE_FLOAT));
+
+	MGValue *value = (MGValue*) mgAllocate(sizeof(MGValue));
 	MG_ASSERT(value);
 
 	value->type = type;
+	value->epoch = _mgValueEpoch;
 	value->refCount = 1;
 
-	const MGTypeData *_type = mgGetType(value->type);
+	const MGTypeData *_type = mgGetType(mgValueType(value));
 	if (_type && _type->create)
 		_type->create(value);
 
@@ -41,29 +43,36 @@ void mgDestroyValue(MGValue *value)
 {
 	MG_ASSERT(value);
 
-	if (--value->refCount > 0)
+	if (mgIsImmediateValue(value))
 		return;
 
-	const MGTypeData *type = mgGetType(value->type);
+	if ((mgIsParallel() ? mgAtomicDecrement(&value->refCount) : --value->refCount) > 0)
+		return;
+
+	const MGTypeData *type = mgGetType(mgValueType(value));
 	if (type && type->destroy)
 		type->destroy(value);
 
-	free(value);
+	mgFree(value);
 }
 
 
 MGValue* mgCopyValue(const MGValue *value, MGbool shallow)
 {
 	MG_ASSERT(value);
-	MG_ASSERT(value->type != MG_TYPE_MODULE);
+	MG_ASSERT(mgValueType(value) != MG_TYPE_MODULE);
+
+	if (mgIsImmediateValue(value))
+		return (MGValue*) value;
 
-	MGValue *copy = (MGValue*) malloc(sizeof(MGValue));
+	MGValue *copy = (MGValue*) mgAllocate(sizeof(MGValue));
 	MG_ASSERT(copy);
 
 	*copy = *value;
+	copy->epoch = _mgValueEpoch;
 	copy->refCount = 1;
 
-	const MGTypeData *type = mgGetType(value->type);
+	const MGTypeData *type = mgGetType(mgValueType(value));
 	if (type && type->copy)
 		type->copy(copy, value, shallow);
 
@@ -76,7 +85,14 @@ MGValue* mgReferenceValue(const MGValue *value)
 	MG_ASSERT(value);
 
 	MGValue *referenced = (MGValue*) value;
-	++referenced->refCount;
+
+	if (mgIsImmediateValue(referenced))
+		return referenced;
+
+	if (mgIsParallel())
+		mgAtomicIncrement(&referenced->refCount);
+	else
+		++referenced->refCount;
 
 	return referenced;
 }
@@ -84,18 +100,18 @@ MGValue* mgReferenceValue(const MGValue *value)
 
 MGValue* mgValueConvert(const MGValue *value, MGType type)
 {
-	if (value->type == type)
+	if (mgValueType(value) == type)
 		return mgReferenceValue(value);
 
 	MGValue *result = NULL;
 
-	const MGTypeData *_type = mgGetType(value->type);
+	const MGTypeData *_type = mgGetType(mgValueType(value));
 	if (_type && _type->convert)
 		result = _type->convert(value, type);
 
 	if (result == NULL)
 		mgFatalError("Error: Unsupported conversion from %s to %s",
-		             mgGetTypeName(value->type), mgGetTypeName(type));
+		             mgGetTypeName(mgValueType(value)), mgGetTypeName(type));
 
 	return result;
 }
@@ -105,7 +121,7 @@ MGbool mgValueTruthValue(const MGValue *value)
 {
 	MG_ASSERT(value);
 
-	const MGTypeData *type = mgGetType(value->type);
+	const MGTypeData *type = mgGetType(mgValueType(value));
 	if (type && type->truth)
 		return type->truth(value);
 
@@ -117,7 +133,7 @@ char* mgValueToString(const MGValue *value)
 {
 	MG_ASSERT(value);
 
-	const MGTypeData *type = mgGetType(value->type);
+	const MGTypeData *type = mgGetType(mgValueType(value));
 	if (type && type->str)
 		return type->str(value);
 
@@ -129,7 +145,7 @@ MGValue* mgValueUnaryOp(const MGValue *value, MGUnaryOpType operation)
 {
 	MG_ASSERT(value);
 
-	const MGTypeData *type = mgGetType(value->type);
+	const MGTypeData *type = mgGetType(mgValueType(value));
 	MGTypeUnaryOp unary = NULL;
 
 	switch (operation)
@@ -150,7 +166,7 @@ MGValue* mgValueUnaryOp(const MGValue *value, MGUnaryOpType operation)
 	MGValue *result = NULL;
 
 	if (!unary || !(result = unary(value)))
-		mgFatalError("Error: Unsupported unary operator %s for type %s", _MG_UNARY_OP_NAMES[operation], mgGetTypeName(value->type));
+		mgFatalError("Error: Unsupported unary operator %s for type %s", _MG_UNARY_OP_NAMES[operation], mgGetTypeName(mgValueType(value)));
 
 	return result;
 }
@@ -188,8 +204,8 @@ static inline MGtribool _mgValueCompareUnknownOr(const MGValue *lhs, const MGVal
 
 static inline MGtribool _mgValueCompareUnknown(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
 {
-	const MGTypeData *lhsType = mgGetType(lhs->type);
-	const MGTypeData *rhsType = mgGetType(rhs->type);
+	const MGTypeData *lhsType = mgGetType(mgValueType(lhs));
+	const MGTypeData *rhsType = mgGetType(mgValueType(rhs));
 
 	switch (operation)
 	{
@@ -222,8 +238,8 @@ static inline MGtribool _mgValueCompareUnknown(const MGValue *lhs, const MGValue
 
 static inline MGtribool _mgValueCompare(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
 {
-	const MGTypeData *lhsType = mgGetType(lhs->type);
-	const MGTypeData *rhsType = mgGetType(rhs->type);
+	const MGTypeData *lhsType = mgGetType(mgValueType(lhs));
+	const MGTypeData *rhsType = mgGetType(mgValueType(rhs));
 
 	MGtribool result = MG_INDETERMINATE;
 
@@ -281,7 +297,9 @@ static inline MGtribool _mgValueCompare(const MGValue *lhs, const MGValue *rhs,
 
 MGbool mgValueCompare(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
 {
-	MGtribool result = _mgValueCompare(lhs, rhs, operation);
+	MGtribool result = mgNumericCompare(lhs, rhs, operation);
+	if (result == MG_INDETERMINATE)
+		result = _mgValueCompare(lhs, rhs, operation);
 
 	return (result != MG_INDETERMINATE) ? result : MG_FALSE;
 }
@@ -311,8 +329,8 @@ static inline MGTypeBinOp _mgTypeGetBinaryOpArithmetic(const MGTypeData *type, c
 
 static inline MGValue* _mgValueBinaryOpArithmetic(const MGValue *lhs, const MGValue *rhs, MGBinOpType operation)
 {
-	const MGTypeData *lhsType = mgGetType(lhs->type);
-	const MGTypeData *rhsType = mgGetType(rhs->type);
+	const MGTypeData *lhsType = mgGetType(mgValueType(lhs));
+	const MGTypeData *rhsType = mgGetType(mgValueType(rhs));
 
 	MGValue *result = NULL;
 
@@ -336,7 +354,10 @@ MGValue* mgValueBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType ope
 	MG_ASSERT(lhs);
 	MG_ASSERT(rhs);
 
-	MGValue *result = NULL;
+	MGValue *result = mgNumericBinaryOp(lhs, rhs, operation);
+	if (result)
+		return result;
+
 	MGbool _result;
 
 	switch (operation)
@@ -365,7 +386,7 @@ MGValue* mgValueBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType ope
 
 	if (result == NULL)
 		mgFatalError("Error: Unsupported binary operator %s for left-hand type %s and right-hand type %s",
-		             _MG_BIN_OP_NAMES[operation], mgGetTypeName(lhs->type), mgGetTypeName(rhs->type));
+		             _MG_BIN_OP_NAMES[operation], mgGetTypeName(mgValueType(lhs)), mgGetTypeName(mgValueType(rhs)));
 
 	return result;
 }
@@ -376,7 +397,7 @@ MGValue* mgValueSubscriptGet(const MGValue *collection, const MGValue *index)
 	MG_ASSERT(collection);
 	MG_ASSERT(index);
 
-	const MGTypeData *type = mgGetType(collection->type);
+	const MGTypeData *type = mgGetType(mgValueType(collection));
 	if (type && type->subGet)
 		return type->subGet(collection, index);
 
@@ -389,7 +410,7 @@ MGbool mgValueSubscriptSet(const MGValue *collection, const MGValue *index, MGVa
 	MG_ASSERT(collection);
 	MG_ASSERT(index);
 
-	const MGTypeData *type = mgGetType(collection->type);
+	const MGTypeData *type = mgGetType(mgValueType(collection));
 	if (type && type->subSet)
 		return type->subSet(collection, index, value);
 
@@ -402,7 +423,7 @@ MGValue* mgValueAttributeGet(const MGValue *collection, const char *key)
 	MG_ASSERT(collection);
 	MG_ASSERT(key);
 
-	const MGTypeData *type = mgGetType(collection->type);
+	const MGTypeData *type = mgGetType(mgValueType(collection));
 	if (type && type->attrGet)
 		return type->attrGet(collection, key);
 
@@ -415,7 +436,7 @@ MGbool mgValueAttributeSet(const MGValue *collection, const char *key, MGValue *
 	MG_ASSERT(collection);
 	MG_ASSERT(key);
 
-	const MGTypeData *type = mgGetType(collection->type);
+	const MGTypeData *type = mgGetType(mgValueType(collection));
 	if (type && type->attrSet)
 		return type->attrSet(collection, key, value);
 
@@ -1,6 +1,8 @@
 #ifndef MODELGEN_VALUE_H
 #define MODELGEN_VALUE_H
 
+#include <stdint.h>
+
 #include "parse.h"
 #include "types.h"
 
@@ -49,20 +51,67 @@ typedef enum MGBinOpType {
 typedef enum MGStringUsage {
 	MG_STRING_USAGE_COPY,
 	MG_STRING_USAGE_KEEP,
-	MG_STRING_USAGE_STATIC
+	MG_STRING_USAGE_STATIC,
+	// Takes over a reference to an interned string
+	MG_STRING_USAGE_INTERNED
 } MGStringUsage;
 
-typedef _MGList(MGValue*) MGValueList;
+typedef enum MGBufferFormat {
+	MG_BUFFER_FORMAT_FLOAT,
+	MG_BUFFER_FORMAT_INT
+} MGBufferFormat;
 
-typedef _MGPair(char*, MGValue*) MGValueMapPair;
-typedef _MGList(MGValueMapPair) MGValueMap;
+typedef _MGList(MGValue*) MGValueList;
 
+// Returns a new reference to the next item, or NULL once exhausted
+typedef MGValue* (*MGIteratorNext)(MGValue *iterator);
+
+typedef struct MGValueMapPair {
+	// Interned
+	const char *key;
+	MGValue *value;
+	uint32_t hash;
+} MGValueMapPair;
+
+typedef struct MGValueMap {
+	// Pairs in insertion order
+	_MGList(MGValueMapPair) pairs;
+	// Open addressing table of pair indices plus one (zero
+	// being empty), allocated once a map outgrows a linear scan
+	uint32_t *indices;
+	size_t capacity;
+} MGValueMap;
+
+typedef struct MGIteratorState {
+	MGIteratorNext next;
+	MGInstance *instance;
+	// The call which created the iterator, which is
+	// kept on the call stack while getting items
+	MGValue *module;
+	const MGNode *caller;
+	const char *callerName;
+	// The iterated collections and iterators, or
+	// the start and step of a range
+	MGValueList values;
+	// Called by map and filter
+	MGValue *callable;
+	// The items of the next tuple of consecutive
+	MGValue *window;
+	intmax_t index;
+	intmax_t count;
+} MGIteratorState;
+
+// Null, integer and float values are not allocated, but stored
+// inline in the MGValue pointer itself, tagged in the lowest bits
+// which are always zero for allocated values. These values must
+// only be accessed through mgValueType(), mgIntegerGet() and
+// mgFloatGet(), while referencing and destroying them is a no-op.
 typedef struct MGValue {
 	MGType type;
+	// Epoch of the thread which created the value, see parallel.h
+	uint32_t epoch;
 	size_t refCount;
 	union {
-		int i;
-		float f;
 		struct {
 			char *s;
 			size_t length;
@@ -87,13 +136,67 @@ typedef struct MGValue {
 			MGValue *globals;
 			MGbool isStatic;
 		} module;
+		// Allocated separately, as it is larger than the other types
+		MGIteratorState *iter;
+		struct {
+			// The callable followed by its arguments
+			MGValueList values;
+			// The call to spawn, used as the first frame of the task
+			MGValue *module;
+			const MGNode *caller;
+			const char *callerName;
+			uint64_t seed;
+			// The transform current when spawned, see MGInstance
+			MGValue *transform;
+			// Set once the task has run
+			MGValue *result;
+		} future;
+		// The components of vec2, vec3 and vec4, with unused ones being zero
+		float vec[4];
+		// The columns of mat4, one after another
+		float mat[16];
+		// Elements of components numbers each, stored contiguously as
+		// float or int32_t depending on format
+		struct {
+			void *items;
+			size_t length;
+			size_t capacity;
+			size_t components;
+			MGBufferFormat format;
+		} buffer;
 	} data;
 } MGValue;
 
 
-extern MGValue *_mgNullValue;
-#define _MG_NULL_VALUE _mgNullValue
-#define MG_NULL_VALUE mgReferenceValue(_MG_NULL_VALUE)
+#if UINTPTR_MAX < UINT64_MAX
+#   error Immediate values require 64-bit pointers
+#endif
+
+#define _MG_VALUE_TAG_MASK ((uintptr_t) 0x7)
+#define _MG_VALUE_TAG_NULL ((uintptr_t) 0x1)
+#define _MG_VALUE_TAG_INTEGER ((uintptr_t) 0x3)
+#define _MG_VALUE_TAG_FLOAT ((uintptr_t) 0x5)
+
+#define _mgValueTag(value) (((uintptr_t) (value)) & _MG_VALUE_TAG_MASK)
+#define mgIsImmediateValue(value) (_mgValueTag(value) != 0)
+
+static inline MGType mgValueType(const MGValue *value)
+{
+	switch (_mgValueTag(value))
+	{
+	case 0:
+		return value->type;
+	case _MG_VALUE_TAG_INTEGER:
+		return MG_TYPE_INTEGER;
+	case _MG_VALUE_TAG_FLOAT:
+		return MG_TYPE_FLOAT;
+	default:
+		return MG_TYPE_NULL;
+	}
+}
+
+#define _MG_NULL_VALUE ((MGValue*) _MG_VALUE_TAG_NULL)
+#define MG_NULL_VALUE _MG_NULL_VALUE
 
 MGValue* mgCreateValue(MGType type);
 void mgDestroyValue(MGValue *value);
@@ -134,6 +237,10 @@ MGValue* mgValueBinaryOp(const MGValue *lhs, const MGValue *rhs, MGBinOpType ope
 MGValue* mgValueSubscriptGet(const MGValue *collection, const MGValue *index);
 MGbool mgValueSubscriptSet(const MGValue *collection, const MGValue *index, MGValue *value);
 
+// Values which can be subscripted, but whose items cannot be assigned, e.g. vec4 and mat4
+#define mgIsImmutableValue(collection) \
+	(mgGetType(mgValueType(collection))->subGet && !mgGetType(mgValueType(collection))->subSet)
+
 MGValue* mgValueAttributeGet(const MGValue *collection, const char *key);
 MGbool mgValueAttributeSet(const MGValue *collection, const char *key, MGValue *value);
 
@@ -0,0 +1,882 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vm.h"
+#include "types/primitive.h"
+#include "types/composite.h"
+#include "types/module.h"
+#include "types/vector.h"
+#include "callable.h"
+#include "range.h"
+#include "iterator.h"
+#include "parallel.h"
+#include "error.h"
+
+
+extern MGNode* mgReferenceNode(const MGNode *node);
+
+extern void _mgSetLocalValueEx(MGInstance *instance, MGValue *module, const MGNode *node, const char *name, MGValue *value);
+extern void _mgSetValueEx(MGInstance *instance, MGValue *module, const MGNode *node, const char *name, MGValue *value);
+
+extern void _mgPushFatalStackFrameEx(MGInstance *instance, const MGValue *module, const MGNode *node);
+
+
+#if defined(__GNUC__) && !defined(MG_NO_COMPUTED_GOTO)
+#   define MG_COMPUTED_GOTO 1
+#endif
+
+
+#define _MG_NODE _mgListGet(code->nodes, instruction - _mgListItems(code->instructions))
+
+#define MG_FAIL(...) \
+	do { \
+		_mgPushFatalStackFrameEx(instance, module, _MG_NODE); \
+		mgFatalError(__VA_ARGS__); \
+	} while (0)
+
+
+#define _MG_SET(index, value) \
+	do { \
+		MGValue *_value = (value); \
+		if (registers[index]) \
+			mgDestroyValue(registers[index]); \
+		registers[index] = _value; \
+	} while (0)
+
+#define _MG_RANGE_BOUNDS(range, bounds, count) \
+	do { \
+		MGValue *const *_bounds = (bounds); \
+		for (uint16_t _i = 0; _i < (count); ++_i) \
+			if (mgValueType(_bounds[_i]) != MG_TYPE_INTEGER) \
+				MG_FAIL("Error: Expected range of \"%s\", received \"%s\"", \
+				        mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(mgValueType(_bounds[_i]))); \
+		mgCreateRangeInteger(range, mgIntegerGet(_bounds[0]), mgIntegerGet(_bounds[1]), ((count) == 3) ? mgIntegerGet(_bounds[2]) : 0); \
+	} while (0)
+
+// Lists and tuples are indexed directly, while other
+// iterables are replaced by an iterator over them
+#define _MG_PREPARE_ITERABLE(index) \
+	do { \
+		const MGValue *_iterable = registers[index]; \
+		if ((mgValueType(_iterable) != MG_TYPE_TUPLE) && (mgValueType(_iterable) != MG_TYPE_LIST)) \
+		{ \
+			MGValue *_iterator = mgCreateIterator(_iterable); \
+			if (!_iterator) \
+				MG_FAIL("Error: %s is not iterable", mgGetTypeName(mgValueType(_iterable))); \
+			_MG_SET(index, _iterator); \
+		} \
+		_MG_SET((index) + 1, mgCreateValueInteger(0)); \
+	} while (0)
+
+// Ranges keep their start in place of the iterable, followed by the index, step and length
+#define _MG_PREPARE_RANGE(index, range) \
+	do { \
+		_MG_SET(index, (range)->start); \
+		_MG_SET((index) + 1, mgCreateValueInteger(0)); \
+		_MG_SET((index) + 2, (range)->step); \
+		_MG_SET((index) + 3, mgCreateValueInteger((range)->length)); \
+	} while (0)
+
+
+static inline const MGValue* _mgLookupName(const MGInstance *instance, MGValue *module, const MGStackFrame *frame, const char *name)
+{
+	const MGValue *value = frame->locals ? mgMapGetInterned(frame->locals, name) : NULL;
+
+	if (!value && frame->captured)
+		value = mgMapGetInterned(frame->captured, name);
+
+	if (!value)
+		value = mgModuleGetInterned(module, name);
+
+	if (!value)
+		value = mgModuleGetInterned(instance->base, name);
+
+	return value;
+}
+
+
+// Module attributes are cached by the position of their
+// pair, which is checked as globals can change at any time.
+// Caches are shared by the threads of a parallel map, which
+// therefore only read them.
+static inline MGValue* _mgAttributeGetCached(MGInlineCache *cache, const MGValue *collection, const char *name)
+{
+	if (mgValueType(collection) != MG_TYPE_MODULE)
+		return mgValueAttributeGet(collection, name);
+
+	const MGValueMap *globals = &collection->data.module.globals->data.m;
+
+	if ((cache->key == collection) && (cache->index < _mgMapSize(*globals)))
+	{
+		const MGValueMapPair *pair = &_mgListGet(globals->pairs, cache->index);
+
+		if (pair->key == name)
+			return mgReferenceValue(pair->value);
+	}
+
+	const MGValueMapPair *pair = _mgMapGetPairInterned(globals, name);
+
+	if (!pair)
+		return NULL;
+
+	if (!mgIsParallel())
+	{
+		cache->key = collection;
+		cache->index = (size_t) (pair - _mgListItems(globals->pairs));
+	}
+
+	return mgReferenceValue(pair->value);
+}
+
+
+#define _mgCalleeName(node) \
+	((_mgListGet((node)->children, 0)->type == MG_NODE_NAME) ? _mgListGet((node)->children, 0)->token->value.s : "<anonymous>")
+
+
+static inline MGValue* _mgCallValue(MGInstance *instance, MGValue *module, const MGNode *node, const MGValue *func, size_t argc, const MGValue* const* argv)
+{
+	const char *name = _mgCalleeName(node);
+
+	if (mgIsCFunction(func))
+		return mgCallCFunction(instance, module, node, name, func, argc, argv);
+
+	MGStackFrame frame;
+
+	mgCreateStackFrame(&frame, mgReferenceValue(module));
+	mgSetCallLocals(instance, &frame, func);
+
+	frame.caller = node;
+	frame.callerName = name;
+
+	mgPushStackFrame(instance, &frame);
+
+	MGValue *value = mgCallEx(instance, &frame, func, argc, argv);
+
+	mgPopStackFrame(instance, &frame);
+	mgDestroyStackFrame(&frame);
+
+	MG_ASSERT(value);
+
+	return value;
+}
+
+
+// Calls a function whose result is iterated, returning an iterator instead
+// if it has a lazy counterpart, while other functions receive lists
+static inline MGValue* _mgCallIterable(MGInstance *instance, MGValue *module, const MGNode *node, const MGValue *func, size_t argc, MGValue **argv)
+{
+	MGIteratorCFunction iterate = mgGetIteratorFunction(func);
+
+	if (iterate)
+		return mgCallIterator(instance, module, node, _mgCalleeName(node), iterate, argc, (const MGValue* const*) argv);
+
+	mgMaterializeIterators(argc, argv);
+
+	return _mgCallValue(instance, module, node, func, argc, (const MGValue* const*) argv);
+}
+
+
+static inline MGValue* _mgCreateFunction(MGInstance *instance, MGValue *module, const MGNode *node, MGbool isNested)
+{
+	MGValue *func = mgCreateValue((node->type == MG_NODE_FUNCTION) ? MG_TYPE_FUNCTION : MG_TYPE_PROCEDURE);
+
+	func->data.func.module = mgReferenceValue(module);
+	func->data.func.node = mgReferenceNode(node);
+	func->data.func.locals = NULL;
+
+	if (isNested && instance->callStackTop && instance->callStackTop->last)
+		func->data.func.locals = mgReferenceValue(mgStackFrameCaptureLocals(instance->callStackTop));
+
+	return func;
+}
+
+
+MGValue* mgExecute(MGInstance *instance, MGValue *module, const MGCode *code, size_t argc, const MGValue* const* argv)
+{
+	MG_ASSERT(instance);
+	MG_ASSERT(instance->callStackTop);
+	MG_ASSERT(module);
+	MG_ASSERT(mgValueType(module) == MG_TYPE_MODULE);
+	MG_ASSERT(code);
+	MG_ASSERT((argc == 0) || (argv != NULL));
+
+	MGStackFrame *frame = instance->callStackTop;
+
+	const MGInstruction *instructions = _mgListItems(code->instructions);
+	const MGInstruction *instruction = instructions;
+
+	MGValue *const *constants = _mgListItems(code->constants);
+	const char *const *names = _mgListItems(code->names);
+	const char *const *locals = _mgListItems(code->locals);
+
+	const size_t valueCount = code->registerCount + _mgListLength(code->locals);
+
+	// Local variable slots are stored after the registers
+	MGValue **registers = mgValueStackPush(&instance->valueStack, valueCount);
+
+	MGValue **slots = registers + code->registerCount;
+
+	MGValue **lastSlots = frame->slots;
+	const MGCode *lastCode = frame->code;
+
+	if (_mgListLength(code->locals))
+	{
+		frame->slots = slots;
+		frame->code = code;
+	}
+
+	MGValue *result = NULL;
+
+#if MG_COMPUTED_GOTO
+	static const void *const labels[] = {
+#define _MG_OPC(opcode, name) &&_MG_OPCODE_LABEL_##opcode,
+		_MG_OPCODES
+#undef _MG_OPC
+	};
+
+#   define _MG_CASE(opcode) _MG_OPCODE_LABEL_##opcode:
+#   define _MG_DISPATCH() goto *labels[(instruction = ip++)->opcode]
+#   define _MG_NEXT() _MG_DISPATCH()
+#else
+#   define _MG_CASE(opcode) case MG_OPCODE_##opcode:
+#   define _MG_NEXT() break
+#endif
+
+#define _MG_JUMP(target) (ip = instructions + (target))
+
+	const MGInstruction *ip = instructions;
+
+#if MG_COMPUTED_GOTO
+	_MG_DISPATCH();
+#else
+	for (;;)
+	{
+		instruction = ip++;
+
+		switch ((MGOpcode) instruction->opcode)
+		{
+#endif
+
+	_MG_CASE(NOP)
+		_MG_NEXT();
+
+	_MG_CASE(LOAD_NULL)
+		_MG_SET(instruction->a, MG_NULL_VALUE);
+		_MG_NEXT();
+
+	_MG_CASE(LOAD_CONST)
+		_MG_SET(instruction->a, mgReferenceValue(constants[instruction->b]));
+		_MG_NEXT();
+
+	_MG_CASE(COPY_CONST)
+		_MG_SET(instruction->a, mgListConstantCopy(constants[instruction->b]));
+		_MG_NEXT();
+
+	_MG_CASE(LOAD_NAME)
+	{
+		const MGValue *value = _mgLookupName(instance, module, frame, names[instruction->b]);
+
+		if (!value)
+			MG_FAIL("Error: Undefined name \"%s\"", names[instruction->b]);
+
+		_MG_SET(instruction->a, mgReferenceValue(value));
+		_MG_NEXT();
+	}
+
+	_MG_CASE(STORE_NAME)
+		_mgSetValueEx(instance, module, _MG_NODE, names[instruction->b], mgReferenceValue(registers[instruction->a]));
+		_MG_NEXT();
+
+	_MG_CASE(STORE_LOCAL)
+		_mgSetLocalValueEx(instance, module, _MG_NODE, names[instruction->b], mgReferenceValue(registers[instruction->a]));
+		_MG_NEXT();
+
+	_MG_CASE(DELETE_NAME)
+#if MG_DEBUG
+		if (!_mgLookupName(instance, module, frame, names[instruction->b]))
+			MG_FAIL("Error: Undefined name \"%s\"", names[instruction->b]);
+#endif
+		_mgSetValueEx(instance, module, _MG_NODE, names[instruction->b], NULL);
+		_MG_NEXT();
+
+	_MG_CASE(LOAD_SLOT)
+	{
+		const MGValue *value = slots[instruction->b];
+
+		// Unassigned locals fall back to globals
+		if (!value)
+			value = _mgLookupName(instance, module, frame, locals[instruction->b]);
+
+		if (!value)
+			MG_FAIL("Error: Undefined name \"%s\"", locals[instruction->b]);
+
+		_MG_SET(instruction->a, mgReferenceValue(value));
+		_MG_NEXT();
+	}
+
+	_MG_CASE(STORE_SLOT)
+		if (slots[instruction->b] || !mgModuleGetInterned(module, locals[instruction->b]))
+		{
+			if (slots[instruction->b])
+				mgDestroyValue(slots[instruction->b]);
+
+			slots[instruction->b] = mgReferenceValue(registers[instruction->a]);
+		}
+		else
+		{
+			if (instance->sharedGlobals)
+				MG_FAIL("Error: Cannot assign global \"%s\" in a parallel map or task", locals[instruction->b]);
+
+			mgModuleSetInterned(module, locals[instruction->b], mgReferenceValue(registers[instruction->a]));
+		}
+		_MG_NEXT();
+
+	_MG_CASE(STORE_SLOT_LOCAL)
+		if (slots[instruction->b])
+			mgDestroyValue(slots[instruction->b]);
+
+		slots[instruction->b] = mgReferenceValue(registers[instruction->a]);
+		_MG_NEXT();
+
+	_MG_CASE(DELETE_SLOT)
+		if (slots[instruction->b])
+		{
+			mgDestroyValue(slots[instruction->b]);
+			slots[instruction->b] = NULL;
+		}
+		else
+		{
+#if MG_DEBUG
+			if (!_mgLookupName(instance, module, frame, locals[instruction->b]))
+				MG_FAIL("Error: Undefined name \"%s\"", locals[instruction->b]);
+#endif
+			_mgSetValueEx(instance, module, _MG_NODE, locals[instruction->b], NULL);
+		}
+		_MG_NEXT();
+
+	_MG_CASE(MOVE)
+		_MG_SET(instruction->a, mgReferenceValue(registers[instruction->b]));
+		_MG_NEXT();
+
+	_MG_CASE(BUILD_TUPLE)
+	_MG_CASE(BUILD_LIST)
+	{
+		MGValue *value = mgCreateValueTuple(instruction->c);
+		value->type = (instruction->opcode == MG_OPCODE_BUILD_TUPLE) ? MG_TYPE_TUPLE : MG_TYPE_LIST;
+
+		for (uint16_t i = 0; i < instruction->c; ++i)
+			mgTupleAdd(value, mgReferenceValue(registers[instruction->b + i]));
+
+		_MG_SET(instruction->a, value);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(BUILD_MAP)
+	{
+		MGValue *map = mgCreateValueMap(instruction->c / 2);
+
+		for (uint16_t i = 0; i < instruction->c; i += 2)
+		{
+			const MGValue *key = registers[instruction->b + i];
+
+			if (mgValueType(key) != MG_TYPE_STRING)
+				MG_FAIL("Error: Expected \"%s\" key, received \"%s\"",
+				        mgGetTypeName(MG_TYPE_STRING), mgGetTypeName(mgValueType(key)));
+
+			if (key->data.str.usage == MG_STRING_USAGE_INTERNED)
+				mgMapSetInterned(map, key->data.str.s, mgReferenceValue(registers[instruction->b + i + 1]));
+			else
+				mgMapSet(map, key->data.str.s, mgReferenceValue(registers[instruction->b + i + 1]));
+		}
+
+		_MG_SET(instruction->a, map);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(BUILD_RANGE)
+	{
+		MGRange range;
+		_MG_RANGE_BOUNDS(&range, registers + instruction->b, instruction->c);
+
+		_MG_SET(instruction->a, mgRangeToList(&range));
+		_MG_NEXT();
+	}
+
+	_MG_CASE(POS)
+		_MG_SET(instruction->a, mgValueUnaryOp(registers[instruction->b], MG_UNARY_OP_POSITIVE));
+		_MG_NEXT();
+
+	_MG_CASE(NEG)
+		_MG_SET(instruction->a, mgValueUnaryOp(registers[instruction->b], MG_UNARY_OP_NEGATIVE));
+		_MG_NEXT();
+
+	_MG_CASE(NOT)
+		_MG_SET(instruction->a, mgValueUnaryOp(registers[instruction->b], MG_UNARY_OP_INVERSE));
+		_MG_NEXT();
+
+	_MG_CASE(BOOL)
+		_MG_SET(instruction->a, mgCreateValueBoolean(mgValueTruthValue(registers[instruction->b])));
+		_MG_NEXT();
+
+	_MG_CASE(ADD)
+	_MG_CASE(SUB)
+	_MG_CASE(MUL)
+	_MG_CASE(DIV)
+	_MG_CASE(INT_DIV)
+	_MG_CASE(MOD)
+	_MG_CASE(EQ)
+	_MG_CASE(NOT_EQ)
+	_MG_CASE(LESS)
+	_MG_CASE(LESS_EQ)
+	_MG_CASE(GREATER)
+	_MG_CASE(GREATER_EQ)
+	{
+		const MGValue *lhs = registers[instruction->b];
+		const MGValue *rhs = registers[instruction->c];
+		const MGBinOpType operation = (MGBinOpType) (instruction->opcode - MG_OPCODE_ADD);
+
+		// Numeric operands never reach the type table
+		MGValue *result = mgNumericBinaryOp(lhs, rhs, operation);
+		if (!result)
+			result = mgValueBinaryOp(lhs, rhs, operation);
+
+		_MG_SET(instruction->a, result);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(CONVERT)
+		_MG_SET(instruction->a, mgValueConvert(registers[instruction->b], (MGType) instruction->c));
+		_MG_NEXT();
+
+	_MG_CASE(GET_SUBSCRIPT)
+	{
+		const MGValue *collection = registers[instruction->b];
+		const MGValue *index = registers[instruction->c];
+
+		MGValue *value = mgValueSubscriptGet(collection, index);
+
+		if (!value)
+			MG_FAIL("Error: %s is not subscriptable with %s",
+			        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(index)));
+
+		_MG_SET(instruction->a, value);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(SET_SUBSCRIPT)
+	_MG_CASE(DELETE_SUBSCRIPT)
+	{
+		const MGValue *collection = registers[instruction->b];
+		const MGValue *index = registers[instruction->c];
+
+#if MG_DEBUG
+		if (instruction->opcode == MG_OPCODE_DELETE_SUBSCRIPT)
+		{
+			MGValue *value = mgValueSubscriptGet(collection, index);
+
+			if (!value)
+				MG_FAIL("Error: %s is not subscriptable with %s",
+				        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(index)));
+
+			mgDestroyValue(value);
+		}
+#endif
+
+		if (mgIsSharedValue(instance, collection))
+			MG_FAIL("Error: Cannot modify %s in a parallel map or task, as it was created outside of it", mgGetTypeName(mgValueType(collection)));
+
+		MGValue *value = (instruction->opcode == MG_OPCODE_SET_SUBSCRIPT) ? mgReferenceValue(registers[instruction->a]) : NULL;
+
+		if (mgIsImmutableValue(collection))
+			MG_FAIL("Error: %s is immutable, create a new %s instead of assigning its items",
+			        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(collection)));
+
+		if (!mgValueSubscriptSet(collection, index, value))
+			MG_FAIL("Error: %s is not subscriptable with %s",
+			        mgGetTypeName(mgValueType(collection)), mgGetTypeName(mgValueType(index)));
+
+		_MG_NEXT();
+	}
+
+	_MG_CASE(GET_ATTRIBUTE)
+	{
+		const MGValue *collection = registers[instruction->b];
+		MGValue *value = _mgAttributeGetCached(&code->caches[instruction - instructions], collection, names[instruction->c]);
+
+		if (!value)
+			MG_FAIL("Error: %s has no attribute %s",
+			        mgGetTypeName(mgValueType(collection)), names[instruction->c]);
+
+		_MG_SET(instruction->a, value);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(SET_ATTRIBUTE)
+	_MG_CASE(DELETE_ATTRIBUTE)
+	{
+		const MGValue *collection = registers[instruction->b];
+
+#if MG_DEBUG
+		if (instruction->opcode == MG_OPCODE_DELETE_ATTRIBUTE)
+		{
+			MGValue *value = mgValueAttributeGet(collection, names[instruction->c]);
+
+			if (!value)
+				MG_FAIL("Error: %s has no attribute %s",
+				        mgGetTypeName(mgValueType(collection)), names[instruction->c]);
+
+			mgDestroyValue(value);
+		}
+#endif
+
+		if (mgIsSharedValue(instance, collection))
+			MG_FAIL("Error: Cannot modify %s in a parallel map or task, as it was created outside of it", mgGetTypeName(mgValueType(collection)));
+
+		MGValue *value = (instruction->opcode == MG_OPCODE_SET_ATTRIBUTE) ? mgReferenceValue(registers[instruction->a]) : NULL;
+
+		if (!mgValueAttributeSet(collection, names[instruction->c], value))
+			MG_FAIL("Error: %s has no attribute %s",
+			        mgGetTypeName(mgValueType(collection)), names[instruction->c]);
+
+		_MG_NEXT();
+	}
+
+	_MG_CASE(UNPACK)
+	{
+		const MGValue *values = registers[instruction->a];
+		size_t length = 0;
+
+		if ((mgValueType(values) == MG_TYPE_TUPLE) || (mgValueType(values) == MG_TYPE_LIST))
+			length = mgListLength(values);
+		else if (mgIsVectorValue(values))
+			length = mgVectorLength(values);
+		else
+			MG_FAIL("Error: %s is not iterable", mgGetTypeName(mgValueType(values)));
+
+		if (instruction->b != length)
+			MG_FAIL("Error: Mismatched lengths for parallel assignment (%zu != %zu)", (size_t) instruction->b, length);
+
+		_MG_NEXT();
+	}
+
+	_MG_CASE(GET_ITEM)
+		if (mgIsVectorValue(registers[instruction->b]))
+			_MG_SET(instruction->a, mgCreateValueFloat(mgVectorGet(registers[instruction->b], instruction->c)));
+		else
+			_MG_SET(instruction->a, mgReferenceValue(_mgListGet(registers[instruction->b]->data.a, instruction->c)));
+		_MG_NEXT();
+
+	_MG_CASE(JUMP)
+		_MG_JUMP(instruction->a);
+		_MG_NEXT();
+
+	_MG_CASE(JUMP_IF_FALSE)
+		if (!mgValueTruthValue(registers[instruction->b]))
+			_MG_JUMP(instruction->c);
+		_MG_NEXT();
+
+	_MG_CASE(JUMP_IF_TRUE)
+		if (mgValueTruthValue(registers[instruction->b]))
+			_MG_JUMP(instruction->c);
+		_MG_NEXT();
+
+	_MG_CASE(JUMP_IF_NOT_NULL)
+		if (mgValueType(registers[instruction->b]) != MG_TYPE_NULL)
+			_MG_JUMP(instruction->c);
+		_MG_NEXT();
+
+	_MG_CASE(FOR_PREPARE)
+		_MG_PREPARE_ITERABLE(instruction->a);
+		_MG_NEXT();
+
+	_MG_CASE(FOR_PREPARE_RANGE)
+	{
+		MGRange range;
+		_MG_RANGE_BOUNDS(&range, registers + instruction->a, instruction->c);
+
+		_MG_PREPARE_RANGE(instruction->a, &range);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(FOR_PREPARE_CALL)
+	{
+		const MGValue *func = registers[instruction->b];
+		const MGValue *const *argv = (const MGValue* const*) (registers + instruction->b + 1);
+
+		if (mgIsRangeFunction(func))
+		{
+			MGRange range;
+			mgCallRange(instance, module, _MG_NODE, _mgCalleeName(_MG_NODE), instruction->c, argv, &range);
+
+			_MG_PREPARE_RANGE(instruction->a, &range);
+			_MG_NEXT();
+		}
+
+		_MG_SET(instruction->a, _mgCallIterable(instance, module, _MG_NODE, func, instruction->c, registers + instruction->b + 1));
+		_MG_PREPARE_ITERABLE(instruction->a);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(FOR_NEXT)
+	{
+		const MGValue *iterable = registers[instruction->b];
+		const int index = mgIntegerGet(registers[instruction->b + 1]);
+
+		if (mgIsNumericValue(iterable))
+		{
+			if (index < mgIntegerGet(registers[instruction->b + 3]))
+			{
+				_MG_SET(instruction->a, mgRangeItem(iterable, registers[instruction->b + 2], index));
+				registers[instruction->b + 1] = mgCreateValueInteger(index + 1);
+			}
+			else
+				_MG_JUMP(instruction->c);
+		}
+		else if (mgValueType(iterable) == MG_TYPE_ITERATOR)
+		{
+			MGValue *item = mgIteratorNext((MGValue*) iterable);
+
+			if (item)
+				_MG_SET(instruction->a, item);
+			else
+				_MG_JUMP(instruction->c);
+		}
+		else if ((size_t) index < _mgListLength(iterable->data.a))
+		{
+			_MG_SET(instruction->a, mgReferenceValue(_mgListGet(iterable->data.a, index)));
+			registers[instruction->b + 1] = mgCreateValueInteger(index + 1);
+		}
+		else
+			_MG_JUMP(instruction->c);
+
+		_MG_NEXT();
+	}
+
+	_MG_CASE(ARGUMENT)
+		if (instruction->b < argc)
+		{
+			_MG_SET(instruction->a, mgReferenceValue(argv[instruction->b]));
+			_MG_JUMP(instruction->c);
+		}
+		_MG_NEXT();
+
+	_MG_CASE(MISSING_ARGUMENT)
+		mgFatalError("Error: Expected argument \"%s\"", names[instruction->b]);
+		_MG_NEXT();
+
+	_MG_CASE(CALL)
+	{
+		const MGValue *func = registers[instruction->b];
+		MGValue *value = _mgCallValue(instance, module, _MG_NODE, func, instruction->c, (const MGValue* const*) (registers + instruction->b + 1));
+
+		_MG_SET(instruction->a, value);
+		_MG_NEXT();
+	}
+
+	// Script functions are called once this call has returned, while
+	// others are called in place and their result is then returned
+	_MG_CASE(TAIL_CALL)
+	{
+		const MGValue *func = registers[instruction->b];
+
+		if ((mgValueType(func) == MG_TYPE_FUNCTION) || (mgValueType(func) == MG_TYPE_PROCEDURE))
+		{
+			mgDeferTailCall(instance, module, _MG_NODE, _mgCalleeName(_MG_NODE), func, instruction->c, (const MGValue* const*) (registers + instruction->b + 1));
+
+			result = MG_NULL_VALUE;
+			goto end;
+		}
+
+		_MG_SET(instruction->a, _mgCallValue(instance, module, _MG_NODE, func, instruction->c, (const MGValue* const*) (registers + instruction->b + 1)));
+		_MG_NEXT();
+	}
+
+	_MG_CASE(CALL_ITERATE)
+		_MG_SET(instruction->a, _mgCallIterable(instance, module, _MG_NODE, registers[instruction->b], instruction->c, registers + instruction->b + 1));
+		_MG_NEXT();
+
+	_MG_CASE(CALL_METHOD)
+	{
+		const MGValue *receiver = registers[instruction->a];
+		const char *name = names[instruction->b];
+		const MGValue *const *argv = (const MGValue* const*) (registers + instruction->a + 1);
+
+		MGInlineCache *cache = &code->caches[instruction - instructions];
+		const MGTypeData *type = mgGetType(mgValueType(receiver));
+
+		MGBoundCFunction method = (cache->key == type) ? cache->method : NULL;
+
+		if (!method && type->methodGet && (method = type->methodGet(name)) && !mgIsParallel())
+		{
+			cache->key = type;
+			cache->method = method;
+		}
+
+		MGValue *value;
+
+		if (method)
+			value = mgCallMethod(instance, module, _MG_NODE, "<anonymous>", method, receiver, instruction->c, argv);
+		else
+		{
+			MGValue *func = _mgAttributeGetCached(cache, receiver, name);
+
+			if (!func)
+				MG_FAIL("Error: %s has no attribute %s", mgGetTypeName(mgValueType(receiver)), name);
+
+			value = _mgCallValue(instance, module, _MG_NODE, func, instruction->c, argv);
+
+			mgDestroyValue(func);
+		}
+
+		_MG_SET(instruction->a, value);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(MAKE_FUNCTION)
+		_MG_SET(instruction->a, _mgCreateFunction(instance, module, _MG_NODE, (MGbool) instruction->b));
+		_MG_NEXT();
+
+	_MG_CASE(EMIT)
+	{
+		const unsigned int vertexSize = mgInstanceGetVertexSize(instance);
+
+		const MGValue *tuple = registers[instruction->a];
+
+		if (mgIsVectorValue(tuple))
+		{
+			if (mgVectorLength(tuple) != vertexSize)
+				MG_FAIL("Error: Expected tuple with a length of %u, received \"%s\"",
+				        vertexSize, mgGetTypeName(mgValueType(tuple)));
+		}
+		else if (mgValueType(tuple) != MG_TYPE_TUPLE)
+			MG_FAIL("Error: Expected \"%s\", received \"%s\"",
+			        mgGetTypeName(MG_TYPE_TUPLE), mgGetTypeName(mgValueType(tuple)));
+
+		const size_t vertexCount = _mgListLength(instance->vertices);
+
+		_mgListAddUninitialized(MGVertex, instance->vertices);
+		MGVertex *vertices = _mgListItems(instance->vertices);
+
+		if (mgIsVectorValue(tuple))
+			memcpy(vertices[vertexCount], tuple->data.vec, vertexSize * sizeof(float));
+		else
+		{
+			// Vectors in the tuple are flattened into their components
+			unsigned int count = 0;
+
+			for (size_t i = 0; i < mgTupleLength(tuple); ++i)
+			{
+				const MGValue *component = mgTupleGet(tuple, i);
+
+				if (mgIsVectorValue(component))
+				{
+					for (size_t j = 0; j < mgVectorLength(component); ++j, ++count)
+						if (count < vertexSize)
+							vertices[vertexCount][count] = mgVectorGet(component, j);
+				}
+				else if (mgIsNumericValue(component))
+				{
+					if (count < vertexSize)
+						vertices[vertexCount][count] = _mgNumericGet(component);
+					++count;
+				}
+				else
+					MG_FAIL("Error: Expected \"%s\" or \"%s\", received \"%s\"",
+					        mgGetTypeName(MG_TYPE_INTEGER), mgGetTypeName(MG_TYPE_FLOAT),
+					        mgGetTypeName(mgValueType(component)));
+			}
+
+			if (count != vertexSize)
+				MG_FAIL("Error: Expected tuple with a length of %u, received a tuple with a length of %u",
+				        vertexSize, count);
+		}
+
+		++_mgListLength(instance->vertices);
+
+		_MG_NEXT();
+	}
+
+	_MG_CASE(IMPORT)
+	{
+		MGValue *importedModule = mgImportModule(instance, names[instruction->b]);
+
+		if (!importedModule)
+			MG_FAIL("Error: Undefined module \"%s\"", names[instruction->b]);
+
+		MG_ASSERT(mgValueType(importedModule) == MG_TYPE_MODULE);
+
+		_MG_SET(instruction->a, importedModule);
+		_MG_NEXT();
+	}
+
+	_MG_CASE(IMPORT_NAME)
+	{
+		const MGValue *value = mgModuleGetInterned(registers[instruction->b], names[instruction->c]);
+
+		if (!value)
+			MG_FAIL("Error: Undefined name \"%s\"", names[instruction->c]);
+
+		_MG_SET(instruction->a, mgReferenceValue(value));
+		_MG_NEXT();
+	}
+
+	_MG_CASE(IMPORT_ALL)
+	{
+		MGMapIterator iterator;
+		mgCreateMapIterator(&iterator, registers[instruction->a]->data.module.globals);
+
+		const MGValue *k, *v;
+		while (mgMapIteratorNext(&iterator, &k, &v))
+			_mgSetValueEx(instance, module, _MG_NODE, k->data.str.s, mgReferenceValue(v));
+
+		mgDestroyMapIterator(&iterator);
+
+		_MG_NEXT();
+	}
+
+	_MG_CASE(ASSERT)
+		if (instruction->b)
+		{
+			const MGValue *message = registers[instruction->a];
+
+			if (mgValueType(message) != MG_TYPE_STRING)
+				MG_FAIL("Error: Assertion", 0);
+
+			MG_FAIL("Error: %s", message->data.str.s);
+		}
+		else
+			MG_FAIL("Error: Assertion", 0);
+		_MG_NEXT();
+
+	_MG_CASE(RETURN)
+		result = mgReferenceValue(registers[instruction->a]);
+		goto end;
+
+	_MG_CASE(RETURN_NULL)
+		result = MG_NULL_VALUE;
+		goto end;
+
+#if !MG_COMPUTED_GOTO
+		}
+	}
+#endif
+
+#undef _MG_CASE
+#undef _MG_DISPATCH
+#undef _MG_NEXT
+#undef _MG_JUMP
+
+end:
+
+	frame->slots = lastSlots;
+	frame->code = lastCode;
+
+	for (size_t i = 0; i < valueCount; ++i)
+		if (registers[i])
+			mgDestroyValue(registers[i]);
+
+	mgValueStackPop(&instance->valueStack, registers, valueCount);
+
+	return result;
+}
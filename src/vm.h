@@ -0,0 +1,9 @@
+#ifndef MODELGEN_VM_H
+#define MODELGEN_VM_H
+
+#include "value.h"
+#include "compile.h"
+
+MGValue* mgExecute(MGInstance *instance, MGValue *module, const MGCode *code, size_t argc, const MGValue* const* argv);
+
+#endif
\ No newline at end of file
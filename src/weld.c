@@ -0,0 +1,142 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "value.h"
+#include "weld.h"
+#include "debug.h"
+
+
+// Cells beyond this are clamped, as their coordinates no longer fit
+// an int64_t, which only makes vertices there share fewer cells
+#define _MG_WELD_CELL_LIMIT 1e18
+
+
+typedef struct MGWeldTable {
+	// Unique vertex indices plus one, where zero is empty
+	uint32_t *slots;
+	size_t mask;
+} MGWeldTable;
+
+
+static inline int64_t _mgWeldCell(double q)
+{
+	if (q != q)
+		return 0;
+	else if (q < -_MG_WELD_CELL_LIMIT)
+		return (int64_t) -_MG_WELD_CELL_LIMIT;
+	else if (q > _MG_WELD_CELL_LIMIT)
+		return (int64_t) _MG_WELD_CELL_LIMIT;
+
+	return (int64_t) q;
+}
+
+
+static inline size_t _mgWeldHash(const int64_t *cell)
+{
+	uint64_t h = (uint64_t) cell[0] * 73856093u;
+	h ^= (uint64_t) cell[1] * 19349663u;
+	h ^= (uint64_t) cell[2] * 83492791u;
+
+	// Mixed such that neighboring cells don't cluster in the table
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+
+	return (size_t) h;
+}
+
+
+static inline MGbool _mgWeldEqual(const float *a, const float *b, size_t size, float epsilon)
+{
+	for (size_t i = 0; i < size; ++i)
+		if (!(fabsf(a[i] - b[i]) <= epsilon))
+			return MG_FALSE;
+
+	return MG_TRUE;
+}
+
+
+size_t mgWeldVertices(const float *vertices, size_t count, size_t stride, size_t size,
+                      float epsilon, uint32_t *indices, uint32_t *uniques)
+{
+	MG_ASSERT(size <= stride);
+	MG_ASSERT(epsilon > 0.0f);
+	MG_ASSERT(count < UINT32_MAX);
+
+	const size_t hashed = (size < 3) ? size : 3;
+	const double cellSize = 2.0 * (double) epsilon;
+
+	size_t capacity = 16;
+
+	while (capacity < (count * 2))
+		capacity <<= 1;
+
+	MGWeldTable table;
+	table.slots = (uint32_t*) calloc(capacity, sizeof(uint32_t));
+	table.mask = capacity - 1;
+	MG_ASSERT(table.slots);
+
+	size_t uniqueCount = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float *vertex = vertices + i * stride;
+
+		// The cell of the vertex, and the neighbor on the side
+		// of each axis where a vertex within epsilon could be
+		int64_t cell[3] = { 0, 0, 0 }, neighbor[3] = { 0, 0, 0 };
+
+		for (size_t j = 0; j < hashed; ++j)
+		{
+			const double q = (double) vertex[j] / cellSize;
+			const double f = floor(q);
+
+			cell[j] = _mgWeldCell(f);
+			neighbor[j] = _mgWeldCell(((q - f) < 0.5) ? (f - 1.0) : (f + 1.0));
+		}
+
+		uint32_t found = 0;
+
+		for (int corner = 0; (corner < (1 << hashed)) && !found; ++corner)
+		{
+			int64_t probe[3];
+
+			for (size_t j = 0; j < 3; ++j)
+				probe[j] = (corner & (1 << j)) ? neighbor[j] : cell[j];
+
+			// Any vertex within epsilon is a match, regardless of its cell
+			for (size_t k = _mgWeldHash(probe) & table.mask; table.slots[k]; k = (k + 1) & table.mask)
+			{
+				const uint32_t unique = table.slots[k] - 1;
+
+				if (_mgWeldEqual(vertices + (size_t) uniques[unique] * stride, vertex, size, epsilon))
+				{
+					found = unique + 1;
+					break;
+				}
+			}
+		}
+
+		if (found)
+		{
+			indices[i] = found - 1;
+			continue;
+		}
+
+		size_t k = _mgWeldHash(cell) & table.mask;
+
+		while (table.slots[k])
+			k = (k + 1) & table.mask;
+
+		table.slots[k] = (uint32_t) (uniqueCount + 1);
+
+		uniques[uniqueCount] = (uint32_t) i;
+		indices[i] = (uint32_t) uniqueCount++;
+	}
+
+	free(table.slots);
+
+	return uniqueCount;
+}
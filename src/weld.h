@@ -0,0 +1,25 @@
+#ifndef MODELGEN_WELD_H
+#define MODELGEN_WELD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Welding merges vertices whose components all differ by at most an
+// epsilon, such that exported meshes can share them using indices.
+// Vertices are found using a spatial hash of their first three
+// components, with cells twice the epsilon, such that any vertex within
+// the epsilon lies in one of the 8 cells nearest to it.
+
+#ifndef MG_WELD_EPSILON
+#   define MG_WELD_EPSILON 1e-6f
+#endif
+
+// Welds count vertices of size components each, which are stride floats
+// apart. Sets indices[i] to the index of the unique vertex that vertex i
+// was welded into, and uniques[j] to the index of the first vertex of the
+// j-th unique vertex, and returns the number of unique vertices. Vertices
+// with non-finite components are never welded.
+size_t mgWeldVertices(const float *vertices, size_t count, size_t stride, size_t size,
+                      float epsilon, uint32_t *indices, uint32_t *uniques);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+#ifndef MODELGEN_TEST_CONCURRENCY_H
+#define MODELGEN_TEST_CONCURRENCY_H
+
+#include "thread.h"
+#include "debug.h"
+
+#include "test.h"
+#include "interpret.h"
+#include "script.h"
+
+
+#define _MG_INSTANCE_TEST_THREADS 8
+#define _MG_INSTANCE_TEST_RUNS 8
+
+
+// Exercises interned strings, maps, closures, random() and emit,
+// which previously relied on state shared by every instance
+static const char *_mgInstanceTestScript =
+	"import math\n"
+	"math.seed(7)\n"
+	"counts = {}\n"
+	"func key(i) return \"key\" + string(i % 37)\n"
+	"func scale(s) return func(x) return x * s\n"
+	"half = scale(0.5)\n"
+	"for i in range(2000)\n"
+	"\tk = key(i)\n"
+	"\tcounts[k] = (counts[k] ?? 0) + 1\n"
+	"\temit (half(i), math.random(), len(counts), counts[k], 0, 1)\n";
+
+
+static void _mgInstanceTestThread(void *data)
+{
+	MGScriptTestRun *runs = (MGScriptTestRun*) data;
+
+	for (int i = 0; i < _MG_INSTANCE_TEST_RUNS; ++i)
+		_mgRunScriptTest(&runs[i], NULL, _mgInstanceTestScript);
+}
+
+
+MG_TEST(mgTestConcurrentInstances)
+{
+	MGScriptTestRun expected;
+	_mgCreateScriptTestRun(&expected);
+	_mgRunScriptTest(&expected, NULL, _mgInstanceTestScript);
+
+	MGThread threads[_MG_INSTANCE_TEST_THREADS];
+	MGScriptTestRun runs[_MG_INSTANCE_TEST_THREADS][_MG_INSTANCE_TEST_RUNS];
+
+	for (int i = 0; i < _MG_INSTANCE_TEST_THREADS; ++i)
+	{
+		for (int j = 0; j < _MG_INSTANCE_TEST_RUNS; ++j)
+		{
+			_mgCreateScriptTestRun(&runs[i][j]);
+			runs[i][j].walkAST = (i + j) % 2;
+		}
+
+		MG_ASSERT(mgCreateThread(&threads[i], _mgInstanceTestThread, runs[i]));
+	}
+
+	for (int i = 0; i < _MG_INSTANCE_TEST_THREADS; ++i)
+		mgJoinThread(&threads[i]);
+
+	MGbool match = expected.vertexCount == 2000;
+
+	for (int i = 0; i < _MG_INSTANCE_TEST_THREADS; ++i)
+	{
+		for (int j = 0; j < _MG_INSTANCE_TEST_RUNS; ++j)
+		{
+			if (!_mgScriptTestRunsEqual(&runs[i][j], &expected))
+				match = MG_FALSE;
+
+			_mgDestroyScriptTestRun(&runs[i][j]);
+		}
+	}
+
+	_mgDestroyScriptTestRun(&expected);
+
+	mgTestAssert(match);
+}
+
+
+// Instances existing at the same time on one thread, which are
+// created, run and destroyed in an order unrelated to each other
+MG_TEST(mgTestInterleavedInstances)
+{
+	MGScriptTestRun expected;
+	_mgCreateScriptTestRun(&expected);
+	_mgRunScriptTest(&expected, NULL, _mgInstanceTestScript);
+
+	MGInstance a, b;
+	mgCreateInstance(&a);
+	mgCreateInstance(&b);
+
+	a.vertexSize.position = 3;
+	a.vertexSize.normal = 3;
+
+	mgRunString(&a, _mgInstanceTestScript, "<a>");
+	mgDestroyInstance(&b);
+
+	mgRunString(&a, "x = [1, 2, 3]\n", "<after>");
+
+	mgTestAssertIntEquals((int) _mgListLength(a.vertices), (int) expected.vertexCount);
+	mgTestAssert(!memcmp(_mgListItems(a.vertices), expected.vertices, expected.vertexCount * sizeof(MGVertex)));
+
+	mgDestroyInstance(&a);
+
+	_mgDestroyScriptTestRun(&expected);
+}
+
+
+// Each item emits a number of vertices depending on its index and
+// random(), which must come out the same regardless of the threads
+static const char *_mgParallelMapTestScript =
+	"import math\n"
+	"math.seed(3)\n"
+	"names = {\"a\": 1, \"b\": 2}\n"
+	"func ring(i)\n"
+	"\tn = 1 + i % 5\n"
+	"\tfor j in range(n)\n"
+	"\t\temit (i, j, math.random(), names[\"b\"], len(string(i)), 1)\n"
+	"\treturn [n, \"ring\" + string(i)]\n"
+	"rings = pmap(ring, range(500))\n"
+	"emit (len(rings), rings[499][0], math.random(), 0, 0, 1)\n";
+
+
+// Tasks of uneven sizes, some of which spawn tasks of their own, with the
+// script emitting vertices in between spawning and waiting for them
+static const char *_mgTaskTestScript =
+	"import math\n"
+	"math.seed(5)\n"
+	"proc ring(i)\n"
+	"\tfor j in range((i * 7) % 40)\n"
+	"\t\temit (i, j, math.random(), 0, 0, 1)\n"
+	"func rings(i)\n"
+	"\tchildren = []\n"
+	"\tfor k in range(i % 4)\n"
+	"\t\tchildren.add(spawn(ring, i + k))\n"
+	"\tring(i)\n"
+	"\treturn len(wait(children))\n"
+	"futures = []\n"
+	"for i in range(100)\n"
+	"\tfutures.add(spawn(rings, i))\n"
+	"emit (-1, 0, math.random(), 0, 0, 1)\n"
+	"counts = wait(futures)\n"
+	"spawn(ring, 39)\n"
+	"emit (len(counts), counts[99], math.random(), 0, 0, 1)\n";
+
+
+MG_TEST(mgTestParallelMap)
+{
+	size_t vertexCount;
+	mgTestAssert(_mgScriptTestMatchesAcrossThreads(NULL, _mgParallelMapTestScript, 1, 8, &vertexCount));
+	mgTestAssertIntEquals((int) vertexCount, 1501);
+}
+
+
+MG_TEST(mgTestTasks)
+{
+	size_t vertexCount;
+	mgTestAssert(_mgScriptTestMatchesAcrossThreads(NULL, _mgTaskTestScript, 1, 8, &vertexCount));
+	mgTestAssertIntEquals((int) vertexCount, 4955);
+}
+
+
+// Expects an error rather than a crash from the calls
+// adding to the same global list
+MG_TEST(mgTestParallelMapSharedWrite)
+{
+	mgTestAssert(_mgRunScriptRejected("tests/fixtures/function/_pmap_shared.mg", "--threads 8 ",
+	                                  "Error: Cannot modify list in a parallel map or task"));
+}
+
+
+// Expects an error rather than a race from the calls of a
+// closure assigning a local it captured outside of pmap
+MG_TEST(mgTestParallelMapCapturedWrite)
+{
+	mgTestAssert(_mgRunScriptRejected("tests/fixtures/function/_pmap_captured.mg", "--threads 8 ",
+	                                  "Error: Cannot modify local \"sum\" in a parallel map or task"));
+}
+
+
+static inline void mgRunConcurrencyTests(void)
+{
+	mgRunTestCase(&mgTestConcurrentInstances);
+	mgRunTestCase(&mgTestInterleavedInstances);
+	mgRunTestCase(&mgTestParallelMap);
+	mgRunTestCase(&mgTestTasks);
+	mgRunTestCase(&mgTestParallelMapSharedWrite);
+	mgRunTestCase(&mgTestParallelMapCapturedWrite);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+# Assigning a local captured by a closure created outside of pmap is
+# an error, as the calls would race modifying it, see
+# mgTestParallelMapCapturedWrite
+
+func total(items)
+	sum = 0
+	add = func(x)
+		sum += x
+		return sum
+	return pmap(add, items)
+
+print(total(range(100)))
@@ -0,0 +1,11 @@
+# Modifying a container created outside of pmap is an error, as the
+# calls would race adding to it, see mgTestParallelMapSharedWrite
+
+out = []
+
+func fill(i)
+	for j in range(300000)
+		out.add(j)
+	return i
+
+print(pmap(fill, range(8)))
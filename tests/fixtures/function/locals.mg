@@ -0,0 +1,36 @@
+x = 1
+
+func f(a, b = 2)
+	# x is a global, so assigning it writes the global
+	x = a + b
+	c = x * 2
+	print(locals())
+	return c
+
+print(f(3))
+print(x)
+
+
+func g()
+	y = 2
+	delete y
+	y = 3
+	return y
+
+print(g())
+
+
+func fib(n)
+	if n < 2
+		return n
+	return fib(n - 1) + fib(n - 2)
+
+print(fib(10))
+
+
+func h(n)
+	for i in range(n)
+		last = i
+	return last
+
+print(h(4))
@@ -0,0 +1,62 @@
+import math
+
+# pmap maps like map, while the calls may run on several threads,
+# which share the globals they read
+
+scale = 3
+names = {"a": "x", "b": "y"}
+
+func square(x)
+	return x * x * scale
+
+func join(a, b)
+	return a + names[b]
+
+assert pmap(square, range(6)) == map(square, range(6))
+assert pmap(square, []) == []
+assert pmap(join, ["1", "2", "3"], ("a", "b")) == ["1x", "2y"]
+assert pmap(int, ["1", "2"]) == [1, 2]
+
+# Closures and nested maps
+func multiply(x)
+	by = func(y)
+		return x * y
+	return pmap(by, range(3))
+
+assert pmap(multiply, range(3)) == [[0, 0, 0], [0, 1, 2], [0, 2, 4]]
+
+# Calls of a closure created outside of pmap read the locals it
+# captured, while its parameters and locals belong to each call
+func offsets(x, n)
+	by = func(x)
+		y = x + n
+		for i in range(2)
+			y += i
+		return y
+	return pmap(by, range(n))
+
+assert offsets(100, 4) == [5, 6, 7, 8]
+
+# Each call gets its own random() sequence seeded by its index,
+# so the results are the same however the calls are split
+func sample(i)
+	return math.random()
+
+math.seed(1)
+first = pmap(sample, range(100))
+after = math.random()
+math.seed(1)
+assert pmap(sample, range(100)) == first
+assert math.random() == after
+assert first[0] != first[1]
+
+# Vertices are emitted in the order of the items
+func ring(i)
+	for j in range(i % 3)
+		emit i, j, 0, 0, 0, 1
+	return i % 3
+
+func count(i)
+	return i % 3
+
+assert pmap(ring, range(30)) == map(count, range(30))
@@ -0,0 +1,29 @@
+
+# Deep enough for the registers and arguments of
+# the active calls to span several stack segments
+func depth(n, a, b, c)
+	if n == 0
+		return a + b + c
+	x = n * 2
+	y = (x, a)
+	return depth(n - 1, a + 1, b, c)
+
+assert depth(3000, 0, 1, 2) == 3003
+
+func sum(l, i = 0)
+	if i == len(l)
+		return 0
+	return l[i] + sum(l, i + 1)
+
+assert sum(range(1000)) == 499500
+
+# Locals only exist as a map once a closure captures them
+func outer(n)
+	a = n
+	f = func()
+		return a + n
+	a += 1
+	return f
+
+assert outer(1)() == 3
+assert outer(10)() == 21
@@ -0,0 +1,67 @@
+import math
+
+# spawn returns a future of a call, which runs once any pending
+# future is waited for, possibly on another thread
+
+scale = 3
+
+func square(x)
+	return x * x * scale
+
+func add(a, b)
+	return a + b
+
+a = spawn(square, 4)
+b = spawn(add, "a", "b")
+c = spawn(int, "5")
+
+assert type(a) == "future"
+assert wait(a) == 48
+assert wait(b) == "ab"
+assert wait(a, b, c) == [48, "ab", 5]
+assert wait([a, c]) == [48, 5]
+assert wait() == null
+
+# Tasks spawned by tasks are run before the task returns
+func sum(n)
+	futures = []
+	for i in range(n)
+		futures.add(spawn(square, i))
+	total = 0
+	for x in wait(futures)
+		total += x
+	return total
+
+assert wait(spawn(sum, 5)) == 90
+
+# Futures left pending are run by the parallel map which spawned them
+func forget(i)
+	spawn(square, i)
+	return i
+
+assert pmap(forget, range(4)) == [0, 1, 2, 3]
+
+# Each task gets its own random() sequence seeded in spawn order
+func sample()
+	return math.random()
+
+math.seed(1)
+first = wait(map(spawn, [sample] * 20))
+after = math.random()
+math.seed(1)
+assert wait(map(spawn, [sample] * 20)) == first
+assert math.random() == after
+assert first[0] != first[1]
+
+# Vertices are emitted in the order the tasks were spawned,
+# after the vertices emitted before waiting for them
+proc ring(i)
+	for j in range(i % 3 + 1)
+		emit i, j, 0, 0, 0, 1
+
+for i in range(10)
+	spawn(ring, i)
+
+emit -1, 0, 0, 0, 0, 1
+
+wait()
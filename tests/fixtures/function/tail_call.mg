@@ -0,0 +1,62 @@
+# Calls in tail position reuse the frame of the returning
+# call, so tail recursion is not limited by its depth
+func count(n, total = 0)
+	if n == 0
+		return total
+	return count(n - 1, total + 1)
+
+assert count(1000000) == 1000000
+
+func even(n)
+	if n == 0
+		return true
+	return odd(n - 1)
+
+func odd(n)
+	if n == 0
+		return false
+	return even(n - 1)
+
+assert even(100000)
+assert odd(100001)
+
+# Returns from loops and into closures and other callables
+func find(l, x, i = 0)
+	for j in range(i, len(l))
+		if l[j] == x
+			return found(j)
+	return len(l)
+
+func found(i)
+	return i
+
+assert find([3, 1, 4, 1, 5], 4) == 2
+assert find([3, 1, 4], 9) == 3
+
+func adder(x)
+	return func(y) return x + y
+
+func apply(f, n)
+	if n == 0
+		return f(n)
+	return apply(f, n - 1)
+
+assert apply(adder(5), 10000) == 5
+
+func outer(n)
+	a = n
+	f = func()
+		return a + n
+	return f()
+
+assert outer(4) == 8
+
+func size(l)
+	return len(l)
+
+assert size([1, 2, 3]) == 3
+
+func index(l, x)
+	return l.index(x)
+
+assert index(["a", "b"], "b") == 1
@@ -0,0 +1,125 @@
+# Loops step through maps, and through calls of lazy
+# functions, without creating intermediate lists
+
+m = {"a": 1, "b": 2, "c": 3}
+keys = []
+for key in m
+	keys.add(key)
+assert keys == ["a", "b", "c"]
+assert (for key in {} key) == null
+
+func collect(items)
+	result = []
+	for item in items
+		result.add(item)
+	return result
+
+func square(x)
+	return x * x
+
+func even(x)
+	return x % 2 == 0
+
+# Each loop yields the items of the list the call returns
+items = []
+for item in enumerate([5, 6, 7])
+	items.add(item)
+assert items == enumerate([5, 6, 7])
+
+items = []
+for item in enumerate(range(3), 10)
+	items.add(item)
+assert items == enumerate(range(3), 10)
+
+items = []
+for item in zip(range(3), range(10, 20))
+	items.add(item)
+assert items == zip(range(3), range(10, 20))
+
+items = []
+for item in zip(range(2), [1, 2, 3], (4, 5, 6))
+	items.add(item)
+assert items == zip(range(2), [1, 2, 3], (4, 5, 6))
+
+items = []
+for item in consecutive(range(5))
+	items.add(item)
+assert items == consecutive(range(5))
+
+items = []
+for item in consecutive(range(5), 3)
+	items.add(item)
+assert items == consecutive(range(5), 3)
+
+items = []
+for item in consecutive(range(2))
+	items.add(item)
+assert items == consecutive(range(2))
+
+items = []
+for item in consecutive(range(3), 0)
+	items.add(item)
+assert items == consecutive(range(3), 0)
+
+items = []
+for item in map(square, range(5))
+	items.add(item)
+assert items == map(square, range(5))
+
+items = []
+for item in map((a, b) -> a * b, range(5), range(10, 15))
+	items.add(item)
+assert items == map((a, b) -> a * b, range(5), range(10, 15))
+
+items = []
+for item in filter(even, range(7))
+	items.add(item)
+assert items == filter(even, range(7))
+
+items = []
+for item in range(0.0, 1.0, 0.25)
+	items.add(item)
+assert items == range(0.0, 1.0, 0.25)
+
+# Nested calls stream through each other
+items = []
+for i, x in enumerate(map(square, filter(even, range(10))))
+	items.add((i, x))
+assert items == [(0, 0), (1, 4), (2, 16), (3, 36), (4, 64)]
+
+items = []
+for a, (b, c) in zip(range(10), consecutive(map(square, range(5))))
+	items.add(a + b + c)
+assert items == [1, 6, 15, 28]
+
+# Functions are only called for the items which are reached
+calls = [0]
+func count(x)
+	calls[0] += 1
+	return x
+assert (for x in map(count, range(1000)) if x == 3 break x) == 3
+assert calls[0] == 4
+
+# Items added to the iterated collection are not iterated
+items = [1, 2, 3]
+for i, item in enumerate(items)
+	items.add(item)
+assert items == [1, 2, 3, 1, 2, 3]
+
+names = {"a": 1, "b": 2}
+for key in names
+	names[key + key] = 0
+assert len(names) == 4
+
+# Other functions receive lists
+func kind(items)
+	return [type(items)]
+for t in kind(map(square, range(3)))
+	assert t == "list"
+assert (for x in collect(filter(even, range(5))) x) == 4
+
+# Lazy functions which have been rebound are called as usual
+map_ = map
+map = (f, items) -> [-1]
+assert collect(map(square, range(3))) == [-1]
+map = map_
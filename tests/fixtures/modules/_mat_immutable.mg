@@ -0,0 +1,7 @@
+import mat
+
+# Rows of a native mat4 are copied vec4 values, such that
+# assigning into one could never change the matrix
+
+m = mat.mat4(1)
+m[3][0] = 5
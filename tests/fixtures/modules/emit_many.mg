@@ -0,0 +1,41 @@
+import geom
+import modifiers
+
+# emit_many must emit the same vertices as geom.vertex, which
+# tests/modules.h checks by comparing the two halves emitted below
+
+func identity(position, normal)
+	return position, normal
+
+triangles = [((0, 0, 0), (1, 0, 0), (0, 1, 0)), ((1.5, -2, 0.25), (3, 1, -1), (0.5, 0.5, 2))]
+positions = buffer(geom.triangles_to_points(triangles))
+vertices = buffer([(1, 2, 3, 0, 1, 0), (-4, 5.5, 6, 0, 0, -1)], "int")
+
+for pass in range(2)
+	# Modifiers make geom fall back to emitting every vertex
+	if pass == 1
+		modifiers.push_modifier(identity)
+	assert len(modifiers.active()) == pass
+
+	geom.push()
+	geom.translate(1, 2, 3)
+	geom.rotate(0.5, 1, 1, 0)
+	geom.scale(2, 1, 0.5)
+
+	geom.cube((1, 2, 3))
+	geom.sphere(1, (0, 1, 0), 6, 6)
+	geom.triangles(triangles, (1, 0, -1), true)
+	geom.triangle((0, 0, 0), vec3(1, 0, 0), (0, 0, 1))
+
+	if pass == 0
+		emit_many(positions, geom.get_matrix(), (1, 0, -1))
+	else
+		geom.triangles(triangles, (1, 0, -1))
+
+	geom.pop()
+
+	if pass == 0
+		emit_many(vertices)
+	else
+		for vertex in vertices
+			emit vertex
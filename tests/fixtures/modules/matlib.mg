@@ -0,0 +1,68 @@
+import mat
+
+# The native mat module must match the reference mat.mg, which
+# tests/modules.h checks by comparing the vertices emitted below
+
+native = type(mat.mat4()) == "mat4"
+
+m = mat.translate(mat.scaling((1, 2, 3)), (4, 5, 6))
+assert mat.vec_type(m) == "mat"
+assert mat.vec_type((1, 2, 3)) == "vec"
+assert mat.vec_type(1) == "int"
+assert mat.mul(m, (1, 1, 1)) == (5, 12, 21)
+assert mat.mul((1, 1, 1), mat.translation((1, 2, 3))) == (1, 1, 1)
+assert mat.get_translation(m) == (4, 10, 18)
+assert mat.get_scaling(m) == (1, 2, 3)
+assert mat.column(m, 3) == (4, 10, 18, 1)
+assert mat.row(m, 1) == (0, 2, 0, 10)
+assert mat.mul((1, 2, 3), (2, 2, 2)) == (2, 4, 6)
+
+if native
+	assert m[3] == vec4(4, 10, 18, 1)
+	assert m[-1][2] == 18
+	assert len(m) == 4
+	assert (m as tuple) == ((1, 0, 0, 0), (0, 2, 0, 0), (0, 0, 3, 0), (4, 10, 18, 1))
+	assert (((1, 0, 0, 0), (0, 2, 0, 0), (0, 0, 3, 0), (4, 10, 18, 1)) as mat4) == m
+	assert m * mat.mat4() == m
+	assert m * vec3(1, 1, 1) == vec3(5, 12, 21)
+	assert mat.mul(m, vec3(1, 1, 1)) == vec3(5, 12, 21)
+	assert mat.transpose(mat.transpose(m)) == m
+	assert mat.transpose(m)[0] == vec4(1, 0, 0, 4)
+	assert mat.inverse(m) * m == mat.mat4()
+	assert mat.transform_point(mat.inverse(m), (5, 12, 21)) == (1, 1, 1)
+	assert mat.transform_direction(m, (1, 1, 1)) == (1, 2, 3)
+	assert mat.transform_direction(mat.normal_matrix(m), (1, 1, 1)) == (1, 0.5, 1 / 3)
+	assert mat.normal_matrix(mat.rotation(0.5, (1, 2, 3))) == mat.rotation(0.5, (1, 2, 3))
+
+func put(v, tag)
+	if type(v) != "tuple" and type(v) != "mat4"
+		v = (v,)
+	for i in range(len(v))
+		if type(v[i]) == "int" or type(v[i]) == "float"
+			emit (v[i], 0, tag, i, len(v), 1)
+		else
+			for j in range(len(v[i]))
+				emit (v[i][j], j, tag, i, len(v), 2)
+
+matrices = [mat.mat4(), mat.mat4(2.5), mat.scaling((1, 2, 3)), mat.scaling(0.5), mat.translation((1, -2, 0.5)), mat.rotation(0.5, (0, 1, 0)), mat.rotation(1.25, (1, 2, 3)), mat.rotation(2, (0.5, -1, 0.25)), ((1, 2, 3, 0), (0.5, 1, -1, 0), (0, 0.25, 1, 0), (3, -1, 2, 1))]
+vectors = [(1.5, -2, 0.5), (0.5, 0.25, -4, 1), (1, 2, 3), (2, 0, -1, 0)]
+
+tag = 0
+for a in matrices
+	for b in matrices
+		put(mat.mul(a, b), tag)
+		tag += 1
+	for v in vectors
+		put(mat.mul(a, v), tag)
+		put(mat.mul(v, a), tag)
+		tag += 1
+	for i in range(4)
+		put(mat.column(a, i), tag)
+		put(mat.row(a, i), tag)
+	put(mat.get_translation(a), tag)
+	put(mat.get_scaling(a), tag)
+	put(mat.get_rotation(a), tag)
+	put(mat.scale(a, (2, 0.5, 3)), tag)
+	put(mat.translate(a, (2, -0.5, 1.5)), tag)
+	put(mat.rotate(a, -0.75, (1, 1, 0)), tag)
+	tag += 1
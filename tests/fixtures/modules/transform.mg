@@ -0,0 +1,44 @@
+import geom
+
+# Tasks and pmap items start with the transform current when spawn or
+# pmap was called, and then transform only their own vertices, which
+# tests/modules.h checks against running them on a single thread
+
+proc ring(i)
+	geom.push()
+	geom.rotate(i * 0.25, 0, 1, 0)
+	for j in range(i % 5 + 1)
+		geom.translate(0, 0.5, 0)
+		geom.cube((0.1, 0.2, 0.3))
+	geom.pop()
+
+func column(i)
+	geom.translate(i, 0, 0)
+	ring(i)
+	spawn(ring, i + 1)
+	return geom.get_matrix()
+
+geom.translate(0, 0, 10)
+start = geom.get_matrix()
+
+for i in range(16)
+	spawn(ring, i)
+	geom.scale(1.25, 1, 1)
+
+wait()
+
+geom.set_matrix(start)
+matrices = pmap(column, range(8))
+
+assert geom.get_matrix() == start
+assert matrices[0] == start
+assert matrices[3] != start
+
+geom.push()
+geom.scale(2, 2, 2)
+assert geom.get_matrix() != start
+stack = geom.get_matrix_stack()
+assert len(stack) == 2
+assert stack[0] == start and stack[-1] == geom.get_matrix()
+geom.pop()
+assert geom.get_matrix() == start
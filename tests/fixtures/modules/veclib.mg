@@ -0,0 +1,60 @@
+import vec
+
+# The native vec module must match the reference vec.mg, which
+# tests/modules.h checks by comparing the vertices emitted below
+
+assert vec.add((1, 2), (3, 4)) == (4, 6)
+assert vec.add((1, 2, 3, 4), (1, 0.5)) == (2, 2.5, 4, 4.5)
+assert vec.sub(1, (1, 2, 3)) == (0, -1, -2)
+assert vec.mul((1, 2, 3), 2.0) == (2.0, 4.0, 6.0)
+assert vec.div((1, 2), 2) == (0.5, 1.0)
+assert vec.max((1, 5, 3), (4, 2, 3.0)) == (4, 5, 3.0)
+assert vec.min((1, 5), 2) == (1, 2)
+assert vec.dot((1, 2, 3), (4, 5, 6)) == 32
+assert vec.length((3, 4)) == 5.0
+assert vec.cross((1, 0, 0), (0, 1, 0)) == (0, 0, 1)
+assert vec.normalize((0, 3, 4), 10) == (0.0, 6.0, 8.0)
+assert vec.vec4(1, 2, 3) == (1, 2, 3, 1)
+assert type(vec.add((1, 2), (3, 4))[0]) == "int"
+
+values = [1, -2, 3.5, -0.25, 7, (1, 2, 3), (1.5, -2, 0.5), (3, 4), (0.5, 0.25, -4, 2), (1, 2, 3, 4, 5, 6), (2.5, 1, -1, 3, 0.5, 8), (2, 0.5), (1.0, 2.0, 3.0)]
+ops = [vec.add, vec.sub, vec.mul, vec.div, vec.max, vec.min, vec.op_vec]
+func size(v)
+	if type(v) == "tuple"
+		return len(v)
+	return 1
+func put(v, tag)
+	if type(v) != "tuple"
+		v = (v,)
+	for i in range(len(v))
+		emit (v[i], type(v[i]) == "int", tag, i, len(v), 1)
+func twice(a, b)
+	return a * 2 - b
+tag = 0
+for a in values
+	for b in values
+		if size(a) == size(b) or size(a) % size(b) == 0 or size(b) % size(a) == 0
+			for op in ops
+				put(op(a, b), tag)
+			put(vec.op_vec(a, b, twice), tag)
+			put(vec.op_vec(a, b, vec.op_mul), tag)
+			put(vec.dot(a, b), tag)
+			put(vec.distance(a, b), tag)
+			put(vec.distance_squared(a, b), tag)
+			if size(a) == 3 and size(b) == 3
+				put(vec.cross(a, b), tag)
+			tag += 1
+	put(vec.length(a), tag)
+	put(vec.length_squared(a), tag)
+	put(vec._cast(a, 3), tag)
+	if type(a) == "tuple"
+		put(vec.normalize(a), tag)
+		put(vec.normalize(a, 2.5), tag)
+put(vec.mod((5, 7, -9, 4.5), (2, 3.5, 4, 2)), tag)
+put(vec.mod(7, (2, 3)), tag)
+put(vec.vec2(1, 2.5), tag)
+put(vec.vec3(1, 2.5, 3), tag)
+put(vec.vec4(1, 2.5, 3), tag)
+put(vec.vec4(1, 2.5, 3, 0.5), tag)
+put(vec.op_add(1, 2.5), tag)
+put(vec.op_div(3, 4), tag)
@@ -0,0 +1,51 @@
+import math
+
+assert type(2 + 3) == "int"
+assert type(2 + 3.0) == "float"
+assert type(2.0 + 3) == "float"
+assert type(2 / 2) == "float"
+assert type(7 // 2.0) == "int"
+
+assert 7 - 10 == -3
+assert 7 * -3 == -21
+assert 7 // 2 == 3
+assert -7 // 2 == -3
+assert 7 % 3 == 1
+assert -7 % 3 == -1
+assert 7.5 % 2 == 1.5
+assert 7 % 2.5 == 2.0
+assert 1 / 4 == 0.25
+assert 1.5 * 2 == 3.0
+assert 7.5 // 2 == 3
+
+assert 1 < 2
+assert 1 < 1.5
+assert 1.5 <= 1.5
+assert 2 > 1.5
+assert 2.0 >= 2
+assert !(2 < 2)
+assert !(2.5 > 2.5)
+
+n = math.nan
+assert n == n
+assert n <= n
+assert n >= n
+assert !(n < n)
+assert !(n > n)
+
+# The same sites see integers, floats and then strings
+values = [1, 2.5, 3, 4.5, "a", "b"]
+results = []
+for i in range(values.size - 1)
+	results.add(values[i] + values[i + 1])
+	assert values[i] == values[i]
+assert results == [3.5, 5.5, 7.5, "4.5a", "ab"]
+
+total = 0
+for i in range(1000)
+	if i % 2 == 0
+		total += i
+	else
+		total -= 0.5
+assert total == 249250.0
+assert type(total) == "float"
@@ -0,0 +1,53 @@
+# Folded expressions evaluate like they would at runtime
+assert 24 / 2 == 12.0
+assert type(24 / 2) == "float"
+assert -1 + 2 * 3 == 5
+assert 7 // 2 * 2 + 7 % 2 == 7
+assert "x" + 1 + "y" == "x1y"
+assert "a" < "b"
+assert not 0
+assert (true and 1 < 2) == 1
+assert (null ?? "z") == "z"
+assert (false ? 1 // 0 : 2) == 2
+
+# Constant tuples and lists are copied each time they are evaluated
+results = []
+for i in range(3)
+	t = (0, (0, 0))
+	l = [1, 2, [3]]
+	t[0] += i
+	t[1][0] += 1
+	l.add(i)
+	l[2].add(i)
+	results.add((t, l))
+assert results[2] == ((2, (1, 0)), [1, 2, [3, 2], 2])
+assert results[0] == ((0, (1, 0)), [1, 2, [3, 0], 0])
+
+func center(c = (0, 0, 0), scale = 24 / 2)
+	c[0] += scale
+	return c
+assert center() == (12.0, 0, 0)
+assert center() == (12.0, 0, 0)
+
+# Dead branches are removed, and live ones kept
+x = 0
+if false
+	x = 1
+else if 1 > 2
+	x = 2
+else
+	x = 3
+assert x == 3
+
+while false
+	x = 4
+assert x == 3
+
+func pick()
+	if true
+		return "live"
+	return "dead"
+assert pick() == "live"
+
+# Integer division by zero is left to fail when evaluated
+assert (1 < 2 ? 3 : 1 // 0) == 3
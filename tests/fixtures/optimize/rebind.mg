@@ -0,0 +1,7 @@
+# Names like true and false are only folded when never bound
+func flip()
+	true = 0
+	return true ? "yes" : "no"
+
+assert flip() == "no"
+assert (true ? "yes" : "no") == "yes"
@@ -0,0 +1,89 @@
+# Loops step through ranges without creating the list,
+# which must yield the same items as the list would
+
+func collect(items)
+	result = []
+	for item in items
+		result.add(item)
+	return result
+
+func check(a, b, c = null)
+	expected = c == null ? range(a, b) : range(a, b, c)
+	actual = []
+	if c == null
+		for i in range(a, b)
+			actual.add(i)
+	else
+		for i in range(a, b, c)
+			actual.add(i)
+	assert actual == expected
+	assert actual == collect(expected)
+
+check(0, 10)
+check(10, 0)
+check(0, 10, 3)
+check(10, 0, -3)
+check(0, 10, -1)
+check(5, 5)
+check(0.0, 1.0, 0.25)
+check(1.0, 0.0)
+check(0, 2.5)
+
+items = []
+for i in range(4)
+	items.add(i)
+assert items == [0, 1, 2, 3]
+assert type(items[0]) == "int"
+
+items = []
+for x in 2:8:2
+	items.add(x)
+assert items == [2, 4, 6]
+
+n = 5
+items = []
+for x in (n):0
+	items.add(x)
+assert items == [5, 4, 3, 2, 1]
+
+# Nested loops and early exits
+pairs = []
+for i in range(3)
+	for j in range(i)
+		pairs.add((i, j))
+assert pairs == [(1, 0), (2, 0), (2, 1)]
+
+func find(n)
+	for i in range(100)
+		if i * i >= n
+			return i
+	return null
+
+assert find(50) == 8
+assert find(100000) == null
+
+assert (for i in range(10) if i == 4 break i * 10) == 40
+assert (for i in range(4) i) == 3
+assert (for i in range(0) i) == null
+
+# Calls to anything but range are still iterated as lists
+range_ = range
+func range(a)
+	return [a, a]
+items = []
+for i in range(7)
+	items.add(i)
+assert items == [7, 7]
+range = range_
+
+import base
+items = []
+for i in base.range(3)
+	items.add(i)
+assert items == [0, 1, 2]
+
+# Ranges used as values are still lists
+a = range(3)
+assert type(a) == "list"
+a[0] = 10
+assert a == [10, 1, 2]
@@ -0,0 +1,30 @@
+
+a = "tuple"
+b = "tu" + "ple"
+
+assert a == b
+assert b == a
+assert a != "list"
+assert b != "list"
+assert type((1, 2)) == "tuple"
+assert type((1, 2)) == b
+assert type([1, 2]) != "tuple"
+
+
+m = {"key": 1}
+m["k" + "ey"] += 1
+m["other"] = 3
+m[b] = 4
+
+assert m["key"] == 2
+assert m.key == 2
+assert m["tuple"] == 4
+assert m[type((1, 2))] == 4
+assert m.has("ke" + "y")
+assert m.keys() == ["key", "other", "tuple"]
+
+for k, v in m.pairs()
+	assert m[k] == v
+
+m.pop("k" + "ey")
+assert m.keys() == ["other", "tuple"]
@@ -0,0 +1,50 @@
+a = buffer([(1, 2, 3), (4, 5, 6)])
+b = buffer([1, 2, 3, 4, 5], "int")
+
+assert type(a) == "buffer"
+assert len(a) == 2 and a.size == 2
+assert a.components == 3 and a.format == "float"
+assert b.components == 1 and b.format == "int"
+
+assert a[0] == vec3(1, 2, 3)
+assert a[-1] == (4, 5, 6)
+assert b[1] == 2 and type(b[1]) == "int"
+
+assert a + a == a * 2
+assert a - 1 == buffer([(0, 1, 2), (3, 4, 5)])
+assert a * (1, 0, -1) == buffer([(1, 0, -3), (4, 0, -6)])
+assert 12 / a == buffer([(12, 6, 4), (3, 2.4, 2)])
+assert -a == a * -1
+assert b % 2 == buffer([1, 0, 1, 0, 1], "int")
+assert (b * 2).format == "int"
+assert (b / 2).format == "float"
+assert b + 0.5 == buffer([1.5, 2.5, 3.5, 4.5, 5.5])
+
+assert a == buffer(a, "int")
+assert a != buffer([(1, 2, 3)])
+assert buffer(2, "int", 3) == buffer([(0, 0, 0), (0, 0, 0)])
+
+c = a.copy()
+c[0] = 7
+c.add((1, 1, 1), vec3(2, 2, 2))
+c.extend([(3, 3, 3)])
+assert c == buffer([(7, 7, 7), (4, 5, 6), (1, 1, 1), (2, 2, 2), (3, 3, 3)])
+assert a[0] == (1, 2, 3)
+
+delete c[0]
+assert len(c) == 4
+assert c.slice(1, -1) == buffer([(1, 1, 1), (2, 2, 2)])
+assert c.slice(-1, 0, -2) == buffer([(3, 3, 3), (1, 1, 1)])
+
+sum = 0
+for x in b
+	sum += x
+assert sum == 15
+
+assert b as tuple == (1, 2, 3, 4, 5)
+assert [(1, 2), (3, 4)] as buffer == buffer([vec2(1, 2), vec2(3, 4)])
+
+print(a, b)
+print(a / 2)
+print(a as list)
+print(buffer([(1, 2, 3, 4, 5)]))
@@ -0,0 +1,35 @@
+
+a = 2147483647
+b = -2147483647 - 1
+
+assert a > 0
+assert b < 0
+assert a + b == -1
+assert type(a) == "int"
+assert type(b) == "int"
+
+f = -1.5
+assert f < 0
+assert f * 2 == -3.0
+assert type(f) == "float"
+assert int(f) == -1
+assert float(a) > 2147483000.0
+
+x = 1
+y = x
+x += 1
+assert x == 2
+assert y == 1
+
+l = [1, 2.5, null]
+l2 = l.copy()
+l[0] += 10
+assert l == [11, 2.5, null]
+assert l2 == [1, 2.5, null]
+assert l[2] == null
+assert type(l[2]) == "null"
+
+t = 0
+for i in range(10)
+	t += i
+assert t == 45
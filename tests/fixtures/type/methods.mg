@@ -0,0 +1,33 @@
+import math
+
+# The same call site sees lists and maps
+func take(c, key)
+	return c.pop(key)
+
+assert take([5, 6], 0) == 5
+assert take({"k": 7}, "k") == 7
+assert take([8], -1) == 8
+
+# Map values are called when the key isn't a method
+m = {"double": (func(x) return x * 2)}
+assert m.double(4) == 8
+assert m.has("double")
+
+f = m.pop
+f("double")
+assert m.size == 0
+
+# Module attributes follow changes to the module
+func area(r)
+	return math.pi * r * r
+
+assert area(1) > 3.14
+math.pi = 3
+assert area(1) == 3
+math.scale = 2
+assert area(2) == 12
+
+# Removing a global moves the ones after it
+delete math.epsilon
+delete math.sin
+assert area(1) == 3
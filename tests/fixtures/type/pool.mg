@@ -0,0 +1,38 @@
+
+# Lists and maps growing past the largest size class move
+# their storage from the pool to the heap and back again
+for round in range(3)
+	l = []
+	m = {}
+	for i in range(200)
+		l.add([i, i * 2])
+		m["k" + string(i)] = (i, string(i))
+
+	assert l.size == 200
+	assert m.size == 200
+	assert l[199] == [199, 398]
+	assert m["k150"] == (150, "150")
+
+	for i in range(190)
+		l.pop()
+		m.pop("k" + string(i))
+
+	assert l.size == 10
+	assert m.size == 10
+	assert l[9] == [9, 18]
+	assert m["k195"][1] == "195"
+	assert !m.has("k0")
+
+	l.clear()
+	m.clear()
+	assert l.size == 0
+	assert m.size == 0
+
+# Freed values are reused without sharing state
+a = [1, 2, 3]
+a = null
+b = [4, 5, 6]
+c = b.copy()
+c[0] = 7
+assert b == [4, 5, 6]
+assert c == [7, 5, 6]
@@ -0,0 +1,45 @@
+a = vec3(1, 2, 3)
+b = vec3(0.5)
+
+assert type(a) == "vec3"
+assert type(vec2(1, 2)) == "vec2"
+assert type(vec4(1, 2, 3, 4)) == "vec4"
+assert len(a) == 3
+
+assert a + b == (1.5, 2.5, 3.5)
+assert a - 1 == vec3(0, 1, 2)
+assert 2 * a == vec3(2, 4, 6)
+assert a / 2 == (0.5, 1, 1.5)
+assert a % 2 == (1, 0, 1)
+assert -a == (-1, -2, -3)
+assert a + (1, 1, 1) == (1, 1, 1) + a
+
+assert a == vec3(1, 2, 3.0000001)
+assert a != b
+assert a != vec2(1, 2)
+assert a != null
+
+x, y, z = a
+assert (x, y, z) == (1, 2, 3)
+assert type(x) == "float"
+
+assert a[0] == 1 and a[-1] == 3
+assert a.x == 1 and a.y == 2 and a.z == 3
+
+sum = 0
+for c in a
+	sum += c
+assert sum == 6
+
+assert a as tuple == (1.0, 2.0, 3.0)
+assert type(a as list) == "list"
+assert (4, 5) as vec2 == vec2(4, 5)
+assert vec4([1, 2, 3, 4]) == vec4(1, 2, 3, 4)
+
+print(a, b, -vec2(1.5, 2))
+print(vec4(a[0], a[1], a[2], 1))
+print(map(v -> v * 2, [a, b]))
+print("a = " + a)
+
+emit (a, vec3(0, 0, 1))
+emit (1, 2, 3, b)
@@ -0,0 +1,53 @@
+#ifndef MODELGEN_TEST_FORMAT_H
+#define MODELGEN_TEST_FORMAT_H
+
+#include <math.h>
+
+#include "weld.h"
+#include "debug.h"
+
+#include "test.h"
+
+
+MG_TEST(mgTestWeldVertices)
+{
+	const float e = MG_WELD_EPSILON;
+
+	// The third vertex is within epsilon of the first, across the edge
+	// of a cell, while the fourth differs only by its normal
+	const float vertices[][6] = {
+		{ 1.0f, 2.0f, 3.0f, 0.0f, 1.0f, 0.0f },
+		{ 4.0f, 5.0f, 6.0f, 0.0f, 0.0f, 1.0f },
+		{ 1.0f + e * 0.5f, 2.0f - e * 0.5f, 3.0f, 0.0f, 1.0f, e * 0.5f },
+		{ 1.0f, 2.0f, 3.0f, 1.0f, 0.0f, 0.0f },
+		{ 4.0f, 5.0f, 6.0f, 0.0f, 0.0f, 1.0f },
+		{ NAN, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ NAN, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ 1.0f + e * 3.0f, 2.0f, 3.0f, 0.0f, 1.0f, 0.0f }
+	};
+
+	const size_t count = sizeof(vertices) / sizeof(vertices[0]);
+
+	uint32_t indices[8], uniques[8];
+
+	mgTestAssertIntEquals((int) mgWeldVertices(&vertices[0][0], count, 6, 6, e, indices, uniques), 6);
+
+	const uint32_t expectedIndices[] = { 0, 1, 0, 2, 1, 3, 4, 5 };
+	const uint32_t expectedUniques[] = { 0, 1, 3, 5, 6, 7 };
+
+	mgTestAssert(!memcmp(indices, expectedIndices, sizeof(expectedIndices)));
+	mgTestAssert(!memcmp(uniques, expectedUniques, sizeof(expectedUniques)));
+
+	// Only positions, which leaves the normal of the fourth vertex out
+	mgTestAssertIntEquals((int) mgWeldVertices(&vertices[0][0], count, 6, 3, e, indices, uniques), 5);
+	mgTestAssertIntEquals((int) indices[3], 0);
+	mgTestAssertIntEquals((int) indices[7], 4);
+}
+
+
+static inline void mgRunFormatTests(void)
+{
+	mgRunTestCase(&mgTestWeldVertices);
+}
+
+#endif
\ No newline at end of file
@@ -14,9 +14,17 @@
 #define _MG_ERROR_FILENAME "tests/_test.err"
 
 
-static int _mgRun(const char *in)
+// The binary built alongside the tests, relative to the repository root
+#if _WIN32
+#define _MG_LOCAL_EXECUTABLE "bin\\modelgen"
+#else
+#define _MG_LOCAL_EXECUTABLE "bin/modelgen"
+#endif
+
+
+static int _mgRunEx(const char *executable, const char *in, const char *options)
 {
-#define _MG_COMMAND_FORMAT "modelgen \"%s\" > \"" _MG_OUTPUT_FILENAME "\" 2> \"" _MG_ERROR_FILENAME "\"", in
+#define _MG_COMMAND_FORMAT "%s %s\"%s\" > \"" _MG_OUTPUT_FILENAME "\" 2> \"" _MG_ERROR_FILENAME "\"", executable, options, in
 
 	size_t len = (size_t) snprintf(NULL, 0, _MG_COMMAND_FORMAT);
 	MG_ASSERT(len >= 0);
@@ -34,11 +42,36 @@ static int _mgRun(const char *in)
 }
 
 
+static inline int _mgRun(const char *in, const char *options)
+{
+	return _mgRunEx("modelgen", in, options);
+}
+
+
+// Runs the built binary, as the error ends the process, and returns
+// whether the script failed with an error containing message
+static MGbool _mgRunScriptRejected(const char *filename, const char *options, const char *message)
+{
+	int status = _mgRunEx(_MG_LOCAL_EXECUTABLE, filename, options);
+	char *error = mgReadFile(_MG_ERROR_FILENAME, NULL);
+
+	MGbool rejected = (status != 0) && error && strstr(error, message);
+
+	free(error);
+
+	remove(_MG_OUTPUT_FILENAME);
+	remove(_MG_ERROR_FILENAME);
+
+	return rejected;
+}
+
+
 static void _mgInterpreterTest(const MGTestCase *test)
 {
 	const char *in = ((const char**) test->data)[0];
 	const char *out = ((const char**) test->data)[1];
 	const char *err = ((const char**) test->data)[2];
+	const char *options = ((const char**) test->data)[3];
 
 	char *expectedOutput = NULL;
 	char *expectedError = NULL;
@@ -46,7 +79,7 @@ static void _mgInterpreterTest(const MGTestCase *test)
 	char *actualOutput = NULL;
 	char *actualError = NULL;
 
-	int status = _mgRun(in);
+	int status = _mgRun(in, options);
 
 	if (!mgFileExists(_MG_OUTPUT_FILENAME) || !(actualOutput = mgReadFile(_MG_OUTPUT_FILENAME, NULL)))
 	{
@@ -146,11 +179,12 @@ pass:
 }
 
 
-static void mgRunInterpreterTest(const char *in)
+static void _mgRunInterpreterTestEx(const char *in, const char *options)
 {
+	char name[MG_PATH_MAX + 32];
 	char out[MG_PATH_MAX + 1];
 	char err[MG_PATH_MAX + 1];
-	const char *files[3] = { in, out, err };
+	const char *files[4] = { in, out, err, options };
 
 	if (!mgStringEndsWith(in, ".mg"))
 		return;
@@ -165,6 +199,12 @@ static void mgRunInterpreterTest(const char *in)
 	MGTestCase test;
 	test.name = in;
 
+	if (options[0])
+	{
+		snprintf(name, sizeof(name), "%s (%.*s)", in, (int) (strlen(options) - 1), options);
+		test.name = name;
+	}
+
 #if _WIN32
 	test.skip = mgBasename(in)[0] == '_';
 #else
@@ -178,6 +218,15 @@ static void mgRunInterpreterTest(const char *in)
 }
 
 
+static void mgRunInterpreterTest(const char *in)
+{
+	// Run every fixture through both the bytecode VM
+	// and the AST walker, and expect identical results
+	_mgRunInterpreterTestEx(in, "");
+	_mgRunInterpreterTestEx(in, "--walk-ast ");
+}
+
+
 static inline void mgRunInterpreterTests(void)
 {
 	mgWalkFiles("tests/fixtures/", mgRunInterpreterTest);
@@ -0,0 +1,111 @@
+#ifndef MODELGEN_TEST_MODULES_H
+#define MODELGEN_TEST_MODULES_H
+
+#include "test.h"
+#include "interpret.h"
+#include "script.h"
+
+
+MG_TEST(mgTestNativeVec)
+{
+	MGScriptTestRun native, reference;
+	_mgCreateScriptTestRun(&native);
+	_mgCreateScriptTestRun(&reference);
+	reference.reference = MG_TRUE;
+
+	_mgRunScriptTest(&native, "tests/fixtures/modules/veclib.mg", NULL);
+	_mgRunScriptTest(&reference, "tests/fixtures/modules/veclib.mg", NULL);
+
+	mgTestAssert(native.vertexCount > 0);
+	mgTestAssert(_mgScriptTestRunsEqual(&native, &reference));
+
+	_mgDestroyScriptTestRun(&native);
+	_mgDestroyScriptTestRun(&reference);
+}
+
+
+MG_TEST(mgTestNativeMat)
+{
+	MGScriptTestRun native, reference;
+	_mgCreateScriptTestRun(&native);
+	_mgCreateScriptTestRun(&reference);
+	reference.reference = MG_TRUE;
+
+	_mgRunScriptTest(&native, "tests/fixtures/modules/matlib.mg", NULL);
+	_mgRunScriptTest(&reference, "tests/fixtures/modules/matlib.mg", NULL);
+
+	mgTestAssert(native.vertexCount > 0);
+	mgTestAssert(_mgScriptTestRunsEqual(&native, &reference));
+
+	_mgDestroyScriptTestRun(&native);
+	_mgDestroyScriptTestRun(&reference);
+}
+
+
+MG_TEST(mgTestEmitMany)
+{
+	MGScriptTestRun run;
+	_mgCreateScriptTestRun(&run);
+
+	_mgRunScriptTest(&run, "tests/fixtures/modules/emit_many.mg", NULL);
+
+	const size_t half = run.vertexCount / 2;
+
+	mgTestAssert(half > 0);
+	mgTestAssert((run.vertexCount % 2) == 0);
+	mgTestAssert(!memcmp(run.vertices, run.vertices + half * 6, half * sizeof(MGVertex)));
+
+	_mgDestroyScriptTestRun(&run);
+}
+
+
+MG_TEST(mgTestTaskTransforms)
+{
+	size_t vertexCount;
+	mgTestAssert(_mgScriptTestMatchesAcrossThreads("tests/fixtures/modules/transform.mg", NULL, 1, 8, &vertexCount));
+	mgTestAssert(vertexCount > 0);
+}
+
+
+// geom keeps the matrices of the reference modules/mat.mg as
+// they are, which must transform like the native mat module
+MG_TEST(mgTestReferenceTransforms)
+{
+	MGScriptTestRun native, reference;
+	_mgCreateScriptTestRun(&native);
+	_mgCreateScriptTestRun(&reference);
+	reference.reference = MG_TRUE;
+
+	_mgRunScriptTest(&native, "tests/fixtures/modules/transform.mg", NULL);
+	_mgRunScriptTest(&reference, "tests/fixtures/modules/transform.mg", NULL);
+
+	mgTestAssert(native.vertexCount > 0);
+	mgTestAssert(_mgScriptTestRunsEqual(&native, &reference));
+
+	_mgDestroyScriptTestRun(&native);
+	_mgDestroyScriptTestRun(&reference);
+}
+
+
+// Assigning an item of a native matrix or vector is an error, rather
+// than a silent change of a copied row
+MG_TEST(mgTestImmutableMat)
+{
+	mgTestAssert(_mgRunScriptRejected("tests/fixtures/modules/_mat_immutable.mg", "",
+	                                  "Error: vec4 is immutable"));
+	mgTestAssert(_mgRunScriptRejected("tests/fixtures/modules/_mat_immutable.mg", "--walk-ast ",
+	                                  "Error: vec4 is immutable"));
+}
+
+
+static inline void mgRunModuleTests(void)
+{
+	mgRunTestCase(&mgTestNativeVec);
+	mgRunTestCase(&mgTestNativeMat);
+	mgRunTestCase(&mgTestEmitMany);
+	mgRunTestCase(&mgTestTaskTransforms);
+	mgRunTestCase(&mgTestReferenceTransforms);
+	mgRunTestCase(&mgTestImmutableMat);
+}
+
+#endif
\ No newline at end of file
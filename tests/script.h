@@ -0,0 +1,123 @@
+#ifndef MODELGEN_TEST_SCRIPT_H
+#define MODELGEN_TEST_SCRIPT_H
+
+#include "instance.h"
+#include "types/composite.h"
+#include "utilities.h"
+#include "debug.h"
+
+#include "test.h"
+
+
+// Runs scripts in an instance of their own and keeps the vertices they
+// emitted, which tests compare between different options
+
+typedef struct MGScriptTestRun {
+	MGbool walkAST;
+	// Threads used by pmap and tasks, see MGInstance
+	unsigned int threadCount;
+	// Removes the static vec and mat modules, such that "import vec"
+	// and "import mat" fall back to modules/vec.mg and modules/mat.mg
+	MGbool reference;
+	float *vertices;
+	size_t vertexCount;
+} MGScriptTestRun;
+
+
+static void _mgCreateScriptTestRun(MGScriptTestRun *run)
+{
+	run->walkAST = MG_FALSE;
+	run->threadCount = 1;
+	run->reference = MG_FALSE;
+	run->vertices = NULL;
+	run->vertexCount = 0;
+}
+
+
+static void _mgDestroyScriptTestRun(MGScriptTestRun *run)
+{
+	free(run->vertices);
+
+	run->vertices = NULL;
+	run->vertexCount = 0;
+}
+
+
+// Runs the file, or the string if filename is NULL
+static void _mgRunScriptTest(MGScriptTestRun *run, const char *filename, const char *string)
+{
+	MGInstance instance;
+	mgCreateInstance(&instance);
+
+	instance.vertexSize.position = 3;
+	instance.vertexSize.normal = 3;
+	instance.walkAST = run->walkAST;
+	instance.threadCount = run->threadCount;
+
+	if (run->reference)
+	{
+		mgMapRemove(instance.staticModules, "vec");
+		mgMapRemove(instance.staticModules, "mat");
+	}
+
+	_mgListAdd(char*, instance.path, mgStringDuplicate("modules"));
+
+	if (filename)
+		mgRunFile(&instance, filename, NULL);
+	else
+		mgRunString(&instance, string, "<test>");
+
+	run->vertexCount = _mgListLength(instance.vertices);
+	run->vertices = (float*) malloc((run->vertexCount ? run->vertexCount : 1) * sizeof(MGVertex));
+	MG_ASSERT(run->vertices);
+
+	memcpy(run->vertices, _mgListItems(instance.vertices), run->vertexCount * sizeof(MGVertex));
+
+	mgDestroyInstance(&instance);
+}
+
+
+static MGbool _mgScriptTestRunsEqual(const MGScriptTestRun *a, const MGScriptTestRun *b)
+{
+	return (a->vertexCount == b->vertexCount) && !memcmp(a->vertices, b->vertices, a->vertexCount * sizeof(MGVertex));
+}
+
+
+// Runs the script using the tree walker, which runs pmap and tasks on
+// a single thread, then using the VM with every thread count within
+// [minThreadCount, maxThreadCount], and returns whether every run emitted
+// the same vertices, of which the count is returned in vertexCount
+static MGbool _mgScriptTestMatchesAcrossThreads(const char *filename, const char *string,
+                                               unsigned int minThreadCount, unsigned int maxThreadCount,
+                                               size_t *vertexCount)
+{
+	MGScriptTestRun expected;
+	_mgCreateScriptTestRun(&expected);
+	expected.walkAST = MG_TRUE;
+
+	_mgRunScriptTest(&expected, filename, string);
+
+	MGbool match = MG_TRUE;
+
+	for (unsigned int threadCount = minThreadCount; threadCount <= maxThreadCount; ++threadCount)
+	{
+		MGScriptTestRun run;
+		_mgCreateScriptTestRun(&run);
+		run.threadCount = threadCount;
+
+		_mgRunScriptTest(&run, filename, string);
+
+		if (!_mgScriptTestRunsEqual(&run, &expected))
+			match = MG_FALSE;
+
+		_mgDestroyScriptTestRun(&run);
+	}
+
+	*vertexCount = expected.vertexCount;
+
+	_mgDestroyScriptTestRun(&expected);
+
+	return match;
+}
+
+#endif
\ No newline at end of file
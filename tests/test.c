@@ -3,6 +3,9 @@
 #include "tokenize.h"
 #include "parse.h"
 #include "interpret.h"
+#include "concurrency.h"
+#include "modules.h"
+#include "format.h"
 
 
 int main(int argc, char *argv[])
@@ -11,6 +14,9 @@ int main(int argc, char *argv[])
 	mgRunTokenizerTests();
 	mgRunParserTests();
 	mgRunInterpreterTests();
+	mgRunConcurrencyTests();
+	mgRunModuleTests();
+	mgRunFormatTests();
 	mgTestingEnd();
 
 	return _mgTestsFailed ? EXIT_FAILURE : EXIT_SUCCESS;